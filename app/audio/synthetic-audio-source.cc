@@ -0,0 +1,113 @@
+#include "synthetic-audio-source.h"
+#include "platform.h"
+#include "logger.h"
+#include <math.h>
+
+// 10ms 一包，和 wasapi 默认周期接近
+#define SYNTHETIC_AUDIO_PACKET_MS 10
+
+SyntheticAudioSource::SyntheticAudioSource()
+{
+	work_run_.store(false);
+}
+
+SyntheticAudioSource::~SyntheticAudioSource()
+{
+	work_run_.store(false);
+	if (work_thread_.joinable())
+		work_thread_.join();
+}
+
+void SyntheticAudioSource::RegisterAudioDataReceivedCallback(AudioDataReceived callback)
+{
+	data_received_callback_ = callback;
+}
+
+void SyntheticAudioSource::UnRegisterAudioDataReceivedCallback()
+{
+	data_received_callback_ = nullptr;
+}
+
+bool SyntheticAudioSource::InitSyntheticAudio(WaveType type, double frequency, float amplitude, uint64_t seed,
+	enum CoreAudioData::speaker_layout speakers, uint32_t samples_per_sec)
+{
+	if (work_run_.load() || !samples_per_sec || CoreAudioData::get_audio_channels(speakers) <= 0)
+		return false;
+
+	wave_type_ = type;
+	frequency_ = frequency;
+	amplitude_ = amplitude;
+	seed_ = seed;
+	speakers_ = speakers;
+	samples_per_sec_ = samples_per_sec;
+
+	work_run_.store(true);
+	work_thread_ = std::thread(&SyntheticAudioSource::WorkThreadImpl, this);
+	return true;
+}
+
+void SyntheticAudioSource::FillSamples(uint64_t first_sample, uint32_t frames)
+{
+	const int channels = CoreAudioData::get_audio_channels(speakers_);
+	for (int i = 0; i < channels; i++)
+		planes_[i].resize(frames);
+
+	if (wave_type_ == WaveType::kTone)
+	{
+		const double two_pi = 6.283185307179586;
+		for (uint32_t i = 0; i < frames; i++)
+		{
+			// 相位按采样序号直接算，不做累加，避免误差随时间漂移
+			uint64_t n = first_sample + i;
+			double phase = fmod((double)n * frequency_ / (double)samples_per_sec_, 1.0);
+			float v = amplitude_ * (float)sin(two_pi * phase);
+			for (int c = 0; c < channels; c++)
+				planes_[c][i] = v;
+		}
+	}
+	else
+	{
+		for (uint32_t i = 0; i < frames; i++)
+		{
+			for (int c = 0; c < channels; c++)
+			{
+				// 每个声道的每个采样单独做一次 SplitMix，声道之间互不相关
+				uint64_t x = seed_ + ((first_sample + i) * channels + c) * 0x9E3779B97F4A7C15ULL;
+				x = (x ^ (x >> 30)) * 0xBF58476D1CE4E5B9ULL;
+				x = (x ^ (x >> 27)) * 0x94D049BB133111EBULL;
+				x ^= x >> 31;
+				float v = (float)(x >> 40) / 8388608.0f - 1.0f;
+				planes_[c][i] = amplitude_ * v;
+			}
+		}
+	}
+}
+
+void SyntheticAudioSource::WorkThreadImpl()
+{
+	const uint32_t frames = samples_per_sec_ * SYNTHETIC_AUDIO_PACKET_MS / 1000;
+	const uint64_t start_ns = os_gettime_ns();
+	uint64_t samples = 0;
+
+	LOGGER_INFO("[SyntheticAudio] start, type:%d rate:%u", (int)wave_type_, samples_per_sec_);
+	while (work_run_.load())
+	{
+		FillSamples(samples, frames);
+
+		CoreAudioData::AudioMixerOutput data = {};
+		for (int i = 0; i < MAX_AV_PLANES; i++)
+			data.data[i] = planes_[i].empty() ? nullptr : (uint8_t*)planes_[i].data();
+		data.frames = frames;
+		data.speakers = speakers_;
+		data.format = CoreAudioData::AUDIO_FORMAT_FLOAT_PLANAR;
+		data.samples_per_sec = samples_per_sec_;
+		data.timestamp = start_ns + audio_frames_to_ns(samples_per_sec_, samples);
+
+		if (data_received_callback_)
+			data_received_callback_(&data);
+
+		samples += frames;
+		os_sleepto_ns(start_ns + audio_frames_to_ns(samples_per_sec_, samples));
+	}
+	LOGGER_INFO("[SyntheticAudio] thread finished");
+}
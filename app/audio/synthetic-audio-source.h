@@ -0,0 +1,52 @@
+#ifndef SYNTHETIC_AUDIO_SOURCE_H
+#define SYNTHETIC_AUDIO_SOURCE_H
+
+/* 合成音频源，和 TestPatternSource 配套做压测
+* 输出正弦音或者按 seed 生成的白噪声，回调接口和 WasapiAudioSource 一致，CoreAudio 可以直接替换
+* 采样值只由采样序号和 seed 决定，逐位可复现
+*/
+
+#include <thread>
+#include <atomic>
+#include <functional>
+#include <vector>
+#include "core-audio-data.h"
+
+using AudioDataReceived = std::function<void(const CoreAudioData::AudioMixerOutput*)>;
+
+class SyntheticAudioSource
+{
+public:
+	enum class WaveType
+	{
+		kTone,
+		kNoise,
+	};
+
+	SyntheticAudioSource();
+	~SyntheticAudioSource();
+
+	bool InitSyntheticAudio(WaveType type, double frequency, float amplitude, uint64_t seed,
+		enum CoreAudioData::speaker_layout speakers, uint32_t samples_per_sec);
+	void RegisterAudioDataReceivedCallback(AudioDataReceived callback);
+	void UnRegisterAudioDataReceivedCallback();
+
+private:
+	void WorkThreadImpl();
+	void FillSamples(uint64_t first_sample, uint32_t frames);
+
+private:
+	WaveType wave_type_ = WaveType::kTone;
+	double frequency_ = 1000.0;
+	float amplitude_ = 0.25f;
+	uint64_t seed_ = 0;
+	enum CoreAudioData::speaker_layout speakers_ = CoreAudioData::SPEAKERS_STEREO;
+	uint32_t samples_per_sec_ = 48000;
+
+	std::thread work_thread_;
+	std::atomic<bool> work_run_;
+	std::vector<float> planes_[MAX_AV_PLANES];
+	AudioDataReceived data_received_callback_ = nullptr;
+};
+
+#endif
@@ -0,0 +1,186 @@
+/* 内置滤镜的 CPU 版本
+* tiny-bench cpu-filter [--filter split|alpha-clip|bolt|all] [--iterations N] [--threads N]
+* 每个滤镜在 720p / 1080p / 4K 下输出单线程 C / AVX2 / 多线程的每帧耗时
+* 同时检查 AVX2 和多线程结果与单线程 C 逐字节相同，split 再和按着色器公式直接算的结果比较 (允许差 1)
+*/
+
+#include "bench-util.h"
+#include "cpu-filter.h"
+#include "task-pool.h"
+#include "cpu-features.h"
+#include "test-pattern-generator.h"
+#include <math.h>
+#include <string.h>
+#include <memory>
+#include <functional>
+
+namespace
+{
+	struct Resolution
+	{
+		const char* name;
+		int width;
+		int height;
+	};
+
+	const Resolution kResolutions[] = {
+		{ "720p", 1280, 720 },
+		{ "1080p", 1920, 1080 },
+		{ "4K", 3840, 2160 },
+	};
+
+	// 闪电位图的大小，和素材差不多
+	const int kBoltWidth = 256;
+	const int kBoltHeight = 32;
+	const int kBoltLineHeight = 50;
+	const int kBoltSteps = 60;
+
+	using Frame = std::vector<uint8_t>;
+	using FilterFunc = std::function<void(const Frame& src, Frame& dst, int width, int height, const CpuFilter::Options& options)>;
+
+	void FillSource(Frame& frame, int width, int height)
+	{
+		TestPatternGenerator::Params params;
+		params.type = TestPatternGenerator::PatternType::kMovingGradient;
+		params.width = width;
+		params.height = height;
+		params.entropy = 10;
+		params.seed = 42;
+		TestPatternGenerator generator;
+		generator.SetParams(params);
+		frame.resize((size_t)width * height * 4);
+		generator.Generate(7, frame.data(), width * 4);
+		// alpha 也要有变化，alpha-clip 才有意义
+		for (int y = 0; y < height; y++)
+		{
+			for (int x = 0; x < width; x++)
+				frame[((size_t)y * width + x) * 4 + 3] = (uint8_t)((x * 7 + y * 3) & 0xFF);
+		}
+	}
+
+	std::vector<uint8_t> MakeBoltBitmap()
+	{
+		std::vector<uint8_t> bitmap((size_t)kBoltWidth * kBoltHeight * 4);
+		for (int y = 0; y < kBoltHeight; y++)
+		{
+			for (int x = 0; x < kBoltWidth; x++)
+			{
+				uint8_t* p = &bitmap[((size_t)y * kBoltWidth + x) * 4];
+				p[0] = (uint8_t)(x * 255 / (kBoltWidth - 1));
+				p[1] = (uint8_t)(y * 255 / (kBoltHeight - 1));
+				p[2] = (uint8_t)((x ^ y) * 8);
+				p[3] = 255;
+			}
+		}
+		return bitmap;
+	}
+
+	// 按 Basic_PS_ThreeMirror.hlsl 的公式逐像素算，浮点线性插值
+	bool CheckThreeMirror(const Frame& src, const Frame& dst, int width, int height)
+	{
+		for (int y = 0; y < height; y++)
+		{
+			const uint8_t* line = &src[(size_t)y * width * 4];
+			const uint8_t* out = &dst[(size_t)y * width * 4];
+			for (int x = 0; x < width; x++)
+			{
+				double u = (x + 0.5) / width;
+				if (u < 1 / 3.0)
+					u += 1 / 3.0;
+				else if (u > 2 / 3.0)
+					u = 1 / 3.0 + (u - 2 / 3.0);
+				double s = u * width - 0.5;
+				int x0 = (int)floor(s);
+				double f = s - x0;
+				int x1 = x0 + 1 < width ? x0 + 1 : 0;
+				for (int c = 0; c < 4; c++)
+				{
+					double v = line[x0 * 4 + c] * (1.0 - f) + line[x1 * 4 + c] * f;
+					if (fabs(v - out[x * 4 + c]) > 1.0)
+						return false;
+				}
+			}
+		}
+		return true;
+	}
+
+	int BenchCpuFilter(int argc, char* argv[])
+	{
+		const std::string which = BenchArg(argc, argv, "--filter", "all");
+		const int iterations = BenchArgInt(argc, argv, "--iterations", 20);
+		const int threads = BenchArgInt(argc, argv, "--threads", 0);
+
+		std::unique_ptr<TaskPool> own_pool;
+		TaskPool* pool = TaskPool::GetShared();
+		if (threads > 0)
+		{
+			own_pool.reset(new TaskPool(threads - 1));
+			pool = own_pool.get();
+		}
+
+		const std::vector<uint8_t> bolt = MakeBoltBitmap();
+		struct Case
+		{
+			const char* name;
+			FilterFunc func;
+		};
+		const Case cases[] = {
+			{ "split", [](const Frame& src, Frame& dst, int w, int h, const CpuFilter::Options& options) {
+				CpuFilter::ThreeMirror(src.data(), w * 4, dst.data(), w * 4, w, h, options);
+			} },
+			{ "alpha-clip", [](const Frame& src, Frame& dst, int w, int h, const CpuFilter::Options& options) {
+				// 往固定的底色上合成，每次结果相同
+				memset(dst.data(), 0x40, dst.size());
+				CpuFilter::AlphaClip(src.data(), w * 4, dst.data(), w * 4, w, h, options);
+			} },
+			{ "bolt", [&bolt](const Frame& src, Frame& dst, int w, int h, const CpuFilter::Options& options) {
+				// 跨两条边的那一步，两个四边形都画
+				BoltPath::Quad quads[BoltPath::kMaxQuads];
+				size_t count = BoltPath::BuildQuads(w, h, kBoltLineHeight, 1, kBoltSteps, quads);
+				CpuFilter::BoltBox(src.data(), w * 4, dst.data(), w * 4, w, h, quads, count,
+					bolt.data(), kBoltWidth * 4, kBoltWidth, kBoltHeight, options);
+			} },
+		};
+
+		printf("avx2:%s threads:%zu iterations:%d\n", cpu_has_avx2() ? "yes" : "no", pool->GetThreadCount() + 1, iterations);
+		printf("%-11s %-6s %10s %10s %10s %10s %8s\n", "filter", "size", "C", "AVX2", "MT", "MP/s(MT)", "check");
+
+		bool all_ok = true;
+		for (const auto& c : cases)
+		{
+			if (which != "all" && which != c.name)
+				continue;
+			for (const auto& res : kResolutions)
+			{
+				Frame src, ref, simd, mt;
+				FillSource(src, res.width, res.height);
+				ref.resize(src.size());
+				simd.resize(src.size());
+				mt.resize(src.size());
+
+				CpuFilter::Options c_options;
+				c_options.use_simd = false;
+				CpuFilter::Options simd_options;
+				CpuFilter::Options mt_options;
+				mt_options.pool = pool;
+
+				BenchStats c_stats = BenchRun(1, iterations, [&]() { c.func(src, ref, res.width, res.height, c_options); });
+				BenchStats simd_stats = BenchRun(1, iterations, [&]() { c.func(src, simd, res.width, res.height, simd_options); });
+				BenchStats mt_stats = BenchRun(1, iterations, [&]() { c.func(src, mt, res.width, res.height, mt_options); });
+
+				bool ok = simd == ref && mt == ref;
+				if (ok && !strcmp(c.name, "split"))
+					ok = CheckThreeMirror(src, ref, res.width, res.height);
+				all_ok = all_ok && ok;
+
+				double mt_ms = mt_stats.MeanMs();
+				printf("%-11s %-6s %8.3fms %8.3fms %8.3fms %10.0f %8s\n", c.name, res.name,
+					c_stats.MeanMs(), simd_stats.MeanMs(), mt_ms,
+					mt_ms > 0 ? (double)res.width * res.height / 1e6 / (mt_ms / 1000.0) : 0.0, ok ? "ok" : "FAILED");
+			}
+		}
+		return all_ok ? 0 : 1;
+	}
+}
+
+BENCH_REGISTER("cpu-filter", "CPU split / alpha-clip / bolt filters at 720p, 1080p and 4K", BenchCpuFilter);
@@ -0,0 +1,209 @@
+/* 检测频率按负载调整
+* tiny-bench detect-governor [--cores N] [--seed N]
+* 模拟一台 cores 个核的机器：渲染 60fps、x264 编码、人脸检测抢同一批核，总需求超过核数时都按比例变慢，
+* 编码跟不上的帧进队列，空闲的核再把队列追回来；每 500ms 一个窗口交给 DetectRateGovernor
+* 分几段负载：空闲、编码重、检测变贵、场景渲染重、再空闲，对比固定 6fps、固定 15fps 和自动调整的
+* 每段检测频率、编码队列最大深度、渲染超时帧比例
+* 检查：空闲时升到上限、编码重时积压比固定 15fps 少得多且段末追平、检测变贵时不超 CPU 预算、
+* 渲染重时降到下限、频率一直在范围内、同一段负载里升降来回的次数有限
+*/
+
+#include "bench-util.h"
+#include "detect-rate-governor.h"
+#include <math.h>
+#include <random>
+#include <vector>
+
+namespace
+{
+	const int kFps = 60;
+	const double kFrameMs = 1000.0 / kFps;
+
+	struct Phase
+	{
+		const char* name;
+		int windows;
+		// 编码占用的核数
+		double encoder_cores;
+		// 一帧渲染的耗时，不抢核时
+		double render_ms;
+		// 一次检测的单核耗时，不抢核时
+		double detect_ms;
+	};
+
+	struct PhaseResult
+	{
+		double mean_rate = 0.0;
+		int end_rate = 0;
+		int min_rate = 1 << 30;
+		int max_rate = 0;
+		int changes = 0;
+		// 升降方向反过来的次数
+		int reversals = 0;
+		double max_queue = 0.0;
+		double end_queue = 0.0;
+		double late_ratio = 0.0;
+		double end_detect_cpu = 0.0;
+	};
+
+	class Machine
+	{
+	public:
+		Machine(double cores, uint32_t seed) : cores_(cores), rng_(seed) {}
+
+		// 跑一个窗口，返回这个窗口的负载
+		DetectRateGovernor::Sample Run(const Phase& phase, int rate, int window_ms)
+		{
+			std::normal_distribution<double> jitter(1.0, 0.08);
+			const double render_cores = phase.render_ms / kFrameMs;
+			const double demand = phase.encoder_cores + render_cores + rate * phase.detect_ms / 1000.0;
+			// 超过核数时所有人按同一个比例变慢
+			const double slow = std::max(1.0, demand / cores_);
+
+			const double frames = kFps * window_ms / 1000.0;
+			if (slow > 1.0)
+				queue_ += frames * (1.0 - 1.0 / slow);
+			else
+				queue_ = std::max(0.0, queue_ - frames * (cores_ - demand) / std::max(phase.encoder_cores, 0.1));
+			max_queue_ = std::max(max_queue_, queue_);
+
+			DetectRateGovernor::Sample sample;
+			sample.frame_interval_ns = (uint64_t)(kFrameMs * 1e6);
+			for (int i = 0; i < (int)frames; i++)
+			{
+				const double cost = phase.render_ms * slow * jitter(rng_);
+				sample.frames++;
+				sample.render_ns += (uint64_t)(cost * 1e6);
+				if (cost > kFrameMs)
+					sample.late_frames++;
+			}
+			sample.detect_count = (uint64_t)(rate * window_ms / 1000);
+			for (uint64_t i = 0; i < sample.detect_count; i++)
+				sample.detect_ns += (uint64_t)(phase.detect_ms * slow * jitter(rng_) * 1e6);
+			sample.encoder_queue = (int)ceil(queue_);
+			return sample;
+		}
+
+		double GetQueue() const { return queue_; }
+		double TakeMaxQueue()
+		{
+			double value = max_queue_;
+			max_queue_ = queue_;
+			return value;
+		}
+
+	private:
+		double cores_;
+		std::mt19937 rng_;
+		double queue_ = 0.0;
+		double max_queue_ = 0.0;
+	};
+
+	// fixed_rate 为 0 时用 DetectRateGovernor
+	std::vector<PhaseResult> Simulate(const std::vector<Phase>& phases, double cores, uint32_t seed, int fixed_rate,
+		const DetectRateGovernor::Params& params)
+	{
+		DetectRateGovernor governor(params);
+		Machine machine(cores, seed);
+		std::vector<PhaseResult> results;
+		for (const auto& phase : phases)
+		{
+			PhaseResult result;
+			uint64_t frames = 0, late = 0;
+			double rate_sum = 0.0;
+			int last_direction = 0;
+			for (int w = 0; w < phase.windows; w++)
+			{
+				const int rate = fixed_rate ? fixed_rate : governor.GetRate();
+				DetectRateGovernor::Sample sample = machine.Run(phase, rate, params.window_ms);
+				frames += sample.frames;
+				late += sample.late_frames;
+				rate_sum += rate;
+				result.min_rate = std::min(result.min_rate, rate);
+				result.max_rate = std::max(result.max_rate, rate);
+				if (!fixed_rate)
+				{
+					DetectRateGovernor::Decision decision = governor.Update(sample);
+					if (decision.changed)
+					{
+						const int direction = decision.rate > rate ? 1 : -1;
+						result.changes++;
+						result.reversals += last_direction && direction != last_direction ? 1 : 0;
+						last_direction = direction;
+					}
+					result.end_detect_cpu = decision.detect_ms * decision.rate / 1000.0;
+				}
+			}
+			result.mean_rate = rate_sum / phase.windows;
+			result.end_rate = fixed_rate ? fixed_rate : governor.GetRate();
+			result.max_queue = machine.TakeMaxQueue();
+			result.end_queue = machine.GetQueue();
+			result.late_ratio = frames ? (double)late / frames : 0.0;
+			results.push_back(result);
+		}
+		return results;
+	}
+
+	int BenchDetectGovernor(int argc, char* argv[])
+	{
+		const double cores = BenchArgInt(argc, argv, "--cores", 2);
+		const uint32_t seed = (uint32_t)BenchArgInt(argc, argv, "--seed", 7);
+
+		DetectRateGovernor::Params params;
+		const std::vector<Phase> phases = {
+			{ "idle", 40, 0.6, 6.0, 25.0 },
+			{ "encode", 60, 1.5, 6.0, 25.0 },
+			{ "detect", 40, 0.6, 6.0, 70.0 },
+			{ "render", 40, 0.6, 15.0, 25.0 },
+			{ "idle", 60, 0.6, 6.0, 25.0 },
+		};
+
+		struct Run
+		{
+			const char* name;
+			int fixed_rate;
+			std::vector<PhaseResult> results;
+		};
+		std::vector<Run> runs = { { "fixed 6", 6, {} }, { "fixed 15", 15, {} }, { "governor", 0, {} } };
+		for (auto& run : runs)
+			run.results = Simulate(phases, cores, seed, run.fixed_rate, params);
+
+		printf("cores:%.0f window:%dms rate:[%d, %d] start:%d cpu budget:%.2f\n", cores, params.window_ms, params.min_rate,
+			params.max_rate, params.initial_rate, params.cpu_budget);
+		printf("%-8s %-9s %9s %8s %8s %10s %10s %9s %8s\n", "phase", "run", "mean fps", "end fps", "changes", "reversals", "max queue", "end queue", "late");
+		for (size_t p = 0; p < phases.size(); p++)
+		{
+			for (const auto& run : runs)
+			{
+				const PhaseResult& r = run.results[p];
+				printf("%-8s %-9s %9.1f %8d %8d %10d %10.1f %9.1f %7.1f%%\n", phases[p].name, run.name, r.mean_rate, r.end_rate,
+					r.changes, r.reversals, r.max_queue, r.end_queue, r.late_ratio * 100.0);
+			}
+		}
+
+		const std::vector<PhaseResult>& fixed = runs[1].results;
+		const std::vector<PhaseResult>& gov = runs[2].results;
+		bool range_ok = true;
+		int max_reversals = 0;
+		for (const auto& r : gov)
+		{
+			range_ok = range_ok && r.min_rate >= params.min_rate && r.max_rate <= params.max_rate;
+			max_reversals = std::max(max_reversals, r.reversals);
+		}
+		const bool idle_ok = gov[0].end_rate == params.max_rate && gov[4].end_rate == params.max_rate;
+		// 核多时固定 15fps 也不积压，只看段末追平
+		const bool encode_ok = (gov[1].max_queue * 4 < fixed[1].max_queue || fixed[1].max_queue <= params.queue_high) &&
+			gov[1].end_queue <= params.queue_high;
+		const bool detect_ok = gov[2].end_detect_cpu <= params.cpu_budget && gov[2].end_rate < params.max_rate;
+		const bool render_ok = gov[3].end_rate == params.min_rate;
+		// 同一段负载里只允许追平积压后试探着回升再降的一两轮
+		const bool stable_ok = max_reversals <= 3;
+
+		printf("range:%s idle:%s encode:%s detect:%s render:%s stable:%s (max reversals per phase %d)\n",
+			range_ok ? "ok" : "FAILED", idle_ok ? "ok" : "FAILED", encode_ok ? "ok" : "FAILED", detect_ok ? "ok" : "FAILED",
+			render_ok ? "ok" : "FAILED", stable_ok ? "ok" : "FAILED", max_reversals);
+		return range_ok && idle_ok && encode_ok && detect_ok && render_ok && stable_ok ? 0 : 1;
+	}
+}
+
+BENCH_REGISTER("detect-governor", "load-driven face detection rate vs fixed rates on a simulated busy machine", BenchDetectGovernor);
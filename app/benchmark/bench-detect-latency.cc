@@ -0,0 +1,139 @@
+/* 检测结果和画面的时间对齐
+* tiny-bench detect-latency [--latency-ms N] [--detect-fps N] [--seconds N] [--speed N]
+* 人脸在 640 宽的画面里左右往返，检测每 1/detect-fps 秒取一帧，结果在 latency-ms 之后才能拿到；渲染 60fps
+* 三种取法的框中心误差：最新结果 (画面不动)、画面推迟测得的延迟再取对应时间的结果、按速度外推到当前画面
+* 检查推迟和外推的误差都小于直接用最新结果，直方图测到的延迟和设定的一致
+*/
+
+#include "bench-util.h"
+#include "detect-result-history.h"
+#include <math.h>
+#include <deque>
+#include <vector>
+
+namespace
+{
+	const double kPi = 3.14159265358979323846;
+	const int64_t kFrameNs = 16666667;
+	const int kFaceSize = 80;
+
+	struct Motion
+	{
+		double amplitude;
+		double frequency;
+		double X(int64_t ns) const { return 320.0 + amplitude * sin(2.0 * kPi * frequency * ns / 1e9); }
+	};
+
+	AiDetect::AiDetectResult MakeResult(const Motion& motion, int64_t ns)
+	{
+		AiDetect::AiDetectResult result;
+		result.detectType = AiDetect::KAiDetectFace;
+		result.timestamp = ns;
+		result.faceResult.Alloc(1);
+		AiDetect::FaceDetectionCnn& face = result.faceResult.info[0];
+		face.x = (short)lround(motion.X(ns) - kFaceSize / 2);
+		face.y = 140;
+		face.width = kFaceSize;
+		face.height = kFaceSize;
+		face.confidence = 90;
+		return result;
+	}
+
+	struct Error
+	{
+		double total = 0.0;
+		double worst = 0.0;
+		int count = 0;
+		void Add(double e)
+		{
+			total += e;
+			worst = std::max(worst, e);
+			count++;
+		}
+		double Mean() const { return count ? total / count : 0.0; }
+	};
+
+	double CenterError(const AiDetect::AiDetectResult& result, const Motion& motion, int64_t ns)
+	{
+		if (result.faceResult.size != 1)
+			return 1e9;
+		return fabs(result.faceResult.info[0].x + kFaceSize / 2 - motion.X(ns));
+	}
+
+	int BenchDetectLatency(int argc, char* argv[])
+	{
+		const int latency_ms = BenchArgInt(argc, argv, "--latency-ms", 60);
+		const int detect_fps = std::max(1, BenchArgInt(argc, argv, "--detect-fps", 15));
+		const int seconds = std::max(2, BenchArgInt(argc, argv, "--seconds", 10));
+		// 最大速度，像素 / 秒
+		const double speed = BenchArgInt(argc, argv, "--speed", 300);
+
+		Motion motion;
+		motion.frequency = 0.4;
+		motion.amplitude = speed / (2.0 * kPi * motion.frequency);
+		const int64_t latency_ns = (int64_t)latency_ms * 1000000;
+		const int64_t detect_every = std::max<int64_t>(1, 60 / detect_fps);
+
+		// 第一遍测延迟：结果第一次被渲染取走时记一次
+		DetectResultHistory history;
+		LatencyHistogram latency;
+		std::deque<AiDetect::AiDetectResult> in_flight;
+		Error latest, extrapolate, delayed;
+		const int frames = seconds * 60;
+		for (int pass = 0; pass < 2; pass++)
+		{
+			history.Clear();
+			in_flight.clear();
+			// 第二遍画面推迟第一遍测得的 p50
+			const int64_t delay_ns = (int64_t)(latency.GetPercentileMs(50.0) * 1e6);
+			for (int i = 0; i < frames; i++)
+			{
+				const int64_t now = (i + 1) * kFrameNs;
+				if (i % detect_every == 0)
+					in_flight.push_back(MakeResult(motion, now));
+				while (!in_flight.empty() && in_flight.front().timestamp + latency_ns <= now)
+				{
+					if (history.Push(in_flight.front()) && pass == 0)
+						latency.Record(now - in_flight.front().timestamp);
+					in_flight.pop_front();
+				}
+				// 前一秒是预热
+				if (pass == 0 || now < 1000000000ll || !history.GetSize())
+					continue;
+
+				AiDetect::AiDetectResult result;
+				history.Get(now, AiDetect::KAiDetectAlignLatest, result);
+				latest.Add(CenterError(result, motion, now));
+				history.Get(now, AiDetect::KAiDetectAlignExtrapolate, result);
+				extrapolate.Add(CenterError(result, motion, now));
+				// 画面显示的是 now - delay 那一帧
+				history.Get(now - delay_ns, AiDetect::KAiDetectAlignDelay, result);
+				delayed.Add(CenterError(result, motion, now - delay_ns));
+			}
+		}
+
+		printf("latency:%dms detect:%dfps speed:%.0fpx/s face:%dpx render:60fps\n", latency_ms, (int)(60 / detect_every), speed, kFaceSize);
+		printf("measured latency count:%llu mean:%.1fms p50:%.0fms p95:%.0fms\n", (unsigned long long)latency.GetCount(),
+			latency.GetMeanMs(), latency.GetPercentileMs(50.0), latency.GetPercentileMs(95.0));
+		printf("histogram:");
+		for (int i = 0; i < LatencyHistogram::kBucketCount; i++)
+		{
+			if (latency.GetBucket(i))
+				printf(" %d-%dms:%llu", i * LatencyHistogram::kBucketMs, (i + 1) * LatencyHistogram::kBucketMs,
+					(unsigned long long)latency.GetBucket(i));
+		}
+		printf("\n");
+		printf("%-12s %10s %10s\n", "align", "mean err", "max err");
+		printf("%-12s %8.2fpx %8.2fpx\n", "latest", latest.Mean(), latest.worst);
+		printf("%-12s %8.2fpx %8.2fpx\n", "delay video", delayed.Mean(), delayed.worst);
+		printf("%-12s %8.2fpx %8.2fpx\n", "extrapolate", extrapolate.Mean(), extrapolate.worst);
+
+		const double p50 = latency.GetPercentileMs(50.0);
+		const bool latency_ok = p50 >= latency_ms && p50 <= latency_ms + 1000.0 / 60.0 + LatencyHistogram::kBucketMs;
+		const bool align_ok = delayed.Mean() < latest.Mean() && extrapolate.Mean() < latest.Mean();
+		printf("latency:%s align:%s\n", latency_ok ? "ok" : "FAILED", align_ok ? "ok" : "FAILED");
+		return latency_ok && align_ok ? 0 : 1;
+	}
+}
+
+BENCH_REGISTER("detect-latency", "detection result alignment: latest vs delayed video vs extrapolated boxes", BenchDetectLatency);
@@ -0,0 +1,168 @@
+/* 人脸检测输入的预处理：BGRA 缩小到 320 宽并转成 BGR
+* tiny-bench detect-preprocess [--iterations N] [--threads N]
+* 输出每帧的耗时：原来的做法 (每帧 new 一块，逐像素转 BGR，不缩小)、VideoScaler (kBGRAToBGR + kArea) 的 C / AVX2 / 多线程
+* 检查 AVX2 和多线程结果与 C 逐字节相同，和按浮点算的面积平均最多差 1
+*/
+
+#include "bench-util.h"
+#include "video-scaler.h"
+#include "task-pool.h"
+#include "cpu-features.h"
+#include "test-pattern-generator.h"
+#include <math.h>
+#include <string.h>
+#include <memory>
+#include <vector>
+
+namespace
+{
+	const int kDetectWidth = 320;
+
+	struct Size
+	{
+		int width;
+		int height;
+	};
+
+	void FillSource(std::vector<uint8_t>& frame, int width, int height)
+	{
+		TestPatternGenerator::Params params;
+		params.type = TestPatternGenerator::PatternType::kMovingGradient;
+		params.width = width;
+		params.height = height;
+		params.entropy = 40;
+		params.seed = 3;
+		TestPatternGenerator generator;
+		generator.SetParams(params);
+		frame.resize((size_t)width * height * 4);
+		generator.Generate(2, frame.data(), width * 4);
+	}
+
+	// 原来 ItemFaceCnn 里的转换，输入已经是检测大小
+	volatile uint8_t g_sink = 0;
+	void LegacyBgraToBgr(const uint8_t* bgra, int width, int height)
+	{
+		std::shared_ptr<uint8_t> bgr(new uint8_t[(size_t)width * height * 3], std::default_delete<uint8_t[]>());
+		const int size = width * height * 4;
+		for (int i = 0, j = 0; j < size; i += 3, j += 4)
+		{
+			bgr.get()[i] = bgra[j];
+			bgr.get()[i + 1] = bgra[j + 1];
+			bgr.get()[i + 2] = bgra[j + 2];
+		}
+		g_sink += bgr.get()[(size_t)width * height];
+	}
+
+	// 目标像素 i 覆盖源坐标 [i * src / dst, (i + 1) * src / dst]，每个源像素按重叠长度计权
+	std::vector<std::vector<double>> AreaWeights(int src_size, int dst_size, std::vector<int>& first)
+	{
+		const double scale = (double)src_size / dst_size;
+		std::vector<std::vector<double>> weights(dst_size);
+		first.resize(dst_size);
+		for (int i = 0; i < dst_size; i++)
+		{
+			const double lo = i * scale;
+			const double hi = (i + 1) * scale;
+			first[i] = (int)floor(lo);
+			for (int j = first[i]; j < src_size && j < hi; j++)
+				weights[i].push_back((std::min(hi, j + 1.0) - std::max(lo, (double)j)) / scale);
+		}
+		return weights;
+	}
+
+	double CompareReference(const std::vector<uint8_t>& src, Size in, const std::vector<uint8_t>& dst, Size out)
+	{
+		std::vector<int> x_first, y_first;
+		const auto x_weights = AreaWeights(in.width, out.width, x_first);
+		const auto y_weights = AreaWeights(in.height, out.height, y_first);
+		double worst = 0.0;
+		for (int y = 0; y < out.height; y++)
+		{
+			for (int x = 0; x < out.width; x++)
+			{
+				for (int c = 0; c < 3; c++)
+				{
+					double ref = 0.0;
+					for (size_t ky = 0; ky < y_weights[y].size(); ky++)
+					{
+						const uint8_t* line = &src[(size_t)(y_first[y] + ky) * in.width * 4];
+						for (size_t kx = 0; kx < x_weights[x].size(); kx++)
+							ref += y_weights[y][ky] * x_weights[x][kx] * line[(x_first[x] + kx) * 4 + c];
+					}
+					worst = std::max(worst, fabs(ref - dst[((size_t)y * out.width + x) * 3 + c]));
+				}
+			}
+		}
+		return worst;
+	}
+
+	int BenchDetectPreprocess(int argc, char* argv[])
+	{
+		const int iterations = BenchArgInt(argc, argv, "--iterations", 50);
+		const int threads = BenchArgInt(argc, argv, "--threads", 0);
+
+		std::unique_ptr<TaskPool> own_pool;
+		TaskPool* pool = TaskPool::GetShared();
+		if (threads > 0)
+		{
+			own_pool.reset(new TaskPool(threads - 1));
+			pool = own_pool.get();
+		}
+
+		VideoScaler c_scaler;
+		c_scaler.SetUseSimd(false);
+		VideoScaler simd_scaler;
+		VideoScaler mt_scaler;
+		mt_scaler.SetTaskPool(pool);
+
+		// 640x360 是 FaceDetectFilter 读回的大小；1366x768 不是整数倍
+		const Size inputs[] = { { 320, 180 }, { 640, 360 }, { 1280, 720 }, { 1366, 768 }, { 1920, 1080 }, { 3840, 2160 } };
+
+		printf("avx2:%s threads:%zu iterations:%d output:%d wide BGR\n", cpu_has_avx2() ? "yes" : "no",
+			pool->GetThreadCount() + 1, iterations, kDetectWidth);
+		printf("%-10s %-8s %10s %10s %10s %10s %8s %8s\n", "input", "output", "legacy", "C", "AVX2", "MT", "maxdiff", "check");
+
+		bool all_ok = true;
+		for (const auto& in : inputs)
+		{
+			Size out = { kDetectWidth, (in.height * kDetectWidth + in.width / 2) / in.width };
+			std::vector<uint8_t> src;
+			FillSource(src, in.width, in.height);
+			std::vector<uint8_t> ref((size_t)out.width * out.height * 3), simd(ref.size()), mt(ref.size());
+
+			auto run = [&](std::vector<uint8_t>& dst, VideoScaler& scaler) {
+				scaler.Init(VideoScaler::Format::kBGRAToBGR, in.width, in.height, out.width, out.height, VideoScaler::Filter::kArea);
+				const uint8_t* src_planes[] = { src.data() };
+				const int src_linesize[] = { in.width * 4 };
+				uint8_t* dst_planes[] = { dst.data() };
+				const int dst_linesize[] = { out.width * 3 };
+				return BenchRun(2, iterations, [&]() {
+					scaler.Scale(src_planes, src_linesize, dst_planes, dst_linesize);
+				}).MeanMs();
+			};
+			double c_ms = run(ref, c_scaler);
+			double simd_ms = run(simd, simd_scaler);
+			double mt_ms = run(mt, mt_scaler);
+
+			char legacy[32] = "-";
+			if (in.width == out.width)
+			{
+				double legacy_ms = BenchRun(2, iterations, [&]() { LegacyBgraToBgr(src.data(), in.width, in.height); }).MeanMs();
+				snprintf(legacy, sizeof(legacy), "%.3fms", legacy_ms);
+			}
+
+			double diff = CompareReference(src, in, ref, out);
+			bool ok = simd == ref && mt == ref && diff <= 1.0;
+			all_ok = all_ok && ok;
+
+			char in_name[32], out_name[32];
+			snprintf(in_name, sizeof(in_name), "%dx%d", in.width, in.height);
+			snprintf(out_name, sizeof(out_name), "%dx%d", out.width, out.height);
+			printf("%-10s %-8s %10s %8.3fms %8.3fms %8.3fms %8.3f %8s\n", in_name, out_name, legacy,
+				c_ms, simd_ms, mt_ms, diff, ok ? "ok" : "FAILED");
+		}
+		return all_ok ? 0 : 1;
+	}
+}
+
+BENCH_REGISTER("detect-preprocess", "VideoScaler area downscale + BGRA->BGR for face detection input", BenchDetectPreprocess);
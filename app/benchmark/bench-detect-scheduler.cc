@@ -0,0 +1,236 @@
+/* 多个源的人脸检测：每个检测项一个线程 vs 共享的 DetectScheduler
+* tiny-bench detect-scheduler [--sources N] [--workers N] [--seconds N] [--work-us N] [--encode-us N]
+* 每个源 30fps 给帧，检测每次占 work-us 的 CPU；主线程模拟编码，每 16.7ms 做 encode-us 的计算，统计这段计算实际用了多久
+* 检测线程和编码抢 CPU 时编码耗时会被拉长。输出两种做法的线程数、检测次数、各源的检测次数差异、排队等待和编码耗时
+* 检查同优先级各源的检测次数接近、同一个源的任务不会并发、高优先级先执行、Unregister 等正在跑的任务结束
+*/
+
+#include "bench-util.h"
+#include "detect-scheduler.h"
+#include "frame-mailbox.h"
+#include <atomic>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace
+{
+	volatile uint64_t g_sink = 0;
+	double g_spins_per_us = 0.0;
+
+	void SpinOnce(uint64_t count)
+	{
+		uint64_t x = 1;
+		for (uint64_t i = 0; i < count; i++)
+			x = x * 6364136223846793005ull + 1442695040888963407ull;
+		g_sink += x;
+	}
+
+	// 按次数而不是墙上时间计算，被抢占时不会少算
+	void Spin(int us)
+	{
+		SpinOnce((uint64_t)(us * g_spins_per_us));
+	}
+
+	void Calibrate()
+	{
+		const uint64_t count = 2000000;
+		uint64_t begin = BenchNowNs();
+		SpinOnce(count);
+		g_spins_per_us = count / ((BenchNowNs() - begin) / 1000.0);
+	}
+
+	struct Result
+	{
+		size_t threads = 0;
+		std::vector<uint64_t> runs;
+		BenchStats encode;
+		DetectScheduler::Stats scheduler;
+	};
+
+	// 主线程：源按 30fps 给帧，编码按 60fps 计算，submit 每个源每两帧调一次
+	template <typename SubmitFn>
+	void DriveFrames(int seconds, int encode_us, BenchStats& encode, SubmitFn&& submit)
+	{
+		const int frames = seconds * 60;
+		uint64_t next = BenchNowNs();
+		for (int i = 0; i < frames; i++)
+		{
+			if (i % 2 == 0)
+				submit();
+			uint64_t begin = BenchNowNs();
+			Spin(encode_us);
+			encode.Add(BenchNowNs() - begin);
+			next += 16666667;
+			uint64_t now = BenchNowNs();
+			if (now < next)
+				std::this_thread::sleep_for(std::chrono::nanoseconds(next - now));
+		}
+	}
+
+	// 原来的做法：每个检测项一个线程，从信箱取最新一帧
+	Result RunThreadPerItem(int sources, int seconds, int work_us, int encode_us)
+	{
+		Result result;
+		result.threads = sources;
+		result.runs.assign(sources, 0);
+		FrameMailbox mailbox(sources);
+		std::vector<std::thread> threads;
+		for (int s = 0; s < sources; s++)
+		{
+			threads.emplace_back([&, s]() {
+				while (mailbox.Wait(s))
+				{
+					Spin(work_us);
+					result.runs[s]++;
+				}
+			});
+		}
+		DriveFrames(seconds, encode_us, result.encode, [&]() { mailbox.Publish(mailbox.Acquire(16)); });
+		mailbox.Close();
+		for (auto& t : threads)
+			t.join();
+		return result;
+	}
+
+	Result RunScheduler(int sources, size_t workers, int seconds, int work_us, int encode_us, bool& overlap_ok)
+	{
+		Result result;
+		result.threads = workers;
+		result.runs.assign(sources, 0);
+		DetectScheduler scheduler(workers);
+		std::vector<int> clients;
+		std::unique_ptr<std::atomic<int>[]> in_flight(new std::atomic<int>[sources]);
+		for (int s = 0; s < sources; s++)
+		{
+			clients.push_back(scheduler.Register(0));
+			in_flight[s] = 0;
+		}
+		overlap_ok = true;
+		DriveFrames(seconds, encode_us, result.encode, [&]() {
+			for (int s = 0; s < sources; s++)
+			{
+				scheduler.Submit(clients[s], [&, s]() {
+					if (++in_flight[s] != 1)
+						overlap_ok = false;
+					Spin(work_us);
+					result.runs[s]++;
+					--in_flight[s];
+				});
+			}
+		});
+		result.scheduler = scheduler.GetStats();
+		for (int c : clients)
+			scheduler.Unregister(c);
+		return result;
+	}
+
+	// 一个工作线程被占住时排队的任务：高优先级的先执行
+	bool CheckPriority()
+	{
+		DetectScheduler scheduler(1);
+		const int low = scheduler.Register(0);
+		const int high = scheduler.Register(5);
+		const int blocker = scheduler.Register(0);
+		std::atomic<bool> release(false);
+		std::vector<int> order;
+		std::mutex order_mutex;
+		scheduler.Submit(blocker, [&]() {
+			while (!release)
+				std::this_thread::sleep_for(std::chrono::milliseconds(1));
+		});
+		std::this_thread::sleep_for(std::chrono::milliseconds(5));
+		scheduler.Submit(low, [&]() { std::lock_guard<std::mutex> lock(order_mutex); order.push_back(low); });
+		scheduler.Submit(high, [&]() { std::lock_guard<std::mutex> lock(order_mutex); order.push_back(high); });
+		release = true;
+		uint64_t deadline = BenchNowNs() + 1000000000ull;
+		for (;;)
+		{
+			{
+				std::lock_guard<std::mutex> lock(order_mutex);
+				if (order.size() == 2 || BenchNowNs() > deadline)
+					break;
+			}
+			std::this_thread::sleep_for(std::chrono::milliseconds(1));
+		}
+		for (int c : { low, high, blocker })
+			scheduler.Unregister(c);
+		return order.size() == 2 && order[0] == high;
+	}
+
+	// Unregister 等正在执行的任务结束，排队的任务不再执行
+	bool CheckUnregister()
+	{
+		DetectScheduler scheduler(1);
+		const int client = scheduler.Register(0);
+		std::atomic<int> state(0);
+		std::atomic<int> runs(0);
+		scheduler.Submit(client, [&]() {
+			state = 1;
+			std::this_thread::sleep_for(std::chrono::milliseconds(20));
+			runs++;
+			state = 2;
+		});
+		while (state == 0)
+			std::this_thread::sleep_for(std::chrono::milliseconds(1));
+		scheduler.Submit(client, [&]() { runs++; });
+		scheduler.Unregister(client);
+		const bool done = state == 2;
+		std::this_thread::sleep_for(std::chrono::milliseconds(10));
+		return done && runs == 1;
+	}
+
+	void PrintResult(const char* name, const Result& r, int seconds)
+	{
+		uint64_t total = 0, min_runs = UINT64_MAX, max_runs = 0;
+		for (uint64_t runs : r.runs)
+		{
+			total += runs;
+			min_runs = std::min(min_runs, runs);
+			max_runs = std::max(max_runs, runs);
+		}
+		printf("%-16s threads:%-3zu detect/s:%7.1f per source min:%llu max:%llu  encode mean:%.2fms p95:%.2fms\n", name, r.threads,
+			(double)total / seconds, (unsigned long long)min_runs, (unsigned long long)max_runs, r.encode.MeanMs(), r.encode.PercentileMs(95.0));
+	}
+
+	int BenchDetectScheduler(int argc, char* argv[])
+	{
+		const int sources = std::max(1, BenchArgInt(argc, argv, "--sources", 6));
+		const size_t workers = (size_t)BenchArgInt(argc, argv, "--workers", (int)DetectScheduler::GetDefaultWorkerCount());
+		const int seconds = std::max(1, BenchArgInt(argc, argv, "--seconds", 3));
+		const int work_us = BenchArgInt(argc, argv, "--work-us", 8000);
+		const int encode_us = BenchArgInt(argc, argv, "--encode-us", 4000);
+
+		Calibrate();
+		printf("hardware threads:%u sources:%d workers:%zu seconds:%d detect:%dus encode:%dus\n", std::thread::hardware_concurrency(),
+			sources, workers, seconds, work_us, encode_us);
+
+		Result per_item = RunThreadPerItem(sources, seconds, work_us, encode_us);
+		bool overlap_ok = true;
+		Result shared = RunScheduler(sources, workers, seconds, work_us, encode_us, overlap_ok);
+		PrintResult("thread per item", per_item, seconds);
+		PrintResult("scheduler", shared, seconds);
+
+		const DetectScheduler::Stats& stats = shared.scheduler;
+		printf("scheduler queue depth max:%zu  wait avg:%.2fms max:%.2fms  submitted:%llu run:%llu coalesced:%llu\n",
+			stats.max_queue_depth, stats.wait.AvgWaitMs(), stats.wait.MaxWaitMs(), (unsigned long long)stats.wait.submitted,
+			(unsigned long long)stats.wait.run, (unsigned long long)stats.wait.coalesced);
+
+		uint64_t min_runs = UINT64_MAX, max_runs = 0;
+		for (uint64_t runs : shared.runs)
+		{
+			min_runs = std::min(min_runs, runs);
+			max_runs = std::max(max_runs, runs);
+		}
+		const bool fair_ok = max_runs > 0 && min_runs * 10 >= max_runs * 8;
+		const bool count_ok = stats.wait.submitted == stats.wait.run + stats.wait.coalesced + stats.queue_depth;
+		const bool priority_ok = CheckPriority();
+		const bool unregister_ok = CheckUnregister();
+		printf("fair:%s overlap:%s counts:%s priority:%s unregister:%s\n", fair_ok ? "ok" : "FAILED", overlap_ok ? "ok" : "FAILED",
+			count_ok ? "ok" : "FAILED", priority_ok ? "ok" : "FAILED", unregister_ok ? "ok" : "FAILED");
+		return fair_ok && overlap_ok && count_ok && priority_ok && unregister_ok ? 0 : 1;
+	}
+}
+
+BENCH_REGISTER("detect-scheduler", "shared detection worker pool vs one thread per detect item", BenchDetectScheduler);
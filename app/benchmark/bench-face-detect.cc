@@ -0,0 +1,375 @@
+/* ItemFaceCnn 单独的检测吞吐，不需要 D3D 和 GPU
+* tiny-bench face-detect [--images DIR] [--width N] [--height N] [--threads N] [--frames N] [--fps N] [--track] [--detect-fps N] [--motion-gate]
+* 输入为 DIR 下的 .ppm (P6) 图片，缩放到 width x height 后循环使用；不给 DIR 时用测试图案的合成画面 (没有人脸，结果数为 0)
+* threads 个 ItemFaceCnn 各占一个线程，经过 IAiDetectItem::InputBgraRawPixelData 的完整路径喂帧；fps 为 0 时按最快速度，
+* 开跟踪时默认按 60fps 喂帧，检测按 detect-fps 的墙上时间间隔触发，其余帧跟踪
+* 默认关掉 ItemFaceCnn 的静止画面跳过，循环的图片不一定每帧都不同；--motion-gate 时打开
+* 输出总帧率、每帧 p50 / p99 耗时、每帧的内存分配次数、检测结果数
+* tiny-bench face-detect-tiled [--images DIR] [--width N] [--height N] [--threads N] [--frames N]
+* 一个 ItemFaceCnn 每帧整幅检测 (不跟踪、不跳过静止画面、不做区域检测)，对比单次 facedetect_cnn 和切块并行在 1..threads 个线程上的
+* 每帧 p50 / p99 耗时、加速比和每帧记进检测耗时的 CPU 时间 (各块耗时之和)；给了图片时再看切块的结果和单次检测的一致程度 (IoU > 0.5 算同一张脸)
+* 需要 libfacedetection：Windows 用 third-part 里的预编译库，其他平台 find_package(facedetection) 找到时才编译
+*/
+
+#include "bench-util.h"
+
+#if defined(BENCH_WITH_FACEDETECTION)
+#include "item-face-cnn.h"
+#include "detect-scheduler.h"
+#include "test-pattern-generator.h"
+#include <atomic>
+#include <filesystem>
+#include <fstream>
+#include <memory>
+#include <new>
+#include <string>
+#include <thread>
+#include <vector>
+
+// 统计整个进程的 operator new 次数，只在计时区间内看差值
+namespace
+{
+	std::atomic<uint64_t> g_alloc_count(0);
+}
+
+void* operator new(size_t size)
+{
+	g_alloc_count.fetch_add(1, std::memory_order_relaxed);
+	void* p = malloc(size ? size : 1);
+	if (!p)
+		throw std::bad_alloc();
+	return p;
+}
+
+void operator delete(void* p) noexcept
+{
+	free(p);
+}
+
+void operator delete(void* p, size_t) noexcept
+{
+	free(p);
+}
+
+namespace
+{
+	struct Image
+	{
+		std::string name;
+		std::vector<uint8_t> bgra;
+	};
+
+	// 只认二进制 P6、maxval 255
+	bool LoadPpm(const std::filesystem::path& path, int& width, int& height, std::vector<uint8_t>& rgb)
+	{
+		std::ifstream file(path, std::ios::binary);
+		std::string magic;
+		int maxval = 0;
+		file >> magic >> width >> height >> maxval;
+		if (!file || magic != "P6" || maxval != 255 || width <= 0 || height <= 0)
+			return false;
+		file.get();
+		rgb.resize((size_t)width * height * 3);
+		file.read((char*)rgb.data(), rgb.size());
+		return (bool)file;
+	}
+
+	// 最近邻缩放到检测输入大小并转 BGRA
+	void ResizeToBgra(const std::vector<uint8_t>& rgb, int src_width, int src_height, int width, int height, std::vector<uint8_t>& bgra)
+	{
+		bgra.resize((size_t)width * height * 4);
+		for (int y = 0; y < height; y++)
+		{
+			const uint8_t* line = rgb.data() + (size_t)(y * src_height / height) * src_width * 3;
+			uint8_t* dst = bgra.data() + (size_t)y * width * 4;
+			for (int x = 0; x < width; x++)
+			{
+				const uint8_t* p = line + (size_t)(x * src_width / width) * 3;
+				dst[x * 4 + 0] = p[2];
+				dst[x * 4 + 1] = p[1];
+				dst[x * 4 + 2] = p[0];
+				dst[x * 4 + 3] = 255;
+			}
+		}
+	}
+
+	std::vector<Image> LoadImages(const char* dir, int width, int height)
+	{
+		std::vector<Image> images;
+		std::error_code error;
+		for (const auto& entry : std::filesystem::directory_iterator(dir, error))
+		{
+			if (entry.path().extension() != ".ppm")
+				continue;
+			int w = 0, h = 0;
+			std::vector<uint8_t> rgb;
+			if (!LoadPpm(entry.path(), w, h, rgb))
+			{
+				printf("skip %s: not a binary P6 ppm\n", entry.path().string().c_str());
+				continue;
+			}
+			Image image;
+			image.name = entry.path().filename().string();
+			ResizeToBgra(rgb, w, h, width, height, image.bgra);
+			images.push_back(std::move(image));
+		}
+		return images;
+	}
+
+	std::vector<Image> MakeSynthetic(int width, int height)
+	{
+		TestPatternGenerator::Params params;
+		params.type = TestPatternGenerator::PatternType::kMovingGradient;
+		params.width = width;
+		params.height = height;
+		params.entropy = 40;
+		params.seed = 17;
+		TestPatternGenerator generator;
+		generator.SetParams(params);
+		std::vector<Image> images(8);
+		for (size_t i = 0; i < images.size(); i++)
+		{
+			images[i].name = "pattern";
+			images[i].bgra.resize((size_t)width * height * 4);
+			generator.Generate((uint64_t)i * 4, images[i].bgra.data(), width * 4);
+		}
+		return images;
+	}
+
+	struct WorkerResult
+	{
+		// 计时前分配好，记录耗时本身不产生分配
+		std::vector<uint64_t> latency;
+		uint64_t frames = 0;
+		uint64_t faces = 0;
+		uint64_t frames_with_faces = 0;
+	};
+
+	int BenchFaceDetect(int argc, char* argv[])
+	{
+		const char* dir = BenchArg(argc, argv, "--images", nullptr);
+		const int width = BenchArgInt(argc, argv, "--width", 640);
+		const int height = BenchArgInt(argc, argv, "--height", 360);
+		const int threads = std::max(1, BenchArgInt(argc, argv, "--threads", 1));
+		const int frames = std::max(1, BenchArgInt(argc, argv, "--frames", 200));
+		const bool track = BenchHasFlag(argc, argv, "--track");
+		// 0 表示每帧都检测；开跟踪时默认按 6fps 检测，其余帧跟踪
+		const int detect_fps = BenchArgInt(argc, argv, "--detect-fps", track ? 6 : 0);
+		const int fps = BenchArgInt(argc, argv, "--fps", track ? 60 : 0);
+		const bool motion_gate = BenchHasFlag(argc, argv, "--motion-gate");
+		const uint64_t frame_ns = fps > 0 ? 1000000000ull / fps : 0;
+
+		std::vector<Image> images = dir ? LoadImages(dir, width, height) : MakeSynthetic(width, height);
+		if (images.empty())
+		{
+			printf("no .ppm images in %s\n", dir);
+			return 1;
+		}
+
+		std::vector<std::unique_ptr<ItemFaceCnn>> items;
+		for (int t = 0; t < threads; t++)
+		{
+			items.emplace_back(new ItemFaceCnn());
+			// 帧率超过 1000 时检测间隔为 0，不限频
+			items.back()->UpdateDetectFrameRate(detect_fps > 0 ? detect_fps : 1000000);
+			items.back()->EnableTracking(track);
+			items.back()->EnableMotionGate(motion_gate);
+		}
+		std::vector<WorkerResult> results(threads);
+		for (auto& r : results)
+			r.latency.resize(frames);
+
+		// 每个线程一份输入拷贝，线程之间不共享缓冲
+		std::vector<std::vector<Image>> inputs(threads, images);
+		// 先各跑一帧，网络第一次调用的初始化不计入
+		for (int t = 0; t < threads; t++)
+			items[t]->InputBgraRawPixelData(inputs[t][0].bgra.data(), inputs[t][0].bgra.size(), width, height, 1);
+
+		const uint64_t alloc_begin = g_alloc_count.load();
+		const uint64_t begin = BenchNowNs();
+		std::vector<std::thread> workers;
+		for (int t = 0; t < threads; t++)
+		{
+			workers.emplace_back([&, t]() {
+				WorkerResult& r = results[t];
+				AiDetect::AiDetectResult result;
+				uint64_t next = BenchNowNs();
+				for (int i = 0; i < frames; i++)
+				{
+					if (frame_ns)
+					{
+						uint64_t now = BenchNowNs();
+						if (now < next)
+							std::this_thread::sleep_for(std::chrono::nanoseconds(next - now));
+						next += frame_ns;
+					}
+					Image& image = inputs[t][i % inputs[t].size()];
+					const int64_t timestamp = (int64_t)BenchNowNs();
+					const uint64_t start = BenchNowNs();
+					items[t]->InputBgraRawPixelData(image.bgra.data(), image.bgra.size(), width, height, timestamp);
+					r.latency[i] = BenchNowNs() - start;
+					items[t]->GetOutputDetectResult(result, timestamp, AiDetect::KAiDetectAlignLatest);
+					r.frames++;
+					r.faces += result.faceResult.size;
+					r.frames_with_faces += result.faceResult.size ? 1 : 0;
+				}
+			});
+		}
+		for (auto& w : workers)
+			w.join();
+		const double seconds = (BenchNowNs() - begin) / 1e9;
+		const uint64_t allocs = g_alloc_count.load() - alloc_begin;
+
+		BenchStats all;
+		uint64_t total_frames = 0, faces = 0, frames_with_faces = 0;
+		for (const auto& r : results)
+		{
+			for (uint64_t ns : r.latency)
+				all.Add(ns);
+			total_frames += r.frames;
+			faces += r.faces;
+			frames_with_faces += r.frames_with_faces;
+		}
+
+		printf("input:%dx%d source:%s (%zu images) threads:%d frames/thread:%d fps:%d track:%s detect fps:%d motion gate:%s hardware threads:%u\n", width, height,
+			dir ? dir : "synthetic", images.size(), threads, frames, fps, track ? "on" : "off", detect_fps, motion_gate ? "on" : "off", std::thread::hardware_concurrency());
+		printf("throughput %.1f fps  latency mean:%.2fms p50:%.2fms p99:%.2fms max:%.2fms\n", total_frames / seconds, all.MeanMs(),
+			all.PercentileMs(50.0), all.PercentileMs(99.0), all.PercentileMs(100.0));
+		printf("allocations/frame %.2f  faces/frame %.2f  frames with faces %llu/%llu\n", (double)allocs / total_frames,
+			(double)faces / total_frames, (unsigned long long)frames_with_faces, (unsigned long long)total_frames);
+		return 0;
+	}
+
+	// 每帧记进检测耗时的时间，频率调节按它估算 CPU 占用
+	double DetectCostMs(const ItemFaceCnn& item)
+	{
+		uint64_t count = 0, ns = 0;
+		item.GetDetectCost(count, ns);
+		return count ? ns / 1e6 / count : 0.0;
+	}
+
+	// 每帧整幅检测，latency 记每帧耗时，boxes 记每张图的结果
+	void RunFullScan(ItemFaceCnn& item, std::vector<Image>& images, int width, int height, int frames, BenchStats& latency,
+		std::vector<std::vector<FaceTracker::Box>>& boxes)
+	{
+		FaceRoiPlanner::Params roi;
+		roi.full_scan_interval = 1;
+		item.SetRoiParams(roi);
+		item.UpdateDetectFrameRate(1000000);
+		item.EnableTracking(false);
+		item.EnableMotionGate(false);
+		// 第一次调用的初始化不计入
+		item.InputBgraRawPixelData(images[0].bgra.data(), images[0].bgra.size(), width, height, 1);
+
+		boxes.assign(images.size(), {});
+		AiDetect::AiDetectResult result;
+		for (int i = 0; i < frames; i++)
+		{
+			Image& image = images[i % images.size()];
+			const int64_t timestamp = (int64_t)BenchNowNs();
+			const uint64_t start = BenchNowNs();
+			item.InputBgraRawPixelData(image.bgra.data(), image.bgra.size(), width, height, timestamp);
+			latency.Add(BenchNowNs() - start);
+			item.GetOutputDetectResult(result, timestamp, AiDetect::KAiDetectAlignLatest);
+			std::vector<FaceTracker::Box>& out = boxes[i % images.size()];
+			out.clear();
+			for (short f = 0; f < result.faceResult.size; f++)
+			{
+				const AiDetect::FaceDetectionCnn& info = result.faceResult.info[f];
+				FaceTracker::Box box;
+				box.x = info.x;
+				box.y = info.y;
+				box.width = info.width;
+				box.height = info.height;
+				box.confidence = info.confidence;
+				out.push_back(box);
+			}
+		}
+	}
+
+	int BenchFaceDetectTiled(int argc, char* argv[])
+	{
+		const char* dir = BenchArg(argc, argv, "--images", nullptr);
+		const int width = BenchArgInt(argc, argv, "--width", 640);
+		const int height = BenchArgInt(argc, argv, "--height", 360);
+		const int threads = std::max(1, BenchArgInt(argc, argv, "--threads", (int)std::max(1u, std::thread::hardware_concurrency())));
+		const int frames = std::max(1, BenchArgInt(argc, argv, "--frames", 100));
+
+		std::vector<Image> images = dir ? LoadImages(dir, width, height) : MakeSynthetic(width, height);
+		if (images.empty())
+		{
+			printf("no .ppm images in %s\n", dir);
+			return 1;
+		}
+
+		BenchStats single;
+		std::vector<std::vector<FaceTracker::Box>> reference;
+		double single_cost = 0.0;
+		{
+			ItemFaceCnn item;
+			RunFullScan(item, images, width, height, frames, single, reference);
+			single_cost = DetectCostMs(item);
+		}
+		size_t reference_faces = 0;
+		for (const auto& r : reference)
+			reference_faces += r.size();
+
+		printf("input:%dx%d source:%s (%zu images) frames:%d hardware threads:%u\n", width, height, dir ? dir : "synthetic",
+			images.size(), frames, std::thread::hardware_concurrency());
+		printf("%-8s %8s %10s %10s %8s %10s %10s %8s\n", "mode", "threads", "p50", "p99", "speedup", "cpu", "matched", "extra");
+		printf("%-8s %8d %8.2fms %8.2fms %8.2f %8.2fms %10zu %8d\n", "single", 1, single.PercentileMs(50.0), single.PercentileMs(99.0), 1.0,
+			single_cost, reference_faces, 0);
+
+		std::vector<int> counts;
+		for (int t = 2; t < threads; t *= 2)
+			counts.push_back(t);
+		counts.push_back(threads);
+		for (int t : counts)
+		{
+			// 调用线程不是调度器的工作线程，t 个名额里能借到 t - 1 个，加上调用线程共 t 个
+			DetectScheduler scheduler(t);
+			ItemFaceCnn item;
+			item.EnableTiling(&scheduler);
+			BenchStats tiled;
+			std::vector<std::vector<FaceTracker::Box>> boxes;
+			RunFullScan(item, images, width, height, frames, tiled, boxes);
+
+			size_t matched = 0, faces = 0;
+			for (size_t i = 0; i < images.size(); i++)
+			{
+				faces += boxes[i].size();
+				for (const auto& ref : reference[i])
+				{
+					bool found = false;
+					for (const auto& box : boxes[i])
+						found = found || FaceRoiPlanner::IoU(ref, box) > 0.5f;
+					matched += found ? 1 : 0;
+				}
+			}
+			printf("%-8s %8d %8.2fms %8.2fms %8.2f %8.2fms %5zu/%-4zu %8d\n", "tiled", t, tiled.PercentileMs(50.0), tiled.PercentileMs(99.0),
+				single.PercentileMs(50.0) / tiled.PercentileMs(50.0), DetectCostMs(item), matched, reference_faces, (int)(faces - matched));
+		}
+		return 0;
+	}
+}
+
+#else
+
+namespace
+{
+	int BenchFaceDetect(int, char*[])
+	{
+		printf("built without libfacedetection, configure with facedetection_DIR pointing at its CMake package to enable\n");
+		return 0;
+	}
+
+	int BenchFaceDetectTiled(int, char*[])
+	{
+		return BenchFaceDetect(0, nullptr);
+	}
+}
+
+#endif
+
+BENCH_REGISTER("face-detect", "headless ItemFaceCnn throughput: fps, p50/p99 latency, allocations and results per frame", BenchFaceDetect);
+BENCH_REGISTER("face-detect-tiled", "ItemFaceCnn full-frame latency vs thread count: single facedetect_cnn call vs overlapping tiles", BenchFaceDetectTiled);
@@ -0,0 +1,219 @@
+/* 人脸检测只在上次结果附近跑 CNN
+* tiny-bench face-roi [--iterations N]
+* 640x360 输入 (FaceDetectFilter 读回的大小)，按几种人脸分布输出 FaceRoiPlanner 的整幅 / 区域检测送进网络的像素数、
+* 人脸在网络输入里的缩放比例和预处理 (裁剪 + 缩小 + BGR) 耗时；CNN 的耗时和像素数成正比
+* 检查区域完整包含外扩前的人脸且在画面内、区域像素少于整幅、每 full_scan_interval 次整幅一次、NMS 去掉重复框
+* 分块检测的切块：块在画面内且盖满画面、不超过线程数、任意位置边长不超过重叠的脸都完整落在某一块里，输出多送进网络的像素比例
+*/
+
+#include "bench-util.h"
+#include "face-roi-planner.h"
+#include "video-scaler.h"
+#include "test-pattern-generator.h"
+#include <algorithm>
+#include <vector>
+
+namespace
+{
+	const int kWidth = 640;
+	const int kHeight = 360;
+	const int kDetectWidth = 320;
+
+	struct Case
+	{
+		const char* name;
+		std::vector<FaceTracker::Box> faces;
+	};
+
+	FaceTracker::Box Face(float x, float y, float size)
+	{
+		FaceTracker::Box box;
+		box.x = x;
+		box.y = y;
+		box.width = size;
+		box.height = size;
+		box.confidence = 90;
+		return box;
+	}
+
+	std::vector<Case> MakeCases()
+	{
+		return {
+			{ "1 face", { Face(280, 120, 80) } },
+			{ "small", { Face(400, 200, 24) } },
+			{ "3 faces", { Face(60, 100, 60), Face(300, 140, 60), Face(520, 90, 60) } },
+			{ "close", { Face(200, 120, 60), Face(250, 140, 60) } },
+			{ "edge", { Face(-10, -10, 70), Face(600, 320, 70) } },
+			// 区域加起来比整幅还大，退回整幅
+			{ "large", { Face(160, 40, 260) } },
+		};
+	}
+
+	bool Contains(const FaceRoiPlanner::Rect& r, const FaceTracker::Box& face)
+	{
+		const float x0 = std::max(face.x, 0.0f), y0 = std::max(face.y, 0.0f);
+		const float x1 = std::min(face.x + face.width, (float)kWidth), y1 = std::min(face.y + face.height, (float)kHeight);
+		return x0 >= r.x && y0 >= r.y && x1 <= r.x + r.width && y1 <= r.y + r.height;
+	}
+
+	bool CheckNms()
+	{
+		std::vector<FaceTracker::Box> boxes = { Face(100, 100, 60), Face(104, 102, 58), Face(300, 100, 60), Face(98, 99, 62) };
+		boxes[1].confidence = 95;
+		FaceRoiPlanner::Nms(boxes, 0.4f);
+		return boxes.size() == 2 && boxes[0].confidence == 95 && boxes[1].x == 300.0f;
+	}
+
+	bool CheckTiles()
+	{
+		const int overlap = 64;
+		struct TileCase
+		{
+			int width;
+			int height;
+		};
+		const TileCase cases[] = { { 320, 180 }, { 320, 240 }, { 180, 320 }, { 100, 60 }, { 640, 360 } };
+
+		printf("\ntile overlap:%d\n", overlap);
+		printf("%-9s %6s %6s %10s %10s %8s\n", "size", "lanes", "tiles", "tile", "overhead", "check");
+		bool all_ok = true;
+		std::vector<FaceRoiPlanner::Rect> tiles;
+		for (const auto& c : cases)
+		{
+			for (int lanes = 1; lanes <= 8; lanes *= 2)
+			{
+				FaceRoiPlanner::PlanTiles(c.width, c.height, lanes, overlap, tiles);
+				bool ok = !tiles.empty() && (int)tiles.size() <= lanes;
+				int64_t pixels = 0;
+				for (const auto& t : tiles)
+				{
+					pixels += (int64_t)t.width * t.height;
+					ok = ok && t.x >= 0 && t.y >= 0 && t.x + t.width <= c.width && t.y + t.height <= c.height;
+					// 多于一块时每块都能完整放下一张重叠大小的脸
+					ok = ok && (tiles.size() == 1 || (t.width >= overlap && t.height >= overlap));
+				}
+				// 边长为 overlap 的脸放在每个位置上 (贴着画面边的也算)
+				const int face = std::min(overlap, std::min(c.width, c.height));
+				for (int y = 0; y + face <= c.height && ok; y++)
+				{
+					for (int x = 0; x + face <= c.width && ok; x++)
+					{
+						bool inside = false;
+						for (const auto& t : tiles)
+							inside = inside || (x >= t.x && y >= t.y && x + face <= t.x + t.width && y + face <= t.y + t.height);
+						ok = inside;
+					}
+				}
+				all_ok = all_ok && ok;
+				char size[32], tile[32], overhead[32];
+				snprintf(size, sizeof(size), "%dx%d", c.width, c.height);
+				snprintf(tile, sizeof(tile), "%dx%d", tiles.empty() ? 0 : tiles[0].width, tiles.empty() ? 0 : tiles[0].height);
+				snprintf(overhead, sizeof(overhead), "%.0f%%", 100.0 * pixels / ((int64_t)c.width * c.height) - 100.0);
+				printf("%-9s %6d %6zu %10s %10s %8s\n", size, lanes, tiles.size(), tile, overhead, ok ? "ok" : "FAILED");
+			}
+		}
+		return all_ok;
+	}
+
+	int BenchFaceRoi(int argc, char* argv[])
+	{
+		const int iterations = BenchArgInt(argc, argv, "--iterations", 200);
+
+		std::vector<uint8_t> frame((size_t)kWidth * kHeight * 4);
+		TestPatternGenerator::Params pattern;
+		pattern.type = TestPatternGenerator::PatternType::kMovingGradient;
+		pattern.width = kWidth;
+		pattern.height = kHeight;
+		pattern.entropy = 40;
+		pattern.seed = 5;
+		TestPatternGenerator generator;
+		generator.SetParams(pattern);
+		generator.Generate(1, frame.data(), kWidth * 4);
+		std::vector<uint8_t> bgr;
+		VideoScaler scaler;
+
+		auto preprocess = [&](const std::vector<FaceRoiPlanner::Pass>& passes) {
+			for (const auto& pass : passes)
+			{
+				bgr.resize((size_t)pass.dst_width * pass.dst_height * 3);
+				scaler.Init(VideoScaler::Format::kBGRAToBGR, pass.src.width, pass.src.height, pass.dst_width, pass.dst_height,
+					VideoScaler::Filter::kArea);
+				const uint8_t* src[] = { frame.data() + (size_t)pass.src.y * kWidth * 4 + (size_t)pass.src.x * 4 };
+				const int src_linesize[] = { kWidth * 4 };
+				uint8_t* dst[] = { bgr.data() };
+				const int dst_linesize[] = { pass.dst_width * 3 };
+				scaler.Scale(src, src_linesize, dst, dst_linesize);
+			}
+		};
+
+		FaceRoiPlanner probe;
+		const FaceRoiPlanner::Params params = probe.GetParams();
+		printf("input:%dx%d full:%d wide scan every:%d expand:%.2f max crop:%d\n", kWidth, kHeight, kDetectWidth,
+			params.full_scan_interval, params.expand, params.max_crop_side);
+		printf("%-8s %5s %10s %10s %10s %10s %10s %10s %8s\n", "faces", "crops", "full px", "roi px", "saved", "full scale",
+			"roi scale", "roi prep", "check");
+
+		bool all_ok = true;
+		for (const auto& c : MakeCases())
+		{
+			FaceRoiPlanner planner;
+			std::vector<FaceRoiPlanner::Pass> full, roi;
+			bool scan_ok = planner.Plan(kWidth, kHeight, kDetectWidth, c.faces, full) && full.size() == 1;
+			const bool is_full = planner.Plan(kWidth, kHeight, kDetectWidth, c.faces, roi);
+
+			const int64_t full_px = (int64_t)full[0].dst_width * full[0].dst_height;
+			int64_t roi_px = 0;
+			float roi_scale = 1.0f;
+			bool rect_ok = true;
+			for (const auto& pass : roi)
+			{
+				roi_px += (int64_t)pass.dst_width * pass.dst_height;
+				roi_scale = std::min(roi_scale, (float)pass.dst_width / pass.src.width);
+				rect_ok = rect_ok && pass.src.x >= 0 && pass.src.y >= 0 && pass.src.x + pass.src.width <= kWidth &&
+					pass.src.y + pass.src.height <= kHeight;
+			}
+			if (!is_full)
+			{
+				for (const auto& face : c.faces)
+				{
+					bool inside = false;
+					for (const auto& pass : roi)
+						inside = inside || Contains(pass.src, face);
+					rect_ok = rect_ok && inside;
+				}
+			}
+
+			// 之后的第 full_scan_interval 次又是整幅
+			std::vector<FaceRoiPlanner::Pass> passes;
+			for (int i = 2; i < params.full_scan_interval; i++)
+				scan_ok = scan_ok && (is_full || !planner.Plan(kWidth, kHeight, kDetectWidth, c.faces, passes));
+			scan_ok = scan_ok && planner.Plan(kWidth, kHeight, kDetectWidth, c.faces, passes);
+
+			const double roi_ms = BenchRun(5, iterations, [&]() { preprocess(roi); }).MeanMs();
+
+			const bool ok = rect_ok && scan_ok && (is_full ? roi_px == full_px : roi_px < full_px);
+			all_ok = all_ok && ok;
+			char saved[32] = "full";
+			if (!is_full)
+				snprintf(saved, sizeof(saved), "%.0f%%", 100.0 * (full_px - roi_px) / full_px);
+			printf("%-8s %5zu %10lld %10lld %10s %10.2f %10.2f %8.3fms %8s\n", c.name, is_full ? (size_t)0 : roi.size(),
+				(long long)full_px, (long long)(is_full ? 0 : roi_px), saved, (float)full[0].dst_width / kWidth,
+				is_full ? 0.0f : roi_scale, roi_ms, ok ? "ok" : "FAILED");
+		}
+
+		FaceRoiPlanner planner;
+		std::vector<FaceRoiPlanner::Pass> passes;
+		const double full_ms = BenchRun(5, iterations, [&]() {
+			planner.Plan(kWidth, kHeight, kDetectWidth, {}, passes);
+			preprocess(passes);
+		}).MeanMs();
+		printf("full prep %.3fms\n", full_ms);
+
+		const bool nms_ok = CheckNms();
+		printf("nms:%s\n", nms_ok ? "ok" : "FAILED");
+		const bool tiles_ok = CheckTiles();
+		return all_ok && nms_ok && tiles_ok ? 0 : 1;
+	}
+}
+
+BENCH_REGISTER("face-roi", "ROI-restricted face detection plan: CNN input pixels and scale vs full-frame", BenchFaceRoi);
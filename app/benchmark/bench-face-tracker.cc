@@ -0,0 +1,156 @@
+/* 两次 CNN 检测之间的人脸跟踪
+* tiny-bench face-tracker [--frames N] [--detect-fps N] [--speed N]
+* 320x180 的灰度画面，有纹理的"人脸"按李萨如曲线移动，每帧加噪声；按 detect-fps 给带误差的检测框，其余帧用 FaceTracker 跟踪
+* 输出跟踪每帧耗时，以及中间帧框中心误差：跟踪 vs 沿用上一次检测结果
+* 检查跟踪误差小于沿用结果的误差，人脸被遮挡后 NeedsDetection 返回 true
+*/
+
+#include "bench-util.h"
+#include "face-tracker.h"
+#include <math.h>
+#include <algorithm>
+#include <vector>
+
+namespace
+{
+	const int kWidth = 320;
+	const int kHeight = 180;
+	const int kFaceSize = 48;
+	const double kFrameSeconds = 1.0 / 60.0;
+
+	struct Random
+	{
+		uint32_t state;
+		uint32_t Next()
+		{
+			state = state * 1664525u + 1013904223u;
+			return state >> 8;
+		}
+		// [-1, 1]
+		float Signed() { return (Next() & 0xFFFF) / 32767.5f - 1.0f; }
+	};
+
+	struct Scene
+	{
+		std::vector<uint8_t> background;
+		std::vector<uint8_t> face;
+		std::vector<uint8_t> frame;
+		Random random = { 7 };
+
+		Scene()
+		{
+			// 背景是低频的明暗变化，人脸是 6x6 像素一块的随机纹理，两者相关性低
+			background.resize((size_t)kWidth * kHeight);
+			for (int y = 0; y < kHeight; y++)
+			{
+				for (int x = 0; x < kWidth; x++)
+					background[(size_t)y * kWidth + x] = (uint8_t)(110 + 40 * sinf(x * 0.05f) * cosf(y * 0.07f));
+			}
+			face.resize((size_t)kFaceSize * kFaceSize);
+			std::vector<uint8_t> blocks(64);
+			for (auto& b : blocks)
+				b = (uint8_t)(40 + random.Next() % 180);
+			for (int y = 0; y < kFaceSize; y++)
+			{
+				for (int x = 0; x < kFaceSize; x++)
+					face[(size_t)y * kFaceSize + x] = blocks[(y / 6) * 8 + x / 6];
+			}
+			frame.resize(background.size());
+		}
+
+		void Render(float cx, float cy, bool visible)
+		{
+			for (size_t i = 0; i < frame.size(); i++)
+				frame[i] = (uint8_t)std::min(std::max((int)background[i] + (int)(random.Signed() * 8.0f), 0), 255);
+			if (!visible)
+				return;
+			const int x0 = (int)lroundf(cx) - kFaceSize / 2;
+			const int y0 = (int)lroundf(cy) - kFaceSize / 2;
+			for (int y = 0; y < kFaceSize; y++)
+			{
+				if (y0 + y < 0 || y0 + y >= kHeight)
+					continue;
+				for (int x = 0; x < kFaceSize; x++)
+				{
+					if (x0 + x < 0 || x0 + x >= kWidth)
+						continue;
+					int v = face[(size_t)y * kFaceSize + x] + (int)(random.Signed() * 8.0f);
+					frame[(size_t)(y0 + y) * kWidth + x0 + x] = (uint8_t)std::min(std::max(v, 0), 255);
+				}
+			}
+		}
+	};
+
+	int BenchFaceTracker(int argc, char* argv[])
+	{
+		const int frames = BenchArgInt(argc, argv, "--frames", 600);
+		const int detect_fps = std::max(1, BenchArgInt(argc, argv, "--detect-fps", 6));
+		// 人脸最大速度，像素 / 秒
+		const float speed = (float)BenchArgInt(argc, argv, "--speed", 120);
+		const int detect_every = std::max(1, 60 / detect_fps);
+
+		Scene scene;
+		FaceTracker tracker;
+		std::vector<FaceTracker::Box> detections, boxes;
+		BenchStats track_cost;
+		double track_error = 0.0, hold_error = 0.0;
+		int measured = 0, lost = 0;
+		float hold_x = 0.0f, hold_y = 0.0f;
+
+		// 李萨如曲线，振幅按速度上限换算
+		const float ax = 100.0f, ay = 50.0f;
+		const float wx = speed / ax * 0.7f, wy = speed / ay * 0.7f * 0.6f;
+		for (int i = 0; i < frames; i++)
+		{
+			const double time = i * kFrameSeconds;
+			const float cx = kWidth / 2 + ax * sinf((float)(wx * time));
+			const float cy = kHeight / 2 + ay * sinf((float)(wy * time + 0.5));
+			scene.Render(cx, cy, true);
+
+			if (i % detect_every == 0)
+			{
+				FaceTracker::Box box;
+				box.x = cx - kFaceSize / 2 + scene.random.Signed() * 2.0f;
+				box.y = cy - kFaceSize / 2 + scene.random.Signed() * 2.0f;
+				box.width = kFaceSize;
+				box.height = kFaceSize;
+				box.confidence = 90;
+				detections.assign(1, box);
+				tracker.OnDetection(scene.frame.data(), kWidth, kHeight, kWidth, detections, time);
+				hold_x = box.x + box.width / 2;
+				hold_y = box.y + box.height / 2;
+				continue;
+			}
+
+			uint64_t begin = BenchNowNs();
+			tracker.OnFrame(scene.frame.data(), kWidth, kHeight, kWidth, time);
+			track_cost.Add(BenchNowNs() - begin);
+			tracker.GetBoxes(boxes);
+			if (boxes.size() != 1)
+			{
+				lost++;
+				continue;
+			}
+			lost += tracker.NeedsDetection() ? 1 : 0;
+			track_error += hypot(boxes[0].x + boxes[0].width / 2 - cx, boxes[0].y + boxes[0].height / 2 - cy);
+			hold_error += hypot(hold_x - cx, hold_y - cy);
+			measured++;
+		}
+		track_error /= std::max(measured, 1);
+		hold_error /= std::max(measured, 1);
+
+		// 人脸消失 (遮挡) 后跟踪分数应该掉下来，请求重新检测
+		scene.Render(0.0f, 0.0f, false);
+		tracker.OnFrame(scene.frame.data(), kWidth, kHeight, kWidth, frames * kFrameSeconds);
+		const bool occlusion_ok = tracker.NeedsDetection();
+
+		const bool error_ok = measured > 0 && track_error < hold_error;
+		printf("frames:%d detect:%dfps speed:%.0fpx/s frame:%dx%d face:%d\n", frames, 60 / detect_every, speed, kWidth, kHeight, kFaceSize);
+		printf("track      %.4fms/frame  p95:%.4fms\n", track_cost.MeanMs(), track_cost.PercentileMs(95.0));
+		printf("center err tracker %.2fpx  hold last detection %.2fpx  low score frames:%d\n", track_error, hold_error, lost);
+		printf("error:%s occlusion:%s\n", error_ok ? "ok" : "FAILED", occlusion_ok ? "ok" : "FAILED");
+		return error_ok && occlusion_ok ? 0 : 1;
+	}
+}
+
+BENCH_REGISTER("face-tracker", "Kalman + NCC tracking between low-rate face detections", BenchFaceTracker);
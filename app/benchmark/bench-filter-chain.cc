@@ -0,0 +1,192 @@
+/* 滤镜链：旧的拷贝链和乒乓渲染目标对比，同时是 FilterChain 规划的无头检查
+* tiny-bench filter-chain [--width N] [--height N] [--filters N] [--iterations N]
+* 用 CPU 上的 BGRA 平面模拟渲染目标，滤镜是逐像素的读输入写输出
+* 旧链每个滤镜：拷进自己的输入、画到自己的目标、拷回输出、再拷回链上，最后再拷一次给外层画
+* 新链按 FilterChain 在两张目标之间交替，外层直接读最后一遍的输出
+* 检查：结果和旧链一致，每帧 passes == N+1、copies == 0，没有一遍读写同一张目标，
+* 同一帧第二次渲染 (预览) 不再跑滤镜；任何一项不满足返回非 0
+*/
+
+#include "bench-util.h"
+#include "core-filter-chain.h"
+#include <string.h>
+
+namespace
+{
+	using Surface = std::vector<uint32_t>;
+
+	struct ChainStats
+	{
+		uint64_t passes = 0;
+		uint64_t copies = 0;
+		uint64_t copy_bytes = 0;
+		bool hazard = false;
+	};
+
+	void CopySurface(Surface& dst, const Surface& src, ChainStats& stats)
+	{
+		memcpy(dst.data(), src.data(), src.size() * sizeof(uint32_t));
+		stats.copies += 1;
+		stats.copy_bytes += src.size() * sizeof(uint32_t);
+	}
+
+	void DrawSource(Surface& dst, int width, int height, uint32_t frame)
+	{
+		for (int y = 0; y < height; y++)
+		{
+			uint32_t* row = dst.data() + (size_t)y * width;
+			for (int x = 0; x < width; x++)
+				row[x] = 0xff000000u | ((x + frame) & 0xff) << 16 | (y & 0xff) << 8 | ((x ^ y) & 0xff);
+		}
+	}
+
+	// 第 index 个滤镜，每个滤镜不同，顺序错了结果就不一样
+	void DrawFilter(Surface& dst, const Surface& src, int index)
+	{
+		const uint32_t k = 0x9e3779b9u * (uint32_t)(index + 1);
+		for (size_t i = 0; i < src.size(); i++)
+		{
+			uint32_t v = src[i];
+			dst[i] = ((v * 33u + k) ^ (v >> 7)) | 0xff000000u;
+		}
+	}
+
+	class LegacyChain
+	{
+	public:
+		LegacyChain(int width, int height, int filters)
+			: width_(width), height_(height), target_((size_t)width * height), final_((size_t)width * height),
+			filter_output_(filters, Surface((size_t)width * height)), filter_target_(filters, Surface((size_t)width * height))
+		{
+		}
+
+		const Surface& Render(uint32_t frame, ChainStats& stats)
+		{
+			DrawSource(target_, width_, height_, frame);
+			stats.passes += 1;
+			for (size_t i = 0; i < filter_output_.size(); i++)
+			{
+				// SetInputTexture: 拷进输入，画到自己的目标，再拷回输出
+				CopySurface(filter_output_[i], target_, stats);
+				DrawFilter(filter_target_[i], filter_output_[i], (int)i);
+				CopySurface(filter_output_[i], filter_target_[i], stats);
+				// CopyOutputTexture
+				CopySurface(target_, filter_output_[i], stats);
+				stats.passes += 1;
+			}
+			CopySurface(final_, target_, stats);
+			return final_;
+		}
+
+	private:
+		int width_;
+		int height_;
+		Surface target_;
+		Surface final_;
+		std::vector<Surface> filter_output_;
+		std::vector<Surface> filter_target_;
+	};
+
+	class PingPongChain
+	{
+	public:
+		PingPongChain(int width, int height, int filters)
+			: width_(width), height_(height), filters_(filters)
+		{
+			for (auto& c : targets_)
+				c.resize((size_t)width * height);
+		}
+
+		// 和 CoreFilter::RenderSourcesWidthFilters 一样，同一帧只跑一次链
+		const Surface& Render(uint64_t frame, ChainStats& stats)
+		{
+			if (final_target_ == FilterChain::kNoTarget || rendered_frame_ != frame)
+			{
+				size_t pass = 0;
+				DrawSource(targets_[FilterChain::OutputTarget(pass)], width_, height_, (uint32_t)frame);
+				stats.passes += 1;
+				for (int i = 0; i < filters_; i++)
+				{
+					pass += 1;
+					int input = FilterChain::InputTarget(pass);
+					int output = FilterChain::OutputTarget(pass);
+					if (input == output || input == FilterChain::kNoTarget)
+						stats.hazard = true;
+					DrawFilter(targets_[output], targets_[input], i);
+					stats.passes += 1;
+				}
+				if (FilterChain::OutputTarget(pass) != FilterChain::FinalTarget(filters_))
+					stats.hazard = true;
+				final_target_ = FilterChain::FinalTarget(filters_);
+				rendered_frame_ = frame;
+			}
+			return targets_[final_target_];
+		}
+
+	private:
+		int width_;
+		int height_;
+		int filters_;
+		Surface targets_[FilterChain::kTargetCount];
+		int final_target_ = FilterChain::kNoTarget;
+		uint64_t rendered_frame_ = 0;
+	};
+
+	int BenchFilterChain(int argc, char* argv[])
+	{
+		const int width = BenchArgInt(argc, argv, "--width", 1920);
+		const int height = BenchArgInt(argc, argv, "--height", 1080);
+		const int max_filters = BenchArgInt(argc, argv, "--filters", 4);
+		const int iterations = BenchArgInt(argc, argv, "--iterations", 20);
+
+		printf("%dx%d filters:1-%d iterations:%d (each frame rendered twice: output + preview)\n", width, height, max_filters, iterations);
+		printf("%-8s %-10s %8s %8s %12s %12s %8s\n", "filters", "chain", "passes", "copies", "copy MB", "frame", "check");
+
+		bool all_ok = true;
+		for (int filters = 1; filters <= max_filters; filters++)
+		{
+			LegacyChain legacy(width, height, filters);
+			PingPongChain pingpong(width, height, filters);
+			ChainStats legacy_stats, pingpong_stats;
+			bool match = true;
+			uint64_t frame = 0;
+
+			// 旧链输出和预览各跑一遍完整的链
+			BenchStats legacy_time = BenchRun(1, iterations, [&]() {
+				frame += 1;
+				legacy.Render((uint32_t)frame, legacy_stats);
+				legacy.Render((uint32_t)frame, legacy_stats);
+			});
+			BenchStats pingpong_time = BenchRun(1, iterations, [&]() {
+				frame += 1;
+				pingpong.Render(frame, pingpong_stats);
+				pingpong.Render(frame, pingpong_stats);
+			});
+			const uint64_t frames = (uint64_t)iterations + 1;
+
+			// 结果和旧链逐像素一致
+			ChainStats check_stats;
+			for (int i = 0; i < 3; i++)
+			{
+				frame += 1;
+				if (pingpong.Render(frame, check_stats) != legacy.Render((uint32_t)frame, check_stats))
+					match = false;
+			}
+
+			bool ok = match && !pingpong_stats.hazard &&
+				pingpong_stats.passes == frames * FilterChain::PassCount(filters) &&
+				pingpong_stats.copies == 0;
+			all_ok = all_ok && ok;
+
+			printf("%-8d %-10s %8.1f %8.1f %12.1f %10.3fms %8s\n", filters, "legacy",
+				(double)legacy_stats.passes / frames, (double)legacy_stats.copies / frames,
+				legacy_stats.copy_bytes / (double)frames / (1024.0 * 1024.0), legacy_time.MeanMs(), "");
+			printf("%-8d %-10s %8.1f %8.1f %12.1f %10.3fms %8s\n", filters, "ping-pong",
+				(double)pingpong_stats.passes / frames, (double)pingpong_stats.copies / frames,
+				pingpong_stats.copy_bytes / (double)frames / (1024.0 * 1024.0), pingpong_time.MeanMs(), ok ? "ok" : "FAILED");
+		}
+		return all_ok ? 0 : 1;
+	}
+}
+
+BENCH_REGISTER("filter-chain", "copy-based vs ping-pong filter chain passes/copies per frame", BenchFilterChain);
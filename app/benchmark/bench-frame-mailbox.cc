@@ -0,0 +1,142 @@
+/* 检测帧从渲染线程交给检测线程的开销
+* tiny-bench frame-mailbox [--consumers N] [--frames N] [--work-us N] [--width N] [--height N]
+* 对比原来的做法 (生产者 malloc 一份，再给每个检测线程 malloc + memset + memcpy 一份) 和 FrameMailbox 的每帧生产者耗时
+* 检测线程每帧模拟 work-us 的检测耗时 (默认 40ms，比帧间隔长)，统计丢帧；检查每个消费者拿到的序号递增、最后都拿到最新一帧、池子的分配数有上限
+*/
+
+#include "bench-util.h"
+#include "frame-mailbox.h"
+#include <string.h>
+#include <atomic>
+#include <thread>
+#include <vector>
+
+namespace
+{
+	volatile uint32_t g_sink = 0;
+
+	// 原来的每帧做法，只计生产者这边的分配和拷贝；每个检测线程的拷贝留到下一帧再释放，模拟检测期间占用
+	uint64_t CopyPathFrame(const std::vector<uint8_t>& source, std::vector<uint8_t*>& held, size_t index)
+	{
+		const size_t size = source.size();
+		uint64_t begin = BenchNowNs();
+		uint8_t* scale_data = (uint8_t*)malloc(size);
+		memcpy(scale_data, source.data(), size);
+		for (auto& copy : held)
+		{
+			free(copy);
+			copy = (uint8_t*)malloc(size);
+			memset(copy, 0, size);
+			memcpy(copy, scale_data, size);
+		}
+		free(scale_data);
+		uint64_t ns = BenchNowNs() - begin;
+		for (auto copy : held)
+			g_sink += copy[index * 4099 % size];
+		return ns;
+	}
+
+	int BenchFrameMailbox(int argc, char* argv[])
+	{
+		const int consumers = std::max(1, BenchArgInt(argc, argv, "--consumers", 2));
+		const int frames = BenchArgInt(argc, argv, "--frames", 300);
+		// 默认比帧间隔长，检测跟不上时应该丢帧而不是排队
+		const int work_us = BenchArgInt(argc, argv, "--work-us", 40000);
+		const size_t width = (size_t)BenchArgInt(argc, argv, "--width", 320);
+		const size_t height = (size_t)BenchArgInt(argc, argv, "--height", 180);
+		const size_t size = width * height * 4;
+
+		std::vector<uint8_t> source(size, 0x80);
+		std::vector<uint8_t*> held(consumers, nullptr);
+		BenchStats copy_path;
+
+		FrameMailbox mailbox(consumers);
+		std::vector<std::thread> threads;
+		std::vector<uint64_t> received(consumers, 0);
+		// 生产者线程会读，用原子变量
+		std::vector<std::atomic<uint64_t>> last_sequence(consumers);
+		std::atomic<bool> order_ok(true);
+		for (int c = 0; c < consumers; c++)
+		{
+			threads.emplace_back([&, c]() {
+				for (;;)
+				{
+					FrameMailbox::FramePtr frame = mailbox.Wait(c);
+					if (!frame)
+						break;
+					if (frame->sequence <= last_sequence[c] || frame->data.size() != size || frame->data[0] != (uint8_t)frame->sequence)
+						order_ok = false;
+					last_sequence[c] = frame->sequence;
+					received[c]++;
+					// 检测在别的核上跑，这里用 sleep 模拟，不和生产者抢 CPU
+					std::this_thread::sleep_for(std::chrono::microseconds(work_us));
+				}
+			});
+		}
+
+		// 渲染线程按 60fps 节奏给帧，两种做法在同一帧里各做一次，缓存状态相同；信箱只计 Acquire + 写入 + Publish
+		BenchStats publish;
+		uint64_t next = BenchNowNs();
+		for (int i = 0; i < frames; i++)
+		{
+			copy_path.Add(CopyPathFrame(source, held, (size_t)i));
+
+			uint64_t begin = BenchNowNs();
+			std::shared_ptr<FrameMailbox::Frame> frame = mailbox.Acquire(size);
+			memcpy(frame->data.data(), source.data(), size);
+			frame->data[0] = (uint8_t)(i + 1);
+			frame->width = width;
+			frame->height = height;
+			frame->linesize = width * 4;
+			mailbox.Publish(std::move(frame));
+			publish.Add(BenchNowNs() - begin);
+
+			next += 16666667;
+			uint64_t now = BenchNowNs();
+			if (now < next)
+				std::this_thread::sleep_for(std::chrono::nanoseconds(next - now));
+		}
+
+		// 最后一帧留给消费者取走再关
+		bool last_ok = true;
+		uint64_t deadline = BenchNowNs() + (uint64_t)(work_us + 200000) * 1000;
+		for (int c = 0; c < consumers; c++)
+		{
+			while (BenchNowNs() < deadline && last_sequence[c] != (uint64_t)frames)
+				std::this_thread::sleep_for(std::chrono::milliseconds(1));
+		}
+		FrameMailbox::Stats stats = mailbox.GetStats();
+		mailbox.Close();
+		for (auto& t : threads)
+			t.join();
+
+		for (int c = 0; c < consumers; c++)
+			last_ok = last_ok && last_sequence[c] == (uint64_t)frames;
+		for (auto copy : held)
+			free(copy);
+
+		// 每个消费者收到的 + 丢掉的 = 发布的
+		bool count_ok = stats.published == (uint64_t)frames;
+		uint64_t total_received = 0;
+		for (int c = 0; c < consumers; c++)
+		{
+			count_ok = count_ok && received[c] + mailbox.GetDroppedCount(c) == stats.published;
+			total_received += received[c];
+		}
+		// 同时在用的缓冲：生产者一块、每个消费者手上和槽里各一块
+		bool pool_ok = stats.allocated <= (uint64_t)consumers * 2 + 1;
+
+		printf("consumers:%d frames:%d work:%dus frame:%zux%zu (%zu KB)\n", consumers, frames, work_us, width, height, size / 1024);
+		printf("copy path  producer %.4fms/frame  copies/frame:%d\n", copy_path.MeanMs(), consumers + 1);
+		printf("mailbox    producer %.4fms/frame  copies/frame:1  p95:%.4fms\n", publish.MeanMs(), publish.PercentileMs(95.0));
+		printf("received:%llu dropped:%llu buffers:%llu\n", (unsigned long long)total_received,
+			(unsigned long long)stats.dropped, (unsigned long long)stats.allocated);
+
+		bool ok = order_ok && last_ok && count_ok && pool_ok;
+		printf("order:%s latest:%s counts:%s pool:%s\n", order_ok ? "ok" : "FAILED", last_ok ? "ok" : "FAILED",
+			count_ok ? "ok" : "FAILED", pool_ok ? "ok" : "FAILED");
+		return ok ? 0 : 1;
+	}
+}
+
+BENCH_REGISTER("frame-mailbox", "latest-frame mailbox vs per-consumer copies for detection frames", BenchFrameMailbox);
@@ -0,0 +1,266 @@
+/* 3D LUT 调色的 CPU 版本
+* tiny-bench lut3d [--size 17|33|65|all] [--interp tetrahedral|trilinear|all] [--iterations N] [--threads N]
+* 1080p 下输出单线程 C / AVX2 / 多线程的每帧耗时，LUT 先生成 .cube 文本再解析，顺带覆盖解析器
+* 检查 AVX2 和多线程结果与 C 逐字节相同，C 和按浮点直接插值的结果最多差 1，单位 LUT 不改变画面 (最多差 1)
+*/
+
+#include "bench-util.h"
+#include "cpu-filter.h"
+#include "cube-lut.h"
+#include "task-pool.h"
+#include "cpu-features.h"
+#include "test-pattern-generator.h"
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <algorithm>
+#include <memory>
+#include <string>
+
+namespace
+{
+	const int kWidth = 1920;
+	const int kHeight = 1080;
+	const int kSizes[] = { 17, 33, 65 };
+
+	using Frame = std::vector<uint8_t>;
+
+	void FillSource(Frame& frame)
+	{
+		TestPatternGenerator::Params params;
+		params.type = TestPatternGenerator::PatternType::kMovingGradient;
+		params.width = kWidth;
+		params.height = kHeight;
+		params.entropy = 10;
+		params.seed = 7;
+		TestPatternGenerator generator;
+		generator.SetParams(params);
+		frame.resize((size_t)kWidth * kHeight * 4);
+		generator.Generate(3, frame.data(), kWidth * 4);
+		// 渐变只覆盖色彩空间的一小块，再叠一层散列噪声让查表落到各个格子里
+		uint32_t state = 12345;
+		for (size_t i = 0; i < frame.size(); i += 4)
+		{
+			state = state * 1664525u + 1013904223u;
+			if (state >> 31)
+			{
+				frame[i + 0] = (uint8_t)(state >> 8);
+				frame[i + 1] = (uint8_t)(state >> 16);
+				frame[i + 2] = (uint8_t)(state >> 24);
+			}
+			frame[i + 3] = (uint8_t)(i >> 2);
+		}
+	}
+
+	// 非线性的调色：S 曲线对比度、偏暖、降饱和，超出 0 - 1 的部分留给钳位
+	void Grade(double r, double g, double b, double out[3])
+	{
+		auto curve = [](double x) { return x * x * (3.0 - 2.0 * x) * 1.1 - 0.05; };
+		double luma = 0.2126 * r + 0.7152 * g + 0.0722 * b;
+		out[0] = curve(luma + (r - luma) * 0.8) + 0.04;
+		out[1] = curve(luma + (g - luma) * 0.8);
+		out[2] = curve(luma + (b - luma) * 0.8) - 0.04;
+	}
+
+	std::string MakeCube(int size, bool identity)
+	{
+		std::string text = "# tiny-bench\nTITLE \"bench\"\nLUT_3D_SIZE " + std::to_string(size) + "\n";
+		char line[96];
+		for (int b = 0; b < size; b++)
+		{
+			for (int g = 0; g < size; g++)
+			{
+				for (int r = 0; r < size; r++)
+				{
+					double in[3] = { r / (size - 1.0), g / (size - 1.0), b / (size - 1.0) };
+					double out[3] = { in[0], in[1], in[2] };
+					if (!identity)
+						Grade(in[0], in[1], in[2], out);
+					snprintf(line, sizeof(line), "%.6f %.6f %.6f\n", out[0], out[1], out[2]);
+					text += line;
+				}
+			}
+		}
+		return text;
+	}
+
+	// 浮点参考实现，直接按 .cube 的 RGB 数据插值
+	void ReferencePixel(const CubeLut::Lut& lut, CpuFilter::LutInterpolation interpolation, const uint8_t* in, double out[3])
+	{
+		const int n = lut.size;
+		double pos[3];
+		int index[3];
+		double frac[3];
+		for (int c = 0; c < 3; c++)
+		{
+			// in 是 BGRA，c 按 RGB
+			pos[c] = in[2 - c] / 255.0 * (n - 1);
+			index[c] = std::min((int)floor(pos[c]), n - 2);
+			frac[c] = pos[c] - index[c];
+		}
+		auto at = [&](int dr, int dg, int db, int c) {
+			size_t i = ((size_t)(index[2] + db) * n + (index[1] + dg)) * n + (index[0] + dr);
+			return (double)std::min(std::max(lut.rgb[i * 3 + c], 0.0f), 1.0f);
+		};
+
+		for (int c = 0; c < 3; c++)
+		{
+			if (interpolation == CpuFilter::LutInterpolation::kTrilinear)
+			{
+				double v = 0.0;
+				for (int k = 0; k < 8; k++)
+				{
+					int dr = k & 1, dg = (k >> 1) & 1, db = (k >> 2) & 1;
+					double w = (dr ? frac[0] : 1 - frac[0]) * (dg ? frac[1] : 1 - frac[1]) * (db ? frac[2] : 1 - frac[2]);
+					v += w * at(dr, dg, db, c);
+				}
+				out[c] = v;
+			}
+			else
+			{
+				// 按权重从大到小沿棱走
+				int order[3] = { 0, 1, 2 };
+				std::sort(order, order + 3, [&](int a, int b) { return frac[a] > frac[b]; });
+				int step[3] = { 0, 0, 0 };
+				double v = (1 - frac[order[0]]) * at(0, 0, 0, c);
+				double prev = frac[order[0]];
+				for (int k = 0; k < 3; k++)
+				{
+					step[order[k]] = 1;
+					double next = k < 2 ? frac[order[k + 1]] : 0.0;
+					v += (prev - next) * at(step[0], step[1], step[2], c);
+					prev = next;
+				}
+				out[c] = v;
+			}
+		}
+	}
+
+	// 返回和参考结果的最大差值 (8 位单位)
+	double CompareReference(const CubeLut::Lut& lut, CpuFilter::LutInterpolation interpolation, const Frame& src, const Frame& dst)
+	{
+		double worst = 0.0;
+		for (size_t i = 0; i < src.size(); i += 4)
+		{
+			double ref[3];
+			ReferencePixel(lut, interpolation, &src[i], ref);
+			for (int c = 0; c < 3; c++)
+				worst = std::max(worst, fabs(ref[c] * 255.0 - dst[i + 2 - c]));
+			if (src[i + 3] != dst[i + 3])
+				return 255.0;
+		}
+		return worst;
+	}
+
+	int BenchLut3D(int argc, char* argv[])
+	{
+		const std::string which_size = BenchArg(argc, argv, "--size", "all");
+		const std::string which_interp = BenchArg(argc, argv, "--interp", "all");
+		const int iterations = BenchArgInt(argc, argv, "--iterations", 20);
+		const int threads = BenchArgInt(argc, argv, "--threads", 0);
+
+		std::unique_ptr<TaskPool> own_pool;
+		TaskPool* pool = TaskPool::GetShared();
+		if (threads > 0)
+		{
+			own_pool.reset(new TaskPool(threads - 1));
+			pool = own_pool.get();
+		}
+
+		Frame src, ref, simd, mt;
+		FillSource(src);
+		ref.resize(src.size());
+		simd.resize(src.size());
+		mt.resize(src.size());
+
+		struct Interp
+		{
+			const char* name;
+			CpuFilter::LutInterpolation mode;
+		};
+		const Interp interps[] = {
+			{ "tetrahedral", CpuFilter::LutInterpolation::kTetrahedral },
+			{ "trilinear", CpuFilter::LutInterpolation::kTrilinear },
+		};
+
+		CpuFilter::Options c_options;
+		c_options.use_simd = false;
+		CpuFilter::Options simd_options;
+		CpuFilter::Options mt_options;
+		mt_options.pool = pool;
+
+		printf("avx2:%s threads:%zu iterations:%d size:%dx%d\n", cpu_has_avx2() ? "yes" : "no",
+			pool->GetThreadCount() + 1, iterations, kWidth, kHeight);
+		printf("%-5s %-12s %9s %10s %10s %10s %10s %8s %8s\n", "lut", "interp", "parse", "C", "AVX2", "MT", "MP/s(MT)", "maxdiff", "check");
+
+		bool all_ok = true;
+		for (int size : kSizes)
+		{
+			if (which_size != "all" && atoi(which_size.c_str()) != size)
+				continue;
+
+			const std::string text = MakeCube(size, false);
+			CubeLut::Lut lut;
+			std::string error;
+			uint64_t parse_begin = BenchNowNs();
+			bool parsed = CubeLut::Parse(text.c_str(), text.size(), lut, &error);
+			double parse_ms = (BenchNowNs() - parse_begin) / 1e6;
+			CpuFilter::Lut3DTable table;
+			if (!parsed || !CpuFilter::BuildLut3DTable(lut.rgb.data(), lut.size, lut.domain_min, lut.domain_max, table))
+			{
+				printf("%-5d parse failed: %s\n", size, error.c_str());
+				all_ok = false;
+				continue;
+			}
+
+			for (const auto& c : interps)
+			{
+				if (which_interp != "all" && which_interp != c.name)
+					continue;
+
+				BenchStats c_stats = BenchRun(1, iterations, [&]() {
+					CpuFilter::ApplyLut3D(src.data(), kWidth * 4, ref.data(), kWidth * 4, kWidth, kHeight, table, c.mode, c_options);
+				});
+				BenchStats simd_stats = BenchRun(1, iterations, [&]() {
+					CpuFilter::ApplyLut3D(src.data(), kWidth * 4, simd.data(), kWidth * 4, kWidth, kHeight, table, c.mode, simd_options);
+				});
+				BenchStats mt_stats = BenchRun(1, iterations, [&]() {
+					CpuFilter::ApplyLut3D(src.data(), kWidth * 4, mt.data(), kWidth * 4, kWidth, kHeight, table, c.mode, mt_options);
+				});
+
+				double diff = CompareReference(lut, c.mode, src, ref);
+				bool ok = simd == ref && mt == ref && diff <= 1.0;
+				all_ok = all_ok && ok;
+
+				double mt_ms = mt_stats.MeanMs();
+				printf("%-5d %-12s %7.2fms %8.3fms %8.3fms %8.3fms %10.0f %8.3f %8s\n", size, c.name, parse_ms,
+					c_stats.MeanMs(), simd_stats.MeanMs(), mt_ms,
+					mt_ms > 0 ? (double)kWidth * kHeight / 1e6 / (mt_ms / 1000.0) : 0.0, diff, ok ? "ok" : "FAILED");
+			}
+		}
+
+		// 单位 LUT：原地处理，画面应该不变
+		{
+			const std::string text = MakeCube(33, true);
+			CubeLut::Lut lut;
+			CpuFilter::Lut3DTable table;
+			bool ok = CubeLut::Parse(text.c_str(), text.size(), lut) &&
+				CpuFilter::BuildLut3DTable(lut.rgb.data(), lut.size, lut.domain_min, lut.domain_max, table);
+			for (const auto& c : interps)
+			{
+				if (!ok)
+					break;
+				Frame frame = src;
+				CpuFilter::ApplyLut3D(frame.data(), kWidth * 4, frame.data(), kWidth * 4, kWidth, kHeight, table, c.mode, mt_options);
+				for (size_t i = 0; i < frame.size() && ok; i++)
+					ok = abs((int)frame[i] - (int)src[i]) <= 1;
+			}
+			printf("identity: %s\n", ok ? "ok" : "FAILED");
+			all_ok = all_ok && ok;
+		}
+		return all_ok ? 0 : 1;
+	}
+}
+
+BENCH_REGISTER("lut3d", "3D LUT colour grading (17/33/65, tetrahedral/trilinear) at 1080p", BenchLut3D);
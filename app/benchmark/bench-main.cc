@@ -0,0 +1,43 @@
+#include "bench-util.h"
+#include <string.h>
+
+std::vector<BenchEntry>& BenchEntries()
+{
+	static std::vector<BenchEntry> entries;
+	return entries;
+}
+
+static void PrintUsage()
+{
+	printf("usage: tiny-bench <name|all> [options]\n");
+	for (const BenchEntry& e : BenchEntries())
+		printf("  %-16s %s\n", e.name, e.help);
+}
+
+int main(int argc, char* argv[])
+{
+	if (argc < 2)
+	{
+		PrintUsage();
+		return 1;
+	}
+
+	bool all = strcmp(argv[1], "all") == 0;
+	bool found = false;
+	int ret = 0;
+	for (const BenchEntry& e : BenchEntries())
+	{
+		if (all || strcmp(argv[1], e.name) == 0)
+		{
+			found = true;
+			printf("==== %s ====\n", e.name);
+			ret |= e.func(argc - 2, argv + 2);
+		}
+	}
+	if (!found)
+	{
+		PrintUsage();
+		return 1;
+	}
+	return ret;
+}
@@ -0,0 +1,219 @@
+/* 画面静止时跳过人脸检测
+* tiny-bench motion-gate [--iterations N] [--threads N]
+* BlockSad 的 C / AVX2 / 多线程耗时，检查三者和逐像素的参考结果相同 (包括块边长不是 8 的倍数、右下边块不满的情况)
+* 再用 320x180 的合成灰度序列 (30fps，带 ±3 的噪声) 走 MotionGate：静止、方块移动、只有嘴部大小的区域在变、再静止，
+* 输出每段跑检测 / 跳过的次数和每帧 Check 的耗时；检查静止段只在强制刷新时检测，运动段和嘴部变化每帧都检测
+*/
+
+#include "bench-util.h"
+#include "motion-gate.h"
+#include "cpu-filter.h"
+#include "task-pool.h"
+#include "cpu-features.h"
+#include <stdlib.h>
+#include <memory>
+#include <random>
+#include <vector>
+
+namespace
+{
+	const int kWidth = 320;
+	const int kHeight = 180;
+	const int64_t kFrameNs = 33333333;
+
+	void ReferenceSad(const std::vector<uint8_t>& a, const std::vector<uint8_t>& b, int width, int height, int block, std::vector<uint32_t>& sads)
+	{
+		const int columns = (width + block - 1) / block;
+		sads.assign((size_t)columns * ((height + block - 1) / block), 0);
+		for (int y = 0; y < height; y++)
+		{
+			for (int x = 0; x < width; x++)
+				sads[(size_t)(y / block) * columns + x / block] += (uint32_t)abs(a[(size_t)y * width + x] - b[(size_t)y * width + x]);
+		}
+	}
+
+	bool BenchBlockSad(int iterations, TaskPool* pool)
+	{
+		CpuFilter::Options c_options;
+		c_options.use_simd = false;
+		CpuFilter::Options simd_options;
+		CpuFilter::Options mt_options;
+		mt_options.pool = pool;
+
+		struct Case
+		{
+			int width;
+			int height;
+			int block;
+		};
+		const Case cases[] = { { 320, 180, 16 }, { 333, 187, 16 }, { 320, 180, 12 }, { 640, 360, 8 }, { 1920, 1080, 32 } };
+
+		printf("%-10s %6s %10s %10s %10s %8s\n", "size", "block", "C", "AVX2", "MT", "check");
+		bool all_ok = true;
+		std::mt19937 rng(5);
+		for (const auto& c : cases)
+		{
+			std::vector<uint8_t> a((size_t)c.width * c.height), b(a.size());
+			for (size_t i = 0; i < a.size(); i++)
+			{
+				a[i] = (uint8_t)rng();
+				b[i] = (uint8_t)rng();
+			}
+			std::vector<uint32_t> ref;
+			ReferenceSad(a, b, c.width, c.height, c.block, ref);
+			std::vector<uint32_t> sads_c(ref.size()), sads_simd(ref.size()), sads_mt(ref.size());
+
+			auto run = [&](std::vector<uint32_t>& sads, const CpuFilter::Options& options) {
+				return BenchRun(2, iterations, [&]() {
+					CpuFilter::BlockSad(a.data(), c.width, b.data(), c.width, c.width, c.height, c.block, sads.data(), options);
+				}).MeanMs();
+			};
+			double c_ms = run(sads_c, c_options);
+			double simd_ms = run(sads_simd, simd_options);
+			double mt_ms = run(sads_mt, mt_options);
+
+			bool ok = sads_c == ref && sads_simd == ref && sads_mt == ref;
+			all_ok = all_ok && ok;
+			char name[32];
+			snprintf(name, sizeof(name), "%dx%d", c.width, c.height);
+			printf("%-10s %6d %8.4fms %8.4fms %8.4fms %8s\n", name, c.block, c_ms, simd_ms, mt_ms, ok ? "ok" : "FAILED");
+		}
+		return all_ok;
+	}
+
+	// 合成画面：固定的纹理背景，加上每帧不同的噪声
+	class Scene
+	{
+	public:
+		Scene() : rng_(11), background_((size_t)kWidth * kHeight), frame_(background_.size())
+		{
+			for (int y = 0; y < kHeight; y++)
+			{
+				for (int x = 0; x < kWidth; x++)
+					background_[(size_t)y * kWidth + x] = (uint8_t)(60 + (x * 7 + y * 3) % 90 + rng_() % 20);
+			}
+		}
+
+		const uint8_t* Render(int block_x, int block_y, bool mouth_open)
+		{
+			for (size_t i = 0; i < frame_.size(); i++)
+				frame_[i] = (uint8_t)std::min(255, std::max(0, background_[i] + (int)(rng_() % 7) - 3));
+			if (block_x >= 0)
+				Fill(block_x, block_y, 40, 40, 230);
+			// 嘴部：12x6，落在一个 16x16 块里
+			if (mouth_open)
+				Fill(164, 100, 12, 6, 20);
+			return frame_.data();
+		}
+
+	private:
+		void Fill(int x0, int y0, int width, int height, uint8_t value)
+		{
+			for (int y = std::max(y0, 0); y < std::min(y0 + height, kHeight); y++)
+			{
+				for (int x = std::max(x0, 0); x < std::min(x0 + width, kWidth); x++)
+					frame_[(size_t)y * kWidth + x] = value;
+			}
+		}
+
+	private:
+		std::mt19937 rng_;
+		std::vector<uint8_t> background_;
+		std::vector<uint8_t> frame_;
+	};
+
+	enum class Segment
+	{
+		kStatic,
+		kMoving,
+		kMouth,
+	};
+
+	bool BenchGate()
+	{
+		struct Part
+		{
+			const char* name;
+			Segment segment;
+			int frames;
+		};
+		const Part parts[] = {
+			{ "static", Segment::kStatic, 150 },
+			{ "moving", Segment::kMoving, 60 },
+			{ "mouth", Segment::kMouth, 60 },
+			{ "static", Segment::kStatic, 150 },
+		};
+
+		MotionGate gate;
+		const MotionGate::Params& params = gate.GetParams();
+		Scene scene;
+		int64_t time = 0;
+		int frame = 0;
+		bool all_ok = true;
+
+		printf("\nmotion gate %dx%d block:%d diff:%d max changed:%d refresh:%dms\n", kWidth, kHeight, params.block,
+			params.block_diff, params.max_changed_blocks, params.refresh_ms);
+		printf("%-8s %6s %6s %8s %8s %12s %8s\n", "segment", "frames", "run", "refresh", "skipped", "check/frame", "result");
+		for (const auto& part : parts)
+		{
+			gate.ResetStats();
+			BenchStats check;
+			for (int i = 0; i < part.frames; i++, frame++, time += kFrameNs)
+			{
+				const uint8_t* gray = nullptr;
+				if (part.segment == Segment::kMoving)
+					gray = scene.Render(20 + i * 4, 60 + i, false);
+				else if (part.segment == Segment::kMouth)
+					gray = scene.Render(-1, -1, (i / 2) % 2 == 0);
+				else
+					gray = scene.Render(-1, -1, false);
+				uint64_t begin = BenchNowNs();
+				gate.Check(gray, kWidth, kHeight, kWidth, time);
+				check.Add(BenchNowNs() - begin);
+			}
+
+			const MotionGate::Stats& stats = gate.GetStats();
+			bool ok = true;
+			if (part.segment == Segment::kStatic)
+			{
+				// 段首的一帧 (画面刚停下或第一帧) 加上每秒一次的刷新
+				const int64_t refreshes = (int64_t)part.frames * kFrameNs / ((int64_t)params.refresh_ms * 1000000) + 1;
+				ok = stats.run - stats.refreshed <= 1 && stats.refreshed <= refreshes;
+			}
+			else if (part.segment == Segment::kMoving)
+			{
+				ok = stats.skipped == 0;
+			}
+			else
+			{
+				// 嘴每两帧开合一次，每次变化都要检测到
+				ok = stats.run >= part.frames / 2;
+			}
+			all_ok = all_ok && ok;
+			printf("%-8s %6d %6lld %8lld %8lld %10.4fms %8s\n", part.name, part.frames, (long long)stats.run, (long long)stats.refreshed,
+				(long long)stats.skipped, check.MeanMs(), ok ? "ok" : "FAILED");
+		}
+		return all_ok;
+	}
+
+	int BenchMotionGate(int argc, char* argv[])
+	{
+		const int iterations = BenchArgInt(argc, argv, "--iterations", 200);
+		const int threads = BenchArgInt(argc, argv, "--threads", 0);
+
+		std::unique_ptr<TaskPool> own_pool;
+		TaskPool* pool = TaskPool::GetShared();
+		if (threads > 0)
+		{
+			own_pool.reset(new TaskPool(threads - 1));
+			pool = own_pool.get();
+		}
+
+		printf("avx2:%s threads:%zu iterations:%d\n", cpu_has_avx2() ? "yes" : "no", pool->GetThreadCount() + 1, iterations);
+		bool sad_ok = BenchBlockSad(iterations, pool);
+		bool gate_ok = BenchGate();
+		return sad_ok && gate_ok ? 0 : 1;
+	}
+}
+
+BENCH_REGISTER("motion-gate", "block SAD change detection that skips face detection on static frames", BenchMotionGate);
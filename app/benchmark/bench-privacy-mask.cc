@@ -0,0 +1,247 @@
+/* 人脸区域的隐私模糊 / 马赛克的 CPU 版本
+* tiny-bench privacy-mask [--mode blur|mosaic|all] [--radius N] [--passes N] [--block N] [--iterations N] [--threads N]
+* 1080p 下按区域面积从无到整幅画面输出单线程 C / AVX2 / 多线程的耗时和每百万像素耗时，耗时应和区域面积成正比
+* 检查 AVX2 和多线程结果与 C 逐字节相同，区域外的像素不变，区域内和整幅画面处理的结果相同
+* 最后用抖动的检测框检查 FaceRegionSmoother 的平滑和漏检保持
+*/
+
+#include "bench-util.h"
+#include "cpu-filter.h"
+#include "face-region-smoother.h"
+#include "task-pool.h"
+#include "cpu-features.h"
+#include "test-pattern-generator.h"
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <algorithm>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace
+{
+	const int kWidth = 1920;
+	const int kHeight = 1080;
+
+	using Frame = std::vector<uint8_t>;
+	using Regions = std::vector<CpuFilter::Region>;
+
+	struct Case
+	{
+		const char* name;
+		Regions regions;
+	};
+
+	void FillSource(Frame& frame)
+	{
+		TestPatternGenerator::Params params;
+		params.type = TestPatternGenerator::PatternType::kMovingGradient;
+		params.width = kWidth;
+		params.height = kHeight;
+		params.entropy = 30;
+		params.seed = 11;
+		TestPatternGenerator generator;
+		generator.SetParams(params);
+		frame.resize((size_t)kWidth * kHeight * 4);
+		generator.Generate(5, frame.data(), kWidth * 4);
+	}
+
+	std::vector<Case> MakeCases()
+	{
+		return {
+			{ "none", {} },
+			{ "small", { { 900, 400, 96, 96 } } },
+			{ "medium", { { 820, 300, 240, 280 } } },
+			{ "4 faces", { { 120, 200, 200, 240 }, { 600, 260, 200, 240 }, { 1080, 220, 200, 240 }, { 1560, 300, 200, 240 } } },
+			{ "large", { { 640, 220, 640, 640 } } },
+			// 超出画面的部分裁掉
+			{ "edge", { { -60, -40, 300, 300 }, { 1760, 900, 300, 300 } } },
+			{ "full", { { 0, 0, kWidth, kHeight } } },
+		};
+	}
+
+	int64_t RegionArea(const Regions& regions)
+	{
+		int64_t area = 0;
+		for (const auto& r : regions)
+		{
+			int w = std::min(r.x + r.width, kWidth) - std::max(r.x, 0);
+			int h = std::min(r.y + r.height, kHeight) - std::max(r.y, 0);
+			if (w > 0 && h > 0)
+				area += (int64_t)w * h;
+		}
+		return area;
+	}
+
+	bool InRegions(const Regions& regions, int x, int y)
+	{
+		for (const auto& r : regions)
+		{
+			if (x >= r.x && x < r.x + r.width && y >= r.y && y < r.y + r.height)
+				return true;
+		}
+		return false;
+	}
+
+	// 区域外和原图相同，区域内和整幅画面处理的结果相同 (区域不重叠时成立)
+	bool CheckRegions(const Frame& src, const Frame& full, const Frame& dst, const Regions& regions)
+	{
+		const uint32_t* s = (const uint32_t*)src.data();
+		const uint32_t* f = (const uint32_t*)full.data();
+		const uint32_t* d = (const uint32_t*)dst.data();
+		for (int y = 0; y < kHeight; y++)
+		{
+			for (int x = 0; x < kWidth; x++)
+			{
+				size_t i = (size_t)y * kWidth + x;
+				if (d[i] != (InRegions(regions, x, y) ? f[i] : s[i]))
+					return false;
+			}
+		}
+		return true;
+	}
+
+	// 固定位置的人脸加 ±jitter 像素的抖动，每 7 帧漏检一次，返回平滑后框中心的最大偏移
+	bool CheckSmoother(double& raw_jitter, double& smooth_jitter)
+	{
+		FaceRegionSmoother smoother;
+		FaceRegionSmoother::Params params = smoother.GetParams();
+		params.margin = 0.0f;
+		smoother.SetParams(params);
+
+		const float cx = 800.0f, cy = 400.0f, size = 200.0f, jitter = 6.0f;
+		uint32_t state = 99;
+		raw_jitter = 0.0;
+		smooth_jitter = 0.0;
+		std::vector<FaceRegionSmoother::Box> detections, regions;
+		bool ok = true;
+		for (int frame = 0; frame < 120; frame++)
+		{
+			detections.clear();
+			if (frame % 7 != 6)
+			{
+				state = state * 1664525u + 1013904223u;
+				float dx = ((state >> 8) & 0xFF) / 255.0f * 2.0f - 1.0f;
+				float dy = ((state >> 16) & 0xFF) / 255.0f * 2.0f - 1.0f;
+				FaceRegionSmoother::Box box;
+				box.x = cx + dx * jitter - size / 2;
+				box.y = cy + dy * jitter - size / 2;
+				box.width = size;
+				box.height = size;
+				detections.push_back(box);
+				raw_jitter = std::max(raw_jitter, (double)std::max(fabsf(dx), fabsf(dy)) * jitter);
+			}
+			smoother.Update(&detections);
+			smoother.GetRegions(regions);
+			// 漏检的那一帧框还在，也不会多出第二条轨迹
+			ok = ok && regions.size() == 1;
+			if (frame >= 20 && regions.size() == 1)
+			{
+				double mx = regions[0].x + regions[0].width / 2 - cx;
+				double my = regions[0].y + regions[0].height / 2 - cy;
+				smooth_jitter = std::max(smooth_jitter, std::max(fabs(mx), fabs(my)));
+			}
+		}
+
+		// 人脸离开后保持 hold_frames 次，然后消失
+		detections.clear();
+		for (int i = 0; i < params.hold_frames; i++)
+			smoother.Update(&detections);
+		ok = ok && smoother.GetTrackCount() == 1;
+		smoother.Update(&detections);
+		ok = ok && smoother.GetTrackCount() == 0;
+		return ok && smooth_jitter < raw_jitter;
+	}
+
+	int BenchPrivacyMask(int argc, char* argv[])
+	{
+		const std::string which_mode = BenchArg(argc, argv, "--mode", "all");
+		const int radius = BenchArgInt(argc, argv, "--radius", 8);
+		const int passes = BenchArgInt(argc, argv, "--passes", 3);
+		const int block = BenchArgInt(argc, argv, "--block", 16);
+		const int iterations = BenchArgInt(argc, argv, "--iterations", 20);
+		const int threads = BenchArgInt(argc, argv, "--threads", 0);
+
+		std::unique_ptr<TaskPool> own_pool;
+		TaskPool* pool = TaskPool::GetShared();
+		if (threads > 0)
+		{
+			own_pool.reset(new TaskPool(threads - 1));
+			pool = own_pool.get();
+		}
+
+		CpuFilter::Options c_options;
+		c_options.use_simd = false;
+		CpuFilter::Options simd_options;
+		CpuFilter::Options mt_options;
+		mt_options.pool = pool;
+
+		Frame src;
+		FillSource(src);
+		const std::vector<Case> cases = MakeCases();
+
+		printf("avx2:%s threads:%zu iterations:%d size:%dx%d radius:%d passes:%d block:%d\n", cpu_has_avx2() ? "yes" : "no",
+			pool->GetThreadCount() + 1, iterations, kWidth, kHeight, radius, passes, block);
+		printf("%-7s %-8s %7s %10s %10s %10s %12s %8s\n", "mode", "regions", "MP", "C", "AVX2", "MT", "AVX2 ms/MP", "check");
+
+		bool all_ok = true;
+		for (int m = 0; m < 2; m++)
+		{
+			const bool blur = m == 0;
+			const char* mode = blur ? "blur" : "mosaic";
+			if (which_mode != "all" && which_mode != mode)
+				continue;
+
+			auto apply = [&](Frame& frame, const Regions& regions, const CpuFilter::Options& options) {
+				if (blur)
+					CpuFilter::BlurRegions(frame.data(), kWidth * 4, kWidth, kHeight, regions.data(), regions.size(), radius, passes, options);
+				else
+					CpuFilter::MosaicRegions(frame.data(), kWidth * 4, kWidth, kHeight, regions.data(), regions.size(), block, options);
+			};
+
+			Frame full = src;
+			const Regions whole = { { 0, 0, kWidth, kHeight } };
+			apply(full, whole, c_options);
+
+			for (const auto& c : cases)
+			{
+				// 原地处理，每次计时前恢复原图，恢复的拷贝不计入
+				Frame ref, simd, mt;
+				auto run = [&](Frame& out, const CpuFilter::Options& options) {
+					uint64_t total = 0;
+					for (int i = 0; i < iterations + 1; i++)
+					{
+						out = src;
+						uint64_t begin = BenchNowNs();
+						apply(out, c.regions, options);
+						if (i > 0)
+							total += BenchNowNs() - begin;
+					}
+					return total / 1e6 / iterations;
+				};
+				double c_ms = run(ref, c_options);
+				double simd_ms = run(simd, simd_options);
+				double mt_ms = run(mt, mt_options);
+
+				bool ok = simd == ref && mt == ref && CheckRegions(src, full, ref, c.regions);
+				all_ok = all_ok && ok;
+
+				double mp = RegionArea(c.regions) / 1e6;
+				char per_mp[32] = "-";
+				if (mp > 0.0)
+					snprintf(per_mp, sizeof(per_mp), "%.3f", simd_ms / mp);
+				printf("%-7s %-8s %7.3f %8.3fms %8.3fms %8.3fms %12s %8s\n", mode, c.name, mp, c_ms, simd_ms, mt_ms,
+					per_mp, ok ? "ok" : "FAILED");
+			}
+		}
+
+		double raw_jitter = 0.0, smooth_jitter = 0.0;
+		bool smoother_ok = CheckSmoother(raw_jitter, smooth_jitter);
+		printf("smoother: raw jitter %.2fpx, smoothed %.2fpx, hold %s\n", raw_jitter, smooth_jitter, smoother_ok ? "ok" : "FAILED");
+		all_ok = all_ok && smoother_ok;
+		return all_ok ? 0 : 1;
+	}
+}
+
+BENCH_REGISTER("privacy-mask", "ROI-limited blur/mosaic for face privacy at 1080p, cost vs region area", BenchPrivacyMask);
@@ -0,0 +1,159 @@
+/* 场景命令队列：MpscQueue 和 mutex + deque 对比
+* tiny-bench scene-command [--producers N] [--commands N] [--iterations N]
+* 多个生产者线程各自投递 commands 条单命令批次 (和 CoreScene::UpdateSourceProperty 一样)
+* 消费者线程模拟渲染线程，每 "帧" 取完队列里的命令，取之间做一段固定的工作
+* 统计生产者单次投递的延迟和全部取完的总时间；另外统计控制端点一行 100 条命令的解析耗时
+*/
+
+#include "bench-util.h"
+#include "core-scene-command.h"
+#include "mpsc-queue.h"
+#include <atomic>
+#include <deque>
+#include <mutex>
+#include <thread>
+
+namespace
+{
+	class LockedQueue
+	{
+	public:
+		void Push(SceneCommand::CommandBatch value)
+		{
+			std::unique_lock<std::mutex> lock(mutex_);
+			queue_.push_back(std::move(value));
+		}
+
+		bool Pop(SceneCommand::CommandBatch& value)
+		{
+			std::unique_lock<std::mutex> lock(mutex_);
+			if (queue_.empty())
+				return false;
+			value = std::move(queue_.front());
+			queue_.pop_front();
+			return true;
+		}
+
+	private:
+		std::mutex mutex_;
+		std::deque<SceneCommand::CommandBatch> queue_;
+	};
+
+	SceneCommand::CommandBatch MakeUpdate(int index)
+	{
+		SceneCommand::CommandBatch batch(1);
+		batch[0].type = SceneCommand::CommandType::kUpdateSource;
+		batch[0].source = "text_fps";
+		batch[0].props.SetString(CoreProperty::PropertyId::kText, "fps:" + std::to_string(index));
+		return batch;
+	}
+
+	// 防止消费者的工作被优化掉
+	volatile uint64_t g_sink = 0;
+
+	template<class Queue>
+	void RunQueue(int producers, int commands, BenchStats& push_stats, BenchStats& total_stats)
+	{
+		Queue queue;
+		std::atomic<int> ready{ 0 };
+		std::atomic<bool> go{ false };
+		std::vector<std::vector<uint64_t>> latency(producers);
+		const uint64_t expected = (uint64_t)producers * commands;
+
+		uint64_t begin = 0;
+		std::thread consumer([&]() {
+			uint64_t received = 0;
+			SceneCommand::CommandBatch batch;
+			while (received < expected)
+			{
+				while (queue.Pop(batch))
+				{
+					received += batch.size();
+					g_sink += batch[0].props.Size();
+				}
+				// 一帧里其余的工作
+				uint64_t x = g_sink;
+				for (int i = 0; i < 2000; i++)
+					x = x * 6364136223846793005ULL + 1442695040888963407ULL;
+				g_sink = x;
+			}
+		});
+
+		std::vector<std::thread> threads;
+		for (int p = 0; p < producers; p++)
+		{
+			threads.emplace_back([&, p]() {
+				std::vector<SceneCommand::CommandBatch> batches;
+				for (int i = 0; i < commands; i++)
+					batches.push_back(MakeUpdate(i));
+				latency[p].reserve(commands);
+				ready++;
+				while (!go)
+					std::this_thread::yield();
+				for (int i = 0; i < commands; i++)
+				{
+					uint64_t t = BenchNowNs();
+					queue.Push(std::move(batches[i]));
+					latency[p].push_back(BenchNowNs() - t);
+				}
+			});
+		}
+		while (ready < producers)
+			std::this_thread::yield();
+		begin = BenchNowNs();
+		go = true;
+		for (auto& t : threads)
+			t.join();
+		consumer.join();
+		total_stats.Add(BenchNowNs() - begin);
+
+		for (auto& v : latency)
+		{
+			for (uint64_t ns : v)
+				push_stats.Add(ns);
+		}
+	}
+
+	int BenchSceneCommand(int argc, char* argv[])
+	{
+		const int producers = BenchArgInt(argc, argv, "--producers", 4);
+		const int commands = BenchArgInt(argc, argv, "--commands", 50000);
+		const int iterations = BenchArgInt(argc, argv, "--iterations", 5);
+
+		printf("producers:%d commands/producer:%d iterations:%d\n", producers, commands, iterations);
+		printf("%-8s %12s %12s %12s %12s %14s\n", "queue", "push p50", "push p99", "push p99.9", "total", "commands/s");
+
+		auto report = [&](const char* name, const BenchStats& push, const BenchStats& total) {
+			double total_ms = total.MeanMs();
+			printf("%-8s %10.3fus %10.3fus %10.3fus %10.3fms %14.0f\n", name,
+				push.PercentileMs(50) * 1000.0, push.PercentileMs(99) * 1000.0, push.PercentileMs(99.9) * 1000.0,
+				total_ms, total_ms > 0 ? (double)producers * commands / (total_ms / 1000.0) : 0.0);
+		};
+
+		BenchStats mpsc_push, mpsc_total, locked_push, locked_total;
+		for (int i = 0; i < iterations; i++)
+		{
+			RunQueue<MpscQueue<SceneCommand::CommandBatch>>(producers, commands, mpsc_push, mpsc_total);
+			RunQueue<LockedQueue>(producers, commands, locked_push, locked_total);
+		}
+		report("mpsc", mpsc_push, mpsc_total);
+		report("mutex", locked_push, locked_total);
+
+		// 控制端点的一行请求
+		nlohmann::json request = { { "commands", nlohmann::json::array() } };
+		for (int i = 0; i < 100; i++)
+		{
+			request["commands"].push_back({ { "op", "update" }, { "source", "source_" + std::to_string(i) },
+				{ "param", { { "topX", "-4" }, { "topY", "-2" }, { "width", "-1" }, { "height", "-1" }, { "text", "item " + std::to_string(i) } } } });
+		}
+		std::string line = request.dump();
+		SceneCommand::CommandBatch batch;
+		bool ok = true;
+		BenchStats parse = BenchRun(10, 200, [&]() { ok = SceneCommand::ParseCommandBatch(line.c_str(), line.size(), batch) && ok; });
+		printf("parse 100-command request (%zu bytes): mean %.3fms p95 %.3fms %s\n", line.size(),
+			parse.MeanMs(), parse.PercentileMs(95), ok && batch.size() == 100 ? "" : "FAILED");
+		return ok ? 0 : 1;
+	}
+}
+
+BENCH_REGISTER("scene-command", "MPSC vs mutex scene command queue latency and throughput", BenchSceneCommand);
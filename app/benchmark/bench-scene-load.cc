@@ -0,0 +1,224 @@
+/* 场景加载：JSON 和 .tsb 二进制场景对比
+* tiny-bench scene-load [--iterations N]
+* 分别生成 10 / 100 / 1000 个源的场景写到临时目录，按 CoreScene 的流程只做解析和属性填充 (不创建源)
+* JSON：读文件 -> parse -> 每个源 PropertyBag::FromJson，滤镜列表 dump 后再 parse (和 GenerateFilters 一致)
+* 二进制：mmap -> 校验 -> 每个源 FillProperties
+*/
+
+#include "bench-util.h"
+#include "core-scene-binary.h"
+#include <filesystem>
+#include <fstream>
+#include <sstream>
+
+namespace
+{
+	// core-scene-data.h 是 UTF-16 编码，这里直接写对应的数值
+	enum BenchSourceType
+	{
+		kSourceImage = 1,
+		kSourceGdiplusText = 3,
+		kSourceMedia = 4,
+		kSourceTestPattern = 7,
+	};
+
+	enum BenchFilterType
+	{
+		kFilterSplit = 1,
+		kFilterBoltBox = 2,
+	};
+
+	const int kAlignLeft = -4;
+	const int kAlignRight = -3;
+	const int kAlignTop = -2;
+	const int kActuallySize = -1;
+
+	nlohmann::json MakeRect(int index)
+	{
+		return {
+			{ "topX", std::to_string(index % 2 ? kAlignRight : kAlignLeft) },
+			{ "topY", std::to_string(kAlignTop) },
+			{ "width", std::to_string(index % 3 ? kActuallySize : 320 + index) },
+			{ "height", std::to_string(index % 3 ? kActuallySize : 180 + index) },
+		};
+	}
+
+	nlohmann::json MakeScene(int count)
+	{
+		nlohmann::json sources = nlohmann::json::array();
+		for (int i = 0; i < count; i++)
+		{
+			nlohmann::json source;
+			nlohmann::json param = MakeRect(i);
+			BenchSourceType type;
+			switch (i % 4)
+			{
+			case 0:
+				type = kSourceMedia;
+				param["path"] = "D:\\media\\clip_" + std::to_string(i) + ".mp4";
+				break;
+			case 1:
+				type = kSourceGdiplusText;
+				param["text"] = "scene item " + std::to_string(i);
+				break;
+			case 2:
+				type = kSourceImage;
+				param["path"] = "D:\\images\\overlay_" + std::to_string(i) + ".png";
+				break;
+			default:
+				type = kSourceTestPattern;
+				param["pattern"] = "noise";
+				param["patternWidth"] = "1280";
+				param["patternHeight"] = "720";
+				param["fps"] = "30";
+				param["entropy"] = std::to_string(i % 100);
+				param["seed"] = std::to_string(i);
+				break;
+			}
+			source["name"] = "source_" + std::to_string(i);
+			source["type"] = std::to_string((int)type);
+			source["param"] = param;
+			if (i % 3 == 0)
+			{
+				source["filters"] = {
+					{ { "name", "split" }, { "type", std::to_string((int)kFilterSplit) } },
+					{ { "name", "bolt" }, { "type", std::to_string((int)kFilterBoltBox) },
+						{ "param", { { "path", "D:\\BoltAnim" } } } },
+				};
+			}
+			sources.push_back(source);
+		}
+		return { { "sources", sources } };
+	}
+
+	bool WriteFile(const std::string& path, const void* data, size_t size)
+	{
+		std::ofstream file(path, std::ios::binary);
+		file.write((const char*)data, size);
+		return (bool)file;
+	}
+
+	// 返回填充过的属性条数，防止被优化掉
+	size_t LoadJson(const std::string& path)
+	{
+		std::ifstream file(path, std::ios::binary);
+		std::stringstream ss;
+		ss << file.rdbuf();
+		std::string data = ss.str();
+
+		size_t total = 0;
+		auto json = nlohmann::json::parse(data);
+		const auto& sources = json.at("sources");
+		for (size_t i = 0; i < sources.size(); i++)
+		{
+			const auto& c = sources[i];
+			std::string name = c.at("name");
+			std::string type = c.at("type");
+			total += std::stoi(type) + name.size();
+			if (c.find("param") != c.end())
+			{
+				CoreProperty::PropertyBag props;
+				props.FromJson(c.at("param"));
+				total += props.Size();
+			}
+			if (c.find("filters") != c.end())
+			{
+				auto filters = nlohmann::json::parse(c.at("filters").dump());
+				for (size_t j = 0; j < filters.size(); j++)
+				{
+					const auto& f = filters[j];
+					std::string filtername = f.at("name");
+					total += std::stoi((std::string)f.at("type")) + filtername.size();
+					if (f.find("param") != f.end())
+					{
+						CoreProperty::PropertyBag props;
+						props.FromJson(f.at("param"));
+						total += props.Size();
+					}
+				}
+			}
+		}
+		return total;
+	}
+
+	size_t LoadBinary(const std::string& path)
+	{
+		SceneBinary::SceneFile file;
+		if (!file.Open(path.c_str()))
+			return 0;
+
+		size_t total = 0;
+		const SceneBinary::SceneView& view = file.GetView();
+		CoreProperty::PropertyBag props;
+		for (uint32_t i = 0; i < view.GetSourceCount(); i++)
+		{
+			const SceneBinary::ItemRecord& item = view.GetSource(i);
+			std::string name(view.GetName(item), item.name_length);
+			total += item.type + name.size();
+			view.FillProperties(item, props);
+			total += props.Size();
+			for (uint32_t j = 0; j < item.filter_count; j++)
+			{
+				const SceneBinary::ItemRecord& filter = view.GetFilter(item, j);
+				std::string filtername(view.GetName(filter), filter.name_length);
+				total += filter.type + filtername.size();
+				view.FillProperties(filter, props);
+				total += props.Size();
+			}
+		}
+		return total;
+	}
+
+	int BenchSceneLoad(int argc, char* argv[])
+	{
+		const int iterations = BenchArgInt(argc, argv, "--iterations", 50);
+		const std::filesystem::path dir = std::filesystem::temp_directory_path();
+
+		printf("%-8s %10s %10s %12s %12s %12s %12s %8s %9s\n", "sources", "json(B)", "tsb(B)",
+			"json mean", "json p95", "tsb mean", "tsb p95", "speedup", "lossless");
+
+		const int counts[] = { 10, 100, 1000 };
+		for (int count : counts)
+		{
+			nlohmann::json scene = MakeScene(count);
+			std::string json_text = scene.dump();
+			std::vector<uint8_t> binary;
+			std::string error;
+			if (!SceneBinary::JsonToBinary(scene, binary, &error))
+			{
+				fprintf(stderr, "convert failed: %s\n", error.c_str());
+				return 1;
+			}
+
+			std::string json_path = (dir / ("tiny-bench-scene-" + std::to_string(count) + ".json")).string();
+			std::string tsb_path = (dir / ("tiny-bench-scene-" + std::to_string(count) + ".tsb")).string();
+			if (!WriteFile(json_path, json_text.data(), json_text.size()) || !WriteFile(tsb_path, binary.data(), binary.size()))
+			{
+				fprintf(stderr, "write scene files to %s failed\n", dir.string().c_str());
+				return 1;
+			}
+
+			SceneBinary::SceneFile file;
+			nlohmann::json back;
+			bool lossless = file.Open(tsb_path.c_str()) && SceneBinary::BinaryToJson(file.GetView(), back) && back == scene;
+			file.Close();
+
+			size_t json_total = 0;
+			size_t tsb_total = 0;
+			BenchStats json_stats = BenchRun(3, iterations, [&]() { json_total = LoadJson(json_path); });
+			BenchStats tsb_stats = BenchRun(3, iterations, [&]() { tsb_total = LoadBinary(tsb_path); });
+			if (json_total != tsb_total)
+				lossless = false;
+
+			printf("%-8d %10zu %10zu %10.3fms %10.3fms %10.3fms %10.3fms %7.1fx %9s\n", count, json_text.size(), binary.size(),
+				json_stats.MeanMs(), json_stats.PercentileMs(95), tsb_stats.MeanMs(), tsb_stats.PercentileMs(95),
+				tsb_stats.MeanMs() > 0 ? json_stats.MeanMs() / tsb_stats.MeanMs() : 0.0, lossless ? "yes" : "NO");
+
+			std::filesystem::remove(json_path);
+			std::filesystem::remove(tsb_path);
+		}
+		return 0;
+	}
+}
+
+BENCH_REGISTER("scene-load", "JSON vs binary scene load time for 10/100/1000 sources", BenchSceneLoad);
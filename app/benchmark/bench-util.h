@@ -0,0 +1,116 @@
+#ifndef BENCH_UTIL_H
+#define BENCH_UTIL_H
+
+/* TinyBench 的公共部分：注册表、计时和统计
+* 每个 bench-*.cc 用 BENCH_REGISTER 注册一个入口，tiny-bench <name> [options] 运行
+*/
+
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string>
+#include <vector>
+#include <chrono>
+#include <algorithm>
+
+using BenchFunc = int(*)(int argc, char* argv[]);
+
+struct BenchEntry
+{
+	const char* name;
+	const char* help;
+	BenchFunc func;
+};
+
+std::vector<BenchEntry>& BenchEntries();
+
+struct BenchRegistrar
+{
+	BenchRegistrar(const char* name, const char* help, BenchFunc func)
+	{
+		BenchEntries().push_back({ name, help, func });
+	}
+};
+
+#define BENCH_REGISTER(name, help, func) static BenchRegistrar bench_registrar_##func(name, help, func)
+
+inline uint64_t BenchNowNs()
+{
+	return (uint64_t)std::chrono::duration_cast<std::chrono::nanoseconds>(
+		std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+inline const char* BenchArg(int argc, char* argv[], const char* key, const char* def)
+{
+	std::string k = key;
+	for (int i = 0; i + 1 < argc; i++)
+	{
+		if (k == argv[i])
+			return argv[i + 1];
+	}
+	return def;
+}
+
+inline int BenchArgInt(int argc, char* argv[], const char* key, int def)
+{
+	const char* v = BenchArg(argc, argv, key, nullptr);
+	return v ? atoi(v) : def;
+}
+
+inline bool BenchHasFlag(int argc, char* argv[], const char* key)
+{
+	std::string k = key;
+	for (int i = 0; i < argc; i++)
+	{
+		if (k == argv[i])
+			return true;
+	}
+	return false;
+}
+
+class BenchStats
+{
+public:
+	void Add(uint64_t ns) { samples_.push_back(ns); }
+	size_t Count() const { return samples_.size(); }
+	double MeanMs() const
+	{
+		if (samples_.empty())
+			return 0.0;
+		double sum = 0.0;
+		for (uint64_t s : samples_)
+			sum += (double)s;
+		return sum / samples_.size() / 1e6;
+	}
+	// p 取 0 - 100
+	double PercentileMs(double p) const
+	{
+		if (samples_.empty())
+			return 0.0;
+		std::vector<uint64_t> sorted = samples_;
+		std::sort(sorted.begin(), sorted.end());
+		size_t idx = (size_t)(p / 100.0 * (sorted.size() - 1) + 0.5);
+		return sorted[idx] / 1e6;
+	}
+
+private:
+	std::vector<uint64_t> samples_;
+};
+
+// 跑 warmup 次预热，再跑 iterations 次记录耗时
+template<class Fn>
+BenchStats BenchRun(int warmup, int iterations, Fn&& fn)
+{
+	for (int i = 0; i < warmup; i++)
+		fn();
+	BenchStats stats;
+	for (int i = 0; i < iterations; i++)
+	{
+		uint64_t begin = BenchNowNs();
+		fn();
+		stats.Add(BenchNowNs() - begin);
+	}
+	return stats;
+}
+
+#endif
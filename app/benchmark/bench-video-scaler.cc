@@ -0,0 +1,203 @@
+/* VideoScaler 和 swscale 的对比
+* tiny-bench scaler [--iterations N] [--threads N]
+* 每个用例输出单线程 C / AVX2 / 多线程的每帧耗时，链接了 swscale 时同时给出 swscale 耗时和两者结果的 PSNR
+*/
+
+#include "bench-util.h"
+#include "video-scaler.h"
+#include "task-pool.h"
+#include "test-pattern-generator.h"
+#include <math.h>
+#include <memory>
+
+#if defined(BENCH_WITH_SWSCALE)
+extern "C" {
+#include "libswscale/swscale.h"
+#include "libavutil/pixfmt.h"
+}
+#endif
+
+namespace
+{
+	struct Image
+	{
+		int width = 0;
+		int height = 0;
+		std::vector<uint8_t> planes[3];
+		int linesize[3] = { 0 };
+
+		void Alloc(VideoScaler::Format format, int w, int h)
+		{
+			width = w;
+			height = h;
+			if (format == VideoScaler::Format::kBGRA)
+			{
+				linesize[0] = w * 4;
+				planes[0].assign((size_t)linesize[0] * h, 0);
+			}
+			else
+			{
+				linesize[0] = w;
+				linesize[1] = linesize[2] = (w + 1) / 2;
+				planes[0].assign((size_t)w * h, 0);
+				planes[1].assign((size_t)linesize[1] * ((h + 1) / 2), 0);
+				planes[2].assign((size_t)linesize[2] * ((h + 1) / 2), 0);
+			}
+		}
+		const uint8_t* const* Src() { src_[0] = planes[0].data(); src_[1] = planes[1].data(); src_[2] = planes[2].data(); return src_; }
+		uint8_t* const* Dst() { dst_[0] = planes[0].data(); dst_[1] = planes[1].data(); dst_[2] = planes[2].data(); return dst_; }
+
+	private:
+		const uint8_t* src_[3];
+		uint8_t* dst_[3];
+	};
+
+	void FillSource(VideoScaler::Format format, Image& image)
+	{
+		TestPatternGenerator::Params params;
+		params.type = TestPatternGenerator::PatternType::kMovingGradient;
+		params.width = image.width;
+		params.height = image.height;
+		params.entropy = 10;
+		params.seed = 42;
+		TestPatternGenerator generator;
+		generator.SetParams(params);
+
+		if (format == VideoScaler::Format::kBGRA)
+		{
+			generator.Generate(7, image.planes[0].data(), image.linesize[0]);
+			return;
+		}
+		std::vector<uint8_t> bgra((size_t)image.width * image.height * 4);
+		generator.Generate(7, bgra.data(), image.width * 4);
+		// 测试用，粗略的 BT.601 转换就够了
+		for (int y = 0; y < image.height; y++)
+		{
+			for (int x = 0; x < image.width; x++)
+			{
+				const uint8_t* p = &bgra[((size_t)y * image.width + x) * 4];
+				image.planes[0][(size_t)y * image.linesize[0] + x] = (uint8_t)((66 * p[2] + 129 * p[1] + 25 * p[0] + 128) / 256 + 16);
+				if (!(x & 1) && !(y & 1))
+				{
+					image.planes[1][(size_t)(y / 2) * image.linesize[1] + x / 2] = (uint8_t)((-38 * p[2] - 74 * p[1] + 112 * p[0] + 128) / 256 + 128);
+					image.planes[2][(size_t)(y / 2) * image.linesize[2] + x / 2] = (uint8_t)((112 * p[2] - 94 * p[1] - 18 * p[0] + 128) / 256 + 128);
+				}
+			}
+		}
+	}
+
+#if defined(BENCH_WITH_SWSCALE)
+	double Psnr(const Image& a, const Image& b, int planes)
+	{
+		double mse = 0.0;
+		size_t count = 0;
+		for (int i = 0; i < planes; i++)
+		{
+			for (size_t j = 0; j < a.planes[i].size(); j++)
+			{
+				double d = (double)a.planes[i][j] - b.planes[i][j];
+				mse += d * d;
+			}
+			count += a.planes[i].size();
+		}
+		mse /= count;
+		return mse <= 0.0 ? 99.0 : 10.0 * log10(255.0 * 255.0 / mse);
+	}
+
+	int SwsFlags(VideoScaler::Filter filter)
+	{
+		switch (filter)
+		{
+		case VideoScaler::Filter::kBilinear:
+			return SWS_BILINEAR | SWS_ACCURATE_RND;
+		case VideoScaler::Filter::kBicubic:
+			return SWS_BICUBIC | SWS_ACCURATE_RND;
+		case VideoScaler::Filter::kLanczos:
+			return SWS_LANCZOS | SWS_ACCURATE_RND;
+		}
+		return SWS_BILINEAR;
+	}
+#endif
+
+	const char* FilterName(VideoScaler::Filter filter)
+	{
+		switch (filter)
+		{
+		case VideoScaler::Filter::kBilinear:
+			return "bilinear";
+		case VideoScaler::Filter::kBicubic:
+			return "bicubic";
+		case VideoScaler::Filter::kLanczos:
+			return "lanczos";
+		}
+		return "";
+	}
+
+	int BenchVideoScaler(int argc, char* argv[])
+	{
+		const int iterations = BenchArgInt(argc, argv, "--iterations", 30);
+		const int threads = BenchArgInt(argc, argv, "--threads", (int)std::thread::hardware_concurrency() - 1);
+		std::unique_ptr<TaskPool> pool(new TaskPool(threads > 0 ? threads : 0));
+
+		struct Case { int sw, sh, dw, dh; } cases[] = {
+			{ 3840, 2160, 1920, 1080 },
+			{ 1920, 1080, 1280, 720 },
+			{ 1920, 1080, 320, 180 },
+			{ 1280, 720, 1920, 1080 },
+		};
+		const VideoScaler::Format formats[] = { VideoScaler::Format::kBGRA, VideoScaler::Format::kI420 };
+		const VideoScaler::Filter filters[] = { VideoScaler::Filter::kBilinear, VideoScaler::Filter::kBicubic, VideoScaler::Filter::kLanczos };
+
+		printf("%-6s %-22s %-9s %9s %9s %9s", "format", "size", "filter", "C(ms)", "avx2(ms)", "mt(ms)");
+#if defined(BENCH_WITH_SWSCALE)
+		printf(" %9s %7s", "sws(ms)", "psnr");
+#endif
+		printf("\n");
+
+		for (VideoScaler::Format format : formats)
+		{
+			for (const Case& c : cases)
+			{
+				Image src;
+				src.Alloc(format, c.sw, c.sh);
+				FillSource(format, src);
+				Image dst;
+				dst.Alloc(format, c.dw, c.dh);
+
+				for (VideoScaler::Filter filter : filters)
+				{
+					VideoScaler scaler;
+					scaler.Init(format, c.sw, c.sh, c.dw, c.dh, filter);
+
+					scaler.SetUseSimd(false);
+					BenchStats scalar = BenchRun(2, iterations, [&]() { scaler.Scale(src.Src(), src.linesize, dst.Dst(), dst.linesize); });
+					scaler.SetUseSimd(true);
+					BenchStats simd = BenchRun(2, iterations, [&]() { scaler.Scale(src.Src(), src.linesize, dst.Dst(), dst.linesize); });
+					scaler.SetTaskPool(pool.get());
+					BenchStats mt = BenchRun(2, iterations, [&]() { scaler.Scale(src.Src(), src.linesize, dst.Dst(), dst.linesize); });
+
+					char size[32];
+					snprintf(size, sizeof(size), "%dx%d->%dx%d", c.sw, c.sh, c.dw, c.dh);
+					printf("%-6s %-22s %-9s %9.3f %9.3f %9.3f", format == VideoScaler::Format::kBGRA ? "bgra" : "i420",
+						size, FilterName(filter), scalar.PercentileMs(50), simd.PercentileMs(50), mt.PercentileMs(50));
+
+#if defined(BENCH_WITH_SWSCALE)
+					AVPixelFormat pix = format == VideoScaler::Format::kBGRA ? AV_PIX_FMT_BGRA : AV_PIX_FMT_YUV420P;
+					SwsContext* sws = sws_getContext(c.sw, c.sh, pix, c.dw, c.dh, pix, SwsFlags(filter), NULL, NULL, NULL);
+					Image ref;
+					ref.Alloc(format, c.dw, c.dh);
+					BenchStats sws_stats = BenchRun(2, iterations, [&]() {
+						sws_scale(sws, src.Src(), src.linesize, 0, c.sh, ref.Dst(), ref.linesize);
+					});
+					sws_freeContext(sws);
+					printf(" %9.3f %7.2f", sws_stats.PercentileMs(50), Psnr(dst, ref, format == VideoScaler::Format::kBGRA ? 1 : 3));
+#endif
+					printf("\n");
+				}
+			}
+		}
+		return 0;
+	}
+}
+
+BENCH_REGISTER("scaler", "VideoScaler vs swscale, --iterations N --threads N", BenchVideoScaler);
@@ -24,6 +24,12 @@ CoreAudio::~CoreAudio()
 		desktop_audio_ = nullptr;
 	}
 
+	if (synthetic_audio_)
+	{
+		delete synthetic_audio_;
+		synthetic_audio_ = nullptr;
+	}
+
 	if (audio_resampler_)
 	{
 		delete audio_resampler_;
@@ -43,6 +49,10 @@ void CoreAudio::PreEndup()
 	{
 		desktop_audio_->UnRegisterAudioDataReceivedCallback();
 	}
+	if (synthetic_audio_)
+	{
+		synthetic_audio_->UnRegisterAudioDataReceivedCallback();
+	}
 	audio_run_.store(false);
 	if (audio_thread_.joinable())
 		audio_thread_.join();
@@ -58,7 +68,17 @@ void CoreAudio::StartupCoreAudio()
 void CoreAudio::AudioThreadImpl()
 {
 	CoreSettings* settings = core_engine_->GetSettings();
-	if (settings->GetOutputParam()->enable)
+	if (settings->GetOutputParam()->enable && settings->GetOutputParam()->synthetic_audio)
+	{
+		synthetic_audio_ = new SyntheticAudioSource();
+		synthetic_audio_->RegisterAudioDataReceivedCallback(std::bind(&CoreAudio::DesktopAudioDataReceived, this, std::placeholders::_1));
+		const CoreSettingsData::Output* output = settings->GetOutputParam();
+		SyntheticAudioSource::WaveType wave = output->synthetic_wave == CoreSettingsData::SyntheticWave::kNoise ?
+			SyntheticAudioSource::WaveType::kNoise : SyntheticAudioSource::WaveType::kTone;
+		synthetic_audio_->InitSyntheticAudio(wave, output->synthetic_frequency, output->synthetic_level, output->synthetic_seed,
+			settings->GetAudioParam()->speakers, settings->GetAudioParam()->samples_per_sec);
+	}
+	else if (settings->GetOutputParam()->enable)
 	{
 		desktop_audio_ = new WasapiAudioSource();
 		desktop_audio_->InitWasapiDevice(false, true, false);
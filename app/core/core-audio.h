@@ -7,6 +7,7 @@
 #include "core-component-i.h"
 #include "audio-resampler.h"
 #include "wasapi-audio-source.h"
+#include "synthetic-audio-source.h"
 #include "circlebuf.h"
 
 using CoreAudioDataCallback = std::function<void(const CoreAudioData::AudioMixerOutput* data)>;
@@ -34,6 +35,7 @@ private:
 	std::atomic<uint64_t> audio_capture_start_ts_;
 	AudioResampler* audio_resampler_ = nullptr;
 	WasapiAudioSource* desktop_audio_ = nullptr;
+	SyntheticAudioSource* synthetic_audio_ = nullptr;
 	struct circlebuf desktop_audio_buf_[MAX_AUDIO_CHANNELS];
 	std::mutex desktop_audio_mutex_;
 	std::mutex audio_callback_mutex_;
@@ -18,6 +18,10 @@ namespace CoreD3DData
 		kAlpha2D,
 		kModel3D,
 		kThreeMirror2D,
+		kLut3D2D,
+		kLut3DTetrahedral2D,
+		kBlur2D,
+		kMosaic2D,
 	};
 
 }
\ No newline at end of file
@@ -243,6 +243,7 @@ void CoreD3D::RenderBegin()
 		return;
 	m_pd3dImmediateContext->OMSetDepthStencilState(no_depth_stencil_state_.Get(), 0);
 	static float color[4] = { 1.0f, 1.0f, 1.0f, 1.0f };
+	memcpy(clear_color_, color, sizeof(clear_color_));
 	m_pd3dImmediateContext->ClearRenderTargetView(m_pRenderTargetView.Get(), color);
 	m_pd3dImmediateContext->ClearDepthStencilView(m_pDepthStencilView.Get(), D3D11_CLEAR_DEPTH | D3D11_CLEAR_STENCIL, 1.0f, 0);
 	m_pd3dImmediateContext->OMSetRenderTargets(1, m_pRenderTargetView.GetAddressOf(), m_pDepthStencilView.Get());
@@ -255,6 +256,7 @@ void CoreD3D::RenderOutputTextureBegin()
 	PushFrontViewPort((float)settings->GetOutputParam()->video.width, (float)settings->GetOutputParam()->video.height);
 
 	static float color[4] = { 0.0f, 0.0f, 0.0f, 0.0f };
+	memcpy(clear_color_, color, sizeof(clear_color_));
 	m_pd3dImmediateContext->ClearRenderTargetView(output_target_view_.Get(), color);
 	m_pd3dImmediateContext->ClearDepthStencilView(output_depth_stencil_view_.Get(), D3D11_CLEAR_DEPTH | D3D11_CLEAR_STENCIL, 1.0f, 0);
 	m_pd3dImmediateContext->OMSetRenderTargets(1, output_target_view_.GetAddressOf(), output_depth_stencil_view_.Get());
@@ -335,6 +337,15 @@ void CoreD3D::InitAlphaBlendState()
 	}
 
 	HR_EXCEPTION(m_pd3dDevice->CreateBlendState(&bd, alpha_blend_state_.GetAddressOf()));
+
+	for (int i = 0; i < 8; i++) {
+		bd.RenderTarget[i].SrcBlend = D3D11_BLEND_BLEND_FACTOR;
+		bd.RenderTarget[i].DestBlend = D3D11_BLEND_INV_BLEND_FACTOR;
+		bd.RenderTarget[i].SrcBlendAlpha = D3D11_BLEND_BLEND_FACTOR;
+		bd.RenderTarget[i].DestBlendAlpha = D3D11_BLEND_INV_BLEND_FACTOR;
+	}
+
+	HR_EXCEPTION(m_pd3dDevice->CreateBlendState(&bd, fade_blend_state_.GetAddressOf()));
 }
 
 void CoreD3D::InitDepthStencilState()
@@ -398,6 +409,10 @@ void CoreD3D::InitHLSLShaderResource()
 	CreatePixelShader(CoreD3DData::PixelHlslType::kAlpha2D, L"Basic_PS_Alpha_2D.hlsl");
 	CreatePixelShader(CoreD3DData::PixelHlslType::kModel3D, L"Model_PS.hlsl");
 	CreatePixelShader(CoreD3DData::PixelHlslType::kThreeMirror2D, L"Basic_PS_ThreeMirror.hlsl");
+	CreatePixelShader(CoreD3DData::PixelHlslType::kLut3D2D, L"Basic_PS_Lut3D.hlsl");
+	CreatePixelShader(CoreD3DData::PixelHlslType::kLut3DTetrahedral2D, L"Basic_PS_Lut3D_Tetrahedral.hlsl");
+	CreatePixelShader(CoreD3DData::PixelHlslType::kBlur2D, L"Basic_PS_Blur.hlsl");
+	CreatePixelShader(CoreD3DData::PixelHlslType::kMosaic2D, L"Basic_PS_Mosaic.hlsl");
 
 }
 
@@ -572,6 +587,17 @@ void CoreD3D::CloseAlphaBlend()
 	m_pd3dImmediateContext->OMSetBlendState(nullptr, blendFactor, 0xffffffff);
 }
 
+void CoreD3D::OpenFadeBlend(float factor)
+{
+	float blendFactor[] = { factor, factor, factor, factor };
+	m_pd3dImmediateContext->OMSetBlendState(fade_blend_state_.Get(), blendFactor, 0xffffffff);
+}
+
+void CoreD3D::GetClearColor(float color[4])
+{
+	memcpy(color, clear_color_, sizeof(clear_color_));
+}
+
 void CoreD3D::PushFrontViewPort(float width, float height)
 {
 	D3D11_VIEWPORT viewport;
@@ -615,9 +641,9 @@ void CoreD3D::DrawIndexed(UINT indexcount, UINT startlocation, UINT baselocation
 	m_pd3dImmediateContext->DrawIndexed(indexcount, startlocation, baselocation);
 }
 
-void CoreD3D::Map(ID3D11Resource* pResource, UINT Subresource, D3D11_MAP MapType, UINT MapFlags, D3D11_MAPPED_SUBRESOURCE* pMappedResource)
+HRESULT CoreD3D::Map(ID3D11Resource* pResource, UINT Subresource, D3D11_MAP MapType, UINT MapFlags, D3D11_MAPPED_SUBRESOURCE* pMappedResource)
 {
-	m_pd3dImmediateContext->Map(pResource, Subresource, MapType, MapFlags, pMappedResource);
+	return m_pd3dImmediateContext->Map(pResource, Subresource, MapType, MapFlags, pMappedResource);
 }
 
 void CoreD3D::UnMap(ID3D11Resource* pResource, UINT Subresource)
@@ -628,6 +654,107 @@ void CoreD3D::UnMap(ID3D11Resource* pResource, UINT Subresource)
 void CoreD3D::CopyResource(ID3D11Resource* pDstResource, ID3D11Resource* pSrcResource)
 {
 	m_pd3dImmediateContext->CopyResource(pDstResource, pSrcResource);
+	filter_counters_.copies++;
+}
+
+void CoreD3D::TakeFilterCounters(FilterChain::Counters& counters)
+{
+	counters = filter_counters_;
+	filter_counters_ = FilterChain::Counters();
+}
+
+void CoreD3D::NextFrame()
+{
+	if (!m_pd3dImmediateContext)
+	{
+		frame_index_++;
+		return;
+	}
+
+	GpuFrame& last = gpu_frames_[frame_index_ % kGpuFrameLatency];
+	if (last.pending)
+		m_pd3dImmediateContext->End(last.disjoint.Get());
+
+	frame_index_++;
+	GpuFrame& frame = gpu_frames_[frame_index_ % kGpuFrameLatency];
+	if (frame.pending)
+		ResolveGpuFrame(frame);
+
+	if (!frame.disjoint)
+	{
+		D3D11_QUERY_DESC desc = { D3D11_QUERY_TIMESTAMP_DISJOINT, 0 };
+		if (FAILED(m_pd3dDevice->CreateQuery(&desc, frame.disjoint.GetAddressOf())))
+			return;
+	}
+	m_pd3dImmediateContext->Begin(frame.disjoint.Get());
+	frame.used = 0;
+	frame.pending = true;
+}
+
+void CoreD3D::ResolveGpuFrame(GpuFrame& frame)
+{
+	// 不 flush，没完成就丢掉这一帧，不能让渲染线程等 GPU
+	D3D11_QUERY_DATA_TIMESTAMP_DISJOINT disjoint = { 0 };
+	if (m_pd3dImmediateContext->GetData(frame.disjoint.Get(), &disjoint, sizeof(disjoint), D3D11_ASYNC_GETDATA_DONOTFLUSH) == S_OK
+		&& !disjoint.Disjoint && disjoint.Frequency)
+	{
+		for (size_t i = 0; i < frame.used; i++)
+		{
+			GpuScope& scope = frame.scopes[i];
+			UINT64 begin = 0, end = 0;
+			if (!scope.ended)
+				continue;
+			if (m_pd3dImmediateContext->GetData(scope.begin.Get(), &begin, sizeof(begin), D3D11_ASYNC_GETDATA_DONOTFLUSH) != S_OK
+				|| m_pd3dImmediateContext->GetData(scope.end.Get(), &end, sizeof(end), D3D11_ASYNC_GETDATA_DONOTFLUSH) != S_OK
+				|| end < begin)
+				continue;
+			scope.item->Record(scope.metric, (uint64_t)((end - begin) * 1000000000.0 / disjoint.Frequency));
+		}
+	}
+	frame.used = 0;
+	frame.pending = false;
+}
+
+int CoreD3D::BeginGpuTiming(Profiler::Item* item, Profiler::Metric metric)
+{
+	if (!item || !m_pd3dImmediateContext)
+		return -1;
+
+	GpuFrame& frame = gpu_frames_[frame_index_ % kGpuFrameLatency];
+	if (!frame.pending || frame.used >= kGpuMaxScopes)
+		return -1;
+
+	// 槽位按需创建，之后各帧复用
+	if (frame.used == frame.scopes.size())
+	{
+		GpuScope scope;
+		D3D11_QUERY_DESC desc = { D3D11_QUERY_TIMESTAMP, 0 };
+		if (FAILED(m_pd3dDevice->CreateQuery(&desc, scope.begin.GetAddressOf()))
+			|| FAILED(m_pd3dDevice->CreateQuery(&desc, scope.end.GetAddressOf())))
+			return -1;
+		frame.scopes.push_back(scope);
+	}
+
+	GpuScope& scope = frame.scopes[frame.used];
+	scope.item = item;
+	scope.metric = metric;
+	scope.ended = false;
+	m_pd3dImmediateContext->End(scope.begin.Get());
+	return (int)frame.used++;
+}
+
+void CoreD3D::EndGpuTiming(int slot)
+{
+	if (slot < 0 || !m_pd3dImmediateContext)
+		return;
+
+	GpuFrame& frame = gpu_frames_[frame_index_ % kGpuFrameLatency];
+	if (!frame.pending || (size_t)slot >= frame.used)
+		return;
+
+	GpuScope& scope = frame.scopes[slot];
+	m_pd3dImmediateContext->End(scope.end.Get());
+	scope.ended = true;
 }
 
 void CoreD3D::OMGetRenderTargets(UINT NumViews, ID3D11RenderTargetView** ppRenderTargetViews, ID3D11DepthStencilView** ppDepthStencilView)
@@ -8,6 +8,9 @@
 #include "core-component-i.h"
 #include "dx-header.h"
 #include "core-d3d-data.h"
+#include "core-filter-chain.h"
+#include "profiler.h"
+#include <vector>
 #include <list>
 
 class CoreD3D : public ICoreComponent
@@ -40,7 +43,7 @@ public:
 	bool ResetMesh(const Geometry::MeshData<VertexPosTex, DWORD>& meshData, UINT& bufferSize);
 	void PSSetShaderResources(int startslots, int numviews, ID3D11ShaderResourceView** view);
 	void DrawIndexed(UINT indexcount, UINT startlocation, UINT baselocation);
-	void Map(ID3D11Resource* pResource, UINT Subresource, D3D11_MAP MapType, UINT MapFlags, D3D11_MAPPED_SUBRESOURCE* pMappedResource);
+	HRESULT Map(ID3D11Resource* pResource, UINT Subresource, D3D11_MAP MapType, UINT MapFlags, D3D11_MAPPED_SUBRESOURCE* pMappedResource);
 	void UnMap(ID3D11Resource* pResource, UINT Subresource);
 	void CopyResource(ID3D11Resource* pDstResource, ID3D11Resource* pSrcResource);
 	void OMGetRenderTargets(UINT NumViews, ID3D11RenderTargetView** ppRenderTargetViews, ID3D11DepthStencilView** ppDepthStencilView);
@@ -49,11 +52,28 @@ public:
 	void ClearDepthStencilView(ID3D11DepthStencilView* pDepthStencilView, UINT ClearFlags, FLOAT Depth, UINT8 Stencil);
 	void OpenAlphaBlend();
 	void CloseAlphaBlend();
+	// 按 factor 和目标混合：src * factor + dst * (1 - factor)，用于场景淡入淡出
+	void OpenFadeBlend(float factor);
+	// 当前渲染目标 (窗口或输出纹理) 开始时的清屏颜色
+	void GetClearColor(float color[4]);
 
 	void PushFrontViewPort(float width, float height);
 	void GetFrontViewPort(D3D11_VIEWPORT* port);
 	void PopFrontViewPort();
 
+	// 帧序号，CoreVideo 每帧开始时加一；滤镜链据此判断本帧是否已经渲染过
+	// 同时结束上一帧的 GPU 计时，并读回 kGpuFrameLatency 帧前的结果
+	void NextFrame();
+	uint64_t GetFrameIndex() { return frame_index_; }
+	void CountFilterPass() { filter_counters_.passes++; }
+	void CountFilterReuse() { filter_counters_.reused++; }
+	// 取出并清零渲染统计，只在渲染线程调用
+	void TakeFilterCounters(FilterChain::Counters& counters);
+	// GPU 耗时，用 timestamp 查询，结果晚几帧才读回，读回时记到 item 上；读不到 (GPU 还没跑完或频率不稳) 的帧丢掉
+	// BeginGpuTiming 返回的槽位交给 EndGpuTiming，本帧槽位用完时返回 -1；只在渲染线程调用
+	int BeginGpuTiming(Profiler::Item* item, Profiler::Metric metric);
+	void EndGpuTiming(int slot);
+
 private:
 	void InitD3D(HWND hwnd);
 	void InitHLSLShaderResource();
@@ -62,6 +82,25 @@ private:
 	void InitDepthStencilState();
 	void InitAlphaBlendState();
 
+	struct GpuScope
+	{
+		ComPtr<ID3D11Query> begin;
+		ComPtr<ID3D11Query> end;
+		Profiler::Item* item = nullptr;
+		Profiler::Metric metric = Profiler::Metric::kRenderGpu;
+		bool ended = false;
+	};
+
+	struct GpuFrame
+	{
+		ComPtr<ID3D11Query> disjoint;
+		std::vector<GpuScope> scopes;
+		size_t used = 0;
+		bool pending = false;
+	};
+
+	void ResolveGpuFrame(GpuFrame& frame);
+
 private:
 	ComPtr<ID3D11Device> m_pd3dDevice;                    
 	ComPtr<ID3D11DeviceContext> m_pd3dImmediateContext;  
@@ -85,6 +124,8 @@ private:
 	ComPtr<ID3D11SamplerState> sampler_state_;
 	ComPtr< ID3D11DepthStencilState> no_depth_stencil_state_;
 	ComPtr< ID3D11BlendState> alpha_blend_state_;
+	ComPtr< ID3D11BlendState> fade_blend_state_;
+	float clear_color_[4] = { 0.0f, 0.0f, 0.0f, 0.0f };
 	UINT index_buffer_size_ = 0;
 
 	ComPtr< ID3D11Texture2D> output_render_texture_;
@@ -97,6 +138,29 @@ private:
 	std::map<CoreD3DData::PixelHlslType, ID3D11PixelShader*> pixel_shader_map_;
 
 	std::list< D3D11_VIEWPORT > viewport_list_;
+
+	uint64_t frame_index_ = 0;
+	FilterChain::Counters filter_counters_;
+
+	static const int kGpuFrameLatency = 4;
+	static const size_t kGpuMaxScopes = 256;
+	GpuFrame gpu_frames_[kGpuFrameLatency];
+};
+
+// 作用域内的 GPU 耗时，d3d 或 item 为空时什么都不做
+class GpuProfileScope
+{
+public:
+	GpuProfileScope(CoreD3D* d3d, Profiler::Item* item, Profiler::Metric metric)
+		: d3d_(d3d), slot_(d3d ? d3d->BeginGpuTiming(item, metric) : -1) {}
+	~GpuProfileScope() { if (d3d_) d3d_->EndGpuTiming(slot_); }
+
+	GpuProfileScope(const GpuProfileScope&) = delete;
+	GpuProfileScope& operator=(const GpuProfileScope&) = delete;
+
+private:
+	CoreD3D* d3d_;
+	int slot_;
 };
 
 #endif
\ No newline at end of file
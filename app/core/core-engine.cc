@@ -7,12 +7,15 @@
 #include "core-audio.h"
 #include "core-d3d.h"
 #include "core-output.h"
+#include "control-server.h"
+#include "profiler.h"
 #include "json.hpp"
 #include "platform.h"
 #include <string>
 #include "fifo_map.hpp"
 #include "gdiplus-text-source.h"
 #include <codecvt>
+#include <filesystem>
 
 template<class K, class V, class dummy_compare, class A>
 using my_workaround_fifo_map = nlohmann::fifo_map<K, V, nlohmann::fifo_map_compare<K>, A>;
@@ -28,11 +31,15 @@ CoreEngine::CoreEngine()
 	core_audio_ = new CoreAudio();
 	core_d3d_ = new CoreD3D();
 	core_output_ = new CoreOutput();
+	control_server_ = new ControlServer();
+	profiler_ = new Profiler();
 	GdiplusTextSource::ModuleLoad();
 }
 
 CoreEngine::~CoreEngine()
 {
+	// 先断开控制连接，之后不会再有命令进场景
+	control_server_->Stop();
 	core_output_->PreEndup();
 	core_video_->PreEndup();
 	core_audio_->PreEndup();
@@ -44,6 +51,7 @@ CoreEngine::~CoreEngine()
 					ptr = nullptr;	\
 				}
 
+	SafeDelete(control_server_);
 	SafeDelete(core_output_);
 	SafeDelete(core_video_);
 	SafeDelete(core_audio_);
@@ -51,6 +59,7 @@ CoreEngine::~CoreEngine()
 	SafeDelete(core_scene_);
 	SafeDelete(core_d3d_);
 	SafeDelete(core_settings_);
+	SafeDelete(profiler_);
 	
 #undef SafeDelete
 
@@ -102,6 +111,12 @@ int CoreEngine::StartUpCoreEngine()
 
 		core_settings_->UpdateGlobalOutput(&(CoreSettingsData::OutputBuilder()
 			.enable(false)
+			.synthetic_audio(false)
+			.synthetic_wave(CoreSettingsData::SyntheticWave::kTone)
+			.synthetic_frequency(1000.0)
+			.synthetic_level(0.25f)
+			.synthetic_seed(0)
+			.shared_memory(false)
 			.path(outputfilename.c_str())
 			.video(&(CoreSettingsData::VideoBuilder()
 				.width(1920)
@@ -119,7 +134,16 @@ int CoreEngine::StartUpCoreEngine()
 		
 		core_d3d_->StartupCoreD3DEnv(core_display_->GetMainHwnd());
 		
-		core_scene_->GenerateSources(GenerateSourcesJson());
+		// 运行目录下有 scene.tsb 时优先用二进制场景，否则用内置的 JSON 场景
+		std::wstring scene_path = std::wstring(os_get_run_dev_wpath()) + L"\\scene.tsb";
+		std::wstring_convert<std::codecvt_utf8<wchar_t>> cv;
+		if (!std::filesystem::exists(scene_path) || !core_scene_->GenerateSourcesBinary(cv.to_bytes(scene_path).c_str()))
+			core_scene_->GenerateSources(GenerateSourcesJson());
+
+		// 端点被占用 (已经有一个实例在运行) 时不影响启动
+		if (!control_server_->Start(ControlServer::DefaultEndpoint(),
+			[this](const std::string& request) { return HandleControlRequest(request); }))
+			LOGGER_ERROR("[Engine] start control server failed:%s", ControlServer::DefaultEndpoint());
 		
 		core_audio_->StartupCoreAudio();
 
@@ -138,6 +162,19 @@ int CoreEngine::StartUpCoreEngine()
 	return -1;
 }
 
+std::string CoreEngine::HandleControlRequest(const std::string& request)
+{
+	nlohmann::json json = nlohmann::json::parse(request, nullptr, false);
+	if (json.is_object() && json.value("op", "") == "profile")
+	{
+		std::string result = profiler_->DumpJson();
+		if (json.value("reset", false))
+			profiler_->Reset();
+		return result;
+	}
+	return core_scene_->ExecuteCommandRequest(request);
+}
+
 const char* CoreEngine::GenerateSourcesJson()
 {
 	std::wstring_convert<std::codecvt_utf8<wchar_t>> cv;
@@ -203,6 +240,21 @@ const char* CoreEngine::GenerateSourcesJson()
 					} },
 				},
 				//{
+				//	{"name", "pattern_1"},
+				//	{"type", std::to_string((int)CoreSceneData::SourceType::kSourceTestPattern)},
+				//	{"param", { {"topX", std::to_string((int)CoreSceneData::AlignType::kAlignLeft)},
+				//					 {"topY", std::to_string((int)CoreSceneData::AlignType::kAlignTop)},
+				//					 {"width", std::to_string((int)CoreSceneData::SizeType::kClientSize)},
+				//					 {"height",std::to_string((int)CoreSceneData::SizeType::kClientSize)},
+				//					 {"pattern", "noise"},
+				//					 {"patternWidth", std::to_string(1920)},
+				//					 {"patternHeight", std::to_string(1080)},
+				//					 {"fps", std::to_string(60)},
+				//					 {"entropy", std::to_string(20)},
+				//					 {"seed", std::to_string(1)},
+				//	} },
+				//},
+				//{
 				//	{"name", "model_1"},
 				//	{"type", std::to_string((int)CoreSceneData::SourceType::kSourceObjModel)},
 				//	{"param", { {"topX", std::to_string((int)CoreSceneData::AlignType::kAlignLeft)},
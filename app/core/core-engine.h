@@ -13,6 +13,8 @@ class CoreVideo;
 class CoreAudio;
 class CoreD3D;
 class CoreOutput;
+class ControlServer;
+class Profiler;
 
 class CoreEngine
 {
@@ -28,9 +30,12 @@ public:
 	CoreVideo* GetVideo() { return core_video_; }
 	CoreAudio* GetAudio() { return core_audio_; }
 	CoreOutput* GetOutput() { return core_output_; }
+	Profiler* GetProfiler() { return profiler_; }
 
 private:
 	const char* GenerateSourcesJson();
+	// {"op":"profile"} (可带 "reset":true) 返回耗时统计，其余交给场景命令队列
+	std::string HandleControlRequest(const std::string& request);
 
 private:
 	CoreDisplay* core_display_ = nullptr;
@@ -40,6 +45,10 @@ private:
 	CoreAudio* core_audio_ = nullptr;
 	CoreD3D* core_d3d_ = nullptr;
 	CoreOutput* core_output_ = nullptr;
+	// 本机控制端点，收到的命令交给 CoreScene 的命令队列
+	ControlServer* control_server_ = nullptr;
+	// 各源/滤镜的 CPU 和 GPU 耗时
+	Profiler* profiler_ = nullptr;
 	HINSTANCE app_instance_ = 0;
 	std::string sources_json_ = "";
 };
@@ -0,0 +1,31 @@
+#ifndef CORE_FILTER_CHAIN_H
+#define CORE_FILTER_CHAIN_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+// 滤镜链的乒乓规划，不依赖 D3D，CoreFilter 和 tiny-bench 共用
+// 第 0 遍把源画到目标 0，第 i 个滤镜读第 i-1 遍的输出、写另一张目标，整条链没有拷贝
+namespace FilterChain
+{
+	const int kTargetCount = 2;
+	const int kNoTarget = -1;
+
+	// 第 pass 遍写入的目标
+	inline int OutputTarget(size_t pass) { return (int)(pass & 1); }
+	// 第 pass 遍读取的目标，第 0 遍画源本身，没有输入
+	inline int InputTarget(size_t pass) { return pass ? OutputTarget(pass - 1) : kNoTarget; }
+	// filter_count 个滤镜时一帧的遍数，最后一遍的输出直接画到外层目标
+	inline size_t PassCount(size_t filter_count) { return filter_count + 1; }
+	inline int FinalTarget(size_t filter_count) { return OutputTarget(filter_count); }
+
+	// 渲染线程统计，CoreVideo 每秒打印一次
+	struct Counters
+	{
+		uint64_t passes = 0;	// 滤镜链渲染的遍数 (含源那一遍)
+		uint64_t copies = 0;	// CopyResource 次数
+		uint64_t reused = 0;	// 同一帧第二次渲染直接复用链结果的次数
+	};
+}
+
+#endif
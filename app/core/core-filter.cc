@@ -6,6 +6,7 @@
 #include "core-d3d.h"
 #include "logger.h"
 #include "base-source-i.h"
+#include <vector>
 
 CoreFilter::CoreFilter()
 {
@@ -43,56 +44,158 @@ void CoreFilter::AppendFilter(std::string name, IBaseFilter* filter)
 	filter_list_.push_back(filter);
 }
 
+bool CoreFilter::LoadFilters()
+{
+	// Load 会读文件、解析 LUT，不能占着渲染线程也要用的锁；滤镜只在析构时删除，各自的状态自己加锁
+	std::vector<IBaseFilter*> filters;
+	{
+		std::unique_lock<std::mutex> lock(filter_mutex_);
+		filters.assign(filter_list_.begin(), filter_list_.end());
+	}
+	bool ret = true;
+	for (const auto& c : filters)
+	{
+		if (!c->Load())
+		{
+			LOGGER_ERROR("[Filter] load filter failed:%s", c->GetFilterName());
+			ret = false;
+		}
+	}
+	return ret;
+}
+
+void CoreFilter::SetFiltersActive(bool active)
+{
+	std::unique_lock<std::mutex> lock(filter_mutex_);
+	for (const auto& c : filter_list_)
+	{
+		if (active)
+			c->OnActivate();
+		else
+			c->OnDeactivate();
+	}
+}
+
+void CoreFilter::SetFiltersShowing(bool showing)
+{
+	std::unique_lock<std::mutex> lock(filter_mutex_);
+	for (const auto& c : filter_list_)
+	{
+		if (showing)
+			c->OnShow();
+		else
+			c->OnHide();
+	}
+}
+
 void CoreFilter::RenderSourcesOnly(IBaseSource* source)
 {
+	Profiler::Item* item = source->GetProfileItem();
+	ProfileScope scope(item, Profiler::Metric::kRender);
+	GpuProfileScope gpu_scope(core_engine_->GetD3D(), item, Profiler::Metric::kRenderGpu);
 	source->Render();
 }
 
+void CoreFilter::UpdateProfileItems(IBaseSource* source)
+{
+	Profiler* profiler = core_engine_->GetProfiler();
+	if (!profiler)
+		return;
+
+	bool renamed = profile_source_ != source->GetSourceName();
+	profile_source_ = source->GetSourceName();
+	for (const auto& c : filter_list_)
+	{
+		if (renamed || !c->GetProfileItem())
+			c->SetProfileItem(profiler->GetItem(profile_source_ + "/" + c->GetFilterName()));
+	}
+}
+
 void CoreFilter::RenderSourcesWidthFilters(IBaseSource* source)
 {
 	CoreD3D* d3d = core_engine_->GetD3D();
 
 	size_t sourceWidth = (size_t)source->GetSourceRect()->width;
 	size_t sourceHeight = (size_t)source->GetSourceRect()->height;
+
+	ResetFilterResource(sourceWidth, sourceHeight);
+
+	// 输出和预览在同一帧各调一次，滤镜只跑一遍，第二次直接画上次的结果
+	uint64_t frame = d3d->GetFrameIndex();
+	if (final_target_ == FilterChain::kNoTarget || rendered_frame_ != frame)
+	{
+		RenderFilterChain(source, sourceWidth, sourceHeight);
+		rendered_frame_ = frame;
+	}
+	else
+	{
+		d3d->CountFilterReuse();
+	}
+
+	d3d->UpdateVertexShader(CoreD3DData::VertexHlslType::kBasic2D);
+	d3d->UpdatePixelShader(CoreD3DData::PixelHlslType::kBasic2D);
+
+	float cenx = 0, ceny = 0, scalex = 0, scaley = 0;
+	source->GetRenderSize(cenx, ceny, scalex, scaley);
+	UINT buffersize = 0;
+	auto meshData = Geometry::Create2DShow(cenx, ceny, scalex, scaley);
+	d3d->ResetMesh(meshData, buffersize);
+	d3d->PSSetShaderResources(0, 1, chain_targets_[final_target_].resource_view.GetAddressOf());
+	d3d->DrawIndexed(buffersize, 0, 0);
+}
+
+void CoreFilter::RenderFilterChain(IBaseSource* source, size_t sourceWidth, size_t sourceHeight)
+{
+	CoreD3D* d3d = core_engine_->GetD3D();
+
 	ComPtr<ID3D11RenderTargetView> View;
 	ComPtr<ID3D11DepthStencilView> Depth;
-	UINT viewnum = 0;
-	uint8_t* copy_ptr = nullptr;
+	ID3D11ShaderResourceView* nullView = nullptr;
 	static float color[4] = { 0.0f, 0.0f, 0.0f, 0.0f };
 
-	ResetFilterResource(sourceWidth, sourceHeight);
 	d3d->OMGetRenderTargets(1, View.GetAddressOf(), Depth.GetAddressOf());
-	d3d->ClearRenderTargetView(filter_target_view_.Get(), color);
-	d3d->ClearDepthStencilView(filter_depth_stencil_view_.Get(), D3D11_CLEAR_DEPTH | D3D11_CLEAR_STENCIL, 1.0f, 0);
-	d3d->OMSetRenderTargets(1, filter_target_view_.GetAddressOf(), filter_depth_stencil_view_.Get());
-
 	d3d->PushFrontViewPort((float)sourceWidth, (float)sourceHeight);
 
-	source->Render();
+	// 第 0 遍：源画到目标 0
+	size_t pass = 0;
+	ChainTarget& first = chain_targets_[FilterChain::OutputTarget(pass)];
+	d3d->PSSetShaderResources(0, 1, &nullView);
+	d3d->ClearRenderTargetView(first.target_view.Get(), color);
+	d3d->ClearDepthStencilView(filter_depth_stencil_view_.Get(), D3D11_CLEAR_DEPTH | D3D11_CLEAR_STENCIL, 1.0f, 0);
+	d3d->OMSetRenderTargets(1, first.target_view.GetAddressOf(), filter_depth_stencil_view_.Get());
+	{
+		Profiler::Item* item = source->GetProfileItem();
+		ProfileScope scope(item, Profiler::Metric::kRender);
+		GpuProfileScope gpu_scope(d3d, item, Profiler::Metric::kRenderGpu);
+		source->Render();
+	}
+	d3d->CountFilterPass();
 
 	{
 		std::unique_lock<std::mutex> lock(filter_mutex_);
+		UpdateProfileItems(source);
 		for (const auto& c : filter_list_)
 		{
-			c->SetInputTexture(filter_render_texture_.Get(), sourceWidth, sourceHeight, copy_ptr);
-			c->CopyOutputTexture(filter_render_texture_.Get());
+			pass += 1;
+			ChainTarget& input = chain_targets_[FilterChain::InputTarget(pass)];
+			ChainTarget& output = chain_targets_[FilterChain::OutputTarget(pass)];
+
+			// 输出目标上一遍还作为 SRV 绑着，先解绑再当 RTV 用
+			d3d->PSSetShaderResources(0, 1, &nullView);
+			d3d->OMSetRenderTargets(1, output.target_view.GetAddressOf(), nullptr);
+			{
+				ProfileScope scope(c->GetProfileItem(), Profiler::Metric::kRender);
+				GpuProfileScope gpu_scope(d3d, c->GetProfileItem(), Profiler::Metric::kRenderGpu);
+				c->RenderFilter(input.resource_view.Get(), output.target_view.Get(), filter_depth_stencil_view_.Get(), sourceWidth, sourceHeight);
+			}
+			d3d->CountFilterPass();
 		}
 	}
 
+	d3d->PSSetShaderResources(0, 1, &nullView);
 	d3d->PopFrontViewPort();
-
-	d3d->CopyResource(filer_final_render_texture_.Get(), filter_render_texture_.Get());
 	d3d->OMSetRenderTargets(1, View.GetAddressOf(), Depth.Get());
-	d3d->UpdateVertexShader(CoreD3DData::VertexHlslType::kBasic2D);
-	d3d->UpdatePixelShader(CoreD3DData::PixelHlslType::kBasic2D);
-
-	float cenx = 0, ceny = 0, scalex = 0, scaley = 0;
-	source->GetRenderSize(cenx, ceny, scalex, scaley);
-	UINT buffersize = 0;
-	auto meshData = Geometry::Create2DShow(cenx, ceny, scalex, scaley);
-	d3d->ResetMesh(meshData, buffersize);
-	d3d->PSSetShaderResources(0, 1, filter_final_render_view_.GetAddressOf());
-	d3d->DrawIndexed(buffersize, 0, 0);
+	final_target_ = FilterChain::OutputTarget(pass);
 }
 
 void CoreFilter::TextureFilters(IBaseSource* source)
@@ -136,25 +239,30 @@ void CoreFilter::ResetFilterResource(size_t sourceWidth, size_t sourceHeight)
 
 	if (reset)
 	{
-		filter_render_texture_.Reset();
-		filter_target_view_.Reset();
+		for (auto& c : chain_targets_)
+		{
+			c.texture.Reset();
+			c.target_view.Reset();
+			c.resource_view.Reset();
+		}
 		filter_depth_stencil_buffer_.Reset();
 		filter_depth_stencil_view_.Reset();
+		final_target_ = FilterChain::kNoTarget;
 
 		texture_width_ = sourceWidth;
 		texture_height_ = sourceHeight;
 
-		if (!d3d->CreateD3DTexture(filter_render_texture_.GetAddressOf(), true, false, sourceWidth, sourceHeight, false))
-			EXCEPTION_TEXT("filter render texture failed!");
-
-		if (!d3d->CreateRenderTargetView(filter_render_texture_.Get(), filter_target_view_.GetAddressOf()))
-			EXCEPTION_TEXT("filter render target view failed!");
+		for (auto& c : chain_targets_)
+		{
+			if (!d3d->CreateD3DTexture(c.texture.GetAddressOf(), true, false, sourceWidth, sourceHeight, false))
+				EXCEPTION_TEXT("filter render texture failed!");
 
-		if (!d3d->CreateD3DTexture(filer_final_render_texture_.GetAddressOf(), false, false, sourceWidth, sourceHeight, false))
-			EXCEPTION_TEXT("filter copy texture failed!");
+			if (!d3d->CreateRenderTargetView(c.texture.Get(), c.target_view.GetAddressOf()))
+				EXCEPTION_TEXT("filter render target view failed!");
 
-		if(!d3d->CreateShaderResourceView(filer_final_render_texture_.Get(), filter_final_render_view_.GetAddressOf()))
-			EXCEPTION_TEXT("filter copy view failed!");
+			if (!d3d->CreateShaderResourceView(c.texture.Get(), c.resource_view.GetAddressOf()))
+				EXCEPTION_TEXT("filter resource view failed!");
+		}
 
 		if (!d3d->CreateDepthStencilBuffer(filter_depth_stencil_buffer_.GetAddressOf(), sourceWidth, sourceHeight))
 			EXCEPTION_TEXT("filter depth stencil buffer failed!");
@@ -5,6 +5,7 @@
 #include <map>
 #include <string>
 #include <base-filter-i.h>
+#include "core-filter-chain.h"
 #include <mutex>
 #include <list>
 #include <functional>
@@ -23,24 +24,39 @@ public:
 	IBaseFilter* GetNamedFilter(std::string name);
 	void TextureFilters(IBaseSource* source);
 	size_t GetFiltersSize();
+	bool LoadFilters();
+	void SetFiltersActive(bool active);
+	void SetFiltersShowing(bool showing);
 
 private:
 	void ResetFilterResource(size_t sourceWidth, size_t sourceHeight);
 	void RenderSourcesWidthFilters(IBaseSource* source);
+	void RenderFilterChain(IBaseSource* source, size_t sourceWidth, size_t sourceHeight);
 	void RenderSourcesOnly(IBaseSource* source);
+	// 源改名后滤镜的统计条目跟着换
+	void UpdateProfileItems(IBaseSource* source);
 
 private:
+	// 滤镜链乒乓用的渲染目标，既当 RTV 写也当 SRV 读
+	struct ChainTarget
+	{
+		ComPtr< ID3D11Texture2D> texture;
+		ComPtr< ID3D11RenderTargetView> target_view;
+		ComPtr< ID3D11ShaderResourceView> resource_view;
+	};
+
 	std::mutex filter_mutex_;
 	std::list<IBaseFilter*> filter_list_;
 
-	ComPtr< ID3D11Texture2D> filter_render_texture_;
-	ComPtr< ID3D11RenderTargetView> filter_target_view_;
-	ComPtr< ID3D11Texture2D> filer_final_render_texture_;
-	ComPtr< ID3D11ShaderResourceView> filter_final_render_view_;
+	ChainTarget chain_targets_[FilterChain::kTargetCount];
 	ComPtr<ID3D11Texture2D> filter_depth_stencil_buffer_;
 	ComPtr<ID3D11DepthStencilView> filter_depth_stencil_view_;
 	int texture_width_ = 0;
 	int texture_height_ = 0;
+	// 最后一遍输出所在的目标；输出和预览在同一帧各画一次，第二次直接用它
+	int final_target_ = FilterChain::kNoTarget;
+	uint64_t rendered_frame_ = 0;
+	std::string profile_source_ = "";
 };
 
 #endif
\ No newline at end of file
@@ -77,6 +77,8 @@ void CoreOutput::PreEndup()
 	}
 	video->UnRegisterVideoDataCallback(this);
 	audio->UnRegisterCoreAudioDataCallback(this);
+	if (shm_publisher_)
+		shm_publisher_->Stop();
 	if (init_thread_.joinable())
 		init_thread_.join();
 	video_raw_data_cond_.notify_one();
@@ -96,6 +98,13 @@ void CoreOutput::StartupCoreOutput()
 	if (!settings->GetOutputParam()->enable)
 		return;
 	final_exit_.store(false);
+	if (settings->GetOutputParam()->shared_memory)
+	{
+		shm_publisher_.reset(new ShmFramePublisher());
+		shm_publisher_->SetCoreEnv(core_engine_);
+		if (!shm_publisher_->Start(SHM_FRAME_RING_DEFAULT_NAME, true))
+			shm_publisher_.reset();
+	}
 	init_thread_ = std::thread(&CoreOutput::InitImpl, this);
 }
 
@@ -167,6 +176,7 @@ void CoreOutput::VideoImpl()
 				CoreVideoData::RawData temp = video_raw_data_list_.front();
 				memcpy(&rawData, &temp, sizeof(CoreVideoData::RawData));
 				video_raw_data_list_.pop_front();
+				video_queue_depth_.store(video_raw_data_list_.size());
 				popraw = true;
 			}
 		}
@@ -392,6 +402,7 @@ void CoreOutput::VideoRawDataReceived(const CoreVideoData::RawData* data)
 	memset(rawData.bgra_data, 0, data->linesize);
 	memcpy(rawData.bgra_data, data->bgra_data, data->linesize);
 	video_raw_data_list_.push_back(rawData);
+	video_queue_depth_.store(video_raw_data_list_.size());
 	video_raw_data_cond_.notify_one();
 }
 
@@ -6,6 +6,7 @@
 #include "core-audio-data.h"
 #include "base-encoder-i.h"
 #include "base-output-i.h"
+#include "shm-frame-publisher.h"
 #include <thread>
 #include <mutex>
 #include <condition_variable>
@@ -22,6 +23,8 @@ public:
 
 	void PreEndup();
 	void StartupCoreOutput();
+	// 等待编码的视频帧数，编码跟不上时会一直涨
+	size_t GetVideoQueueDepth() { return video_queue_depth_.load(); }
 
 private:
 	void InitImpl();
@@ -43,6 +46,7 @@ private:
 	std::mutex video_raw_data_mutex_;
 	std::list<CoreVideoData::RawData> video_raw_data_list_;
 	std::condition_variable video_raw_data_cond_;
+	std::atomic<size_t> video_queue_depth_{ 0 };
 
 	std::mutex audio_raw_data_mutex_;
 	std::list<CoreAudioData::AudioMixerOutput> audio_raw_data_list_;
@@ -64,6 +68,7 @@ private:
 	std::shared_ptr<IBaseEncoder> video_encoder_;
 	std::shared_ptr<IBaseEncoder> audio_encoder_;
 	std::shared_ptr<IBaseOutput> output_instance_;
+	std::unique_ptr<ShmFramePublisher> shm_publisher_;
 
 	uint64_t output_start_time_ = 0;
 };
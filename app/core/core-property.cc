@@ -0,0 +1,269 @@
+#include "core-property.h"
+#include <string.h>
+#include <unordered_map>
+
+namespace CoreProperty
+{
+	namespace
+	{
+		const uint8_t kNoEntry = 0xFF;
+
+		// seed 之类的值可能超过 int64 的正数范围，按位保存
+		int64_t ParseInt(const std::string& text)
+		{
+			if (!text.empty() && text[0] == '-')
+				return (int64_t)std::stoll(text);
+			return (int64_t)std::stoull(text);
+		}
+
+		const PropertyInfo kPropertyTable[] = {
+			{ PropertyId::kTopX, "topX", ValueType::kInt },
+			{ PropertyId::kTopY, "topY", ValueType::kInt },
+			{ PropertyId::kWidth, "width", ValueType::kInt },
+			{ PropertyId::kHeight, "height", ValueType::kInt },
+			{ PropertyId::kPath, "path", ValueType::kString },
+			{ PropertyId::kText, "text", ValueType::kString },
+			{ PropertyId::kPattern, "pattern", ValueType::kString },
+			{ PropertyId::kPatternWidth, "patternWidth", ValueType::kInt },
+			{ PropertyId::kPatternHeight, "patternHeight", ValueType::kInt },
+			{ PropertyId::kFps, "fps", ValueType::kInt },
+			{ PropertyId::kEntropy, "entropy", ValueType::kInt },
+			{ PropertyId::kSeed, "seed", ValueType::kInt },
+			{ PropertyId::kInterpolation, "interpolation", ValueType::kString },
+			{ PropertyId::kMode, "mode", ValueType::kString },
+			{ PropertyId::kRadius, "radius", ValueType::kInt },
+			{ PropertyId::kMinFps, "minFps", ValueType::kInt },
+			{ PropertyId::kMaxFps, "maxFps", ValueType::kInt },
+			{ PropertyId::kTiled, "tiled", ValueType::kInt },
+		};
+
+		static_assert(sizeof(kPropertyTable) / sizeof(kPropertyTable[0]) == (size_t)PropertyId::kCount,
+			"kPropertyTable must cover every PropertyId");
+		static_assert((size_t)PropertyId::kCount < kNoEntry, "PropertyId index overflow");
+	}
+
+	const PropertyInfo* GetPropertyInfo(PropertyId id)
+	{
+		if ((size_t)id >= (size_t)PropertyId::kCount)
+			return nullptr;
+		return &kPropertyTable[(size_t)id];
+	}
+
+	PropertyId FindPropertyId(const std::string& name)
+	{
+		static const std::unordered_map<std::string, PropertyId> name_map = []() {
+			std::unordered_map<std::string, PropertyId> map;
+			for (const auto& c : kPropertyTable)
+				map[c.name] = c.id;
+			return map;
+		}();
+
+		auto it = name_map.find(name);
+		if (it == name_map.end())
+			return PropertyId::kUnknown;
+		return it->second;
+	}
+
+	PropertyBag::PropertyBag()
+		: index_((size_t)PropertyId::kCount, kNoEntry)
+	{
+
+	}
+
+	void PropertyBag::Clear()
+	{
+		for (const auto& c : entries_)
+			index_[(size_t)c.id] = kNoEntry;
+		entries_.clear();
+		strings_.clear();
+	}
+
+	PropertyBag::Entry* PropertyBag::FindEntry(PropertyId id)
+	{
+		if ((size_t)id >= index_.size() || index_[(size_t)id] == kNoEntry)
+			return nullptr;
+		return &entries_[index_[(size_t)id]];
+	}
+
+	const PropertyBag::Entry* PropertyBag::FindEntry(PropertyId id) const
+	{
+		if ((size_t)id >= index_.size() || index_[(size_t)id] == kNoEntry)
+			return nullptr;
+		return &entries_[index_[(size_t)id]];
+	}
+
+	PropertyBag::Entry& PropertyBag::AddEntry(PropertyId id, ValueType type)
+	{
+		Entry* entry = FindEntry(id);
+		if (!entry)
+		{
+			index_[(size_t)id] = (uint8_t)entries_.size();
+			entries_.push_back(Entry());
+			entry = &entries_.back();
+			memset(entry, 0, sizeof(Entry));
+			entry->id = id;
+		}
+		entry->type = type;
+		return *entry;
+	}
+
+	void PropertyBag::SetInt(PropertyId id, int64_t value)
+	{
+		if ((size_t)id >= index_.size())
+			return;
+		Entry& entry = AddEntry(id, ValueType::kInt);
+		entry.int_value = value;
+		entry.double_value = (double)value;
+	}
+
+	void PropertyBag::SetDouble(PropertyId id, double value)
+	{
+		if ((size_t)id >= index_.size())
+			return;
+		Entry& entry = AddEntry(id, ValueType::kDouble);
+		entry.double_value = value;
+		entry.int_value = (int64_t)value;
+	}
+
+	void PropertyBag::SetString(PropertyId id, const char* value, size_t length)
+	{
+		if ((size_t)id >= index_.size())
+			return;
+		Entry& entry = AddEntry(id, ValueType::kString);
+		// 原来的空间放得下就原地覆盖，否则追加到末尾
+		if (length + 1 > entry.capacity)
+		{
+			entry.offset = (uint32_t)strings_.size();
+			entry.capacity = (uint32_t)length + 1;
+			strings_.resize(strings_.size() + length + 1);
+		}
+		if (length)
+			memcpy(&strings_[entry.offset], value, length);
+		strings_[entry.offset + length] = '\0';
+		entry.length = (uint32_t)length;
+	}
+
+	bool PropertyBag::Has(PropertyId id) const
+	{
+		return FindEntry(id) != nullptr;
+	}
+
+	bool PropertyBag::GetInt(PropertyId id, int64_t& value) const
+	{
+		const Entry* entry = FindEntry(id);
+		if (!entry || entry->type == ValueType::kString)
+			return false;
+		value = entry->int_value;
+		return true;
+	}
+
+	bool PropertyBag::GetInt(PropertyId id, int32_t& value) const
+	{
+		int64_t v = 0;
+		if (!GetInt(id, v))
+			return false;
+		value = (int32_t)v;
+		return true;
+	}
+
+	bool PropertyBag::GetDouble(PropertyId id, double& value) const
+	{
+		const Entry* entry = FindEntry(id);
+		if (!entry || entry->type == ValueType::kString)
+			return false;
+		value = entry->double_value;
+		return true;
+	}
+
+	bool PropertyBag::GetString(PropertyId id, std::string& value) const
+	{
+		const char* str = GetString(id);
+		if (!str)
+			return false;
+		value.assign(str, FindEntry(id)->length);
+		return true;
+	}
+
+	const char* PropertyBag::GetString(PropertyId id) const
+	{
+		const Entry* entry = FindEntry(id);
+		if (!entry || entry->type != ValueType::kString)
+			return nullptr;
+		return &strings_[entry->offset];
+	}
+
+	bool PropertyBag::FromJson(const nlohmann::json& json)
+	{
+		if (!json.is_object())
+			return false;
+
+		try
+		{
+			for (auto it = json.begin(); it != json.end(); ++it)
+			{
+				const PropertyInfo* info = GetPropertyInfo(FindPropertyId(it.key()));
+				if (!info)
+					continue;
+
+				const auto& value = it.value();
+				switch (info->type)
+				{
+				case ValueType::kInt:
+				{
+					if (value.is_string())
+						SetInt(info->id, ParseInt(value.get<std::string>()));
+					else if (value.is_number_unsigned())
+						SetInt(info->id, (int64_t)value.get<uint64_t>());
+					else if (value.is_number())
+						SetInt(info->id, value.get<int64_t>());
+				}
+				break;
+				case ValueType::kDouble:
+				{
+					if (value.is_string())
+						SetDouble(info->id, std::stod(value.get<std::string>()));
+					else if (value.is_number())
+						SetDouble(info->id, value.get<double>());
+				}
+				break;
+				case ValueType::kString:
+				{
+					if (value.is_string())
+						SetString(info->id, value.get<std::string>());
+					else
+						SetString(info->id, value.dump());
+				}
+				break;
+				}
+			}
+			return true;
+		}
+		catch (...)
+		{
+
+		}
+		return false;
+	}
+
+	nlohmann::json PropertyBag::ToJson() const
+	{
+		nlohmann::json json = nlohmann::json::object();
+		for (const auto& c : entries_)
+		{
+			const char* name = GetPropertyInfo(c.id)->name;
+			switch (c.type)
+			{
+			case ValueType::kInt:
+				json[name] = std::to_string(c.int_value);
+				break;
+			case ValueType::kDouble:
+				json[name] = std::to_string(c.double_value);
+				break;
+			case ValueType::kString:
+				json[name] = std::string(&strings_[c.offset], c.length);
+				break;
+			}
+		}
+		return json;
+	}
+}
@@ -0,0 +1,114 @@
+#ifndef CORE_PROPERTY_H
+#define CORE_PROPERTY_H
+
+/* 源和滤镜的类型化属性包
+* 属性名预先映射成 PropertyId，运行时更新直接按 id 取值，不再序列化/解析 JSON
+* JSON 只作为场景的持久化格式，加载时通过 FromJson 转换一次
+*/
+
+#include <stdint.h>
+#include <string>
+#include <vector>
+#include "json.hpp"
+
+namespace CoreProperty
+{
+	enum class PropertyId : uint16_t
+	{
+		kTopX,
+		kTopY,
+		kWidth,
+		kHeight,
+		kPath,
+		kText,
+		kPattern,
+		kPatternWidth,
+		kPatternHeight,
+		kFps,
+		kEntropy,
+		kSeed,
+		kInterpolation,
+		kMode,
+		kRadius,
+		kMinFps,
+		kMaxFps,
+		kTiled,
+		kCount,
+		kUnknown = 0xFFFF,
+	};
+
+	enum class ValueType : uint8_t
+	{
+		kInt,
+		kDouble,
+		kString,
+	};
+
+	struct PropertyInfo
+	{
+		PropertyId id;
+		const char* name;
+		ValueType type;
+	};
+
+	// id 越界时返回 nullptr
+	const PropertyInfo* GetPropertyInfo(PropertyId id);
+	// 未知名字返回 kUnknown
+	PropertyId FindPropertyId(const std::string& name);
+
+	class PropertyBag
+	{
+	public:
+		PropertyBag();
+
+		// 只清空条目，保留已分配的内存，可以在每帧复用同一个对象
+		void Clear();
+		bool Empty() const { return entries_.empty(); }
+		size_t Size() const { return entries_.size(); }
+		PropertyId GetId(size_t index) const { return entries_[index].id; }
+
+		void SetInt(PropertyId id, int64_t value);
+		void SetDouble(PropertyId id, double value);
+		void SetString(PropertyId id, const char* value, size_t length);
+		void SetString(PropertyId id, const std::string& value) { SetString(id, value.c_str(), value.length()); }
+
+		bool Has(PropertyId id) const;
+		// 数值类型之间互相转换，字符串不做转换
+		bool GetInt(PropertyId id, int64_t& value) const;
+		bool GetInt(PropertyId id, int32_t& value) const;
+		bool GetDouble(PropertyId id, double& value) const;
+		bool GetString(PropertyId id, std::string& value) const;
+		// 返回的指针在下一次修改前有效，不存在或不是字符串时返回 nullptr
+		const char* GetString(PropertyId id) const;
+
+		// 按 PropertyInfo 里的类型转换，场景 JSON 里的数值都是字符串；未知属性忽略
+		bool FromJson(const nlohmann::json& json);
+		// 输出成场景 JSON 的格式 (值统一为字符串)
+		nlohmann::json ToJson() const;
+
+	private:
+		struct Entry
+		{
+			PropertyId id;
+			ValueType type;
+			uint32_t offset;
+			uint32_t length;
+			uint32_t capacity;
+			int64_t int_value;
+			double double_value;
+		};
+
+		Entry* FindEntry(PropertyId id);
+		const Entry* FindEntry(PropertyId id) const;
+		Entry& AddEntry(PropertyId id, ValueType type);
+
+	private:
+		std::vector<Entry> entries_;
+		// 每个 id 在 entries_ 里的位置，kNoEntry 表示不存在
+		std::vector<uint8_t> index_;
+		// 字符串值连续存放，以 '\0' 结尾
+		std::vector<char> strings_;
+	};
+}
+
+#endif
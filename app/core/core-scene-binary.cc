@@ -0,0 +1,550 @@
+#include "core-scene-binary.h"
+#include <string.h>
+#include <stdlib.h>
+#include <unordered_map>
+
+#if defined(_WIN32)
+#include <Windows.h>
+#else
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#endif
+
+namespace SceneBinary
+{
+	namespace
+	{
+		const uint8_t kPropertyUnsigned = 1 << 1;
+
+		inline double BitsToDouble(int64_t bits)
+		{
+			double value;
+			memcpy(&value, &bits, sizeof(value));
+			return value;
+		}
+
+		inline int64_t DoubleToBits(double value)
+		{
+			int64_t bits;
+			memcpy(&bits, &value, sizeof(bits));
+			return bits;
+		}
+
+		// 和 PropertyBag::FromJson 一致：负数按 int64 解析，其余按 uint64 保存位模式
+		bool ParseIntText(const char* text, int64_t& value)
+		{
+			char* end = nullptr;
+			if (text[0] == '-')
+				value = (int64_t)strtoll(text, &end, 10);
+			else
+				value = (int64_t)strtoull(text, &end, 10);
+			return end != text;
+		}
+
+		class Writer
+		{
+		public:
+			Writer()
+			{
+				// 偏移 0 留给空串，字符串池始终非空
+				strings_.push_back('\0');
+			}
+
+			bool AddScene(const nlohmann::json& scene)
+			{
+				if (!scene.is_object())
+					return Fail("scene is not an object");
+				for (auto it = scene.begin(); it != scene.end(); ++it)
+				{
+					if (it.key() != "sources")
+						return Fail("unsupported scene key:" + it.key());
+				}
+				auto sources = scene.find("sources");
+				if (sources == scene.end() || !sources->is_array())
+					return Fail("missing sources array");
+
+				// 先把源记录占好位置，保证源在文件里连续
+				sources_.resize(sources->size());
+				for (size_t i = 0; i < sources->size(); i++)
+				{
+					if (!AddItem((*sources)[i], true, sources_[i]))
+						return false;
+				}
+				return true;
+			}
+
+			void Write(std::vector<uint8_t>& out)
+			{
+				FileHeader header;
+				memset(&header, 0, sizeof(header));
+				header.magic = kMagic;
+				header.version = kVersion;
+				header.header_size = sizeof(FileHeader);
+				header.source_count = (uint32_t)sources_.size();
+				header.source_offset = sizeof(FileHeader);
+				header.filter_count = (uint32_t)filters_.size();
+				header.filter_offset = header.source_offset + header.source_count * sizeof(ItemRecord);
+				header.property_count = (uint32_t)properties_.size();
+				header.property_offset = header.filter_offset + header.filter_count * sizeof(ItemRecord);
+				header.string_size = (uint32_t)strings_.size();
+				header.string_offset = header.property_offset + header.property_count * sizeof(PropertyRecord);
+				header.file_size = header.string_offset + header.string_size;
+
+				out.resize(header.file_size);
+				memcpy(out.data(), &header, sizeof(header));
+				if (!sources_.empty())
+					memcpy(out.data() + header.source_offset, sources_.data(), sources_.size() * sizeof(ItemRecord));
+				if (!filters_.empty())
+					memcpy(out.data() + header.filter_offset, filters_.data(), filters_.size() * sizeof(ItemRecord));
+				if (!properties_.empty())
+					memcpy(out.data() + header.property_offset, properties_.data(), properties_.size() * sizeof(PropertyRecord));
+				memcpy(out.data() + header.string_offset, strings_.data(), strings_.size());
+			}
+
+			const std::string& GetError() const { return error_; }
+
+		private:
+			bool Fail(const std::string& error)
+			{
+				error_ = error;
+				return false;
+			}
+
+			uint32_t AddString(const std::string& str, uint32_t& length)
+			{
+				length = (uint32_t)str.length();
+				auto it = string_map_.find(str);
+				if (it != string_map_.end())
+					return it->second;
+				uint32_t offset = (uint32_t)strings_.size();
+				strings_.append(str);
+				strings_.push_back('\0');
+				string_map_[str] = offset;
+				return offset;
+			}
+
+			bool AddItem(const nlohmann::json& item, bool is_source, ItemRecord& record)
+			{
+				memset(&record, 0, sizeof(record));
+				if (!item.is_object())
+					return Fail("item is not an object");
+
+				for (auto it = item.begin(); it != item.end(); ++it)
+				{
+					const std::string& key = it.key();
+					if (key != "name" && key != "type" && key != "param" && !(is_source && key == "filters"))
+						return Fail("unsupported item key:" + key);
+				}
+
+				auto name = item.find("name");
+				auto type = item.find("type");
+				if (name == item.end() || !name->is_string() || type == item.end() || !type->is_string())
+					return Fail("item without string name/type");
+
+				const std::string& type_text = type->get_ref<const std::string&>();
+				int64_t type_value = 0;
+				if (!ParseIntText(type_text.c_str(), type_value) || std::to_string((int32_t)type_value) != type_text)
+					return Fail("invalid item type:" + type_text);
+
+				record.name_offset = AddString(name->get_ref<const std::string&>(), record.name_length);
+				record.type = (int32_t)type_value;
+
+				auto param = item.find("param");
+				if (param != item.end())
+				{
+					if (!param->is_object())
+						return Fail("param is not an object");
+					record.flags |= kItemHasParam;
+					record.property_begin = (uint32_t)properties_.size();
+					for (auto it = param->begin(); it != param->end(); ++it)
+						AddProperty(it.key(), it.value());
+					record.property_count = (uint32_t)properties_.size() - record.property_begin;
+				}
+
+				auto filters = item.find("filters");
+				if (filters != item.end())
+				{
+					if (!filters->is_array())
+						return Fail("filters is not an array");
+					record.flags |= kItemHasFilters;
+					record.filter_begin = (uint32_t)filters_.size();
+					record.filter_count = (uint32_t)filters->size();
+					filters_.resize(filters_.size() + filters->size());
+					for (size_t i = 0; i < filters->size(); i++)
+					{
+						ItemRecord filter;
+						if (!AddItem((*filters)[i], false, filter))
+							return false;
+						filters_[record.filter_begin + i] = filter;
+					}
+				}
+				return true;
+			}
+
+			void AddProperty(const std::string& key, const nlohmann::json& value)
+			{
+				PropertyRecord record;
+				memset(&record, 0, sizeof(record));
+
+				const CoreProperty::PropertyInfo* info = CoreProperty::GetPropertyInfo(CoreProperty::FindPropertyId(key));
+				if (info)
+				{
+					record.id = (uint16_t)info->id;
+				}
+				else
+				{
+					record.id = (uint16_t)CoreProperty::PropertyId::kUnknown;
+					uint32_t key_length = 0;
+					record.key_offset = AddString(key, key_length);
+				}
+
+				const CoreProperty::ValueType type = info ? info->type : CoreProperty::ValueType::kString;
+				if (type == CoreProperty::ValueType::kInt && value.is_string())
+				{
+					// 只有规范写法的整数才存成数值，"+4"、"04" 之类按字符串保存，读出时再转换
+					const std::string& text = value.get_ref<const std::string&>();
+					int64_t v = 0;
+					bool negative = !text.empty() && text[0] == '-';
+					if (!text.empty() && ParseIntText(text.c_str(), v)
+						&& (negative ? std::to_string(v) : std::to_string((uint64_t)v)) == text)
+					{
+						record.kind = (uint8_t)ValueKind::kInt;
+						record.value = v;
+						if (!negative && v < 0)
+							record.flags |= kPropertyUnsigned;
+					}
+					else
+					{
+						record.kind = (uint8_t)ValueKind::kString;
+						record.string.offset = AddString(text, record.string.length);
+					}
+				}
+				else if (type == CoreProperty::ValueType::kInt && value.is_number_integer())
+				{
+					record.kind = (uint8_t)ValueKind::kInt;
+					record.flags |= kPropertyJsonNumber;
+					if (value.is_number_unsigned())
+					{
+						record.value = (int64_t)value.get<uint64_t>();
+						record.flags |= kPropertyUnsigned;
+					}
+					else
+					{
+						record.value = value.get<int64_t>();
+					}
+				}
+				else if (type == CoreProperty::ValueType::kDouble && value.is_number_float())
+				{
+					record.kind = (uint8_t)ValueKind::kDouble;
+					record.flags |= kPropertyJsonNumber;
+					record.value = DoubleToBits(value.get<double>());
+				}
+				else if (value.is_string())
+				{
+					record.kind = (uint8_t)ValueKind::kString;
+					record.string.offset = AddString(value.get_ref<const std::string&>(), record.string.length);
+				}
+				else
+				{
+					record.kind = (uint8_t)ValueKind::kRawJson;
+					record.string.offset = AddString(value.dump(), record.string.length);
+				}
+				properties_.push_back(record);
+			}
+
+		private:
+			std::vector<ItemRecord> sources_;
+			std::vector<ItemRecord> filters_;
+			std::vector<PropertyRecord> properties_;
+			std::string strings_;
+			std::unordered_map<std::string, uint32_t> string_map_;
+			std::string error_;
+		};
+
+		nlohmann::json PropertyToJson(const SceneView& view, const PropertyRecord& record)
+		{
+			switch ((ValueKind)record.kind)
+			{
+			case ValueKind::kInt:
+			{
+				const bool is_unsigned = (record.flags & kPropertyUnsigned) != 0;
+				if (record.flags & kPropertyJsonNumber)
+				{
+					if (is_unsigned)
+						return nlohmann::json((uint64_t)record.value);
+					return nlohmann::json(record.value);
+				}
+				return nlohmann::json(is_unsigned ? std::to_string((uint64_t)record.value) : std::to_string(record.value));
+			}
+			case ValueKind::kDouble:
+				return nlohmann::json(BitsToDouble(record.value));
+			case ValueKind::kString:
+				return nlohmann::json(std::string(view.GetString(record.string.offset), record.string.length));
+			case ValueKind::kRawJson:
+				return nlohmann::json::parse(std::string(view.GetString(record.string.offset), record.string.length));
+			}
+			return nlohmann::json();
+		}
+
+		nlohmann::json ItemToJson(const SceneView& view, const ItemRecord& item, bool is_source)
+		{
+			nlohmann::json json = nlohmann::json::object();
+			json["name"] = std::string(view.GetName(item), item.name_length);
+			json["type"] = std::to_string(item.type);
+			if (item.flags & kItemHasParam)
+			{
+				nlohmann::json param = nlohmann::json::object();
+				for (uint32_t i = 0; i < item.property_count; i++)
+				{
+					const PropertyRecord& record = view.GetProperty(item, i);
+					const CoreProperty::PropertyInfo* info = CoreProperty::GetPropertyInfo((CoreProperty::PropertyId)record.id);
+					std::string key = info ? std::string(info->name) : std::string(view.GetString(record.key_offset));
+					param[key] = PropertyToJson(view, record);
+				}
+				json["param"] = param;
+			}
+			if (is_source && (item.flags & kItemHasFilters))
+			{
+				nlohmann::json filters = nlohmann::json::array();
+				for (uint32_t i = 0; i < item.filter_count; i++)
+					filters.push_back(ItemToJson(view, view.GetFilter(item, i), false));
+				json["filters"] = filters;
+			}
+			return json;
+		}
+	}
+
+	bool SceneView::CheckString(uint32_t offset, uint32_t length) const
+	{
+		uint64_t end = (uint64_t)offset + length;
+		return end < header_->string_size && strings_[end] == '\0';
+	}
+
+	bool SceneView::CheckItem(const ItemRecord& item, bool is_source) const
+	{
+		if (!CheckString(item.name_offset, item.name_length))
+			return false;
+		if ((uint64_t)item.property_begin + item.property_count > header_->property_count)
+			return false;
+		if (!is_source)
+			return item.filter_count == 0;
+		return (uint64_t)item.filter_begin + item.filter_count <= header_->filter_count;
+	}
+
+	bool SceneView::Attach(const void* data, size_t size)
+	{
+		header_ = nullptr;
+		if (!data || size < sizeof(FileHeader) || ((uintptr_t)data & 7))
+			return false;
+
+		const FileHeader* header = (const FileHeader*)data;
+		if (header->magic != kMagic || header->version != kVersion || header->header_size != sizeof(FileHeader))
+			return false;
+		if (header->file_size > size)
+			return false;
+
+		auto check_section = [&](uint32_t offset, uint64_t bytes) {
+			return (offset & 7) == 0 && offset >= sizeof(FileHeader) && (uint64_t)offset + bytes <= header->file_size;
+		};
+		if (!check_section(header->source_offset, (uint64_t)header->source_count * sizeof(ItemRecord))
+			|| !check_section(header->filter_offset, (uint64_t)header->filter_count * sizeof(ItemRecord))
+			|| !check_section(header->property_offset, (uint64_t)header->property_count * sizeof(PropertyRecord)))
+			return false;
+		if (!header->string_size || (uint64_t)header->string_offset + header->string_size > header->file_size)
+			return false;
+
+		const uint8_t* base = (const uint8_t*)data;
+		header_ = header;
+		sources_ = (const ItemRecord*)(base + header->source_offset);
+		filters_ = (const ItemRecord*)(base + header->filter_offset);
+		properties_ = (const PropertyRecord*)(base + header->property_offset);
+		strings_ = (const char*)(base + header->string_offset);
+
+		bool valid = strings_[header->string_size - 1] == '\0';
+		for (uint32_t i = 0; valid && i < header->source_count; i++)
+			valid = CheckItem(sources_[i], true);
+		for (uint32_t i = 0; valid && i < header->filter_count; i++)
+			valid = CheckItem(filters_[i], false);
+		for (uint32_t i = 0; valid && i < header->property_count; i++)
+		{
+			const PropertyRecord& record = properties_[i];
+			if (record.kind > (uint8_t)ValueKind::kRawJson)
+				valid = false;
+			else if (record.id == (uint16_t)CoreProperty::PropertyId::kUnknown)
+				valid = record.key_offset < header_->string_size;
+			else if (record.id >= (uint16_t)CoreProperty::PropertyId::kCount)
+				valid = false;
+			if (valid && (record.kind == (uint8_t)ValueKind::kString || record.kind == (uint8_t)ValueKind::kRawJson))
+				valid = CheckString(record.string.offset, record.string.length);
+		}
+
+		if (!valid)
+			header_ = nullptr;
+		return valid;
+	}
+
+	void SceneView::FillProperties(const ItemRecord& item, CoreProperty::PropertyBag& props) const
+	{
+		props.Clear();
+		for (uint32_t i = 0; i < item.property_count; i++)
+		{
+			const PropertyRecord& record = GetProperty(item, i);
+			const CoreProperty::PropertyInfo* info = CoreProperty::GetPropertyInfo((CoreProperty::PropertyId)record.id);
+			if (!info)
+				continue;
+
+			switch ((ValueKind)record.kind)
+			{
+			case ValueKind::kInt:
+				props.SetInt(info->id, record.value);
+				break;
+			case ValueKind::kDouble:
+				props.SetDouble(info->id, BitsToDouble(record.value));
+				break;
+			case ValueKind::kString:
+			case ValueKind::kRawJson:
+			{
+				// 非规范写法的数值和 JSON 路径一样在这里转换
+				const char* text = GetString(record.string.offset);
+				if (info->type == CoreProperty::ValueType::kString)
+				{
+					props.SetString(info->id, text, record.string.length);
+				}
+				else if (info->type == CoreProperty::ValueType::kInt)
+				{
+					int64_t value = 0;
+					if (ParseIntText(text, value))
+						props.SetInt(info->id, value);
+				}
+				else
+				{
+					char* end = nullptr;
+					double value = strtod(text, &end);
+					if (end != text)
+						props.SetDouble(info->id, value);
+				}
+			}
+			break;
+			}
+		}
+	}
+
+	SceneFile::SceneFile()
+	{
+
+	}
+
+	SceneFile::~SceneFile()
+	{
+		Close();
+	}
+
+	bool SceneFile::Open(const char* path)
+	{
+		Close();
+
+#if defined(_WIN32)
+		int length = MultiByteToWideChar(CP_UTF8, 0, path, -1, NULL, 0);
+		if (length <= 0)
+			return false;
+		std::wstring wpath(length, L'\0');
+		MultiByteToWideChar(CP_UTF8, 0, path, -1, &wpath[0], length);
+
+		HANDLE file = CreateFileW(wpath.c_str(), GENERIC_READ, FILE_SHARE_READ, NULL, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, NULL);
+		if (file == INVALID_HANDLE_VALUE)
+			return false;
+		file_ = file;
+
+		LARGE_INTEGER file_size;
+		if (!GetFileSizeEx(file, &file_size) || file_size.QuadPart < (LONGLONG)sizeof(FileHeader))
+		{
+			Close();
+			return false;
+		}
+		size_ = (size_t)file_size.QuadPart;
+		mapping_ = CreateFileMappingW(file, NULL, PAGE_READONLY, 0, 0, NULL);
+		if (!mapping_)
+		{
+			Close();
+			return false;
+		}
+		data_ = MapViewOfFile(mapping_, FILE_MAP_READ, 0, 0, 0);
+#else
+		int fd = open(path, O_RDONLY);
+		if (fd < 0)
+			return false;
+		struct stat st;
+		if (fstat(fd, &st) != 0 || st.st_size < (off_t)sizeof(FileHeader))
+		{
+			close(fd);
+			return false;
+		}
+		size_ = (size_t)st.st_size;
+		void* data = mmap(NULL, size_, PROT_READ, MAP_PRIVATE, fd, 0);
+		close(fd);
+		data_ = data == MAP_FAILED ? nullptr : data;
+#endif
+		if (!data_ || !view_.Attach(data_, size_))
+		{
+			Close();
+			return false;
+		}
+		return true;
+	}
+
+	void SceneFile::Close()
+	{
+		view_ = SceneView();
+#if defined(_WIN32)
+		if (data_)
+			UnmapViewOfFile(data_);
+		if (mapping_)
+			CloseHandle((HANDLE)mapping_);
+		if (file_)
+			CloseHandle((HANDLE)file_);
+		mapping_ = nullptr;
+		file_ = nullptr;
+#else
+		if (data_)
+			munmap(data_, size_);
+#endif
+		data_ = nullptr;
+		size_ = 0;
+	}
+
+	bool JsonToBinary(const nlohmann::json& scene, std::vector<uint8_t>& out, std::string* error)
+	{
+		Writer writer;
+		if (!writer.AddScene(scene))
+		{
+			if (error)
+				*error = writer.GetError();
+			return false;
+		}
+		writer.Write(out);
+		return true;
+	}
+
+	bool BinaryToJson(const SceneView& view, nlohmann::json& scene)
+	{
+		if (!view.IsValid())
+			return false;
+
+		try
+		{
+			nlohmann::json sources = nlohmann::json::array();
+			for (uint32_t i = 0; i < view.GetSourceCount(); i++)
+				sources.push_back(ItemToJson(view, view.GetSource(i), true));
+			scene = nlohmann::json::object();
+			scene["sources"] = sources;
+			return true;
+		}
+		catch (...)
+		{
+
+		}
+		return false;
+	}
+}
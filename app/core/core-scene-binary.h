@@ -0,0 +1,158 @@
+#ifndef CORE_SCENE_BINARY_H
+#define CORE_SCENE_BINARY_H
+
+/* 二进制场景格式 (.tsb)
+* 和 CoreEngine 生成的场景 JSON 一一对应：{"sources":[{name,type,param,filters:[{name,type,param}]}]}
+* 文件布局：FileHeader | ItemRecord[源] | ItemRecord[滤镜] | PropertyRecord[] | 字符串池
+* 所有偏移相对文件头，字符串以 '\0' 结尾，小端序；加载时整个文件 mmap，校验一次后直接按偏移读取
+* 属性按 CoreProperty::PropertyId 存成 16 字节的类型化记录，相同字符串只存一份
+* 加载不做 JSON 解析也没有逐字段分配
+*/
+
+#include <stdint.h>
+#include <stddef.h>
+#include <string>
+#include <vector>
+#include "json.hpp"
+#include "core-property.h"
+
+namespace SceneBinary
+{
+	const uint32_t kMagic = 0x42535354; // "TSSB"
+	const uint16_t kVersion = 1;
+
+	enum class ValueKind : uint8_t
+	{
+		kInt,
+		kDouble,
+		kString,
+		// 非字符串且不是已知数值属性的 JSON 值，原样保存 dump() 的结果
+		kRawJson,
+	};
+
+	enum PropertyFlags : uint8_t
+	{
+		// JSON 里是数字而不是字符串
+		kPropertyJsonNumber = 1 << 0,
+	};
+
+	enum ItemFlags : uint32_t
+	{
+		kItemHasParam = 1 << 0,
+		kItemHasFilters = 1 << 1,
+	};
+
+	struct FileHeader
+	{
+		uint32_t magic;
+		uint16_t version;
+		uint16_t header_size;
+		uint32_t file_size;
+		uint32_t source_count;
+		uint32_t source_offset;
+		uint32_t filter_count;
+		uint32_t filter_offset;
+		uint32_t property_count;
+		uint32_t property_offset;
+		uint32_t string_size;
+		uint32_t string_offset;
+		uint32_t reserved;
+	};
+
+	// 源和滤镜共用，滤镜的 filter_begin/filter_count 为 0
+	struct ItemRecord
+	{
+		uint32_t name_offset;
+		uint32_t name_length;
+		int32_t type;
+		uint32_t flags;
+		uint32_t property_begin;
+		uint32_t property_count;
+		uint32_t filter_begin;
+		uint32_t filter_count;
+	};
+
+	struct StringRef
+	{
+		uint32_t offset;
+		uint32_t length;
+	};
+
+	struct PropertyRecord
+	{
+		// CoreProperty::PropertyId，kUnknown 时名字在 key_offset (以 '\0' 结尾)
+		uint16_t id;
+		uint8_t kind;
+		uint8_t flags;
+		uint32_t key_offset;
+		union
+		{
+			// kInt 为整数，kDouble 为 double 的位模式
+			int64_t value;
+			// kString / kRawJson
+			StringRef string;
+		};
+	};
+
+	static_assert(sizeof(FileHeader) == 48, "FileHeader layout");
+	static_assert(sizeof(ItemRecord) == 32, "ItemRecord layout");
+	static_assert(sizeof(PropertyRecord) == 16, "PropertyRecord layout");
+
+	// 只读视图，不拥有内存
+	class SceneView
+	{
+	public:
+		// 校验所有偏移和范围，失败时视图不可用
+		bool Attach(const void* data, size_t size);
+		bool IsValid() const { return header_ != nullptr; }
+
+		uint32_t GetSourceCount() const { return header_->source_count; }
+		const ItemRecord& GetSource(uint32_t index) const { return sources_[index]; }
+		const ItemRecord& GetFilter(const ItemRecord& source, uint32_t index) const { return filters_[source.filter_begin + index]; }
+		const PropertyRecord& GetProperty(const ItemRecord& item, uint32_t index) const { return properties_[item.property_begin + index]; }
+		const char* GetString(uint32_t offset) const { return strings_ + offset; }
+		const char* GetName(const ItemRecord& item) const { return strings_ + item.name_offset; }
+
+		// 把 item 的属性写进 props (先 Clear)，未知属性跳过
+		void FillProperties(const ItemRecord& item, CoreProperty::PropertyBag& props) const;
+
+	private:
+		bool CheckString(uint32_t offset, uint32_t length) const;
+		bool CheckItem(const ItemRecord& item, bool is_source) const;
+
+	private:
+		const FileHeader* header_ = nullptr;
+		const ItemRecord* sources_ = nullptr;
+		const ItemRecord* filters_ = nullptr;
+		const PropertyRecord* properties_ = nullptr;
+		const char* strings_ = nullptr;
+	};
+
+	// 只读映射整个场景文件
+	class SceneFile
+	{
+	public:
+		SceneFile();
+		~SceneFile();
+
+		// path 为 UTF-8
+		bool Open(const char* path);
+		void Close();
+		const SceneView& GetView() const { return view_; }
+
+	private:
+		void* data_ = nullptr;
+		size_t size_ = 0;
+#if defined(_WIN32)
+		void* file_ = nullptr;
+		void* mapping_ = nullptr;
+#endif
+		SceneView view_;
+	};
+
+	// 结构不符合场景格式 (缺 name/type、多余字段等) 时返回 false，保证能无损转回去
+	bool JsonToBinary(const nlohmann::json& scene, std::vector<uint8_t>& out, std::string* error = nullptr);
+	bool BinaryToJson(const SceneView& view, nlohmann::json& scene);
+}
+
+#endif
@@ -0,0 +1,187 @@
+#include "core-scene-command.h"
+
+namespace
+{
+	// 场景文件里数值都写成字符串，这里两种都接受
+	bool GetInt(const nlohmann::json& json, const char* key, int64_t& value)
+	{
+		auto it = json.find(key);
+		if (it == json.end())
+			return false;
+		if (it->is_number_integer())
+		{
+			value = it->get<int64_t>();
+			return true;
+		}
+		if (!it->is_string())
+			return false;
+		const std::string& str = it->get_ref<const std::string&>();
+		size_t pos = 0;
+		try
+		{
+			value = std::stoll(str, &pos);
+		}
+		catch (...)
+		{
+			return false;
+		}
+		return pos == str.size();
+	}
+
+	bool GetString(const nlohmann::json& json, const char* key, std::string& value)
+	{
+		auto it = json.find(key);
+		if (it == json.end() || !it->is_string())
+			return false;
+		value = it->get<std::string>();
+		return true;
+	}
+
+	bool SetError(std::string* error, const std::string& text)
+	{
+		if (error)
+			*error = text;
+		return false;
+	}
+}
+
+namespace SceneCommand
+{
+	bool ParseCommand(const nlohmann::json& json, const std::string& scene, Command& command, std::string* error)
+	{
+		if (!json.is_object())
+			return SetError(error, "command is not an object");
+
+		std::string op;
+		if (!GetString(json, "op", op))
+			return SetError(error, "missing op");
+
+		command = Command();
+		command.scene = scene;
+		GetString(json, "scene", command.scene);
+
+		auto param = json.find("param");
+		if (param != json.end())
+		{
+			if (!param->is_object())
+				return SetError(error, op + ": param is not an object");
+			command.props.FromJson(*param);
+		}
+
+		if (op == "switch")
+		{
+			command.type = CommandType::kSwitchScene;
+			if (command.scene.empty())
+				return SetError(error, "switch: missing scene");
+			int64_t fade = 0;
+			if (GetInt(json, "fade", fade))
+			{
+				if (fade < 0 || fade > 60000)
+					return SetError(error, "switch: bad fade");
+				command.fade_ms = (uint32_t)fade;
+			}
+			return true;
+		}
+
+		if (!GetString(json, "source", command.source) || command.source.empty())
+			return SetError(error, op + ": missing source");
+
+		if (op == "update")
+		{
+			command.type = CommandType::kUpdateSource;
+			if (command.props.Empty())
+				return SetError(error, "update: empty param");
+		}
+		else if (op == "updateFilter")
+		{
+			command.type = CommandType::kUpdateFilter;
+			if (!GetString(json, "filter", command.filter) || command.filter.empty())
+				return SetError(error, "updateFilter: missing filter");
+			if (command.props.Empty())
+				return SetError(error, "updateFilter: empty param");
+		}
+		else if (op == "add")
+		{
+			command.type = CommandType::kAddSource;
+			int64_t type = 0;
+			if (!GetInt(json, "type", type))
+				return SetError(error, "add: missing type");
+			command.source_type = (int32_t)type;
+			auto filters = json.find("filters");
+			if (filters != json.end())
+			{
+				if (!filters->is_array())
+					return SetError(error, "add: filters is not an array");
+				command.filters = filters->dump();
+			}
+			int64_t index = -1;
+			if (GetInt(json, "index", index))
+				command.index = index < 0 || index > INT32_MAX ? -1 : (int32_t)index;
+		}
+		else if (op == "remove")
+		{
+			command.type = CommandType::kRemoveSource;
+		}
+		else if (op == "move")
+		{
+			command.type = CommandType::kMoveSource;
+			int64_t index = -1;
+			if (!GetInt(json, "index", index))
+				return SetError(error, "move: missing index");
+			command.index = index < 0 || index > INT32_MAX ? -1 : (int32_t)index;
+		}
+		else
+		{
+			return SetError(error, "unknown op: " + op);
+		}
+		return true;
+	}
+
+	bool ParseCommandBatch(const char* data, size_t size, CommandBatch& batch, std::string* error)
+	{
+		batch.clear();
+		nlohmann::json json;
+		try
+		{
+			json = nlohmann::json::parse(data, data + size);
+		}
+		catch (...)
+		{
+			return SetError(error, "invalid json");
+		}
+
+		if (!json.is_object())
+			return SetError(error, "request is not an object");
+
+		std::string scene;
+		GetString(json, "scene", scene);
+
+		auto commands = json.find("commands");
+		if (commands == json.end())
+		{
+			// 单条命令也可以直接发
+			batch.resize(1);
+			if (!ParseCommand(json, scene, batch[0], error))
+			{
+				batch.clear();
+				return false;
+			}
+			return true;
+		}
+
+		if (!commands->is_array() || commands->empty())
+			return SetError(error, "commands is not a non-empty array");
+
+		batch.resize(commands->size());
+		for (size_t i = 0; i < commands->size(); i++)
+		{
+			std::string text;
+			if (!ParseCommand((*commands)[i], scene, batch[i], &text))
+			{
+				batch.clear();
+				return SetError(error, "command " + std::to_string(i) + ": " + text);
+			}
+		}
+		return true;
+	}
+}
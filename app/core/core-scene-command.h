@@ -0,0 +1,59 @@
+#ifndef CORE_SCENE_COMMAND_H
+#define CORE_SCENE_COMMAND_H
+
+/* 场景修改命令
+* 任意线程把命令整批放进 CoreScene 的队列，渲染线程在帧开始时按顺序执行，同一批命令在同一帧里生效
+* 控制端点每行一个 JSON：
+* {"scene":"可选，默认场景","commands":[
+*   {"op":"update","source":"text_fps","param":{"text":"hello"}},
+*   {"op":"updateFilter","source":"media","filter":"filter_2","param":{...}},
+*   {"op":"add","source":"image_2","type":"5","param":{...},"filters":[...]},
+*   {"op":"remove","source":"image_2"},
+*   {"op":"move","source":"image_2","index":"0"},
+*   {"op":"switch","scene":"scene_2","fade":"300"}]}
+* 数值和场景文件一样可以写成字符串；不写 scene 时作用于当前场景
+*/
+
+#include <stdint.h>
+#include <stddef.h>
+#include <string>
+#include <vector>
+#include "json.hpp"
+#include "core-property.h"
+
+namespace SceneCommand
+{
+	enum class CommandType
+	{
+		kUpdateSource = 0,
+		kUpdateFilter,
+		kAddSource,
+		kRemoveSource,
+		kMoveSource,
+		kSwitchScene,
+	};
+
+	struct Command
+	{
+		CommandType type = CommandType::kUpdateSource;
+		std::string scene;
+		std::string source;
+		std::string filter;
+		CoreProperty::PropertyBag props;
+		// kAddSource：CoreSceneData::SourceType 的值，filters 和场景文件里的 filters 数组一样
+		int32_t source_type = 0;
+		std::string filters;
+		// kAddSource/kMoveSource：0 为最底层，-1 或超出范围为最上层
+		int32_t index = -1;
+		// kSwitchScene
+		uint32_t fade_ms = 0;
+	};
+
+	using CommandBatch = std::vector<Command>;
+
+	// 有一条命令不合法就整批拒绝
+	bool ParseCommandBatch(const char* data, size_t size, CommandBatch& batch, std::string* error = nullptr);
+	bool ParseCommand(const nlohmann::json& json, const std::string& scene, Command& command, std::string* error = nullptr);
+}
+
+#endif
@@ -10,7 +10,8 @@ namespace CoreSceneData
 		kSourceGdiplusText,
 		kSourceMedia,
 		kSourceCamera,
-		kSourceObjModel
+		kSourceObjModel,
+		kSourceTestPattern
 	};
 
 	enum class FilterType
@@ -18,6 +19,7 @@ namespace CoreSceneData
 		kFilterFaceDetect,
 		kFilterSplit,
 		kFilterBoltBox,
+		kFilterLut3D,
 	};
 
 	enum class AlignType
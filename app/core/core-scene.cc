@@ -10,47 +10,223 @@
 #include "split-filter.h"
 #include "obj-model-source.h"
 #include "boltbox-filter.h"
+#include "lut-filter.h"
 #include "image-source.h"
+#include "test-pattern-source.h"
 #include "face-detect/facedetect-filter.h"
+#include "task-pool.h"
+#include "core-scene-binary.h"
+#include "logger.h"
+#include "platform.h"
+#include <algorithm>
+#include <iterator>
 
-CoreScene::CoreScene()
+namespace
 {
+	const char* kDefaultScene = "default";
+	// 目标场景迟迟加载不完时最多等这么久就直接切，未就绪的源按占位处理
+	const uint64_t kSwitchWaitNs = 3000000000ULL;
+	// 每帧最多预热的源个数，预热的 Tick 会占用当前帧的时间
+	const int kPrewarmPerFrame = 2;
+	// 每帧最多执行的命令条数，按整批计算，超过之后剩下的批次留到下一帧
+	const size_t kCommandsPerFrame = 4096;
+}
 
+CoreScene::CoreScene()
+{
+	size_t threads = std::thread::hardware_concurrency();
+	threads = threads > 4 ? 4 : (threads ? threads : 1);
+	load_pool_.reset(new TaskPool(threads));
 }
 
 CoreScene::~CoreScene()
 {
-	for (auto& c = source_list_.begin(); c != source_list_.end();)
+	// 线程池析构时会执行完队列里剩下的加载任务
+	load_pool_.reset();
+	for (auto& c : retired_sources_)
+	{
+		c->WaitLoad();
+		delete c;
+	}
+	retired_sources_.clear();
+	for (auto& c : scenes_)
+		DestroyScene(c.second);
+	scenes_.clear();
+	current_scene_ = nullptr;
+	pending_scene_ = nullptr;
+	fade_scene_ = nullptr;
+}
+
+void CoreScene::DestroyScene(SceneItem* scene)
+{
+	for (auto& c = scene->source_list.begin(); c != scene->source_list.end();)
 	{
 		IBaseSource* source = *c;
-		c = source_list_.erase(c);
+		c = scene->source_list.erase(c);
+		// 加载任务还拿着源的指针
+		source->WaitLoad();
 		delete source;
 		source = nullptr;
 	}
+	scene->source_index.clear();
+	delete scene;
 }
 
-IBaseSource* CoreScene::FindNamedSource(std::string sourcename)
+CoreScene::SceneItem* CoreScene::FindCommandScene(const std::string& scene)
 {
-	IBaseSource* ptr = nullptr;
-	for (const auto& c : source_list_)
+	if (scene.empty())
 	{
-		if (c->GetSourceName() == sourcename)
+		// 启动时第一帧还没切到默认场景，先用待切换的场景
+		return current_scene_ ? current_scene_ : pending_scene_;
+	}
+	auto it = scenes_.find(scene);
+	return it == scenes_.end() ? nullptr : it->second;
+}
+
+void CoreScene::GenerateSources(const char* jsondata)
+{
+	if (PreloadScene(kDefaultScene, jsondata))
+		SwitchSceneImpl(kDefaultScene, 0, false);
+}
+
+bool CoreScene::GenerateSourcesBinary(const char* path)
+{
+	if (!PreloadSceneBinary(kDefaultScene, path))
+		return false;
+	return SwitchSceneImpl(kDefaultScene, 0, false);
+}
+
+bool CoreScene::PreloadScene(const std::string& scene, const char* jsondata)
+{
+	SceneItem* item = new SceneItem();
+	item->name = scene;
+	if (!BuildScene(item, jsondata) || !AddScene(item))
+	{
+		DestroyScene(item);
+		return false;
+	}
+	return true;
+}
+
+bool CoreScene::PreloadSceneBinary(const std::string& scene, const char* path)
+{
+	SceneItem* item = new SceneItem();
+	item->name = scene;
+	if (!BuildSceneBinary(item, path) || !AddScene(item))
+	{
+		DestroyScene(item);
+		return false;
+	}
+	return true;
+}
+
+bool CoreScene::AddScene(SceneItem* scene)
+{
+	SceneItem* old = nullptr;
+	{
+		std::unique_lock<std::mutex> lock(scene_mutex_);
+		auto it = scenes_.find(scene->name);
+		if (it != scenes_.end())
 		{
-			ptr = c;
-			return ptr;
+			old = it->second;
+			if (old == current_scene_ || old == pending_scene_ || old == fade_scene_)
+			{
+				LOGGER_ERROR("[Scene] scene %s is in use, can not replace", scene->name.c_str());
+				return false;
+			}
 		}
+		scenes_[scene->name] = scene;
 	}
-	return ptr;
+	if (old)
+		DestroyScene(old);
+	LOGGER_INFO("[Scene] scene %s preloading, sources:%d", scene->name.c_str(), (int)scene->source_list.size());
+	return true;
 }
 
-void CoreScene::GenerateSources(const char* jsondata)
+bool CoreScene::RemoveScene(const std::string& scene)
+{
+	SceneItem* item = nullptr;
+	{
+		std::unique_lock<std::mutex> lock(scene_mutex_);
+		auto it = scenes_.find(scene);
+		if (it == scenes_.end())
+			return false;
+		item = it->second;
+		if (item == current_scene_ || item == pending_scene_ || item == fade_scene_)
+			return false;
+		scenes_.erase(it);
+	}
+	// 源的析构可能要等解码线程退出，放在锁外
+	DestroyScene(item);
+	return true;
+}
+
+bool CoreScene::SwitchScene(const std::string& scene, uint32_t fade_ms)
+{
+	return SwitchSceneImpl(scene, fade_ms, true);
+}
+
+bool CoreScene::SwitchSceneImpl(const std::string& scene, uint32_t fade_ms, bool wait_ready)
+{
+	std::unique_lock<std::mutex> lock(scene_mutex_);
+	return SwitchSceneLocked(scene, fade_ms, wait_ready);
+}
+
+bool CoreScene::SwitchSceneLocked(const std::string& scene, uint32_t fade_ms, bool wait_ready)
+{
+	auto it = scenes_.find(scene);
+	if (it == scenes_.end())
+		return false;
+	if (it->second == current_scene_ && !pending_scene_)
+		return true;
+
+	pending_scene_ = it->second;
+	pending_fade_ns_ = (uint64_t)fade_ms * 1000000ULL;
+	pending_request_ns_ = os_gettime_ns();
+	pending_wait_ready_ = wait_ready;
+	return true;
+}
+
+bool CoreScene::IsSceneReady(const std::string& scene)
+{
+	std::unique_lock<std::mutex> lock(scene_mutex_);
+	auto it = scenes_.find(scene);
+	if (it == scenes_.end())
+		return false;
+	SceneItem* item = it->second;
+	// 当前场景每帧都在 Tick
+	if (item == current_scene_)
+		return true;
+	return IsSceneSettled(item);
+}
+
+std::string CoreScene::GetCurrentSceneName()
+{
+	std::unique_lock<std::mutex> lock(scene_mutex_);
+	return current_scene_ ? current_scene_->name : std::string();
+}
+
+bool CoreScene::IsSceneSettled(SceneItem* scene)
+{
+	for (const auto& c : scene->source_list)
+	{
+		if (c->IsLoading())
+			return false;
+		// 加载失败的源不用等
+		if (c->IsReady() && scene->prewarmed.find(c) == scene->prewarmed.end())
+			return false;
+	}
+	return true;
+}
+
+bool CoreScene::BuildScene(SceneItem* scene, const char* jsondata)
 {
 	try
 	{
 		auto json = nlohmann::json::parse(jsondata);
 		const auto sJson = json.at("sources");
 		if (!sJson.is_array())
-			return;
+			return false;
 
 		for (size_t i = 0; i < sJson.size(); i++)
 		{
@@ -59,27 +235,74 @@ void CoreScene::GenerateSources(const char* jsondata)
 			{
 				std::string name = c.at("name");
 				std::string type = c.at("type");
-				AllocNewSources(name, (CoreSceneData::SourceType)(std::stoi(type)));
+				IBaseSource* source = AllocNewSources(scene, name, (CoreSceneData::SourceType)(std::stoi(type)));
+				if (!source)
+					continue;
 				if (c.find("param") != c.end())
 				{
-					std::string paramjson = c.at("param").dump();
-					UpdateSourceProperty(c.at("name"), paramjson.c_str());
+					CoreProperty::PropertyBag props;
+					props.FromJson(c.at("param"));
+					source->UpdateEntry(props);
 				}
 				if (c.find("filters") != c.end())
 				{
 					std::string filterjson = c.at("filters").dump();
-					GenerateFilters(name, filterjson.c_str());
+					GenerateFilters(source, filterjson.c_str());
 				}
+				// 滤镜都创建完之后再开始加载，加载期间渲染线程照常出帧
+				source->LoadAsync(load_pool_.get());
 			}
 		}
+		return true;
 	}
 	catch(...)
 	{
 
 	}
+	return false;
 }
 
-void CoreScene::GenerateFilters(std::string sourcename, const char* jsondata)
+bool CoreScene::BuildSceneBinary(SceneItem* scene, const char* path)
+{
+	SceneBinary::SceneFile file;
+	if (!file.Open(path))
+	{
+		LOGGER_ERROR("[Scene] open binary scene failed:%s", path);
+		return false;
+	}
+
+	const SceneBinary::SceneView& view = file.GetView();
+	CoreProperty::PropertyBag props;
+	for (uint32_t i = 0; i < view.GetSourceCount(); i++)
+	{
+		const SceneBinary::ItemRecord& item = view.GetSource(i);
+		std::string name(view.GetName(item), item.name_length);
+		IBaseSource* source = AllocNewSources(scene, name, (CoreSceneData::SourceType)item.type);
+		if (!source)
+			continue;
+
+		if (item.flags & SceneBinary::kItemHasParam)
+		{
+			view.FillProperties(item, props);
+			source->UpdateEntry(props);
+		}
+		for (uint32_t j = 0; j < item.filter_count; j++)
+		{
+			const SceneBinary::ItemRecord& filter = view.GetFilter(item, j);
+			std::string filtername(view.GetName(filter), filter.name_length);
+			AllocNewFilter(source, filtername, (CoreSceneData::FilterType)filter.type);
+			if (filter.flags & SceneBinary::kItemHasParam)
+			{
+				view.FillProperties(filter, props);
+				UpdateFilterPropertyImpl(source, filtername, props);
+			}
+		}
+		source->LoadAsync(load_pool_.get());
+	}
+	return true;
+}
+
+void CoreScene::GenerateFilters(IBaseSource* source, const char* jsondata)
 {
 	try
 	{
@@ -93,11 +316,12 @@ void CoreScene::GenerateFilters(std::string sourcename, const char* jsondata)
 			{
 				std::string name = c.at("name");
 				std::string type = c.at("type");
-				AllocNewFilter(sourcename, name, (CoreSceneData::FilterType)(std::stoi(type)));
+				AllocNewFilter(source, name, (CoreSceneData::FilterType)(std::stoi(type)));
 				if (c.find("param") != c.end())
 				{
-					std::string paramjson = c.at("param").dump();
-					UpdateFilterProperty(sourcename, name, paramjson.c_str());
+					CoreProperty::PropertyBag props;
+					props.FromJson(c.at("param"));
+					UpdateFilterPropertyImpl(source, name, props);
 				}
 			}
 		}
@@ -108,14 +332,12 @@ void CoreScene::GenerateFilters(std::string sourcename, const char* jsondata)
 	}
 }
 
-void CoreScene::AllocNewFilter(std::string sourcename, std::string filtername, CoreSceneData::FilterType filtertype)
+void CoreScene::AllocNewFilter(IBaseSource* source, std::string filtername, CoreSceneData::FilterType filtertype)
 {
-	if (!FindNamedSource(sourcename))
+	if (!source)
 		return;
 
-	IBaseSource* source = FindNamedSource(sourcename);
 	CoreFilter* core_filter = source->GetCoreFilter();
-
 	IBaseFilter* filter = nullptr;
 	switch (filtertype)
 	{
@@ -134,6 +356,11 @@ void CoreScene::AllocNewFilter(std::string sourcename, std::string filtername, C
 		filter = new BoltBoxFilter();
 	}
 	break;
+	case CoreSceneData::FilterType::kFilterLut3D:
+	{
+		filter = new Lut3DFilter();
+	}
+	break;
 	}
 	if (!filter)
 		return;
@@ -150,29 +377,472 @@ void CoreScene::AllocNewFilter(std::string sourcename, std::string filtername, C
 	}
 }
 
+void CoreScene::PostCommands(SceneCommand::CommandBatch&& batch)
+{
+	if (batch.empty())
+		return;
+	command_queue_.Push(std::move(batch));
+}
+
+std::string CoreScene::ExecuteCommandRequest(const std::string& request)
+{
+	SceneCommand::CommandBatch batch;
+	std::string error;
+	if (!SceneCommand::ParseCommandBatch(request.c_str(), request.size(), batch, &error))
+		return nlohmann::json({ { "ok", false }, { "error", error } }).dump();
+
+	// 只表示已经进队列，执行结果看日志 (找不到的源/场景会打印错误)
+	size_t count = batch.size();
+	PostCommands(std::move(batch));
+	return nlohmann::json({ { "ok", true }, { "queued", count } }).dump();
+}
+
+void CoreScene::ApplyCommands()
+{
+	ReleaseRetiredSources();
+	if (command_queue_.Empty())
+		return;
+
+	std::vector<IBaseSource*> activated;
+	std::vector<IBaseSource*> removed;
+	size_t applied = 0;
+	{
+		std::unique_lock<std::mutex> lock(scene_mutex_);
+		SceneCommand::CommandBatch batch;
+		while (applied < kCommandsPerFrame && command_queue_.Pop(batch))
+		{
+			for (auto& c : batch)
+				ApplyCommand(c, activated, removed);
+			applied += batch.size();
+		}
+	}
+
+	// 激活/反激活可能要等解码线程，放在锁外
+	for (auto c : activated)
+	{
+		c->Activate();
+		c->Show();
+	}
+	for (auto c : removed)
+	{
+		c->Deactivate();
+		retired_sources_.push_back(c);
+	}
+}
+
+void CoreScene::ApplyCommand(SceneCommand::Command& command, std::vector<IBaseSource*>& activated, std::vector<IBaseSource*>& removed)
+{
+	using SceneCommand::CommandType;
+
+	if (command.type == CommandType::kSwitchScene)
+	{
+		if (!SwitchSceneLocked(command.scene, command.fade_ms, true))
+			LOGGER_ERROR("[Scene] command switch failed, no scene %s", command.scene.c_str());
+		return;
+	}
+
+	SceneItem* scene = FindCommandScene(command.scene);
+	if (!scene)
+	{
+		LOGGER_ERROR("[Scene] command failed, no scene %s", command.scene.c_str());
+		return;
+	}
+
+	IBaseSource* source = nullptr;
+	auto it = scene->source_index.find(command.source);
+	if (it != scene->source_index.end())
+		source = it->second;
+
+	switch (command.type)
+	{
+	case CommandType::kUpdateSource:
+	{
+		if (source)
+			source->UpdateEntry(command.props);
+	}
+	break;
+	case CommandType::kUpdateFilter:
+	{
+		if (source)
+		{
+			UpdateFilterPropertyImpl(source, command.filter, command.props);
+			// 滤镜的资源文件也在加载线程里读，Load 可重复调用
+			source->LoadAsync(load_pool_.get());
+		}
+	}
+	break;
+	case CommandType::kAddSource:
+	{
+		if (source)
+		{
+			LOGGER_ERROR("[Scene] command add failed, source %s exists", command.source.c_str());
+			return;
+		}
+		source = AllocNewSources(scene, command.source, (CoreSceneData::SourceType)command.source_type);
+		if (!source)
+		{
+			LOGGER_ERROR("[Scene] command add failed, source:%s type:%d", command.source.c_str(), command.source_type);
+			return;
+		}
+		if (!command.props.Empty())
+			source->UpdateEntry(command.props);
+		if (!command.filters.empty())
+			GenerateFilters(source, command.filters.c_str());
+		source->LoadAsync(load_pool_.get());
+		if (command.index >= 0)
+		{
+			scene->source_list.pop_back();
+			auto pos = scene->source_list.begin();
+			std::advance(pos, std::min((size_t)command.index, scene->source_list.size()));
+			scene->source_list.insert(pos, source);
+		}
+		// 待切换的场景切过去时会整体激活
+		if (scene == current_scene_ || scene == fade_scene_)
+			activated.push_back(source);
+	}
+	break;
+	case CommandType::kRemoveSource:
+	{
+		if (!source)
+		{
+			LOGGER_ERROR("[Scene] command remove failed, no source %s in scene %s", command.source.c_str(), scene->name.c_str());
+			return;
+		}
+		scene->source_list.remove(source);
+		scene->source_index.erase(it);
+		scene->prewarmed.erase(source);
+		removed.push_back(source);
+	}
+	break;
+	case CommandType::kMoveSource:
+	{
+		if (!source)
+		{
+			LOGGER_ERROR("[Scene] command move failed, no source %s in scene %s", command.source.c_str(), scene->name.c_str());
+			return;
+		}
+		scene->source_list.remove(source);
+		auto pos = scene->source_list.end();
+		if (command.index >= 0 && (size_t)command.index < scene->source_list.size())
+		{
+			pos = scene->source_list.begin();
+			std::advance(pos, command.index);
+		}
+		scene->source_list.insert(pos, source);
+	}
+	break;
+	default:
+		break;
+	}
+}
+
+void CoreScene::ReleaseRetiredSources()
+{
+	for (auto it = retired_sources_.begin(); it != retired_sources_.end();)
+	{
+		IBaseSource* source = *it;
+		// 加载任务还拿着源的指针，结束之后在加载线程里析构，不占渲染线程
+		if (source->IsLoading())
+		{
+			++it;
+			continue;
+		}
+		load_pool_->Post([source]() { delete source; });
+		it = retired_sources_.erase(it);
+	}
+}
+
 void CoreScene::TickSources()
 {
-	for (const auto& c : source_list_)
+	ApplyCommands();
+	ApplyPendingSwitch();
+
+	if (current_scene_)
+		TickSceneItem(current_scene_);
+
+	if (fade_scene_)
 	{
+		if (os_gettime_ns() - fade_start_ns_ >= fade_ns_)
+		{
+			SetSceneActive(fade_scene_, false);
+			std::unique_lock<std::mutex> lock(scene_mutex_);
+			fade_scene_ = nullptr;
+			switching_ = false;
+		}
+		else
+		{
+			TickSceneItem(fade_scene_);
+		}
+	}
+
+	PrewarmScenes();
+}
+
+void CoreScene::TickSceneItem(SceneItem* scene)
+{
+	// 渲染线程：Map 纹理、取帧，收集这一帧有 CPU 工作的源
+	tick_list_.clear();
+	prepare_list_.clear();
+	for (const auto& c : scene->source_list)
+	{
+		// 上一帧的遮挡结果决定显示状态，被盖住的源不 Tick，它的解码线程也已经暂停
+		c->UpdateShowing();
+		if (!c->IsShowing())
+			continue;
+		tick_list_.push_back(c);
+		if (c->TickBeginEntry())
+			prepare_list_.push_back(c);
+	}
+
+	// 工作线程：拷贝帧数据、生成图案、光栅化文字，各个源之间并行，渲染线程也参与
+	TaskPool::GetShared()->ParallelFor(prepare_list_.size(), 1, [this](size_t begin, size_t end) {
+		for (size_t i = begin; i < end; i++)
+			prepare_list_[i]->TickPrepareEntry();
+	});
+
+	// 渲染线程：Unmap 和其他需要 D3D 上下文的提交，按场景顺序
+	for (const auto& c : tick_list_)
 		c->TickEntry();
+}
+
+void CoreScene::SetSceneActive(SceneItem* scene, bool active)
+{
+	for (const auto& c : scene->source_list)
+	{
+		if (active)
+		{
+			// 激活时先当作可见，之后按遮挡情况隐藏
+			c->Activate();
+			c->Show();
+		}
+		else
+		{
+			c->Deactivate();
+		}
+	}
+}
+
+void CoreScene::ApplyPendingSwitch()
+{
+	SceneItem* deactivate[2] = { nullptr, nullptr };
+	SceneItem* activate = nullptr;
+	{
+		std::unique_lock<std::mutex> lock(scene_mutex_);
+		if (!pending_scene_)
+			return;
+
+		switching_ = true;
+		uint64_t now = os_gettime_ns();
+		uint64_t wait_ns = now - pending_request_ns_;
+		if (pending_wait_ready_ && wait_ns < kSwitchWaitNs && !IsSceneSettled(pending_scene_))
+			return;
+
+		// 目标场景已经加载并预热过，这里只交换指针
+		SceneItem* old = current_scene_;
+		SceneItem* old_fade = fade_scene_;
+		current_scene_ = pending_scene_;
+		pending_scene_ = nullptr;
+		fade_scene_ = nullptr;
+		if (pending_fade_ns_ && old && old != current_scene_)
+		{
+			fade_scene_ = old;
+			fade_start_ns_ = now;
+			fade_ns_ = pending_fade_ns_;
+		}
+		else
+		{
+			switching_ = false;
+		}
+
+		// 不再渲染的场景反激活，停掉它们的后台线程
+		if (old && old != current_scene_ && old != fade_scene_)
+			deactivate[0] = old;
+		if (old_fade && old_fade != current_scene_ && old_fade != fade_scene_)
+			deactivate[1] = old_fade;
+		activate = current_scene_;
+
+		LOGGER_INFO("[Scene] switch to %s, wait:%f ms fade:%f ms", current_scene_->name.c_str(), wait_ns / 1000000.0, pending_fade_ns_ / 1000000.0);
+	}
+
+	for (auto c : deactivate)
+	{
+		if (c)
+			SetSceneActive(c, false);
+	}
+	SetSceneActive(activate, true);
+}
+
+void CoreScene::PrewarmScenes()
+{
+	std::unique_lock<std::mutex> lock(scene_mutex_);
+	int budget = kPrewarmPerFrame;
+	auto prewarm = [&](SceneItem* scene) {
+		for (const auto& c : scene->source_list)
+		{
+			if (budget <= 0)
+				return;
+			if (!c->IsReady() || scene->prewarmed.find(c) != scene->prewarmed.end())
+				continue;
+			// 第一次 Tick 会做纹理创建和上传，提前在空闲帧里做掉
+			if (c->TickBeginEntry())
+				c->TickPrepareEntry();
+			c->TickEntry();
+			scene->prewarmed.insert(c);
+			budget--;
+		}
+	};
+
+	// 待切换的场景优先
+	if (pending_scene_)
+		prewarm(pending_scene_);
+	for (const auto& c : scenes_)
+	{
+		if (budget <= 0)
+			return;
+		if (c.second == current_scene_ || c.second == fade_scene_ || c.second == pending_scene_)
+			continue;
+		prewarm(c.second);
 	}
 }
 
 void CoreScene::RenderSources()
 {
-	for (const auto& c : source_list_)
+	FadeTarget* fade_target = nullptr;
+	if (fade_scene_)
+		fade_target = RenderFadeTarget(fade_scene_);
+
+	if (current_scene_)
+		RenderSceneItem(current_scene_);
+
+	if (fade_target)
 	{
+		uint64_t past = os_gettime_ns() - fade_start_ns_;
+		float factor = past >= fade_ns_ ? 0.0f : 1.0f - (float)past / (float)fade_ns_;
+		DrawFadeTarget(fade_target, factor);
+	}
+}
 
-		c->GetCoreFilter()->TextureFilters(c);
+void CoreScene::RenderSceneItem(SceneItem* scene)
+{
+	// 从最上层往下算，被上层不透明源完全盖住或整个在画面外的源这一遍不画，滤镜也跳过
+	cover_rects_.clear();
+	draw_list_.clear();
+	for (auto it = scene->source_list.rbegin(); it != scene->source_list.rend(); ++it)
+	{
+		IBaseSource* source = *it;
+		if (!source->IsReady())
+		{
+			// 还在加载的源不算隐藏
+			source->MarkDrawn();
+			continue;
+		}
+		if (IsSourceCovered(source))
+			continue;
+		source->MarkDrawn();
+		draw_list_.push_back(source);
+	}
+
+	for (auto it = draw_list_.rbegin(); it != draw_list_.rend(); ++it)
+	{
+		(*it)->GetCoreFilter()->TextureFilters(*it);
 	}
 }
 
-void CoreScene::AllocNewSources(std::string name, CoreSceneData::SourceType type)
+bool CoreScene::IsSourceCovered(IBaseSource* source)
 {
-	if (FindNamedSource(name))
-		return;
+	const IBaseSource::SourceRect* size = source->GetSourceRect();
+	// 还没有尺寸的源按原来的流程处理
+	if (size->width <= 0 || size->height <= 0)
+		return false;
+
+	float cenx = 0, ceny = 0, scalex = 0, scaley = 0;
+	source->GetRenderSize(cenx, ceny, scalex, scaley);
+	if (scalex <= 0 || scaley <= 0)
+		return false;
+
+	CoverRect rect = { cenx - scalex, ceny - scaley, cenx + scalex, ceny + scaley };
+	if (rect.right <= -1.0f || rect.left >= 1.0f || rect.top <= -1.0f || rect.bottom >= 1.0f)
+		return true;
+
+	// 只和单个遮挡区域比较，多个源拼起来盖住的情况不算
+	for (const auto& c : cover_rects_)
+	{
+		if (c.left <= rect.left && c.right >= rect.right && c.bottom <= rect.bottom && c.top >= rect.top)
+			return true;
+	}
+
+	if (source->IsOpaque())
+		cover_rects_.push_back(rect);
+	return false;
+}
+
+CoreScene::FadeTarget* CoreScene::RenderFadeTarget(SceneItem* scene)
+{
+	CoreD3D* d3d = core_engine_->GetD3D();
+
+	D3D11_VIEWPORT port;
+	memset(&port, 0, sizeof(port));
+	d3d->GetFrontViewPort(&port);
+	int width = (int)port.Width;
+	int height = (int)port.Height;
+	if (width <= 0 || height <= 0)
+		return nullptr;
+
+	auto key = std::make_pair(width, height);
+	auto it = fade_targets_.find(key);
+	if (it == fade_targets_.end())
+	{
+		FadeTarget target;
+		if (!d3d->CreateD3DTexture(target.render_texture.GetAddressOf(), true, false, width, height, false)
+			|| !d3d->CreateRenderTargetView(target.render_texture.Get(), target.target_view.GetAddressOf())
+			|| !d3d->CreateD3DTexture(target.final_texture.GetAddressOf(), false, false, width, height, false)
+			|| !d3d->CreateShaderResourceView(target.final_texture.Get(), target.final_view.GetAddressOf())
+			|| !d3d->CreateDepthStencilBuffer(target.depth_stencil_buffer.GetAddressOf(), width, height)
+			|| !d3d->CreateDepthStencilView(target.depth_stencil_buffer.Get(), target.depth_stencil_view.GetAddressOf()))
+		{
+			LOGGER_ERROR("[Scene] create fade target failed, %dx%d", width, height);
+			return nullptr;
+		}
+		it = fade_targets_.insert(std::make_pair(key, target)).first;
+	}
+	FadeTarget* target = &it->second;
+
+	ComPtr<ID3D11RenderTargetView> View;
+	ComPtr<ID3D11DepthStencilView> Depth;
+	// 背景和当前目标一致，淡出时不会把背景也混进去
+	float color[4];
+	d3d->GetClearColor(color);
+	d3d->OMGetRenderTargets(1, View.GetAddressOf(), Depth.GetAddressOf());
+	d3d->ClearRenderTargetView(target->target_view.Get(), color);
+	d3d->ClearDepthStencilView(target->depth_stencil_view.Get(), D3D11_CLEAR_DEPTH | D3D11_CLEAR_STENCIL, 1.0f, 0);
+	d3d->OMSetRenderTargets(1, target->target_view.GetAddressOf(), target->depth_stencil_view.Get());
+
+	RenderSceneItem(scene);
+
+	d3d->CopyResource(target->final_texture.Get(), target->render_texture.Get());
+	d3d->OMSetRenderTargets(1, View.GetAddressOf(), Depth.Get());
+	return target;
+}
 
+void CoreScene::DrawFadeTarget(FadeTarget* target, float factor)
+{
 	CoreD3D* d3d = core_engine_->GetD3D();
+	d3d->UpdateVertexShader(CoreD3DData::VertexHlslType::kBasic2D);
+	d3d->UpdatePixelShader(CoreD3DData::PixelHlslType::kBasic2D);
+
+	UINT buffersize = 0;
+	auto meshData = Geometry::Create2DShow();
+	d3d->ResetMesh(meshData, buffersize);
+	d3d->PSSetShaderResources(0, 1, target->final_view.GetAddressOf());
+	d3d->OpenFadeBlend(factor);
+	d3d->DrawIndexed(buffersize, 0, 0);
+	d3d->CloseAlphaBlend();
+}
+
+IBaseSource* CoreScene::AllocNewSources(SceneItem* scene, std::string name, CoreSceneData::SourceType type)
+{
+	if (scene->source_index.find(name) != scene->source_index.end())
+		return nullptr;
 
 	IBaseSource* source = nullptr;
 	switch (type)
@@ -202,41 +872,85 @@ void CoreScene::AllocNewSources(std::string name, CoreSceneData::SourceType type
 		source = new ImageSource();
 	}
 	break;
+	case CoreSceneData::SourceType::kSourceTestPattern:
+	{
+		source = new TestPatternSource();
+	}
+	break;
 	}
 	if (!source)
-		return;
+		return nullptr;
 
 	source->SetCoreEnv(core_engine_);
 	source->SetSourceName(name.c_str());
 	if (source->Init())
 	{
-		source_list_.push_back(source);
+		scene->source_list.push_back(source);
+		scene->source_index[name] = source;
 	}
 	else
 	{
 		delete source;
 		source = nullptr;
 	}
+	return source;
+}
+
+void CoreScene::UpdateFilterProperty(const std::string& sourcename, const std::string& filtername, const char* json)
+{
+	try
+	{
+		CoreProperty::PropertyBag props;
+		if (props.FromJson(nlohmann::json::parse(json)))
+			UpdateFilterProperty(sourcename, filtername, props);
+	}
+	catch (...)
+	{
+
+	}
 }
 
-void CoreScene::UpdateFilterProperty(std::string sourcename, std::string filtername, const char* json)
+void CoreScene::UpdateFilterProperty(const std::string& sourcename, const std::string& filtername, const CoreProperty::PropertyBag& props)
 {
-	if (!FindNamedSource(sourcename))
+	SceneCommand::CommandBatch batch(1);
+	batch[0].type = SceneCommand::CommandType::kUpdateFilter;
+	batch[0].source = sourcename;
+	batch[0].filter = filtername;
+	batch[0].props = props;
+	PostCommands(std::move(batch));
+}
+
+void CoreScene::UpdateFilterPropertyImpl(IBaseSource* source, const std::string& filtername, const CoreProperty::PropertyBag& props)
+{
+	if (!source)
 		return;
 
-	IBaseSource* source = FindNamedSource(sourcename);
 	CoreFilter* core_filter = source->GetCoreFilter();
 	IBaseFilter* filter = core_filter->GetNamedFilter(filtername);
 	if (!filter)
 		return;
-	filter->Update(json);
+	filter->Update(props);
 }
 
-void CoreScene::UpdateSourceProperty(std::string name, const char* json)
+void CoreScene::UpdateSourceProperty(const std::string& name, const char* json)
 {
-	if (!FindNamedSource(name))
-		return;
+	try
+	{
+		CoreProperty::PropertyBag props;
+		if (props.FromJson(nlohmann::json::parse(json)))
+			UpdateSourceProperty(name, props);
+	}
+	catch (...)
+	{
 
-	IBaseSource* source = FindNamedSource(name);
-	source->UpdateEntry(json);
+	}
+}
+
+void CoreScene::UpdateSourceProperty(const std::string& name, const CoreProperty::PropertyBag& props)
+{
+	SceneCommand::CommandBatch batch(1);
+	batch[0].type = SceneCommand::CommandType::kUpdateSource;
+	batch[0].source = name;
+	batch[0].props = props;
+	PostCommands(std::move(batch));
 }
\ No newline at end of file
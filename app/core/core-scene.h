@@ -4,10 +4,19 @@
 #include "core-component-i.h"
 #include "core-scene-data.h"
 #include "base-source-i.h"
+#include "core-property.h"
+#include "core-scene-command.h"
+#include "mpsc-queue.h"
 #include <map>
 #include <string>
 #include <unordered_map>
 #include <list>
+#include <memory>
+#include <mutex>
+#include <unordered_set>
+#include <vector>
+
+class TaskPool;
 
 class CoreScene : public ICoreComponent
 {
@@ -15,21 +24,124 @@ public:
 	CoreScene();
 	virtual ~CoreScene();
 
+	// 生成默认场景，还没有当前场景时直接切过去
 	void GenerateSources(const char* jsondata);
+	// 从 .tsb 二进制场景文件加载，path 为 UTF-8
+	bool GenerateSourcesBinary(const char* path);
+
+	// 在调用线程创建场景，源在加载线程池里加载，不影响当前场景出帧
+	// 同名场景存在且不是当前/待切换/淡出中的场景时会被替换
+	bool PreloadScene(const std::string& scene, const char* jsondata);
+	bool PreloadSceneBinary(const std::string& scene, const char* path);
+	// 在下一帧开始时生效：等目标场景加载完并预热 (最多 kSwitchWaitNs)，之后只交换指针
+	// fade_ms 不为 0 时旧场景在离屏纹理里继续渲染，按时间淡出
+	bool SwitchScene(const std::string& scene, uint32_t fade_ms = 0);
+	bool RemoveScene(const std::string& scene);
+	// 所有源都加载结束并在渲染线程 Tick 过一次
+	bool IsSceneReady(const std::string& scene);
+	std::string GetCurrentSceneName();
+	// 只在渲染线程调用，从发起切换到淡出结束为 true
+	bool IsSwitching() { return switching_; }
+
+	// 任意线程调用，不会阻塞；整批命令在下一帧 Tick 之前按顺序执行，同一批在同一帧里生效
+	void PostCommands(SceneCommand::CommandBatch&& batch);
+	// 控制端点的一行请求，解析后放进队列，返回一行 JSON 回复
+	std::string ExecuteCommandRequest(const std::string& request);
 
 	void TickSources();
 	void RenderSources();
-	void UpdateSourceProperty(std::string name, const char* json);
-	void UpdateFilterProperty(std::string sourcename, std::string filtername, const char* json);
+	// 以下更新当前场景里的源，都走命令队列；JSON 版本只给外部配置用，运行时更新走 PropertyBag
+	void UpdateSourceProperty(const std::string& name, const char* json);
+	void UpdateSourceProperty(const std::string& name, const CoreProperty::PropertyBag& props);
+	void UpdateFilterProperty(const std::string& sourcename, const std::string& filtername, const char* json);
+	void UpdateFilterProperty(const std::string& sourcename, const std::string& filtername, const CoreProperty::PropertyBag& props);
 
 private:
-	void AllocNewSources(std::string name, CoreSceneData::SourceType type);
-	void GenerateFilters(std::string sourcename, const char* jsondata);
-	void AllocNewFilter(std::string sourcename, std::string filtername, CoreSceneData::FilterType filtertype);
-	IBaseSource* FindNamedSource(std::string sourcename);
+	struct SceneItem
+	{
+		std::string name;
+		// source_list 保持渲染顺序，source_index 用于按名字查找
+		std::list<IBaseSource*> source_list;
+		std::unordered_map<std::string, IBaseSource*> source_index;
+		// 已经在渲染线程 Tick 过的源，切过去的那一帧不用再做第一次上传
+		std::unordered_set<IBaseSource*> prewarmed;
+	};
+
+	// 淡入淡出时旧场景的离屏渲染目标，按视口大小分别保存 (窗口和输出纹理大小不同)
+	struct FadeTarget
+	{
+		ComPtr<ID3D11Texture2D> render_texture;
+		ComPtr<ID3D11RenderTargetView> target_view;
+		ComPtr<ID3D11Texture2D> final_texture;
+		ComPtr<ID3D11ShaderResourceView> final_view;
+		ComPtr<ID3D11Texture2D> depth_stencil_buffer;
+		ComPtr<ID3D11DepthStencilView> depth_stencil_view;
+	};
+
+	bool BuildScene(SceneItem* scene, const char* jsondata);
+	bool BuildSceneBinary(SceneItem* scene, const char* path);
+	bool AddScene(SceneItem* scene);
+	void DestroyScene(SceneItem* scene);
+	bool SwitchSceneImpl(const std::string& scene, uint32_t fade_ms, bool wait_ready);
+	// 调用方持有 scene_mutex_
+	bool SwitchSceneLocked(const std::string& scene, uint32_t fade_ms, bool wait_ready);
+	IBaseSource* AllocNewSources(SceneItem* scene, std::string name, CoreSceneData::SourceType type);
+	void GenerateFilters(IBaseSource* source, const char* jsondata);
+	void AllocNewFilter(IBaseSource* source, std::string filtername, CoreSceneData::FilterType filtertype);
+	void UpdateFilterPropertyImpl(IBaseSource* source, const std::string& filtername, const CoreProperty::PropertyBag& props);
+
+	// 以下只在渲染线程调用
+	void ApplyCommands();
+	// 持有 scene_mutex_ 调用，需要在锁外激活/反激活的源放进 activated/removed
+	void ApplyCommand(SceneCommand::Command& command, std::vector<IBaseSource*>& activated, std::vector<IBaseSource*>& removed);
+	SceneItem* FindCommandScene(const std::string& scene);
+	void ReleaseRetiredSources();
+	void ApplyPendingSwitch();
+	void PrewarmScenes();
+	bool IsSceneSettled(SceneItem* scene);
+	void SetSceneActive(SceneItem* scene, bool active);
+	void TickSceneItem(SceneItem* scene);
+	void RenderSceneItem(SceneItem* scene);
+	bool IsSourceCovered(IBaseSource* source);
+	FadeTarget* RenderFadeTarget(SceneItem* scene);
+	void DrawFadeTarget(FadeTarget* target, float factor);
 
 private:
-	std::list<IBaseSource*> source_list_;
+	// 源的文件读取/解码专用线程池，不和渲染用的共享池抢线程
+	std::unique_ptr<TaskPool> load_pool_;
+
+	// 保护 scenes_ 和 pending_*；current_scene_/fade_scene_ 只由渲染线程修改，修改时也持锁
+	std::mutex scene_mutex_;
+	std::map<std::string, SceneItem*> scenes_;
+	SceneItem* current_scene_ = nullptr;
+	SceneItem* pending_scene_ = nullptr;
+	uint64_t pending_fade_ns_ = 0;
+	uint64_t pending_request_ns_ = 0;
+	bool pending_wait_ready_ = true;
+
+	// 只在渲染线程访问
+	SceneItem* fade_scene_ = nullptr;
+	uint64_t fade_start_ns_ = 0;
+	uint64_t fade_ns_ = 0;
+	bool switching_ = false;
+	std::map<std::pair<int, int>, FadeTarget> fade_targets_;
+	// RenderSceneItem 里复用，按 NDC 坐标保存上层不透明源的区域
+	struct CoverRect
+	{
+		float left;
+		float bottom;
+		float right;
+		float top;
+	};
+	std::vector<CoverRect> cover_rects_;
+	std::vector<IBaseSource*> draw_list_;
+	// TickSceneItem 里复用：这一帧要 Tick 的源，以及其中有 CPU 阶段的源
+	std::vector<IBaseSource*> tick_list_;
+	std::vector<IBaseSource*> prepare_list_;
+
+	MpscQueue<SceneCommand::CommandBatch> command_queue_;
+	// 已经从场景里移除、等加载任务结束后再释放的源，只在渲染线程访问
+	std::vector<IBaseSource*> retired_sources_;
 };
 
 #endif
\ No newline at end of file
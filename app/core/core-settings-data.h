@@ -72,9 +72,22 @@ namespace CoreSettingsData
 		}
 	};
 
+	enum class SyntheticWave
+	{
+		kTone,
+		kNoise,
+	};
+
 	struct Output
 	{
 		bool enable;
+		bool synthetic_audio;
+		// 合成音频的波形、正弦音频率 (Hz)、幅度 (0~1) 和噪声种子，synthetic_audio 开启时生效
+		SyntheticWave synthetic_wave;
+		double synthetic_frequency;
+		float synthetic_level;
+		uint64_t synthetic_seed;
+		bool shared_memory;
 		const char* path;
 		Video video;
 		Audio audio;
@@ -88,6 +101,36 @@ namespace CoreSettingsData
 			output.enable = _enable;
 			return *this;
 		}
+		OutputBuilder& synthetic_audio(bool _synthetic_audio)
+		{
+			output.synthetic_audio = _synthetic_audio;
+			return *this;
+		}
+		OutputBuilder& synthetic_wave(SyntheticWave _synthetic_wave)
+		{
+			output.synthetic_wave = _synthetic_wave;
+			return *this;
+		}
+		OutputBuilder& synthetic_frequency(double _synthetic_frequency)
+		{
+			output.synthetic_frequency = _synthetic_frequency;
+			return *this;
+		}
+		OutputBuilder& synthetic_level(float _synthetic_level)
+		{
+			output.synthetic_level = _synthetic_level;
+			return *this;
+		}
+		OutputBuilder& synthetic_seed(uint64_t _synthetic_seed)
+		{
+			output.synthetic_seed = _synthetic_seed;
+			return *this;
+		}
+		OutputBuilder& shared_memory(bool _shared_memory)
+		{
+			output.shared_memory = _shared_memory;
+			return *this;
+		}
 		OutputBuilder& path(const char* _path)
 		{
 			output.path = _path;
@@ -27,6 +27,12 @@ void CoreSettings::UpdateGlobalOutput(const CoreSettingsData::Output* output)
 	std::unique_lock<std::mutex> lock(global_param_mutex_);
 	output_path_ = std::string(output->path);
 	global_output_.enable = output->enable;
+	global_output_.synthetic_audio = output->synthetic_audio;
+	global_output_.synthetic_wave = output->synthetic_wave;
+	global_output_.synthetic_frequency = output->synthetic_frequency;
+	global_output_.synthetic_level = output->synthetic_level;
+	global_output_.synthetic_seed = output->synthetic_seed;
+	global_output_.shared_memory = output->shared_memory;
 	global_output_.path = output_path_.c_str();
 	memcpy(&global_output_.video, &output->video, sizeof(CoreSettingsData::Video));
 	memcpy(&global_output_.audio, &output->audio, sizeof(CoreSettingsData::Audio));
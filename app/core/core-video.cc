@@ -67,6 +67,7 @@ void CoreVideo::GraphicsThreadImpl()
 	uint64_t last_ns = os_gettime_ns();
 	uint64_t start_ns = last_ns;
 	intervalns = util_mul_div64(1000000000ULL, 1, fps);
+	frame_interval_ns_.store(intervalns);
 
 	uint64_t last_metric_ns = last_ns;
 	int frame_cnt = 0;
@@ -85,6 +86,7 @@ void CoreVideo::GraphicsThreadImpl()
 
 		UpdateFpsText();
 
+		d3d->NextFrame();
 		scene->TickSources();
 
 		RenderOutputImpl(timestamp, count);
@@ -93,7 +95,13 @@ void CoreVideo::GraphicsThreadImpl()
 
 		frame_cnt += 1;
 
-		render_cost_ += (os_gettime_ns() - last_ns);
+		uint64_t frame_cost = os_gettime_ns() - last_ns;
+		render_cost_ += frame_cost;
+		UpdateSwitchMetric(frame_cost, intervalns);
+		render_cost_ns_ += frame_cost;
+		if (frame_cost > intervalns)
+			render_late_frames_++;
+		render_frames_++;
 
 		uint64_t cur_ns = os_gettime_ns();
 		uint64_t past = cur_ns - last_ns;
@@ -112,6 +120,9 @@ void CoreVideo::GraphicsThreadImpl()
 		if (last_ns - last_metric_ns >= 1000000000ULL)
 		{
 			LOGGER_INFO("[Graphics] frame num:%d render cost:%lld avg render:%f", frame_cnt, render_cost_, render_cost_ / frame_cnt / 1000000.0);
+			FilterChain::Counters counters;
+			d3d->TakeFilterCounters(counters);
+			LOGGER_INFO("[Graphics] filter passes:%lld reused:%lld copies:%lld", counters.passes, counters.reused, counters.copies);
 			last_frame_cnt_.store(frame_cnt);
 			last_metric_ns = last_ns;
 			frame_cnt = 0;
@@ -120,17 +131,54 @@ void CoreVideo::GraphicsThreadImpl()
 	}
 }
 
+CoreVideo::RenderCounters CoreVideo::GetRenderCounters()
+{
+	RenderCounters counters;
+	counters.frames = render_frames_.load();
+	counters.late_frames = render_late_frames_.load();
+	counters.cost_ns = render_cost_ns_.load();
+	counters.interval_ns = frame_interval_ns_.load();
+	return counters;
+}
+
 void CoreVideo::UpdateFpsText()
 {
-	std::wstring_convert<std::codecvt_utf8<wchar_t>> cv;
-	std::wstring text_1 = L"fps:";
-	text_1 += std::to_wstring(last_frame_cnt_.load());
-	nlohmann::json json = {
-		{"text", cv.to_bytes(text_1)}
-	};
+	// 帧率一秒才变一次，没变化就不用更新
+	uint64_t fps = last_frame_cnt_.load();
+	if (fps == last_fps_text_)
+		return;
+	last_fps_text_ = fps;
+
+	std::string text = "fps:" + std::to_string(fps);
+	fps_text_props_.Clear();
+	fps_text_props_.SetString(CoreProperty::PropertyId::kText, text);
+
+	CoreScene* scene = core_engine_->GetScene();
+	scene->UpdateSourceProperty("text_fps", fps_text_props_);
+}
 
+void CoreVideo::UpdateSwitchMetric(uint64_t frame_cost, uint64_t intervalns)
+{
 	CoreScene* scene = core_engine_->GetScene();
-	scene->UpdateSourceProperty("text_fps", json.dump().c_str());
+	if (scene->IsSwitching())
+	{
+		switch_frame_cnt_ += 1;
+		switch_cost_total_ += frame_cost;
+		if (frame_cost > switch_cost_max_)
+			switch_cost_max_ = frame_cost;
+		if (frame_cost > intervalns)
+			switch_over_budget_cnt_ += 1;
+		return;
+	}
+	if (!switch_frame_cnt_)
+		return;
+
+	LOGGER_INFO("[Graphics] scene switch frames:%d avg render:%f max render:%f over budget:%d", switch_frame_cnt_,
+		switch_cost_total_ / switch_frame_cnt_ / 1000000.0, switch_cost_max_ / 1000000.0, switch_over_budget_cnt_);
+	switch_frame_cnt_ = 0;
+	switch_over_budget_cnt_ = 0;
+	switch_cost_total_ = 0;
+	switch_cost_max_ = 0;
 }
 
 void CoreVideo::RenderOutputImpl(uint64_t timestamp, uint64_t count)
@@ -3,6 +3,7 @@
 
 #include "core-component-i.h"
 #include "core-video-data.h"
+#include "core-property.h"
 #include <thread>
 #include <atomic>
 #include <functional>
@@ -24,10 +25,21 @@ public:
 	uint64_t GetCaptureStartTs() { return video_capture_start_ts_.load(); }
 	uint64_t GetLastFrameCnt() { return last_frame_cnt_.load(); }
 
+	// 渲染线程累计的帧数、超出帧间隔的帧数和渲染耗时，检测频率调节按这些算渲染的余量
+	struct RenderCounters
+	{
+		uint64_t frames = 0;
+		uint64_t late_frames = 0;
+		uint64_t cost_ns = 0;
+		uint64_t interval_ns = 0;
+	};
+	RenderCounters GetRenderCounters();
+
 private:
 	void GraphicsThreadImpl();
 	void RenderOutputImpl(uint64_t timestamp, uint64_t count);
 	void UpdateFpsText();
+	void UpdateSwitchMetric(uint64_t frame_cost, uint64_t intervalns);
 
 private:
 	std::thread graphics_thread_;
@@ -38,6 +50,19 @@ private:
 
 	std::atomic<uint64_t> video_capture_start_ts_;
 	std::atomic<uint64_t> last_frame_cnt_;
+	std::atomic<uint64_t> render_frames_{ 0 };
+	std::atomic<uint64_t> render_late_frames_{ 0 };
+	std::atomic<uint64_t> render_cost_ns_{ 0 };
+	std::atomic<uint64_t> frame_interval_ns_{ 0 };
+
+	// 只在渲染线程访问
+	uint64_t last_fps_text_ = (uint64_t)-1;
+	CoreProperty::PropertyBag fps_text_props_;
+	// 场景切换期间的帧耗时，切换结束时输出一次
+	int switch_frame_cnt_ = 0;
+	int switch_over_budget_cnt_ = 0;
+	uint64_t switch_cost_total_ = 0;
+	uint64_t switch_cost_max_ = 0;
 
 
 };
@@ -0,0 +1,106 @@
+/* 场景 JSON 和 .tsb 二进制场景互转
+* scene-convert <input.json> <output.tsb>
+* scene-convert <input.tsb> <output.json>
+* 按输入文件的头 4 字节判断方向，转换后会再读回来比较，保证无损
+*/
+
+#include "core-scene-binary.h"
+#include <stdio.h>
+#include <string.h>
+#include <fstream>
+#include <sstream>
+
+static bool ReadFile(const char* path, std::string& data)
+{
+	std::ifstream file(path, std::ios::binary);
+	if (!file)
+		return false;
+	std::stringstream ss;
+	ss << file.rdbuf();
+	data = ss.str();
+	return true;
+}
+
+static bool WriteFile(const char* path, const void* data, size_t size)
+{
+	FILE* file = fopen(path, "wb");
+	if (!file)
+		return false;
+	bool ret = fwrite(data, 1, size, file) == size;
+	fclose(file);
+	return ret;
+}
+
+int main(int argc, char* argv[])
+{
+	if (argc < 3)
+	{
+		fprintf(stderr, "usage: scene-convert <input.json|input.tsb> <output>\n");
+		return 1;
+	}
+
+	std::string input;
+	if (!ReadFile(argv[1], input))
+	{
+		fprintf(stderr, "read %s failed\n", argv[1]);
+		return 1;
+	}
+
+	uint32_t magic = 0;
+	if (input.size() >= sizeof(magic))
+		memcpy(&magic, input.data(), sizeof(magic));
+
+	if (magic == SceneBinary::kMagic)
+	{
+		SceneBinary::SceneFile file;
+		nlohmann::json scene;
+		if (!file.Open(argv[1]) || !SceneBinary::BinaryToJson(file.GetView(), scene))
+		{
+			fprintf(stderr, "invalid binary scene %s\n", argv[1]);
+			return 1;
+		}
+		std::string output = scene.dump(4);
+		if (!WriteFile(argv[2], output.data(), output.size()))
+		{
+			fprintf(stderr, "write %s failed\n", argv[2]);
+			return 1;
+		}
+		printf("%u sources -> %s\n", file.GetView().GetSourceCount(), argv[2]);
+		return 0;
+	}
+
+	nlohmann::json scene;
+	try
+	{
+		scene = nlohmann::json::parse(input);
+	}
+	catch (const std::exception& e)
+	{
+		fprintf(stderr, "parse %s failed: %s\n", argv[1], e.what());
+		return 1;
+	}
+
+	std::vector<uint8_t> binary;
+	std::string error;
+	if (!SceneBinary::JsonToBinary(scene, binary, &error))
+	{
+		fprintf(stderr, "convert failed: %s\n", error.c_str());
+		return 1;
+	}
+
+	SceneBinary::SceneView view;
+	nlohmann::json check;
+	if (!view.Attach(binary.data(), binary.size()) || !SceneBinary::BinaryToJson(view, check) || check != scene)
+	{
+		fprintf(stderr, "round trip mismatch\n");
+		return 1;
+	}
+
+	if (!WriteFile(argv[2], binary.data(), binary.size()))
+	{
+		fprintf(stderr, "write %s failed\n", argv[2]);
+		return 1;
+	}
+	printf("%u sources, %zu bytes json -> %zu bytes %s\n", view.GetSourceCount(), input.size(), binary.size(), argv[2]);
+	return 0;
+}
@@ -0,0 +1,98 @@
+/* 给运行中的 TinyStudio 发场景命令
+* scene-ctl [--endpoint <pipe|socket>] [requests.jsonl]
+* 每行一个请求 (格式见 core-scene-command.h)，不给文件时从标准输入读，每个请求打印一行回复
+* 发送前先在本地解析一遍，格式不对的行不发
+* scene-ctl [--endpoint <pipe|socket>] --profile [--reset]
+* 打印各源/滤镜的耗时统计 (JSON)，--reset 在取出后清零
+*/
+
+#include "control-server.h"
+#include "core-scene-command.h"
+#include <stdio.h>
+#include <string.h>
+#include <fstream>
+#include <iostream>
+
+int main(int argc, char* argv[])
+{
+	const char* endpoint = ControlServer::DefaultEndpoint();
+	const char* path = nullptr;
+	bool profile = false;
+	bool reset = false;
+	for (int i = 1; i < argc; i++)
+	{
+		if (strcmp(argv[i], "--endpoint") == 0 && i + 1 < argc)
+			endpoint = argv[++i];
+		else if (strcmp(argv[i], "--profile") == 0)
+			profile = true;
+		else if (strcmp(argv[i], "--reset") == 0)
+			reset = true;
+		else if (argv[i][0] == '-')
+		{
+			fprintf(stderr, "usage: scene-ctl [--endpoint <pipe|socket>] [requests.jsonl]\n"
+				"       scene-ctl [--endpoint <pipe|socket>] --profile [--reset]\n");
+			return 1;
+		}
+		else
+			path = argv[i];
+	}
+
+	std::ifstream file;
+	if (path)
+	{
+		file.open(path, std::ios::binary);
+		if (!file)
+		{
+			fprintf(stderr, "open %s failed\n", path);
+			return 1;
+		}
+	}
+	std::istream& input = path ? file : std::cin;
+
+	ControlClient client;
+	if (!client.Connect(endpoint))
+	{
+		fprintf(stderr, "connect %s failed\n", endpoint);
+		return 1;
+	}
+
+	if (profile)
+	{
+		std::string reply;
+		if (!client.Request(reset ? "{\"op\":\"profile\",\"reset\":true}" : "{\"op\":\"profile\"}", reply))
+		{
+			fprintf(stderr, "connection closed\n");
+			return 1;
+		}
+		printf("%s\n", reply.c_str());
+		return 0;
+	}
+
+	int failed = 0;
+	std::string line;
+	while (std::getline(input, line))
+	{
+		if (!line.empty() && line.back() == '\r')
+			line.pop_back();
+		if (line.empty())
+			continue;
+
+		SceneCommand::CommandBatch batch;
+		std::string error;
+		if (!SceneCommand::ParseCommandBatch(line.c_str(), line.size(), batch, &error))
+		{
+			fprintf(stderr, "skip invalid request: %s\n", error.c_str());
+			failed++;
+			continue;
+		}
+
+		std::string reply;
+		if (!client.Request(line, reply))
+		{
+			fprintf(stderr, "connection closed\n");
+			return 1;
+		}
+		printf("%s\n", reply.c_str());
+	}
+	return failed ? 1 : 0;
+}
@@ -1,6 +1,7 @@
 #ifndef AI_DETECT_DEFINE_H
 #define AI_DETECT_DEFINE_H
 
+#include <stdint.h>
 #include <vector>
 #include <string>
 
@@ -18,20 +19,40 @@ namespace AiDetect
 		KAiDetectFace = 0,
 	};
 
+	// 取结果时怎么和当前画面对齐
+	enum AiDetectAlignMode
+	{
+		// 最新的结果，会比画面晚一个检测延迟
+		KAiDetectAlignLatest = 0,
+		// 画面已经按检测延迟推迟显示：取帧时间不晚于给定时间的最新结果
+		KAiDetectAlignDelay,
+		// 按最近两次结果的速度把框推算到给定时间
+		KAiDetectAlignExtrapolate,
+	};
+
 	struct AiDetectInput
 	{
 		AiDetectType detectType;
 		AiDetectThreadType threadType;
 		int detectFrameRate;
+		// 两次检测之间用跟踪器推算结果，检测频率可以设得很低
+		bool track = false;
+		// 共享调度器里的优先级，越大越优先
+		int priority = 0;
+		// 整幅检测切块，借共享检测调度器空闲的名额并行，单次检测延迟更低，总的 CPU 占用略高
+		bool tiled = false;
 		AiDetectInput()
 		{
 
 		}
-		AiDetectInput(AiDetectType detecttype, AiDetectThreadType threadtype, int framerate)
+		AiDetectInput(AiDetectType detecttype, AiDetectThreadType threadtype, int framerate, bool enabletrack = false, int schedulepriority = 0, bool enabletiled = false)
 		{
 			detectType = detecttype;
 			threadType = threadtype;
 			detectFrameRate = framerate;
+			track = enabletrack;
+			priority = schedulepriority;
+			tiled = enabletiled;
 		}
 	};
 
@@ -95,6 +116,8 @@ namespace AiDetect
 	struct AiDetectResult
 	{
 		AiDetectType detectType = AiDetectType::KAiDetectFace;
+		// 结果对应的源帧时间，steady_clock 纳秒；0 表示还没有结果
+		int64_t timestamp = 0;
 
 		FaceInfo faceResult;
 
@@ -122,6 +145,7 @@ namespace AiDetect
 		AiDetectResult& operator=(AiDetectResult const& other)
 		{
 			detectType = other.detectType;
+			timestamp = other.timestamp;
 			switch (detectType)
 			{
 			case KAiDetectFace:
@@ -140,6 +164,7 @@ namespace AiDetect
 		AiDetectResult(const AiDetectResult& other)
 		{
 			detectType = other.detectType;
+			timestamp = other.timestamp;
 			switch (detectType)
 			{
 			case KAiDetectFace:
@@ -1,5 +1,6 @@
 #include "ai-detect-item-i.h"
 #include "logger.h"
+#include <algorithm>
 
 IAiDetectItem::IAiDetectItem()
 {
@@ -15,12 +16,13 @@ void IAiDetectItem::UpdateDetectFrameRate(int frameRate)
 {
 	if (!frameRate)
 		return;
-	detect_frame_rate_ = frameRate;
-	detect_interval_ms_ = 1000.0 / detect_frame_rate_;
+	detect_frame_rate_.store(frameRate);
+	detect_interval_ms_.store((int)(1000.0 / frameRate));
 }
 
-void IAiDetectItem::InputBgraRawPixelData(uint8_t* data, size_t size, size_t width, size_t height)
+void IAiDetectItem::InputBgraRawPixelData(uint8_t* data, size_t size, size_t width, size_t height, int64_t timestamp)
 {
+	frame_timestamp_ = timestamp;
 	bool bCallDetect = false;
 	std::chrono::system_clock::time_point nowTime = std::chrono::system_clock::now();
 	if (!time_interval_.bStarted)
@@ -32,7 +34,9 @@ void IAiDetectItem::InputBgraRawPixelData(uint8_t* data, size_t size, size_t wid
 
 	int ms = std::chrono::duration_cast<std::chrono::milliseconds>(nowTime - time_interval_.lastDetectTime).count();
 
-	if (ms >= detect_interval_ms_ && !IsCurDetecting())
+	// 跟踪丢了就提前检测，但不快于 kMinRedetectMs
+	bool bNeedDetect = ms >= detect_interval_ms_ || (track_enabled_ && ms >= kMinRedetectMs && NeedsDetection());
+	if (bNeedDetect && !IsCurDetecting())
 	{
 		time_interval_.lastDetectTime = nowTime;
 		time_interval_.detectBeginTime = nowTime;
@@ -40,13 +44,23 @@ void IAiDetectItem::InputBgraRawPixelData(uint8_t* data, size_t size, size_t wid
 	}
 	if (bCallDetect)
 	{
+		std::chrono::steady_clock::time_point begin = std::chrono::steady_clock::now();
+		parallel_wall_ns_ = 0;
+		parallel_cpu_ns_ = 0;
 		InputBgraRawPixelDataImpl(data, size, width, height);
+		uint64_t ns = (uint64_t)std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - begin).count();
+		// 并行的部分换成各线程的耗时之和，频率调节按它估算检测占的 CPU
+		ns = ns - std::min(ns, parallel_wall_ns_) + parallel_cpu_ns_;
+		detect_ns_ += ns;
+		detect_count_++;
 		std::chrono::system_clock::time_point endTime = std::chrono::system_clock::now();
 		time_interval_.totalDetectTime += std::chrono::duration_cast<std::chrono::milliseconds>(endTime - time_interval_.detectBeginTime).count();
 		time_interval_.totalDetectCnt += 1;
 	}
-	else
+	else if (track_enabled_ && !IsCurDetecting())
 	{
+		if (TrackBgraRawPixelDataImpl(data, size, width, height))
+			time_interval_.totalTrackCnt += 1;
 	}
 
 	if (std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::system_clock::now() - time_interval_.dateCollectTime).count() >= 1000)
@@ -56,16 +70,21 @@ void IAiDetectItem::InputBgraRawPixelData(uint8_t* data, size_t size, size_t wid
 		if (time_interval_.totalDetectCnt)
 			time_interval_.avgDetectTime = (float)time_interval_.totalDetectTime / (float)time_interval_.totalDetectCnt;
 
-		LOGGER_INFO ("cnt:%lld ,time:%lldms, avg:%fms", time_interval_.totalDetectCnt, time_interval_.totalDetectTime, time_interval_.avgDetectTime);
+		LOGGER_INFO ("cnt:%lld ,time:%lldms, avg:%fms, track:%lld", time_interval_.totalDetectCnt, time_interval_.totalDetectTime, time_interval_.avgDetectTime, time_interval_.totalTrackCnt);
 
 		time_interval_.totalDetectCnt = 0;
+		time_interval_.totalTrackCnt = 0;
 		time_interval_.totalDetectTime = 0;
 		time_interval_.avgDetectTime = 0;
 	}
 }
 
-void IAiDetectItem::GetOutputDetectResult(AiDetect::AiDetectResult& result)
+void IAiDetectItem::GetOutputDetectResult(AiDetect::AiDetectResult& result, int64_t time, AiDetect::AiDetectAlignMode mode)
 {
-	GetOutputDetectResultImpl(result);
+	GetOutputDetectResultImpl(latest_result_);
+	if (history_.Push(latest_result_))
+		latency_.Record(time - latest_result_.timestamp);
+	if (!history_.Get(time, mode, result))
+		result = latest_result_;
 }
 
@@ -2,9 +2,13 @@
 #define AI_DETECT_ITEM_I_H
 
 #include "ai-detect-define.h"
+#include "detect-result-history.h"
 #include <vector>
 #include <string>
 #include <chrono>
+#include <atomic>
+
+class DetectScheduler;
 
 class IAiDetectItem
 {
@@ -17,6 +21,7 @@ class IAiDetectItem
 		std::chrono::system_clock::time_point dateCollectTime;
 		int64_t totalDetectTime = 0;
 		int64_t totalDetectCnt = 0;
+		int64_t totalTrackCnt = 0;
 		float avgDetectTime = 0.0f;
 	};
 
@@ -24,20 +29,55 @@ public:
 	IAiDetectItem();
 	virtual ~IAiDetectItem();
 	
+	// 可以在渲染线程上随时调整，下一次判断是否检测时生效
 	void UpdateDetectFrameRate(int frameRate);
-	void InputBgraRawPixelData(uint8_t* data, size_t size, size_t width, size_t height);
-	void GetOutputDetectResult(AiDetect::AiDetectResult& result);
+	int GetDetectFrameRate() const { return detect_frame_rate_.load(); }
+	// 累计的检测次数和耗时 (纳秒)，任意线程都能读，调用方自己做差
+	void GetDetectCost(uint64_t& count, uint64_t& ns) const { count = detect_count_.load(); ns = detect_ns_.load(); }
+	void EnableTracking(bool enable) { track_enabled_ = enable; }
+	// 整幅检测切块，借 scheduler 空闲的名额在它的切块线程池上并行；为空时单线程整幅检测。随时可以改，下一次检测生效
+	void EnableTiling(DetectScheduler* scheduler) { tile_scheduler_.store(scheduler); }
+	// timestamp 为源帧时间 (steady_clock 纳秒)，写进这一帧的结果
+	void InputBgraRawPixelData(uint8_t* data, size_t size, size_t width, size_t height, int64_t timestamp);
+	// 渲染线程调用，time 为当前画面的时间；新结果第一次取到时记一次检测到显示的延迟
+	void GetOutputDetectResult(AiDetect::AiDetectResult& result, int64_t time, AiDetect::AiDetectAlignMode mode);
+	const LatencyHistogram& GetLatencyHistogram() const { return latency_; }
 	virtual bool IsCurDetecting() = 0;
 
 protected:
+	int64_t GetFrameTimestamp() const { return frame_timestamp_; }
+	DetectScheduler* GetTileScheduler() const { return tile_scheduler_.load(); }
+	// 检测里并行的部分：wall_ns 为调用线程等待的时间，cpu_ns 为各线程实际干活的时间之和；检测耗时按后者算
+	void AddParallelWork(uint64_t wall_ns, uint64_t cpu_ns) { parallel_wall_ns_ += wall_ns; parallel_cpu_ns_ += cpu_ns; }
+
 	virtual void InputBgraRawPixelDataImpl(uint8_t* data, size_t size, size_t width, size_t height) = 0;
 	virtual void GetOutputDetectResultImpl(AiDetect::AiDetectResult& result) = 0;
+	// 不检测的帧用跟踪器更新结果，不支持跟踪的返回 false
+	virtual bool TrackBgraRawPixelDataImpl(uint8_t* data, size_t size, size_t width, size_t height) { return false; }
+	// 跟踪置信度下降，需要提前检测
+	virtual bool NeedsDetection() { return false; }
 
 private:
-	int detect_frame_rate_ = 15;
-	int detect_interval_ms_ = 66;
+	// 跟踪丢失触发的重新检测的最小间隔
+	static const int kMinRedetectMs = 33;
+
+	std::atomic<int> detect_frame_rate_{ 15 };
+	std::atomic<int> detect_interval_ms_{ 66 };
+	std::atomic<uint64_t> detect_count_{ 0 };
+	std::atomic<uint64_t> detect_ns_{ 0 };
+	bool track_enabled_ = false;
+	std::atomic<DetectScheduler*> tile_scheduler_{ nullptr };
+	// 只在检测线程上访问，每次检测前清零
+	uint64_t parallel_wall_ns_ = 0;
+	uint64_t parallel_cpu_ns_ = 0;
 
 	DetectTimeInterval time_interval_;
+	int64_t frame_timestamp_ = 0;
+
+	// 以下只在渲染线程访问
+	AiDetect::AiDetectResult latest_result_;
+	DetectResultHistory history_;
+	LatencyHistogram latency_;
 };
 
 #endif
\ No newline at end of file
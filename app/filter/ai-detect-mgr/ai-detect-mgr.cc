@@ -1,5 +1,6 @@
 #include "ai-detect-mgr.h"
 #include "item-face-cnn.h"
+#include "logger.h"
 
 AiDetectMgr::AiDetectMgr()
 {
@@ -8,25 +9,19 @@ AiDetectMgr::AiDetectMgr()
 
 AiDetectMgr::~AiDetectMgr()
 {
-	for (auto& c = render_thread_detect_vec_.begin(); c != render_thread_detect_vec_.end();)
+	for (auto c = render_thread_detect_vec_.begin(); c != render_thread_detect_vec_.end();)
 	{
 		IAiDetectItem* item = *c;
 		c = render_thread_detect_vec_.erase(c);
 		delete item;
 		item = nullptr;
 	}
-	for (auto& c = independ_thread_detect_vec_.begin(); c != independ_thread_detect_vec_.end();)
+	// 先从调度器注销，正在跑的检测结束后才删检测项
+	for (auto c = independ_thread_detect_vec_.begin(); c != independ_thread_detect_vec_.end();)
 	{
 		ThreadDetectItem* item = *c;
 		c = independ_thread_detect_vec_.erase(c);
-		{
-			std::unique_lock<std::mutex> lock(item->mutex);
-			item->bFinish = true;
-		}
-		item->cond.notify_one();
-		item->thread->join();
-		delete item->thread;
-		item->thread = nullptr;
+		scheduler_->Unregister(item->client);
 		delete item->detectItem;
 		item->detectItem = nullptr;
 		delete item;
@@ -52,6 +47,9 @@ void AiDetectMgr::InitAiDetectMgr(const std::vector< AiDetect::AiDetectInput >&
 			continue;
 
 		item->UpdateDetectFrameRate(c.detectFrameRate);
+		item->EnableTracking(c.track);
+		if (c.tiled)
+			item->EnableTiling(DetectScheduler::GetShared());
 
 		switch (c.threadType)
 		{
@@ -62,78 +60,157 @@ void AiDetectMgr::InitAiDetectMgr(const std::vector< AiDetect::AiDetectInput >&
 		break;
 		case AiDetect::AiDetectThreadType::KAiDetectIndependThread:
 		{
+			if (!scheduler_)
+				scheduler_ = DetectScheduler::GetShared();
 			ThreadDetectItem* threadItem = new ThreadDetectItem();
 			threadItem->detectItem = item;
-			threadItem->thread = new std::thread(&AiDetectMgr::ThreadDetectImpl, this, threadItem);
+			threadItem->index = independ_thread_detect_vec_.size();
+			threadItem->client = scheduler_->Register(c.priority);
 			independ_thread_detect_vec_.push_back(threadItem);
 		}
 		break;
 		}
 	}
+
+	// 消费者数量确定后再建信箱
+	mailbox_.reset(new FrameMailbox(independ_thread_detect_vec_.size()));
+	stats_time_ = std::chrono::steady_clock::now();
 }
 
-void AiDetectMgr::ThreadDetectImpl(ThreadDetectItem* item)
+void AiDetectMgr::DetectPending(ThreadDetectItem* item)
 {
-	ThreadDetectItem* instance = item;
-	for (;;) {
-		ThreadDetectData data;
-		std::unique_lock<std::mutex> lock(instance->mutex);
-
-		instance->cond.wait(lock, [&] {
-			return !instance->data.empty() || instance->bFinish;
-			});
-		if (instance->bFinish && instance->data.empty())
-			break;
-
-		data = instance->data.front();
-		instance->data.pop_front();
-
-		instance->detectItem->InputBgraRawPixelData(data.data, data.size, data.width, data.height);
+	// 任务排队期间可能来了更新的帧，信箱里始终是最新的
+	FrameMailbox::FramePtr frame = mailbox_->TryTake(item->index);
+	if (!frame)
+		return;
+	item->detectItem->InputBgraRawPixelData((uint8_t*)frame->data.data(), frame->data.size(), frame->width, frame->height, frame->timestamp);
+}
 
-		free(data.data);
-		data.data = nullptr;
-	}
+std::shared_ptr<FrameMailbox::Frame> AiDetectMgr::AcquireFrame(size_t width, size_t height)
+{
+	if (!mailbox_)
+		return nullptr;
+	std::shared_ptr<FrameMailbox::Frame> frame = mailbox_->Acquire(width * height * 4);
+	frame->width = width;
+	frame->height = height;
+	frame->linesize = width * 4;
+	return frame;
 }
 
-void AiDetectMgr::InputBgraRawPixelData(uint8_t* data, size_t size, size_t width, size_t height)
+void AiDetectMgr::InputFrame(std::shared_ptr<FrameMailbox::Frame> frame)
 {
+	if (!frame || !mailbox_)
+		return;
+	// 生产者没给帧时间就用交进来的时间
+	if (!frame->timestamp)
+		frame->timestamp = std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+
 	for (const auto& c : render_thread_detect_vec_)
 	{
-		c->InputBgraRawPixelData(data, size, width, height);
+		c->InputBgraRawPixelData(frame->data.data(), frame->data.size(), frame->width, frame->height, frame->timestamp);
 	}
 
+	if (independ_thread_detect_vec_.empty())
+		return;
+	mailbox_->Publish(std::move(frame));
 	for (const auto& c : independ_thread_detect_vec_)
 	{
-		if (c->detectItem->IsCurDetecting())
-			continue;
+		ThreadDetectItem* item = c;
+		scheduler_->Submit(item->client, [this, item]() { DetectPending(item); });
+	}
+	LogScheduleStats();
+}
+
+void AiDetectMgr::LogScheduleStats()
+{
+	std::chrono::steady_clock::time_point now = std::chrono::steady_clock::now();
+	if (std::chrono::duration_cast<std::chrono::milliseconds>(now - stats_time_).count() < 1000)
+		return;
+	stats_time_ = now;
 
-		ThreadDetectData threaddata;
-		threaddata.data = (uint8_t*)malloc(size);
-		memset(threaddata.data, 0, size);
-		memcpy_s(threaddata.data, size, data, size);
-		threaddata.size = size;
-		threaddata.width = width;
-		threaddata.height = height;
-
-		std::unique_lock<std::mutex> lock(c->mutex);
-		c->data.push_back(threaddata);
-		c->cond.notify_one();
+	LatencyHistogram latency = GetLatencyHistogram();
+	LOGGER_INFO("detect to display latency count:%llu mean:%.1fms p50:%.0fms p95:%.0fms", latency.GetCount(),
+		latency.GetMeanMs(), latency.GetPercentileMs(50.0), latency.GetPercentileMs(95.0));
+
+	DetectScheduler::Stats stats = scheduler_->GetStats();
+	for (const auto& c : independ_thread_detect_vec_)
+	{
+		DetectScheduler::WaitStats wait = scheduler_->GetClientStats(c->client);
+		LOGGER_INFO("client:%d run:%llu coalesced:%llu wait avg:%.2fms max:%.2fms, workers:%zu clients:%zu queue:%zu max queue:%zu",
+			c->client, wait.run, wait.coalesced, wait.AvgWaitMs(), wait.MaxWaitMs(),
+			stats.workers, stats.clients, stats.queue_depth, stats.max_queue_depth);
 	}
 }
 
-void AiDetectMgr::GetOutputDetectResult(std::vector< AiDetect::AiDetectResult >& resultVec)
+void AiDetectMgr::GetOutputDetectResult(std::vector< AiDetect::AiDetectResult >& resultVec, int64_t time, AiDetect::AiDetectAlignMode mode)
 {
 	resultVec.clear();
 	for (const auto& c : render_thread_detect_vec_)
 	{
 		AiDetect::AiDetectResult result;
-		c->GetOutputDetectResult(result);
+		c->GetOutputDetectResult(result, time, mode);
 		resultVec.push_back(result);
 	}
 	for (const auto& c : independ_thread_detect_vec_)
 	{
 		AiDetect::AiDetectResult result;
-		c->detectItem->GetOutputDetectResult(result);
+		c->detectItem->GetOutputDetectResult(result, time, mode);
 		resultVec.push_back(result);
 	}
+}
+
+LatencyHistogram AiDetectMgr::GetLatencyHistogram()
+{
+	LatencyHistogram histogram;
+	for (const auto& c : render_thread_detect_vec_)
+		histogram.Merge(c->GetLatencyHistogram());
+	for (const auto& c : independ_thread_detect_vec_)
+		histogram.Merge(c->detectItem->GetLatencyHistogram());
+	return histogram;
+}
+
+void AiDetectMgr::UpdateDetectFrameRate(int frameRate)
+{
+	for (const auto& c : render_thread_detect_vec_)
+		c->UpdateDetectFrameRate(frameRate);
+	for (const auto& c : independ_thread_detect_vec_)
+		c->detectItem->UpdateDetectFrameRate(frameRate);
+}
+
+void AiDetectMgr::EnableTiling(bool enable)
+{
+	DetectScheduler* scheduler = enable ? DetectScheduler::GetShared() : nullptr;
+	for (const auto& c : render_thread_detect_vec_)
+		c->EnableTiling(scheduler);
+	for (const auto& c : independ_thread_detect_vec_)
+		c->detectItem->EnableTiling(scheduler);
+}
+
+void AiDetectMgr::GetDetectCost(uint64_t& count, uint64_t& ns)
+{
+	count = 0;
+	ns = 0;
+	auto add = [&](const IAiDetectItem* item) {
+		uint64_t item_count = 0, item_ns = 0;
+		item->GetDetectCost(item_count, item_ns);
+		count += item_count;
+		ns += item_ns;
+	};
+	for (const auto& c : render_thread_detect_vec_)
+		add(c);
+	for (const auto& c : independ_thread_detect_vec_)
+		add(c->detectItem);
+}
+
+void AiDetectMgr::DropPendingData()
+{
+	if (mailbox_)
+		mailbox_->Drop();
+	for (const auto& c : independ_thread_detect_vec_)
+		scheduler_->Cancel(c->client);
+}
+
+uint64_t AiDetectMgr::GetDroppedFrameCount()
+{
+	return mailbox_ ? mailbox_->GetStats().dropped : 0;
 }
\ No newline at end of file
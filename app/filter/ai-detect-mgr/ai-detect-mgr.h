@@ -4,29 +4,21 @@
 #include "ai-detect-define.h"
 #include <vector>
 #include <string>
-#include <thread>
-#include <condition_variable>
-#include <list>
+#include <memory>
+#include <chrono>
 #include "ai-detect-item-i.h"
+#include "frame-mailbox.h"
+#include "detect-scheduler.h"
 
 class AiDetectMgr
 {
-	struct ThreadDetectData
-	{
-		uint8_t* data = nullptr;
-		size_t size;
-		size_t width;
-		size_t height;
-	};
-
 	struct ThreadDetectItem
 	{
-		std::mutex mutex;
-		std::condition_variable cond;
-		bool bFinish = false;
-		std::thread* thread = nullptr;
 		IAiDetectItem* detectItem = nullptr;
-		std::list<struct ThreadDetectData> data;
+		// 在信箱里的消费者编号
+		size_t index = 0;
+		// 在共享调度器里的客户端编号
+		int client = 0;
 	};
 
 public:
@@ -34,15 +26,35 @@ public:
 	~AiDetectMgr();
 
 	void InitAiDetectMgr(const std::vector< AiDetect::AiDetectInput >& inputVec);
-	void InputBgraRawPixelData(uint8_t* data, size_t size, size_t width, size_t height);
-	void GetOutputDetectResult(std::vector< AiDetect::AiDetectResult >& resultVec);
+	// 取一块池子里的 BGRA 缓冲，写好后交给 InputFrame，所有检测任务读同一块，不再各自拷贝
+	std::shared_ptr<FrameMailbox::Frame> AcquireFrame(size_t width, size_t height);
+	void InputFrame(std::shared_ptr<FrameMailbox::Frame> frame);
+	// time 为当前画面的时间 (steady_clock 纳秒)，mode 决定结果怎么和画面对齐
+	void GetOutputDetectResult(std::vector< AiDetect::AiDetectResult >& resultVec, int64_t time, AiDetect::AiDetectAlignMode mode);
+	// 所有检测项合在一起的检测到显示延迟 (源帧时间到结果第一次被取走)
+	LatencyHistogram GetLatencyHistogram();
+	// 所有检测项一起改检测频率
+	void UpdateDetectFrameRate(int frameRate);
+	// 所有检测项一起开关整幅检测切块，切块借共享检测调度器的空闲名额
+	void EnableTiling(bool enable);
+	// 所有检测项累计的检测次数和耗时 (纳秒)
+	void GetDetectCost(uint64_t& count, uint64_t& ns);
+	// 丢掉还没开始检测的帧，源隐藏时调用
+	void DropPendingData();
+	// 检测来不及处理、被新帧替换掉的帧数
+	uint64_t GetDroppedFrameCount();
 
 private:
-	void ThreadDetectImpl(ThreadDetectItem* item);
+	// 在调度器的工作线程上执行：取信箱里最新的一帧检测
+	void DetectPending(ThreadDetectItem* item);
+	void LogScheduleStats();
 
 private:
 	std::vector< IAiDetectItem* > render_thread_detect_vec_;
 	std::vector< ThreadDetectItem* > independ_thread_detect_vec_;
+	std::unique_ptr<FrameMailbox> mailbox_;
+	DetectScheduler* scheduler_ = nullptr;
+	std::chrono::steady_clock::time_point stats_time_;
 };
 
 
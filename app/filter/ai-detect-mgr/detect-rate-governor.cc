@@ -0,0 +1,132 @@
+#include "detect-rate-governor.h"
+#include <math.h>
+#include <algorithm>
+
+DetectRateGovernor::DetectRateGovernor()
+{
+	SetParams(params_);
+}
+
+DetectRateGovernor::DetectRateGovernor(const Params& params)
+{
+	SetParams(params);
+}
+
+void DetectRateGovernor::SetParams(const Params& params)
+{
+	params_ = params;
+	params_.min_rate = std::max(params_.min_rate, 1);
+	params_.max_rate = std::max(params_.max_rate, params_.min_rate);
+	rate_ = Clamp(rate_ ? rate_ : params_.initial_rate);
+}
+
+int DetectRateGovernor::Clamp(int rate) const
+{
+	return std::min(std::max(rate, params_.min_rate), params_.max_rate);
+}
+
+DetectRateGovernor::Decision DetectRateGovernor::Update(const Sample& sample)
+{
+	stats_.windows++;
+	if (sample.detect_count)
+		detect_ms_ = sample.detect_ns / 1e6 / sample.detect_count;
+
+	Decision decision;
+	decision.detect_ms = detect_ms_;
+	decision.detect_cpu = detect_ms_ * rate_ / 1000.0;
+	decision.late_ratio = sample.frames ? (double)sample.late_frames / sample.frames : 0.0;
+	decision.render_load = sample.frames && sample.frame_interval_ns ? (double)sample.render_ns / sample.frames / sample.frame_interval_ns : 0.0;
+	decision.encoder_queue = sample.encoder_queue;
+
+	// 编码积压直接影响输出，先看它
+	Reason overload = Reason::kSteady;
+	if (sample.encoder_queue > params_.queue_high)
+		overload = Reason::kEncoderQueue;
+	else if (decision.late_ratio > params_.late_high)
+		overload = Reason::kRenderLate;
+	else if (decision.render_load > params_.render_high)
+		overload = Reason::kRenderLoad;
+	else if (decision.detect_cpu > params_.cpu_budget)
+		overload = Reason::kDetectCost;
+
+	if (hold_ > 0)
+		hold_--;
+	if (overload_memory_ > 0 && !--overload_memory_)
+		overload_rate_ = 0;
+
+	int target = rate_;
+	if (overload != Reason::kSteady)
+	{
+		stats_.overloaded++;
+		idle_windows_ = 0;
+		overload_rate_ = rate_;
+		overload_memory_ = params_.probe_memory_windows;
+		decision.reason = overload;
+		// 检测超预算时直接算出预算内的频率；其他过载要等前一次调整见效，保持期内不再降
+		if (overload == Reason::kDetectCost)
+			target = Clamp((int)floor(params_.cpu_budget * 1000.0 / detect_ms_));
+		else if (hold_ > 0)
+			decision.reason = Reason::kHold;
+		else
+			target = Clamp(std::min(rate_ * 2 / 3, rate_ - 1));
+		if (target == rate_)
+			stats_.blocked++;
+	}
+	else if (!sample.encoder_queue && !sample.late_frames && decision.render_load < params_.render_low &&
+		detect_ms_ * (rate_ + 1) / 1000.0 <= params_.cpu_budget * params_.cpu_budget_up)
+	{
+		stats_.idle++;
+		idle_windows_++;
+		decision.reason = Reason::kIdle;
+		// 升回最近过载过的频率要多等一会
+		const bool probe = overload_rate_ && rate_ + 1 >= overload_rate_;
+		const int windows = probe ? params_.up_windows * params_.probe_backoff : params_.up_windows;
+		if (idle_windows_ >= windows && !hold_ && rate_ < params_.max_rate)
+		{
+			target = rate_ + 1;
+			idle_windows_ = 0;
+			if (probe)
+				overload_rate_ = 0;
+		}
+	}
+	else
+	{
+		idle_windows_ = 0;
+	}
+
+	if (target != rate_)
+	{
+		if (target > rate_)
+			stats_.ups++;
+		else
+			stats_.downs++;
+		rate_ = target;
+		hold_ = params_.hold_windows;
+		decision.changed = true;
+	}
+	decision.rate = rate_;
+	last_ = decision;
+	return decision;
+}
+
+const char* DetectRateGovernor::GetReasonName(Reason reason)
+{
+	switch (reason)
+	{
+	case Reason::kSteady:
+		return "steady";
+	case Reason::kHold:
+		return "hold";
+	case Reason::kIdle:
+		return "idle";
+	case Reason::kDetectCost:
+		return "detect cost";
+	case Reason::kRenderLate:
+		return "render late";
+	case Reason::kRenderLoad:
+		return "render load";
+	case Reason::kEncoderQueue:
+		return "encoder queue";
+	}
+	return "unknown";
+}
@@ -0,0 +1,122 @@
+#ifndef DETECT_RATE_GOVERNOR_H
+#define DETECT_RATE_GOVERNOR_H
+
+/* 按机器负载调整人脸检测的频率，代替固定的 detectFrameRate
+* 调用方每 window_ms 交一次这段时间的负载：检测次数和耗时、渲染帧数 / 超时帧数 / 耗时、编码队列的最大深度
+* 过载 (检测 CPU 超预算、渲染超时、渲染余量不足、编码积压) 时马上降：超预算按预算算出能跑的频率，其余乘 2/3；
+* 连续 up_windows 个窗口都空闲 (阈值比过载宽，留出回差) 才升 1，每次改变后保持 hold_windows 个窗口观察效果；
+* 过载时的频率记 probe_memory_windows 个窗口，这期间升回这个频率要多等 probe_backoff 倍的空闲窗口，不会反复试探
+* 频率始终在 [min_rate, max_rate] 内；不加锁，只在一个线程上用
+*/
+
+#include <stddef.h>
+#include <stdint.h>
+
+class DetectRateGovernor
+{
+public:
+	struct Params
+	{
+		int min_rate = 2;
+		int max_rate = 15;
+		int initial_rate = 6;
+		int window_ms = 500;
+		// 检测每秒最多占用的 CPU 时间 (单位：核)
+		double cpu_budget = 0.5;
+		// 升频时按预算的这个比例算，和降频的阈值错开
+		double cpu_budget_up = 0.8;
+		// 渲染超时帧比例超过 late_high 算过载，为 0 才算空闲
+		double late_high = 0.05;
+		// 渲染平均耗时占帧间隔的比例：超过 render_high 算过载，低于 render_low 才算空闲
+		double render_high = 0.85;
+		double render_low = 0.6;
+		// 编码队列深度超过 queue_high 算过载，为 0 才算空闲
+		int queue_high = 2;
+		int up_windows = 3;
+		int hold_windows = 2;
+		int probe_backoff = 4;
+		int probe_memory_windows = 20;
+	};
+
+	// 一个窗口内的负载
+	struct Sample
+	{
+		uint64_t detect_count = 0;
+		uint64_t detect_ns = 0;
+		uint64_t frames = 0;
+		uint64_t late_frames = 0;
+		uint64_t render_ns = 0;
+		// 一帧的时间预算
+		uint64_t frame_interval_ns = 0;
+		// 窗口内见到的最大编码队列深度
+		int encoder_queue = 0;
+	};
+
+	enum class Reason
+	{
+		kSteady,
+		kHold,
+		kIdle,
+		kDetectCost,
+		kRenderLate,
+		kRenderLoad,
+		kEncoderQueue,
+	};
+
+	struct Decision
+	{
+		int rate = 0;
+		bool changed = false;
+		Reason reason = Reason::kSteady;
+		// 按当前频率估算的检测 CPU 占用 (核)
+		double detect_cpu = 0.0;
+		double detect_ms = 0.0;
+		double late_ratio = 0.0;
+		double render_load = 0.0;
+		int encoder_queue = 0;
+	};
+
+	struct Stats
+	{
+		uint64_t windows = 0;
+		uint64_t ups = 0;
+		uint64_t downs = 0;
+		// 过载但还在保持期、或者已经到下限的窗口
+		uint64_t blocked = 0;
+		uint64_t overloaded = 0;
+		uint64_t idle = 0;
+	};
+
+	DetectRateGovernor();
+	explicit DetectRateGovernor(const Params& params);
+
+	// 会把当前频率钳到新的范围内
+	void SetParams(const Params& params);
+	const Params& GetParams() const { return params_; }
+	int GetRate() const { return rate_; }
+
+	Decision Update(const Sample& sample);
+	const Decision& GetLastDecision() const { return last_; }
+	const Stats& GetStats() const { return stats_; }
+	void ResetStats() { stats_ = Stats(); }
+
+	static const char* GetReasonName(Reason reason);
+
+private:
+	int Clamp(int rate) const;
+
+private:
+	Params params_;
+	int rate_ = 0;
+	// 上次有检测时的平均耗时，窗口内没检测时沿用
+	double detect_ms_ = 0.0;
+	int idle_windows_ = 0;
+	int hold_ = 0;
+	// 最近一次过载时的频率，0 表示没有或者已经过期
+	int overload_rate_ = 0;
+	int overload_memory_ = 0;
+	Decision last_;
+	Stats stats_;
+};
+
+#endif
@@ -0,0 +1,160 @@
+#include "detect-result-history.h"
+#include <math.h>
+#include <algorithm>
+#include <vector>
+
+namespace
+{
+	float FaceIoU(const AiDetect::FaceDetectionCnn& a, const AiDetect::FaceDetectionCnn& b)
+	{
+		float x0 = std::max(a.x, b.x);
+		float y0 = std::max(a.y, b.y);
+		float x1 = std::min(a.x + a.width, b.x + b.width);
+		float y1 = std::min(a.y + a.height, b.y + b.height);
+		if (x1 <= x0 || y1 <= y0)
+			return 0.0f;
+		float inter = (x1 - x0) * (y1 - y0);
+		float uni = (float)a.width * a.height + (float)b.width * b.height - inter;
+		return uni > 0.0f ? inter / uni : 0.0f;
+	}
+}
+
+void LatencyHistogram::Record(int64_t ns)
+{
+	if (ns < 0)
+		ns = 0;
+	int index = (int)(ns / 1000000 / kBucketMs);
+	buckets_[std::min(index, kBucketCount - 1)]++;
+	count_++;
+	total_ns_ += ns;
+}
+
+void LatencyHistogram::Merge(const LatencyHistogram& other)
+{
+	for (int i = 0; i < kBucketCount; i++)
+		buckets_[i] += other.buckets_[i];
+	count_ += other.count_;
+	total_ns_ += other.total_ns_;
+}
+
+void LatencyHistogram::Reset()
+{
+	*this = LatencyHistogram();
+}
+
+double LatencyHistogram::GetPercentileMs(double percent) const
+{
+	if (!count_)
+		return 0.0;
+	uint64_t target = (uint64_t)ceil(count_ * percent / 100.0);
+	uint64_t sum = 0;
+	for (int i = 0; i < kBucketCount; i++)
+	{
+		sum += buckets_[i];
+		if (sum >= target && sum)
+			return (double)(i + 1) * kBucketMs;
+	}
+	return (double)kBucketCount * kBucketMs;
+}
+
+bool DetectResultHistory::Push(const AiDetect::AiDetectResult& result)
+{
+	if (!result.timestamp || (size_ && result.timestamp <= GetNewestTimestamp()))
+		return false;
+	if (size_ == kCapacity)
+	{
+		head_ = (head_ + 1) % kCapacity;
+		size_--;
+	}
+	ring_[(head_ + size_) % kCapacity] = result;
+	size_++;
+	return true;
+}
+
+bool DetectResultHistory::Get(int64_t time, AiDetect::AiDetectAlignMode mode, AiDetect::AiDetectResult& result) const
+{
+	if (!size_)
+		return false;
+
+	const AiDetect::AiDetectResult& last = At(size_ - 1);
+	switch (mode)
+	{
+	case AiDetect::KAiDetectAlignDelay:
+	{
+		// 从新往旧找第一条不晚于 time 的；都比 time 新时用最旧的
+		for (size_t i = size_; i > 0; i--)
+		{
+			if (At(i - 1).timestamp <= time)
+			{
+				result = At(i - 1);
+				return true;
+			}
+		}
+		result = At(0);
+		return true;
+	}
+	case AiDetect::KAiDetectAlignExtrapolate:
+	{
+		if (size_ >= 2 && last.detectType == AiDetect::KAiDetectFace)
+		{
+			Extrapolate(At(size_ - 2), last, time, result);
+			return true;
+		}
+		result = last;
+		return true;
+	}
+	default:
+		result = last;
+		return true;
+	}
+}
+
+void DetectResultHistory::Extrapolate(const AiDetect::AiDetectResult& prev, const AiDetect::AiDetectResult& last, int64_t time,
+	AiDetect::AiDetectResult& result) const
+{
+	result = last;
+	const double span = (last.timestamp - prev.timestamp) / 1e9;
+	const double ahead = std::min(std::max(time - last.timestamp, (int64_t)0), (int64_t)params_.max_extrapolate_ms * 1000000) / 1e9;
+	if (span <= 0.0 || ahead <= 0.0)
+		return;
+
+	// 贪心按 IoU 把这次的框对上上次的框，对上的按位移 / 时间间隔算速度
+	const AiDetect::FaceInfo& a = prev.faceResult;
+	const AiDetect::FaceInfo& b = last.faceResult;
+	std::vector<bool> used(a.size, false);
+	for (int i = 0; i < b.size; i++)
+	{
+		float best = params_.match_iou;
+		int match = -1;
+		for (int j = 0; j < a.size; j++)
+		{
+			if (used[j])
+				continue;
+			float iou = FaceIoU(a.info[j], b.info[i]);
+			if (iou >= best)
+			{
+				best = iou;
+				match = j;
+			}
+		}
+		if (match < 0)
+			continue;
+		used[match] = true;
+
+		const AiDetect::FaceDetectionCnn& from = a.info[match];
+		const AiDetect::FaceDetectionCnn& to = b.info[i];
+		const double vx = ((to.x + to.width * 0.5) - (from.x + from.width * 0.5)) / span;
+		const double vy = ((to.y + to.height * 0.5) - (from.y + from.height * 0.5)) / span;
+		const short dx = (short)lround(vx * ahead);
+		const short dy = (short)lround(vy * ahead);
+		AiDetect::FaceDetectionCnn& out = result.faceResult.info[i];
+		out.x += dx;
+		out.y += dy;
+		for (int k = 0; k < 10; k += 2)
+		{
+			out.landmark[k] += dx;
+			out.landmark[k + 1] += dy;
+		}
+	}
+	result.timestamp = time;
+}
@@ -0,0 +1,73 @@
+#ifndef DETECT_RESULT_HISTORY_H
+#define DETECT_RESULT_HISTORY_H
+
+/* 检测结果的历史和检测到显示的延迟统计
+* 检测结果带着源帧的时间戳，按时间顺序放进一个小环形缓冲；渲染时按对齐方式取：
+* 最新的结果、不晚于给定时间的结果 (画面推迟显示时用)，或用最近两次结果的速度把框外推到给定时间
+* 只在渲染线程使用，不加锁
+*/
+
+#include "ai-detect-define.h"
+#include <stddef.h>
+#include <stdint.h>
+
+// 延迟直方图，每格 kBucketMs 毫秒，最后一格收超出范围的
+class LatencyHistogram
+{
+public:
+	static const int kBucketMs = 5;
+	static const int kBucketCount = 64;
+
+	void Record(int64_t ns);
+	void Merge(const LatencyHistogram& other);
+	void Reset();
+
+	uint64_t GetCount() const { return count_; }
+	uint64_t GetBucket(int index) const { return buckets_[index]; }
+	double GetMeanMs() const { return count_ ? total_ns_ / 1e6 / count_ : 0.0; }
+	// 所在格的上界，毫秒
+	double GetPercentileMs(double percent) const;
+
+private:
+	uint64_t buckets_[kBucketCount] = { 0 };
+	uint64_t count_ = 0;
+	int64_t total_ns_ = 0;
+};
+
+class DetectResultHistory
+{
+public:
+	static const size_t kCapacity = 8;
+
+	struct Params
+	{
+		// 最多往前推算多久，检测停了框不会一直飘走
+		int max_extrapolate_ms = 150;
+		// 前后两次结果里的框 IoU 不低于这个值算同一张脸
+		float match_iou = 0.3f;
+	};
+
+	void SetParams(const Params& params) { params_ = params; }
+	const Params& GetParams() const { return params_; }
+
+	// 时间戳不比最新的一条新时忽略，返回是否放入
+	bool Push(const AiDetect::AiDetectResult& result);
+	// 没有结果时返回 false，result 不变；外推的结果时间戳改为 time
+	bool Get(int64_t time, AiDetect::AiDetectAlignMode mode, AiDetect::AiDetectResult& result) const;
+	int64_t GetNewestTimestamp() const { return size_ ? At(size_ - 1).timestamp : 0; }
+	size_t GetSize() const { return size_; }
+	void Clear() { size_ = 0; }
+
+private:
+	// index 0 是最旧的
+	const AiDetect::AiDetectResult& At(size_t index) const { return ring_[(head_ + index) % kCapacity]; }
+	void Extrapolate(const AiDetect::AiDetectResult& prev, const AiDetect::AiDetectResult& last, int64_t time, AiDetect::AiDetectResult& result) const;
+
+private:
+	Params params_;
+	AiDetect::AiDetectResult ring_[kCapacity];
+	size_t head_ = 0;
+	size_t size_ = 0;
+};
+
+#endif
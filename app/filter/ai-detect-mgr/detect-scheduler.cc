@@ -0,0 +1,215 @@
+#include "detect-scheduler.h"
+#include "task-pool.h"
+#include <chrono>
+#include <algorithm>
+
+DetectScheduler::DetectScheduler(size_t worker_count)
+{
+	if (!worker_count)
+		worker_count = 1;
+	tile_pool_.reset(new TaskPool(worker_count - 1));
+	for (size_t i = 0; i < worker_count; i++)
+		threads_.emplace_back(&DetectScheduler::WorkThreadImpl, this);
+}
+
+DetectScheduler::~DetectScheduler()
+{
+	{
+		std::unique_lock<std::mutex> lock(mutex_);
+		quit_ = true;
+	}
+	work_cond_.notify_all();
+	for (auto& t : threads_)
+	{
+		if (t.joinable())
+			t.join();
+	}
+}
+
+size_t DetectScheduler::GetDefaultWorkerCount()
+{
+	size_t count = std::thread::hardware_concurrency() / 4;
+	return std::min<size_t>(std::max<size_t>(count, 1), 4);
+}
+
+DetectScheduler* DetectScheduler::GetShared()
+{
+	static DetectScheduler scheduler(GetDefaultWorkerCount());
+	return &scheduler;
+}
+
+size_t DetectScheduler::AcquireTileLanes(size_t want)
+{
+	std::unique_lock<std::mutex> lock(mutex_);
+	const size_t busy = running_ + lent_;
+	const size_t count = busy < threads_.size() ? std::min(want, threads_.size() - busy) : 0;
+	lent_ += count;
+	return count;
+}
+
+void DetectScheduler::ReleaseTileLanes(size_t count)
+{
+	if (!count)
+		return;
+	{
+		std::unique_lock<std::mutex> lock(mutex_);
+		lent_ -= std::min(count, lent_);
+	}
+	work_cond_.notify_all();
+}
+
+uint64_t DetectScheduler::NowNs()
+{
+	return (uint64_t)std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+DetectScheduler::Client* DetectScheduler::FindLocked(int client)
+{
+	for (auto& c : clients_)
+	{
+		if (c->id == client)
+			return c.get();
+	}
+	return nullptr;
+}
+
+int DetectScheduler::Register(int priority)
+{
+	std::unique_lock<std::mutex> lock(mutex_);
+	std::unique_ptr<Client> client(new Client());
+	client->id = next_id_++;
+	client->priority = priority;
+	// 新客户端排在同优先级的最前面
+	client->served = 0;
+	clients_.push_back(std::move(client));
+	return clients_.back()->id;
+}
+
+void DetectScheduler::Unregister(int client)
+{
+	std::unique_lock<std::mutex> lock(mutex_);
+	Client* c = FindLocked(client);
+	if (!c)
+		return;
+	if (c->job)
+	{
+		c->job = nullptr;
+		queue_depth_--;
+	}
+	idle_cond_.wait(lock, [&]() { return !c->running; });
+	clients_.erase(std::find_if(clients_.begin(), clients_.end(), [&](const std::unique_ptr<Client>& p) { return p.get() == c; }));
+}
+
+void DetectScheduler::Submit(int client, Job job)
+{
+	{
+		std::unique_lock<std::mutex> lock(mutex_);
+		Client* c = FindLocked(client);
+		if (!c || !job)
+			return;
+		c->stats.submitted++;
+		stats_.submitted++;
+		if (c->job)
+		{
+			// 还没开始的旧任务直接替换，排队时间从第一次进队列算
+			c->stats.coalesced++;
+			stats_.coalesced++;
+		}
+		else
+		{
+			c->queued_ns = NowNs();
+			queue_depth_++;
+			max_queue_depth_ = std::max(max_queue_depth_, queue_depth_);
+		}
+		c->job = std::move(job);
+	}
+	work_cond_.notify_one();
+}
+
+void DetectScheduler::Cancel(int client)
+{
+	std::unique_lock<std::mutex> lock(mutex_);
+	Client* c = FindLocked(client);
+	if (c && c->job)
+	{
+		c->job = nullptr;
+		queue_depth_--;
+	}
+}
+
+DetectScheduler::Client* DetectScheduler::PickLocked(uint64_t now)
+{
+	Client* best = nullptr;
+	int64_t best_priority = 0;
+	for (auto& c : clients_)
+	{
+		if (!c->job || c->running)
+			continue;
+		int64_t priority = c->priority + (int64_t)((now - c->queued_ns) / 1000000 / kAgingMs);
+		if (!best || priority > best_priority || (priority == best_priority && c->served < best->served))
+		{
+			best = c.get();
+			best_priority = priority;
+		}
+	}
+	return best;
+}
+
+void DetectScheduler::WorkThreadImpl()
+{
+	std::unique_lock<std::mutex> lock(mutex_);
+	while (1)
+	{
+		Client* c = nullptr;
+		// 名额被切块检测借走时不取新任务
+		work_cond_.wait(lock, [&]() { return quit_ || (running_ + lent_ < threads_.size() && (c = PickLocked(NowNs())) != nullptr); });
+		if (quit_)
+			return;
+
+		const uint64_t now = NowNs();
+		const uint64_t wait = now - c->queued_ns;
+		Job job = std::move(c->job);
+		c->job = nullptr;
+		c->running = true;
+		c->served = ++serve_count_;
+		queue_depth_--;
+		running_++;
+		for (WaitStats* s : { &c->stats, &stats_ })
+		{
+			s->run++;
+			s->total_wait_ns += wait;
+			s->max_wait_ns = std::max(s->max_wait_ns, wait);
+		}
+
+		lock.unlock();
+		job();
+		job = nullptr;
+		lock.lock();
+
+		c->running = false;
+		running_--;
+		idle_cond_.notify_all();
+		// 执行期间这个客户端可能又来了任务，别的线程因为它在跑而跳过了
+		if (c->job)
+			work_cond_.notify_one();
+	}
+}
+
+DetectScheduler::Stats DetectScheduler::GetStats()
+{
+	std::unique_lock<std::mutex> lock(mutex_);
+	Stats stats;
+	stats.workers = threads_.size();
+	stats.clients = clients_.size();
+	stats.queue_depth = queue_depth_;
+	stats.max_queue_depth = max_queue_depth_;
+	stats.wait = stats_;
+	return stats;
+}
+
+DetectScheduler::WaitStats DetectScheduler::GetClientStats(int client)
+{
+	std::unique_lock<std::mutex> lock(mutex_);
+	Client* c = FindLocked(client);
+	return c ? c->stats : WaitStats();
+}
@@ -0,0 +1,119 @@
+#ifndef DETECT_SCHEDULER_H
+#define DETECT_SCHEDULER_H
+
+/* 进程内共享的检测调度器
+* 所有 AiDetectMgr 的检测任务都交给固定数量的工作线程，不再每个检测项一个线程
+* 每个客户端 (一个源上的一个检测项) 最多排一个任务，新任务替换还没开始的旧任务 (检测只要最新一帧)；
+* 同一个客户端的任务不会同时在两个线程上跑
+* 工作线程取任务时选优先级最高的客户端，同优先级选最久没被服务的；排队每满 kAgingMs 优先级加 1，低优先级不会饿死
+* 切块检测从这里借空闲的名额，在专用的线程池上并行；借出的名额和正在跑的任务加起来不超过工作线程数
+*/
+
+#include <stddef.h>
+#include <stdint.h>
+#include <condition_variable>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+class TaskPool;
+
+class DetectScheduler
+{
+public:
+	using Job = std::function<void()>;
+
+	struct WaitStats
+	{
+		uint64_t submitted = 0;
+		uint64_t run = 0;
+		// 被新任务替换掉的任务数
+		uint64_t coalesced = 0;
+		// 从进入队列到开始执行
+		uint64_t total_wait_ns = 0;
+		uint64_t max_wait_ns = 0;
+
+		double AvgWaitMs() const { return run ? total_wait_ns / 1e6 / run : 0.0; }
+		double MaxWaitMs() const { return max_wait_ns / 1e6; }
+	};
+
+	struct Stats
+	{
+		size_t workers = 0;
+		size_t clients = 0;
+		// 当前排队的客户端数和历史最大值
+		size_t queue_depth = 0;
+		size_t max_queue_depth = 0;
+		WaitStats wait;
+	};
+
+	static const int kAgingMs = 100;
+
+	explicit DetectScheduler(size_t worker_count);
+	~DetectScheduler();
+
+	DetectScheduler(const DetectScheduler&) = delete;
+	DetectScheduler& operator=(const DetectScheduler&) = delete;
+
+	// 工作线程数 = 硬件线程数 / 4，限制在 [1, 4]，给渲染和编码留出 CPU
+	static DetectScheduler* GetShared();
+	static size_t GetDefaultWorkerCount();
+
+	size_t GetWorkerCount() const { return threads_.size(); }
+
+	// 切块检测用的线程池，工作线程数 - 1 个线程，借到名额的检测在上面跑
+	TaskPool* GetTilePool() const { return tile_pool_.get(); }
+	// 最多借 want 个空闲名额，返回借到的个数；借出期间工作线程少取任务。用完要还
+	size_t AcquireTileLanes(size_t want);
+	void ReleaseTileLanes(size_t count);
+
+	// 返回客户端编号，priority 越大越优先
+	int Register(int priority);
+	// 丢掉排队的任务，等正在执行的任务结束后返回；不能在任务里调用
+	void Unregister(int client);
+	void Submit(int client, Job job);
+	// 丢掉排队的任务，不算合并
+	void Cancel(int client);
+
+	Stats GetStats();
+	WaitStats GetClientStats(int client);
+
+private:
+	struct Client
+	{
+		int id = 0;
+		int priority = 0;
+		Job job;
+		bool running = false;
+		uint64_t queued_ns = 0;
+		// 上次开始执行的序号，同优先级时小的先
+		uint64_t served = 0;
+		WaitStats stats;
+	};
+
+	void WorkThreadImpl();
+	Client* FindLocked(int client);
+	Client* PickLocked(uint64_t now);
+	static uint64_t NowNs();
+
+private:
+	std::vector<std::thread> threads_;
+	std::mutex mutex_;
+	std::condition_variable work_cond_;
+	std::condition_variable idle_cond_;
+	std::vector<std::unique_ptr<Client>> clients_;
+	int next_id_ = 1;
+	uint64_t serve_count_ = 0;
+	size_t queue_depth_ = 0;
+	size_t max_queue_depth_ = 0;
+	// 正在执行的任务数和借给切块检测的名额
+	size_t running_ = 0;
+	size_t lent_ = 0;
+	std::unique_ptr<TaskPool> tile_pool_;
+	WaitStats stats_;
+	bool quit_ = false;
+};
+
+#endif
@@ -0,0 +1,205 @@
+#include "face-roi-planner.h"
+#include <math.h>
+#include <algorithm>
+
+FaceRoiPlanner::Rect FaceRoiPlanner::Intersect(const Rect& a, const Rect& b)
+{
+	Rect r;
+	r.x = std::max(a.x, b.x);
+	r.y = std::max(a.y, b.y);
+	r.width = std::max(0, std::min(a.x + a.width, b.x + b.width) - r.x);
+	r.height = std::max(0, std::min(a.y + a.height, b.y + b.height) - r.y);
+	return r;
+}
+
+bool FaceRoiPlanner::Overlaps(const Rect& a, const Rect& b)
+{
+	return a.x < b.x + b.width && b.x < a.x + a.width && a.y < b.y + b.height && b.y < a.y + a.height;
+}
+
+FaceRoiPlanner::Rect FaceRoiPlanner::Union(const Rect& a, const Rect& b)
+{
+	Rect r;
+	r.x = std::min(a.x, b.x);
+	r.y = std::min(a.y, b.y);
+	r.width = std::max(a.x + a.width, b.x + b.width) - r.x;
+	r.height = std::max(a.y + a.height, b.y + b.height) - r.y;
+	return r;
+}
+
+bool FaceRoiPlanner::Plan(int width, int height, int full_width, const std::vector<FaceTracker::Box>& faces, std::vector<Pass>& passes)
+{
+	passes.clear();
+	const Rect frame = { 0, 0, width, height };
+
+	Pass full;
+	full.src = frame;
+	full.dst_width = std::min(width, full_width);
+	full.dst_height = std::max(1, (int)(((int64_t)height * full.dst_width + width / 2) / width));
+	const int64_t full_pixels = (int64_t)full.dst_width * full.dst_height;
+
+	const bool scan = faces.empty() || params_.full_scan_interval <= 1 || count_ % params_.full_scan_interval == 0;
+	count_++;
+	if (!scan)
+	{
+		// 外扩后的区域，重叠的合并成一块，直到没有重叠
+		std::vector<Rect> rects;
+		for (const auto& face : faces)
+		{
+			const float ex = face.width * params_.expand;
+			const float ey = face.height * params_.expand;
+			Rect r;
+			r.x = (int)floorf(face.x - ex);
+			r.y = (int)floorf(face.y - ey);
+			r.width = (int)ceilf(face.width + 2.0f * ex);
+			r.height = (int)ceilf(face.height + 2.0f * ey);
+			// 最短边不够时以中心向两边补齐
+			if (r.width < params_.min_crop_side)
+			{
+				r.x -= (params_.min_crop_side - r.width) / 2;
+				r.width = params_.min_crop_side;
+			}
+			if (r.height < params_.min_crop_side)
+			{
+				r.y -= (params_.min_crop_side - r.height) / 2;
+				r.height = params_.min_crop_side;
+			}
+			r = Intersect(r, frame);
+			if (r.width > 0 && r.height > 0)
+				rects.push_back(r);
+		}
+		for (bool merged = true; merged;)
+		{
+			merged = false;
+			for (size_t i = 0; i < rects.size() && !merged; i++)
+			{
+				for (size_t j = i + 1; j < rects.size(); j++)
+				{
+					if (Overlaps(rects[i], rects[j]))
+					{
+						rects[i] = Union(rects[i], rects[j]);
+						rects.erase(rects.begin() + j);
+						merged = true;
+						break;
+					}
+				}
+			}
+		}
+
+		int64_t roi_pixels = 0;
+		for (const auto& r : rects)
+		{
+			Pass pass;
+			pass.src = r;
+			// 区域最长边压到 max_crop_side，但分辨率不低于整幅检测
+			const int side = std::max(r.width, r.height);
+			const float scale = std::min(1.0f, std::max((float)params_.max_crop_side / side, (float)full.dst_width / width));
+			pass.dst_width = std::max(1, std::min(r.width, (int)lroundf(r.width * scale)));
+			pass.dst_height = std::max(1, std::min(r.height, (int)lroundf(r.height * scale)));
+			roi_pixels += (int64_t)pass.dst_width * pass.dst_height;
+			passes.push_back(pass);
+		}
+		if (!passes.empty() && roi_pixels < full_pixels)
+			return false;
+		passes.clear();
+	}
+
+	passes.push_back(full);
+	return true;
+}
+
+void FaceRoiPlanner::Record(bool full, int64_t pixels, int64_t us)
+{
+	if (full)
+	{
+		stats_.full_passes++;
+		stats_.full_pixels += pixels;
+		stats_.full_us += us;
+	}
+	else
+	{
+		stats_.roi_passes++;
+		stats_.roi_pixels += pixels;
+		stats_.roi_us += us;
+	}
+}
+
+float FaceRoiPlanner::IoU(const FaceTracker::Box& a, const FaceTracker::Box& b)
+{
+	float x0 = std::max(a.x, b.x);
+	float y0 = std::max(a.y, b.y);
+	float x1 = std::min(a.x + a.width, b.x + b.width);
+	float y1 = std::min(a.y + a.height, b.y + b.height);
+	if (x1 <= x0 || y1 <= y0)
+		return 0.0f;
+	float inter = (x1 - x0) * (y1 - y0);
+	float uni = a.width * a.height + b.width * b.height - inter;
+	return uni > 0.0f ? inter / uni : 0.0f;
+}
+
+void FaceRoiPlanner::Nms(std::vector<FaceTracker::Box>& boxes, float iou)
+{
+	std::stable_sort(boxes.begin(), boxes.end(), [](const FaceTracker::Box& a, const FaceTracker::Box& b) {
+		return a.confidence > b.confidence;
+	});
+	std::vector<FaceTracker::Box> kept;
+	kept.reserve(boxes.size());
+	for (const auto& box : boxes)
+	{
+		bool duplicate = false;
+		for (const auto& k : kept)
+		{
+			if (IoU(box, k) > iou)
+			{
+				duplicate = true;
+				break;
+			}
+		}
+		if (!duplicate)
+			kept.push_back(box);
+	}
+	boxes.swap(kept);
+}
+
+void FaceRoiPlanner::PlanTiles(int width, int height, int count, int overlap, std::vector<Rect>& tiles)
+{
+	tiles.clear();
+	overlap = std::max(overlap, 1);
+	const int max_columns = std::max(1, width / overlap - 1);
+	const int max_rows = std::max(1, height / overlap - 1);
+
+	// 块数尽量多，一样多时选块最接近正方形的网格
+	int columns = 1, rows = 1;
+	float best_aspect = 0.0f;
+	for (int c = 1; c <= std::min(count, max_columns); c++)
+	{
+		for (int r = 1; r <= std::min(count / c, max_rows); r++)
+		{
+			const float w = (float)(width + (c - 1) * overlap) / c;
+			const float h = (float)(height + (r - 1) * overlap) / r;
+			const float aspect = std::max(w / h, h / w);
+			if (c * r > columns * rows || (c * r == columns * rows && aspect < best_aspect) || best_aspect == 0.0f)
+			{
+				columns = c;
+				rows = r;
+				best_aspect = aspect;
+			}
+		}
+	}
+
+	// 块大小向上取整，起点向下取整：相邻起点的间距不超过 块大小 - overlap
+	const int tile_width = (width + (columns - 1) * overlap + columns - 1) / columns;
+	const int tile_height = (height + (rows - 1) * overlap + rows - 1) / rows;
+	for (int r = 0; r < rows; r++)
+	{
+		for (int c = 0; c < columns; c++)
+		{
+			Rect tile;
+			tile.x = columns > 1 ? c * (width - tile_width) / (columns - 1) : 0;
+			tile.y = rows > 1 ? r * (height - tile_height) / (rows - 1) : 0;
+			tile.width = std::min(tile_width, width - tile.x);
+			tile.height = std::min(tile_height, height - tile.y);
+			tiles.push_back(tile);
+		}
+	}
+}
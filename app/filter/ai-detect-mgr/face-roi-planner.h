@@ -0,0 +1,89 @@
+#ifndef FACE_ROI_PLANNER_H
+#define FACE_ROI_PLANNER_H
+
+/* 决定每次人脸检测在哪些区域上跑 CNN
+* 第一次和每隔 full_scan_interval 次在整幅画面 (缩小到检测宽度) 上跑，找新出现的脸；
+* 其余时候只在上次结果外扩后的区域上跑，区域按原分辨率 (最多 max_crop_side) 送进网络，小脸更容易检出
+* 区域的像素总数超过整幅画面时退回整幅检测。多个区域的结果换算回输入坐标后做 NMS 去重
+* PlanTiles 把整幅检测切成相互重叠的块，各块可以并行送进网络
+*/
+
+#include "face-tracker.h"
+#include <stddef.h>
+#include <stdint.h>
+#include <vector>
+
+class FaceRoiPlanner
+{
+public:
+	struct Rect
+	{
+		int x = 0;
+		int y = 0;
+		int width = 0;
+		int height = 0;
+	};
+
+	// 输入图上的一块区域 src 缩放到 dst_width x dst_height 后送进网络
+	struct Pass
+	{
+		Rect src;
+		int dst_width = 0;
+		int dst_height = 0;
+	};
+
+	struct Params
+	{
+		// 隔多少次做一次整幅检测，<= 1 表示每次都整幅
+		int full_scan_interval = 5;
+		// 每边外扩的比例 (相对框的宽高)
+		float expand = 0.75f;
+		// 区域送进网络的最长边
+		int max_crop_side = 256;
+		// 区域最短边，太小的区域网络看不全
+		int min_crop_side = 64;
+		// NMS 的 IoU 阈值
+		float nms_iou = 0.4f;
+	};
+
+	// 每秒统计：整幅 / 区域检测的次数、送进网络的像素数和耗时
+	struct Stats
+	{
+		int64_t full_passes = 0;
+		int64_t full_pixels = 0;
+		int64_t full_us = 0;
+		int64_t roi_passes = 0;
+		int64_t roi_pixels = 0;
+		int64_t roi_us = 0;
+	};
+
+	void SetParams(const Params& params) { params_ = params; }
+	const Params& GetParams() const { return params_; }
+
+	// faces 为上次的结果 (输入坐标)；full_width 为整幅检测的宽度。返回 true 表示这次是整幅检测
+	bool Plan(int width, int height, int full_width, const std::vector<FaceTracker::Box>& faces, std::vector<Pass>& passes);
+	void Reset() { count_ = 0; }
+
+	void Record(bool full, int64_t pixels, int64_t us);
+	const Stats& GetStats() const { return stats_; }
+	void ResetStats() { stats_ = Stats(); }
+
+	// 按置信度从高到低保留，和已保留的框 IoU 超过阈值的丢掉
+	static void Nms(std::vector<FaceTracker::Box>& boxes, float iou);
+	static float IoU(const FaceTracker::Box& a, const FaceTracker::Box& b);
+	// 切成最多 count 块，相邻块重叠至少 overlap，边长不超过 overlap 的脸总能完整落在某一块里；
+	// 块的边长不小于 2 * overlap，图太小时只有一块 (整幅)
+	static void PlanTiles(int width, int height, int count, int overlap, std::vector<Rect>& tiles);
+
+private:
+	static Rect Intersect(const Rect& a, const Rect& b);
+	static bool Overlaps(const Rect& a, const Rect& b);
+	static Rect Union(const Rect& a, const Rect& b);
+
+private:
+	Params params_;
+	int64_t count_ = 0;
+	Stats stats_;
+};
+
+#endif
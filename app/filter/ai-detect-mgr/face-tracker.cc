@@ -0,0 +1,302 @@
+#include "face-tracker.h"
+#include <math.h>
+#include <algorithm>
+
+namespace
+{
+	float BoxIoU(const FaceTracker::Box& a, const FaceTracker::Box& b)
+	{
+		float x0 = std::max(a.x, b.x);
+		float y0 = std::max(a.y, b.y);
+		float x1 = std::min(a.x + a.width, b.x + b.width);
+		float y1 = std::min(a.y + a.height, b.y + b.height);
+		if (x1 <= x0 || y1 <= y0)
+			return 0.0f;
+		float inter = (x1 - x0) * (y1 - y0);
+		float uni = a.width * a.height + b.width * b.height - inter;
+		return uni > 0.0f ? inter / uni : 0.0f;
+	}
+}
+
+void FaceTracker::Axis::Init(float value, float noise)
+{
+	pos = value;
+	vel = 0.0f;
+	p00 = noise * noise;
+	p01 = 0.0f;
+	// 初始速度未知，给一个较大的方差
+	p11 = 200.0f * 200.0f;
+}
+
+void FaceTracker::Axis::Predict(float dt, float accel_noise)
+{
+	pos += vel * dt;
+	// P = F P F^T + Q，Q 为分段恒定加速度模型
+	float q = accel_noise * accel_noise;
+	float dt2 = dt * dt;
+	p00 += dt * (2.0f * p01 + dt * p11) + q * dt2 * dt2 / 4.0f;
+	p01 += dt * p11 + q * dt2 * dt / 2.0f;
+	p11 += q * dt2;
+}
+
+void FaceTracker::Axis::Correct(float value, float noise)
+{
+	float s = p00 + noise * noise;
+	float k0 = p00 / s;
+	float k1 = p01 / s;
+	float residual = value - pos;
+	pos += k0 * residual;
+	vel += k1 * residual;
+	float n00 = (1.0f - k0) * p00;
+	float n01 = (1.0f - k0) * p01;
+	float n11 = p11 - k1 * p01;
+	p00 = n00;
+	p01 = n01;
+	p11 = n11;
+}
+
+bool FaceTracker::SamplePatch(const uint8_t* gray, int width, int height, int linesize, float cx, float cy, float size, float* patch)
+{
+	const float step = size / kPatchSize;
+	const float x0 = cx - size * 0.5f + step * 0.5f;
+	const float y0 = cy - size * 0.5f + step * 0.5f;
+	int xs[kPatchSize];
+	for (int i = 0; i < kPatchSize; i++)
+		xs[i] = std::min(std::max((int)(x0 + i * step), 0), width - 1);
+
+	float sum = 0.0f;
+	for (int j = 0; j < kPatchSize; j++)
+	{
+		const uint8_t* line = gray + (size_t)std::min(std::max((int)(y0 + j * step), 0), height - 1) * linesize;
+		for (int i = 0; i < kPatchSize; i++)
+		{
+			float v = line[xs[i]];
+			patch[j * kPatchSize + i] = v;
+			sum += v;
+		}
+	}
+
+	const int n = kPatchSize * kPatchSize;
+	const float mean = sum / n;
+	float var = 0.0f;
+	for (int i = 0; i < n; i++)
+	{
+		patch[i] -= mean;
+		var += patch[i] * patch[i];
+	}
+	var /= n;
+	// 几乎没有纹理的区域匹配不可靠
+	if (var < 4.0f)
+		return false;
+	const float inv = 1.0f / sqrtf(var);
+	for (int i = 0; i < n; i++)
+		patch[i] *= inv;
+	return true;
+}
+
+float FaceTracker::Correlate(const float* a, const float* b)
+{
+	const int n = kPatchSize * kPatchSize;
+	float sum = 0.0f;
+	for (int i = 0; i < n; i++)
+		sum += a[i] * b[i];
+	return sum / n;
+}
+
+float FaceTracker::PatchSize(const Track& track) const
+{
+	// 取框中间的部分，少带背景
+	return std::max(std::min(track.width, track.height) * 0.8f, (float)kPatchSize / 2);
+}
+
+void FaceTracker::InitTrack(Track& track, const uint8_t* gray, int width, int height, int linesize, const Box& box, double time)
+{
+	track.cx.Init(box.x + box.width * 0.5f, params_.detect_noise);
+	track.cy.Init(box.y + box.height * 0.5f, params_.detect_noise);
+	track.width = box.width;
+	track.height = box.height;
+	track.confidence = box.confidence;
+	for (int i = 0; i < 10; i += 2)
+	{
+		track.landmark[i] = box.landmark[i] - track.cx.pos;
+		track.landmark[i + 1] = box.landmark[i + 1] - track.cy.pos;
+	}
+	track.time = time;
+	track.score = SamplePatch(gray, width, height, linesize, track.cx.pos, track.cy.pos, PatchSize(track), track.patch) ? 1.0f : 0.0f;
+}
+
+void FaceTracker::OnDetection(const uint8_t* gray, int width, int height, int linesize, const std::vector<Box>& boxes, double time)
+{
+	// 先预测到这一帧，再和检测框关联
+	for (auto& track : tracks_)
+	{
+		float dt = (float)std::min(std::max(time - track.time, 0.0), 0.5);
+		track.cx.Predict(dt, params_.accel_noise);
+		track.cy.Predict(dt, params_.accel_noise);
+		track.time = time;
+	}
+
+	std::vector<int> matched(tracks_.size(), -1);
+	std::vector<bool> used(boxes.size(), false);
+	for (;;)
+	{
+		float best = params_.match_iou;
+		int best_track = -1, best_box = -1;
+		for (size_t t = 0; t < tracks_.size(); t++)
+		{
+			if (matched[t] >= 0)
+				continue;
+			Box predicted;
+			predicted.width = tracks_[t].width;
+			predicted.height = tracks_[t].height;
+			predicted.x = tracks_[t].cx.pos - predicted.width * 0.5f;
+			predicted.y = tracks_[t].cy.pos - predicted.height * 0.5f;
+			for (size_t d = 0; d < boxes.size(); d++)
+			{
+				if (used[d])
+					continue;
+				float iou = BoxIoU(predicted, boxes[d]);
+				if (iou >= best)
+				{
+					best = iou;
+					best_track = (int)t;
+					best_box = (int)d;
+				}
+			}
+		}
+		if (best_track < 0)
+			break;
+		matched[best_track] = best_box;
+		used[best_box] = true;
+	}
+
+	std::vector<Track> next;
+	next.reserve(boxes.size());
+	for (size_t t = 0; t < tracks_.size(); t++)
+	{
+		// CNN 没再检测到的脸直接去掉
+		if (matched[t] < 0)
+			continue;
+		Track track = tracks_[t];
+		const Box& box = boxes[matched[t]];
+		track.cx.Correct(box.x + box.width * 0.5f, params_.detect_noise);
+		track.cy.Correct(box.y + box.height * 0.5f, params_.detect_noise);
+		track.width = box.width;
+		track.height = box.height;
+		track.confidence = box.confidence;
+		for (int i = 0; i < 10; i += 2)
+		{
+			track.landmark[i] = box.landmark[i] - track.cx.pos;
+			track.landmark[i + 1] = box.landmark[i + 1] - track.cy.pos;
+		}
+		// 模板按检测框中心重新取，避免跟踪误差累积
+		float patch[kPatchSize * kPatchSize];
+		if (SamplePatch(gray, width, height, linesize, box.x + box.width * 0.5f, box.y + box.height * 0.5f, PatchSize(track), patch))
+		{
+			std::copy(patch, patch + kPatchSize * kPatchSize, track.patch);
+			track.score = 1.0f;
+		}
+		next.push_back(track);
+	}
+	for (size_t d = 0; d < boxes.size(); d++)
+	{
+		if (used[d])
+			continue;
+		Track track;
+		InitTrack(track, gray, width, height, linesize, boxes[d], time);
+		next.push_back(track);
+	}
+	tracks_.swap(next);
+}
+
+void FaceTracker::OnFrame(const uint8_t* gray, int width, int height, int linesize, double time)
+{
+	float patch[kPatchSize * kPatchSize];
+	for (auto& track : tracks_)
+	{
+		float dt = (float)std::min(std::max(time - track.time, 0.0), 0.5);
+		track.cx.Predict(dt, params_.accel_noise);
+		track.cy.Predict(dt, params_.accel_noise);
+		track.time = time;
+
+		// 从粗到细在预测位置附近搜 NCC 最大的位置
+		const float size = PatchSize(track);
+		const float radius = std::max(4.0f, track.width * params_.search_ratio);
+		float best_score = -1.0f;
+		float best_x = track.cx.pos;
+		float best_y = track.cy.pos;
+		int step = std::max(1, (int)(radius / 4.0f));
+		int reach = (int)ceilf(radius / step);
+		float center_x = best_x, center_y = best_y;
+		for (;;)
+		{
+			for (int j = -reach; j <= reach; j++)
+			{
+				for (int i = -reach; i <= reach; i++)
+				{
+					float x = center_x + i * step;
+					float y = center_y + j * step;
+					if (!SamplePatch(gray, width, height, linesize, x, y, size, patch))
+						continue;
+					float score = Correlate(track.patch, patch);
+					if (score > best_score)
+					{
+						best_score = score;
+						best_x = x;
+						best_y = y;
+					}
+				}
+			}
+			if (step == 1)
+				break;
+			step = std::max(1, step / 2);
+			reach = 1;
+			center_x = best_x;
+			center_y = best_y;
+		}
+
+		track.score = best_score;
+		if (best_score < params_.min_score)
+			continue;
+
+		track.cx.Correct(best_x, params_.match_noise);
+		track.cy.Correct(best_y, params_.match_noise);
+		// 匹配良好时模板慢慢跟随外观变化
+		if (SamplePatch(gray, width, height, linesize, best_x, best_y, size, patch))
+		{
+			const float blend = params_.template_blend;
+			for (int i = 0; i < kPatchSize * kPatchSize; i++)
+				track.patch[i] += (patch[i] - track.patch[i]) * blend;
+		}
+	}
+}
+
+bool FaceTracker::NeedsDetection() const
+{
+	for (const auto& track : tracks_)
+	{
+		if (track.score < params_.min_score)
+			return true;
+	}
+	return false;
+}
+
+void FaceTracker::GetBoxes(std::vector<Box>& boxes) const
+{
+	boxes.clear();
+	for (const auto& track : tracks_)
+	{
+		Box box;
+		box.width = track.width;
+		box.height = track.height;
+		box.x = track.cx.pos - track.width * 0.5f;
+		box.y = track.cy.pos - track.height * 0.5f;
+		box.confidence = track.confidence;
+		for (int i = 0; i < 10; i += 2)
+		{
+			box.landmark[i] = track.cx.pos + track.landmark[i];
+			box.landmark[i + 1] = track.cy.pos + track.landmark[i + 1];
+		}
+		boxes.push_back(box);
+	}
+}
@@ -0,0 +1,101 @@
+#ifndef FACE_TRACKER_H
+#define FACE_TRACKER_H
+
+/* 两次 CNN 检测之间的人脸跟踪
+* 每张脸一个轨迹：中心点按匀速模型做卡尔曼滤波，框大小跟随检测；中间帧在预测位置附近用灰度小模板做 NCC 匹配，
+* 匹配位置作为观测更新滤波器；匹配分数低于阈值时请求重新检测
+* 坐标都是输入灰度图的像素坐标，时间单位为秒
+*/
+
+#include <stddef.h>
+#include <stdint.h>
+#include <vector>
+
+class FaceTracker
+{
+public:
+	struct Box
+	{
+		float x = 0.0f;
+		float y = 0.0f;
+		float width = 0.0f;
+		float height = 0.0f;
+		// 检测时的置信度，跟踪时沿用
+		int confidence = 0;
+		// 5 个关键点 (x, y)，跟踪时随框中心平移
+		float landmark[10] = { 0.0f };
+	};
+
+	struct Params
+	{
+		// 检测框和轨迹的 IoU 不低于这个值算同一张脸
+		float match_iou = 0.3f;
+		// NCC 分数低于这个值算跟丢
+		float min_score = 0.55f;
+		// 搜索半径，相对框宽，至少 4 像素
+		float search_ratio = 0.35f;
+		// 卡尔曼滤波的加速度噪声 (像素 / 秒^2 的标准差) 和两种观测噪声 (像素)
+		float accel_noise = 300.0f;
+		float detect_noise = 1.5f;
+		float match_noise = 2.5f;
+		// 匹配良好时模板向当前画面靠拢的比例
+		float template_blend = 0.1f;
+	};
+
+	static const int kPatchSize = 24;
+
+	void SetParams(const Params& params) { params_ = params; }
+	const Params& GetParams() const { return params_; }
+
+	// CNN 结果：按 IoU 关联已有轨迹，没匹配上的轨迹删除，新脸建轨迹，模板都从这一帧重新取
+	void OnDetection(const uint8_t* gray, int width, int height, int linesize, const std::vector<Box>& boxes, double time);
+	// 中间帧：预测 + 模板匹配 + 更新
+	void OnFrame(const uint8_t* gray, int width, int height, int linesize, double time);
+	// 有轨迹跟丢时返回 true
+	bool NeedsDetection() const;
+	void GetBoxes(std::vector<Box>& boxes) const;
+	size_t GetTrackCount() const { return tracks_.size(); }
+	void Reset() { tracks_.clear(); }
+
+private:
+	// 一个坐标轴的匀速模型：位置、速度和 2x2 协方差
+	struct Axis
+	{
+		float pos = 0.0f;
+		float vel = 0.0f;
+		float p00 = 0.0f;
+		float p01 = 0.0f;
+		float p11 = 0.0f;
+
+		void Init(float value, float noise);
+		void Predict(float dt, float accel_noise);
+		void Correct(float value, float noise);
+	};
+
+	struct Track
+	{
+		Axis cx;
+		Axis cy;
+		float width = 0.0f;
+		float height = 0.0f;
+		int confidence = 0;
+		// 关键点相对框中心的偏移
+		float landmark[10] = { 0.0f };
+		float score = 1.0f;
+		double time = 0.0;
+		// 零均值、单位方差的灰度模板
+		float patch[kPatchSize * kPatchSize];
+	};
+
+	// 以 (cx, cy) 为中心、边长 size 的正方形采样成 kPatchSize^2，归一化；图像外钳到边缘，方差太小返回 false
+	static bool SamplePatch(const uint8_t* gray, int width, int height, int linesize, float cx, float cy, float size, float* patch);
+	static float Correlate(const float* a, const float* b);
+	void InitTrack(Track& track, const uint8_t* gray, int width, int height, int linesize, const Box& box, double time);
+	float PatchSize(const Track& track) const;
+
+private:
+	Params params_;
+	std::vector<Track> tracks_;
+};
+
+#endif
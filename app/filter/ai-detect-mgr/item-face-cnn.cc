@@ -1,14 +1,19 @@
 #include "item-face-cnn.h"
 #include "facedetectcnn.h"
 #include "facedetection_export.h"
+#include "task-pool.h"
+#include "detect-scheduler.h"
+#include "logger.h"
+#include <algorithm>
 
 ItemFaceCnn::ItemFaceCnn()
 {
     is_detecting_.store(false);
-	result_buffer_.resize(0x20000);
+	result_buffer_.resize(kResultBufferSize);
     face_result_.detectType = AiDetect::AiDetectType::KAiDetectFace;
     face_result_.faceResult.size = 0;
     face_result_.faceResult.info = nullptr;
+    stats_time_ = std::chrono::steady_clock::now();
 }
 
 ItemFaceCnn::~ItemFaceCnn()
@@ -16,55 +21,282 @@ ItemFaceCnn::~ItemFaceCnn()
 
 }
 
-void ItemFaceCnn::InputBgraRawPixelDataImpl(uint8_t* data, size_t size, size_t width, size_t height)
+void ItemFaceCnn::PrepareInput(uint8_t* data, size_t width, size_t height)
 {
-    auto _BgraToBgr = [](uint8_t* bgraData, int bgraSize, uint8_t* bgrData) {
-        for (int i = 0, j = 0; j < bgraSize; i += 3, j += 4) {
-            *(bgrData + i) = *(bgraData + j);
-            *(bgrData + i + 1) = *(bgraData + j + 1);
-            *(bgrData + i + 2) = *(bgraData + j + 2);
+    // 缩小和 BGRA -> BGR 一遍完成，结果坐标再换算回输入的大小
+    detect_width_ = (int)width;
+    detect_height_ = (int)height;
+    if (detect_width_ > kMaxDetectWidth)
+    {
+        detect_width_ = kMaxDetectWidth;
+        detect_height_ = std::max(1, (int)((height * kMaxDetectWidth + width / 2) / width));
+    }
+    bgr_buffer_.resize((size_t)detect_width_ * detect_height_ * 3);
+    ScaleToBgr(input_scaler_, data, (int)width * 4, (int)width, (int)height,
+        bgr_buffer_.data(), detect_width_, detect_height_);
+    scale_x_ = (float)width / detect_width_;
+    scale_y_ = (float)height / detect_height_;
+
+    const size_t pixels = (size_t)detect_width_ * detect_height_;
+    gray_buffer_.resize(pixels);
+    const uint8_t* bgr = bgr_buffer_.data();
+    for (size_t i = 0; i < pixels; i++, bgr += 3)
+        gray_buffer_[i] = (uint8_t)((bgr[0] * 29 + bgr[1] * 150 + bgr[2] * 77) >> 8);
+}
+
+void ItemFaceCnn::ScaleToBgr(VideoScaler& scaler, const uint8_t* src, int src_linesize, int src_width, int src_height,
+    uint8_t* dst, int dst_width, int dst_height)
+{
+    scaler.Init(VideoScaler::Format::kBGRAToBGR, src_width, src_height, dst_width, dst_height, VideoScaler::Filter::kArea);
+    const uint8_t* src_planes[] = { src };
+    const int src_linesizes[] = { src_linesize };
+    uint8_t* dst_planes[] = { dst };
+    const int dst_linesizes[] = { dst_width * 3 };
+    scaler.Scale(src_planes, src_linesizes, dst_planes, dst_linesizes);
+}
+
+void ItemFaceCnn::UpdateResult(const std::vector<FaceTracker::Box>& boxes)
+{
+    std::unique_lock<std::mutex> lock(mutex_);
+    face_result_.timestamp = GetFrameTimestamp();
+    if (boxes.empty())
+    {
+        face_result_.faceResult.Clear();
+        return;
+    }
+    face_result_.faceResult.Alloc((short)boxes.size());
+    for (size_t i = 0; i < boxes.size(); ++i) {
+        const FaceTracker::Box& box = boxes[i];
+        AiDetect::FaceDetectionCnn& info = face_result_.faceResult.info[i];
+        info.confidence = (short)box.confidence;
+        info.x = (short)(box.x * scale_x_);
+        info.y = (short)(box.y * scale_y_);
+        info.width = (short)(box.width * scale_x_);
+        info.height = (short)(box.height * scale_y_);
+        for (int j = 0; j < 10; j += 2)
+        {
+            info.landmark[j] = (short)(box.landmark[j] * scale_x_);
+            info.landmark[j + 1] = (short)(box.landmark[j + 1] * scale_y_);
         }
-    };
+    }
+}
+
+void ItemFaceCnn::DetectPass(const uint8_t* bgr, int width, int height, int step, float ox, float oy, float sx, float sy,
+    std::string& buffer, std::vector<FaceTracker::Box>& boxes)
+{
+    int* result = facedetect_cnn((unsigned char*)&buffer[0], (unsigned char*)bgr, width, height, step);
+    if (!result)
+        return;
+
+    for (int i = 0; i < *result; ++i) {
+        short* p = ((short*)(result + 1)) + 142 * i;
+        FaceTracker::Box box;
+        box.confidence = p[0];
+        box.x = ox + p[1] * sx;
+        box.y = oy + p[2] * sy;
+        box.width = p[3] * sx;
+        box.height = p[4] * sy;
+        for (int j = 0; j < 10; j += 2)
+        {
+            box.landmark[j] = ox + p[5 + j] * sx;
+            box.landmark[j + 1] = oy + p[6 + j] * sy;
+        }
+        boxes.push_back(box);
+    }
+}
+
+void ItemFaceCnn::RunTileJob(TileJob& job)
+{
+    std::chrono::steady_clock::time_point begin = std::chrono::steady_clock::now();
+    job.boxes.clear();
+    DetectPass(job.bgr, job.width, job.height, job.step, job.ox, job.oy, job.sx, job.sy, job.buffer, job.boxes);
+    job.ns = (uint64_t)std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - begin).count();
+    if (job.coarse)
+        return;
+
+    // 碰到块内侧边的框是被切开的脸：不超过重叠的脸在相邻块里是完整的，更大的由缩小的整幅检测负责
+    const float x0 = job.ox > 0.0f ? job.ox + kSeamMargin : -1e9f;
+    const float y0 = job.oy > 0.0f ? job.oy + kSeamMargin : -1e9f;
+    const float x1 = job.ox + job.width < detect_width_ ? job.ox + job.width - kSeamMargin : 1e9f;
+    const float y1 = job.oy + job.height < detect_height_ ? job.oy + job.height - kSeamMargin : 1e9f;
+    job.boxes.erase(std::remove_if(job.boxes.begin(), job.boxes.end(), [&](const FaceTracker::Box& box) {
+        return box.x < x0 || box.y < y0 || box.x + box.width > x1 || box.y + box.height > y1;
+    }), job.boxes.end());
+}
+
+int64_t ItemFaceCnn::DetectTiled(uint8_t* data, size_t width, size_t height, TaskPool* pool, size_t lanes)
+{
+    // 块直接指向 bgr_buffer_ 里的位置，不拷贝
+    tile_jobs_.resize(tiles_.size() + 1);
+    int64_t pixels = 0;
+    for (size_t i = 0; i < tiles_.size(); i++)
+    {
+        const FaceRoiPlanner::Rect& tile = tiles_[i];
+        TileJob& job = tile_jobs_[i];
+        job.bgr = bgr_buffer_.data() + ((size_t)tile.y * detect_width_ + tile.x) * 3;
+        job.width = tile.width;
+        job.height = tile.height;
+        job.step = detect_width_ * 3;
+        job.ox = (float)tile.x;
+        job.oy = (float)tile.y;
+        job.sx = job.sy = 1.0f;
+        job.coarse = false;
+        pixels += (int64_t)tile.width * tile.height;
+    }
+
+    // 比重叠大的脸缩到 kCoarseMinFace 以上，在缩小的整幅上检测
+    TileJob& coarse = tile_jobs_.back();
+    coarse.width = std::max(1, detect_width_ * kCoarseMinFace / kTileOverlap);
+    coarse.height = std::max(1, detect_height_ * kCoarseMinFace / kTileOverlap);
+    coarse.step = coarse.width * 3;
+    coarse_buffer_.resize((size_t)coarse.height * coarse.step);
+    ScaleToBgr(coarse_scaler_, data, (int)width * 4, (int)width, (int)height,
+        coarse_buffer_.data(), coarse.width, coarse.height);
+    coarse.bgr = coarse_buffer_.data();
+    coarse.ox = coarse.oy = 0.0f;
+    coarse.sx = (float)detect_width_ / coarse.width;
+    coarse.sy = (float)detect_height_ / coarse.height;
+    coarse.coarse = true;
+    pixels += (int64_t)coarse.width * coarse.height;
+
+    for (auto& job : tile_jobs_)
+    {
+        if (job.buffer.size() != kResultBufferSize)
+            job.buffer.resize(kResultBufferSize);
+    }
+
+    // 每条线从计数器取下一个任务，块比缩小的整幅大，排在前面
+    std::chrono::steady_clock::time_point begin = std::chrono::steady_clock::now();
+    std::atomic<size_t> next(0);
+    pool->ParallelFor(lanes, 1, [&](size_t, size_t) {
+        for (size_t i = next++; i < tile_jobs_.size(); i = next++)
+            RunTileJob(tile_jobs_[i]);
+    });
 
+    // 重叠区里的脸会在两块里各检出一次
+    uint64_t cpu_ns = 0;
+    for (const auto& job : tile_jobs_)
+    {
+        boxes_.insert(boxes_.end(), job.boxes.begin(), job.boxes.end());
+        cpu_ns += job.ns;
+    }
+    AddParallelWork((uint64_t)std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - begin).count(), cpu_ns);
+    FaceRoiPlanner::Nms(boxes_, roi_planner_.GetParams().nms_iou);
+    return pixels;
+}
+
+void ItemFaceCnn::InputBgraRawPixelDataImpl(uint8_t* data, size_t size, size_t width, size_t height)
+{
     is_detecting_.store(true);
 
-    std::shared_ptr<uint8_t> bgr_buffer(new uint8_t[width * height * 3], std::default_delete<uint8_t[]>());
-    _BgraToBgr(data, width * height * 4, bgr_buffer.get());
-    result_buffer_.clear();
-    int* result = facedetect_cnn((unsigned char*)&result_buffer_[0], bgr_buffer.get(), width, height, width * 3);
+    PrepareInput(data, width, height);
 
-    is_detecting_.store(false);
+    // 画面和上次检测时几乎一样，不跑 CNN，沿用上次的框；
+    // 跟踪器也拿这些框重新起跟踪，否则它一直等检测结果，画面静止期间就不跟踪了
+    if (motion_gate_enabled_ && !motion_gate_.Check(gray_buffer_.data(), detect_width_, detect_height_, detect_width_, GetFrameTimestamp()))
+    {
+        tracker_.OnDetection(gray_buffer_.data(), detect_width_, detect_height_, detect_width_, boxes_, FrameSeconds());
+        is_detecting_.store(false);
+        UpdateResult(boxes_);
+        LogRoiStats();
+        return;
+    }
 
-    std::unique_lock<std::mutex> lock(mutex_);
-    if (result)
+    // 上次的结果换到输入坐标，决定整幅检测还是只检测人脸附近
+    previous_.clear();
+    for (auto box : boxes_)
     {
-        face_result_.faceResult.Alloc(*result);
-        face_result_.faceResult.size = *result;
-        for (int i = 0; i < *result; ++i) {
-            short* p = ((short*)(result + 1)) + 142 * i;
-            face_result_.faceResult.info[i].confidence = p[0];
-            face_result_.faceResult.info[i].x = p[1];
-            face_result_.faceResult.info[i].y = p[2];
-            face_result_.faceResult.info[i].width = p[3];
-            face_result_.faceResult.info[i].height = p[4];
-            face_result_.faceResult.info[i].landmark[0] = p[5];
-            face_result_.faceResult.info[i].landmark[1] = p[6];
-            face_result_.faceResult.info[i].landmark[2] = p[7];
-            face_result_.faceResult.info[i].landmark[3] = p[8];
-            face_result_.faceResult.info[i].landmark[4] = p[9];
-            face_result_.faceResult.info[i].landmark[5] = p[10];
-            face_result_.faceResult.info[i].landmark[6] = p[11];
-            face_result_.faceResult.info[i].landmark[7] = p[12];
-            face_result_.faceResult.info[i].landmark[8] = p[13];
-            face_result_.faceResult.info[i].landmark[9] = p[14];
-        }
+        box.x *= scale_x_;
+        box.y *= scale_y_;
+        box.width *= scale_x_;
+        box.height *= scale_y_;
+        previous_.push_back(box);
     }
-    else
+    const bool full = roi_planner_.Plan((int)width, (int)height, kMaxDetectWidth, previous_, passes_);
+
+    boxes_.clear();
+    // 整幅检测时向调度器借空闲的名额，能切成多块就并行检测，不再走下面的单次整幅检测
+    DetectScheduler* scheduler = full ? GetTileScheduler() : nullptr;
+    const size_t helpers = scheduler ? scheduler->AcquireTileLanes(scheduler->GetTilePool()->GetThreadCount()) : 0;
+    if (helpers)
+        FaceRoiPlanner::PlanTiles(detect_width_, detect_height_, (int)helpers + 1, kTileOverlap, tiles_);
+    if (helpers && tiles_.size() > 1)
     {
-        face_result_.faceResult.Clear();
+        std::chrono::steady_clock::time_point begin = std::chrono::steady_clock::now();
+        const int64_t pixels = DetectTiled(data, width, height, scheduler->GetTilePool(), helpers + 1);
+        roi_planner_.Record(true, pixels,
+            std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - begin).count());
+        passes_.clear();
     }
+    if (helpers)
+        scheduler->ReleaseTileLanes(helpers);
+    for (const auto& pass : passes_)
+    {
+        std::chrono::steady_clock::time_point begin = std::chrono::steady_clock::now();
+        const uint8_t* bgr = bgr_buffer_.data();
+        if (!full)
+        {
+            crop_buffer_.resize((size_t)pass.dst_width * pass.dst_height * 3);
+            ScaleToBgr(crop_scaler_, data + (size_t)pass.src.y * width * 4 + (size_t)pass.src.x * 4, (int)width * 4,
+                pass.src.width, pass.src.height, crop_buffer_.data(), pass.dst_width, pass.dst_height);
+            bgr = crop_buffer_.data();
+        }
+        // 区域坐标 -> 输入坐标 -> 检测大小的坐标
+        DetectPass(bgr, pass.dst_width, pass.dst_height, pass.dst_width * 3, pass.src.x / scale_x_, pass.src.y / scale_y_,
+            (float)pass.src.width / pass.dst_width / scale_x_, (float)pass.src.height / pass.dst_height / scale_y_, result_buffer_, boxes_);
+        roi_planner_.Record(full, (int64_t)pass.dst_width * pass.dst_height,
+            std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - begin).count());
+    }
+    // 合并后的区域之间不重叠，但同一张脸可能跨在两块的边上
+    if (!full)
+        FaceRoiPlanner::Nms(boxes_, roi_planner_.GetParams().nms_iou);
+
+    // 检测结果同时作为跟踪器的新起点
+    tracker_.OnDetection(gray_buffer_.data(), detect_width_, detect_height_, detect_width_, boxes_, FrameSeconds());
+
+    is_detecting_.store(false);
+
+    UpdateResult(boxes_);
+    LogRoiStats();
+}
+
+void ItemFaceCnn::LogRoiStats()
+{
+    std::chrono::steady_clock::time_point now = std::chrono::steady_clock::now();
+    if (std::chrono::duration_cast<std::chrono::milliseconds>(now - stats_time_).count() < 1000)
+        return;
+    stats_time_ = now;
+
+    // 每次检测的平均像素数和耗时，能直接看出区域检测省了多少
+    const FaceRoiPlanner::Stats& stats = roi_planner_.GetStats();
+    LOGGER_INFO("full pass:%lld px:%lld avg:%.2fms, roi pass:%lld px:%lld avg:%.2fms",
+        stats.full_passes, stats.full_passes ? stats.full_pixels / stats.full_passes : 0,
+        stats.full_passes ? stats.full_us / 1000.0 / stats.full_passes : 0.0,
+        stats.roi_passes, stats.roi_passes ? stats.roi_pixels / stats.roi_passes : 0,
+        stats.roi_passes ? stats.roi_us / 1000.0 / stats.roi_passes : 0.0);
+    roi_planner_.ResetStats();
+
+    const MotionGate::Stats& motion = motion_gate_.GetStats();
+    LOGGER_INFO("motion gate run:%lld (refresh:%lld) skipped:%lld changed blocks:%d",
+        motion.run, motion.refreshed, motion.skipped, motion_gate_.GetChangedBlocks());
+    motion_gate_.ResetStats();
+}
 
+bool ItemFaceCnn::TrackBgraRawPixelDataImpl(uint8_t* data, size_t size, size_t width, size_t height)
+{
+    if (!tracker_.GetTrackCount())
+        return false;
+
+    PrepareInput(data, width, height);
+    tracker_.OnFrame(gray_buffer_.data(), detect_width_, detect_height_, detect_width_, FrameSeconds());
+    tracker_.GetBoxes(boxes_);
+    UpdateResult(boxes_);
+    return true;
+}
 
+bool ItemFaceCnn::NeedsDetection()
+{
+    return tracker_.NeedsDetection();
 }
 
 void ItemFaceCnn::GetOutputDetectResultImpl(AiDetect::AiDetectResult& result)
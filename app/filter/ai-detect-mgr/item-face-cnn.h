@@ -2,9 +2,17 @@
 #define ITEM_FACE_CNN_H
 
 #include "ai-detect-item-i.h"
+#include "face-tracker.h"
+#include "face-roi-planner.h"
+#include "motion-gate.h"
+#include "video-scaler.h"
 #include <vector>
 #include <string>
 #include <mutex>
+#include <atomic>
+#include <chrono>
+
+class TaskPool;
 
 class ItemFaceCnn : public IAiDetectItem
 {
@@ -15,9 +23,90 @@ public:
 	virtual void InputBgraRawPixelDataImpl(uint8_t* data, size_t size, size_t width, size_t height);
 	virtual void GetOutputDetectResultImpl(AiDetect::AiDetectResult& result);
 	virtual bool IsCurDetecting();
+	virtual bool TrackBgraRawPixelDataImpl(uint8_t* data, size_t size, size_t width, size_t height);
+	virtual bool NeedsDetection();
+	// 默认开启；同一张图反复输入时 (比如测吞吐) 要关掉，否则都会跳过
+	void EnableMotionGate(bool enable) { motion_gate_enabled_ = enable; }
+	void SetRoiParams(const FaceRoiPlanner::Params& params) { roi_planner_.SetParams(params); }
+
+private:
+	// 分块检测的一块：网络输入坐标按 x * sx + ox 换算到检测大小的坐标
+	struct TileJob
+	{
+		const uint8_t* bgr = nullptr;
+		int width = 0;
+		int height = 0;
+		int step = 0;
+		float ox = 0.0f;
+		float oy = 0.0f;
+		float sx = 1.0f;
+		float sy = 1.0f;
+		// 缩小的整幅检测没有块边
+		bool coarse = false;
+		// 这一块在所在线程上的耗时
+		uint64_t ns = 0;
+		std::string buffer;
+		std::vector<FaceTracker::Box> boxes;
+	};
 
 private:
+	// 缩小到检测大小，填 bgr_buffer_ 和 gray_buffer_
+	void PrepareInput(uint8_t* data, size_t width, size_t height);
+	// BGRA 区域按面积平均缩放成 BGR，scaler 尺寸不变时不重建系数表
+	static void ScaleToBgr(VideoScaler& scaler, const uint8_t* src, int src_linesize, int src_width, int src_height,
+		uint8_t* dst, int dst_width, int dst_height);
+	// 检测大小的框换算回输入大小写进结果
+	void UpdateResult(const std::vector<FaceTracker::Box>& boxes);
+	// 一块区域上跑 CNN，结果按 x * sx + ox 换算到检测大小的坐标追加到 boxes
+	static void DetectPass(const uint8_t* bgr, int width, int height, int step, float ox, float oy, float sx, float sy,
+		std::string& buffer, std::vector<FaceTracker::Box>& boxes);
+	// 整幅检测按 tiles_ 切块在 pool 上用 lanes 个线程 (含调用线程) 并行，另加一遍缩小的整幅检测，
+	// 结果做 NMS 后放进 boxes_；返回送进网络的像素数
+	int64_t DetectTiled(uint8_t* data, size_t width, size_t height, TaskPool* pool, size_t lanes);
+	void RunTileJob(TileJob& job);
+	void LogRoiStats();
+	// 跟踪器用源帧时间，秒
+	double FrameSeconds() const { return GetFrameTimestamp() / 1e9; }
+
+private:
+	// 检测网络输入的宽度上限，输入更宽时先按面积平均缩小
+	static const int kMaxDetectWidth = 320;
+	// facedetect_cnn 的结果缓冲，每个并行的检测一份
+	static const size_t kResultBufferSize = 0x20000;
+	// 相邻块的重叠 (检测大小的像素)，边长不超过它的脸总能完整落在某一块里
+	static const int kTileOverlap = 64;
+	// 缩小的整幅检测里脸的最小边长，比块重叠大的脸 (可能被块边切开) 在那里至少这么大
+	static const int kCoarseMinFace = 32;
+	// 框离块的内侧边不到这么多像素，算被块边切开
+	static const int kSeamMargin = 2;
+
 	std::string result_buffer_;
+	// 复用的 BGR 输入
+	std::vector<uint8_t> bgr_buffer_;
+	VideoScaler input_scaler_;
+	// 跟踪用的灰度图，和 bgr_buffer_ 同样大小
+	std::vector<uint8_t> gray_buffer_;
+	int detect_width_ = 0;
+	int detect_height_ = 0;
+	float scale_x_ = 1.0f;
+	float scale_y_ = 1.0f;
+	FaceTracker tracker_;
+	std::vector<FaceTracker::Box> boxes_;
+	// 上次的结果 (输入坐标)，决定这次检测的区域
+	FaceRoiPlanner roi_planner_;
+	std::vector<FaceTracker::Box> previous_;
+	std::vector<FaceRoiPlanner::Pass> passes_;
+	std::vector<uint8_t> crop_buffer_;
+	VideoScaler crop_scaler_;
+	// 分块检测，任务和缓冲复用
+	std::vector<FaceRoiPlanner::Rect> tiles_;
+	std::vector<TileJob> tile_jobs_;
+	std::vector<uint8_t> coarse_buffer_;
+	VideoScaler coarse_scaler_;
+	// 画面静止时跳过检测
+	MotionGate motion_gate_;
+	bool motion_gate_enabled_ = true;
+	std::chrono::steady_clock::time_point stats_time_;
 	AiDetect::AiDetectResult face_result_;
 	std::mutex mutex_;
 	std::atomic<bool> is_detecting_;
@@ -0,0 +1,65 @@
+#include "motion-gate.h"
+#include <string.h>
+#include <algorithm>
+
+void MotionGate::Reset()
+{
+	valid_ = false;
+	changed_blocks_ = 0;
+}
+
+void MotionGate::SetReference(const uint8_t* gray, int width, int height, int linesize, int64_t time)
+{
+	width_ = width;
+	height_ = height;
+	reference_.resize((size_t)width * height);
+	for (int y = 0; y < height; y++)
+		memcpy(reference_.data() + (size_t)y * width, gray + (size_t)y * linesize, width);
+	reference_time_ = time;
+	valid_ = true;
+}
+
+bool MotionGate::Check(const uint8_t* gray, int width, int height, int linesize, int64_t time)
+{
+	const int block = std::max(params_.block, 1);
+	changed_blocks_ = 0;
+	if (!valid_ || width != width_ || height != height_)
+	{
+		stats_.run++;
+		SetReference(gray, width, height, linesize, time);
+		return true;
+	}
+	if (params_.refresh_ms > 0 && time - reference_time_ >= (int64_t)params_.refresh_ms * 1000000)
+	{
+		stats_.run++;
+		stats_.refreshed++;
+		SetReference(gray, width, height, linesize, time);
+		return true;
+	}
+
+	const int columns = (width + block - 1) / block;
+	const int rows = (height + block - 1) / block;
+	sads_.resize((size_t)columns * rows);
+	CpuFilter::BlockSad(gray, linesize, reference_.data(), width, width, height, block, sads_.data(), options_);
+
+	// 边上不满的块按实际像素数算阈值
+	for (int j = 0; j < rows; j++)
+	{
+		const int bh = std::min(block, height - j * block);
+		for (int i = 0; i < columns; i++)
+		{
+			const int bw = std::min(block, width - i * block);
+			if (sads_[(size_t)j * columns + i] > (uint32_t)(params_.block_diff * bw * bh))
+				changed_blocks_++;
+		}
+	}
+
+	if (changed_blocks_ <= params_.max_changed_blocks)
+	{
+		stats_.skipped++;
+		return false;
+	}
+	stats_.run++;
+	SetReference(gray, width, height, linesize, time);
+	return true;
+}
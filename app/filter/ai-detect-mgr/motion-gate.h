@@ -0,0 +1,67 @@
+#ifndef MOTION_GATE_H
+#define MOTION_GATE_H
+
+/* 画面没变化时跳过人脸检测，直接沿用上次的结果
+* 检测大小的灰度图和上次真正跑检测时的参考帧逐块算绝对差 (CpuFilter::BlockSad)，
+* 平均每像素差超过 block_diff 的块算变化块，变化块不超过 max_changed_blocks 时跳过
+* 距上次检测超过 refresh_ms 时强制检测一次，避免缓慢变化一直累积不到阈值；尺寸变了也重新检测
+*/
+
+#include "cpu-filter.h"
+#include <stddef.h>
+#include <stdint.h>
+#include <vector>
+
+class MotionGate
+{
+public:
+	struct Params
+	{
+		// 块边长，8 的倍数时走 AVX2
+		int block = 16;
+		// 块内平均每像素的绝对差超过这个值算变化，要高于摄像头噪声
+		int block_diff = 6;
+		// 变化块不超过这个数时跳过检测
+		int max_changed_blocks = 0;
+		// 强制刷新间隔，<= 0 表示不强制
+		int refresh_ms = 1000;
+	};
+
+	struct Stats
+	{
+		int64_t run = 0;
+		int64_t skipped = 0;
+		// 因为到了刷新间隔才检测的次数，包含在 run 里
+		int64_t refreshed = 0;
+	};
+
+	void SetParams(const Params& params) { params_ = params; Reset(); }
+	const Params& GetParams() const { return params_; }
+	void SetOptions(const CpuFilter::Options& options) { options_ = options; }
+
+	// time 为帧时间 (纳秒)。返回 true 表示这帧要跑检测，同时把它记为参考帧
+	bool Check(const uint8_t* gray, int width, int height, int linesize, int64_t time);
+	void Reset();
+
+	// 上次 Check 数出的变化块数
+	int GetChangedBlocks() const { return changed_blocks_; }
+	const Stats& GetStats() const { return stats_; }
+	void ResetStats() { stats_ = Stats(); }
+
+private:
+	void SetReference(const uint8_t* gray, int width, int height, int linesize, int64_t time);
+
+private:
+	Params params_;
+	CpuFilter::Options options_;
+	std::vector<uint8_t> reference_;
+	std::vector<uint32_t> sads_;
+	int width_ = 0;
+	int height_ = 0;
+	int64_t reference_time_ = 0;
+	bool valid_ = false;
+	int changed_blocks_ = 0;
+	Stats stats_;
+};
+
+#endif
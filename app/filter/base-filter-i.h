@@ -6,6 +6,8 @@
 #include <string>
 #include "dx-header.h"
 #include "core-d3d-data.h"
+#include "core-property.h"
+#include "profiler.h"
 
 class CoreEngine;
 
@@ -16,13 +18,26 @@ public:
 	void SetCoreEnv(CoreEngine* engine) { core_engine_ = engine; }
 	void SetFilterName(const char* name) { filter_name_ = std::string(name); }
 	const char* GetFilterName() { return filter_name_.c_str(); }
+	// CoreFilter 按 "源/滤镜" 登记的耗时统计条目，RenderFilter 的 CPU/GPU 耗时记在上面
+	Profiler::Item* GetProfileItem() { return profile_item_; }
+	void SetProfileItem(Profiler::Item* item) { profile_item_ = item; }
 
 	virtual bool Init() = 0;
-	virtual void SetInputTexture(ID3D11Texture2D* texture, size_t width, size_t height, uint8_t* data = nullptr) = 0;
-	virtual void CopyOutputTexture(ID3D11Texture2D* texture) = 0;
-	virtual void Update(const char* jsondata) = 0;
+	// 读上一遍的输出 input，画到 output；两者都和源一样大，视口已经设好
+	// depth 是链上共用的深度缓冲，需要时自己清除再绑定；渲染目标由 CoreFilter 保存和恢复
+	// 不要 CopyResource 输入输出，也不要把 input 当渲染目标
+	virtual void RenderFilter(ID3D11ShaderResourceView* input, ID3D11RenderTargetView* output, ID3D11DepthStencilView* depth, size_t width, size_t height) = 0;
+	virtual void Update(const CoreProperty::PropertyBag& props) = 0;
+	// 在加载线程里调用，只做文件读取和解码，D3D 资源在 RenderFilter 里创建；需要可重复调用
+	virtual bool Load() { return true; }
+	// 跟随所属源的激活/显示状态，在渲染线程调用；隐藏时停掉后台线程，反激活时可以释放大块缓冲
+	virtual void OnActivate() {}
+	virtual void OnDeactivate() {}
+	virtual void OnShow() {}
+	virtual void OnHide() {}
 
 protected:
 	CoreEngine* core_engine_ = nullptr;
 	std::string filter_name_ = "";
+	Profiler::Item* profile_item_ = nullptr;
 };
\ No newline at end of file
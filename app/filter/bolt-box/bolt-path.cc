@@ -0,0 +1,116 @@
+#include "bolt-path.h"
+
+namespace
+{
+	void DrawSnake(BoltPath::Quad& quad, int width, int height, int line_height, BoltPath::Side side, float startpos, float line)
+	{
+		using namespace BoltPath;
+
+		float h = line_height / 2.0 / (float)height;
+		float w = line_height / 2.0 / (float)width;
+		switch (side)
+		{
+		case kUp:
+			quad.v[0] = { startpos, 1.0f - h, 0.0f, 1.0f };
+			quad.v[1] = { startpos, 1.0f, 0.0f, 0.0f };
+			quad.v[2] = { startpos + line, 1.0f, 1.0f, 0.0f };
+			quad.v[3] = { startpos + line, 1.0f - h, 1.0f, 1.0f };
+			break;
+		case kRight:
+			quad.v[0] = { 1.0f - w, startpos - line, 1.0f, 1.0f };
+			quad.v[1] = { 1.0f - w, startpos, 0.0f, 1.0f };
+			quad.v[2] = { 1.0f, startpos, 0.0f, 0.0f };
+			quad.v[3] = { 1.0f, startpos - line, 1.0f, 0.0f };
+			break;
+		case kDown:
+			quad.v[0] = { startpos - line, -1.0f, 1.0f, 0.0f };
+			quad.v[1] = { startpos - line, -1.0f + h, 1.0f, 1.0f };
+			quad.v[2] = { startpos, -1.0f + h, 0.0f, 1.0f };
+			quad.v[3] = { startpos, -1.0f, 0.0f, 0.0f };
+			break;
+		case kLeft:
+			quad.v[0] = { -1.0f, startpos, 0.0f, 0.0f };
+			quad.v[1] = { -1.0f, startpos + line, 1.0f, 0.0f };
+			quad.v[2] = { -1.0f + w, startpos + line, 1.0f, 1.0f };
+			quad.v[3] = { -1.0f + w, startpos, 0.0f, 1.0f };
+			break;
+		}
+	}
+}
+
+namespace BoltPath
+{
+	size_t BuildQuads(int width, int height, int line_height, int step, int steps, Quad quads[kMaxQuads])
+	{
+		if (width <= 0 || height <= 0 || steps <= 0)
+			return 0;
+
+		float total = (width + height) * 2.0;
+		float boltline = height > width ? height : width;
+		float stride = total / (float)steps;
+		float walked = stride * step;
+
+		size_t count = 0;
+		auto snake = [&](Side side, float startpos, float line) {
+			DrawSnake(quads[count++], width, height, line_height, side, startpos, line);
+		};
+
+		if (walked < width)
+		{
+			float linewalked = walked;
+
+			if (linewalked >= boltline)
+			{
+				snake(kUp, (linewalked - boltline) / width * 2.0 - 1.0, boltline / width * 2.0);
+			}
+			else
+			{
+				snake(kLeft, (1.0 - (boltline - linewalked) / height) * 2.0 - 1.0, (boltline - linewalked) / height * 2.0);
+				snake(kUp, -1.0, linewalked / width * 2.0);
+			}
+		}
+		else if (walked >= width && walked < (width + height))
+		{
+			float linewalked = walked - width;
+
+			if (linewalked >= boltline)
+			{
+				snake(kRight, (1.0 - (linewalked - boltline) / height) * 2.0 - 1.0, boltline / height * 2.0);
+			}
+			else
+			{
+				snake(kRight, 1.0, linewalked / height * 2.0);
+				snake(kUp, (1.0 - (boltline - linewalked) / width) * 2.0 - 1.0, (boltline - linewalked) / width * 2.0);
+			}
+		}
+		else if (walked >= (width + height) && walked < (width * 2 + height))
+		{
+			float linewalked = walked - width - height;
+
+			if (linewalked >= boltline)
+			{
+				snake(kDown, (1.0 - (linewalked - boltline) / width) * 2.0 - 1.0, boltline / width * 2.0);
+			}
+			else
+			{
+				snake(kDown, 1.0, linewalked / width * 2.0);
+				snake(kRight, (boltline - linewalked) / height * 2.0 - 1.0, (boltline - linewalked) / height * 2.0);
+			}
+		}
+		else
+		{
+			float linewalked = walked - width * 2 - height;
+
+			if (linewalked >= boltline)
+			{
+				snake(kLeft, (linewalked - boltline) / height * 2.0 - 1.0, boltline / height * 2.0);
+			}
+			else
+			{
+				snake(kLeft, -1.0, linewalked / height * 2.0);
+				snake(kDown, (boltline - linewalked) / width * 2.0 - 1.0, (boltline - linewalked) / width * 2.0);
+			}
+		}
+		return count;
+	}
+}
@@ -0,0 +1,41 @@
+#ifndef BOLT_PATH_H
+#define BOLT_PATH_H
+
+/* 闪电框的几何，不依赖 D3D，BoltBoxFilter 和 CPU 版本的闪电框共用
+* 闪电沿源的四条边顺时针绕圈，steps 步绕一圈，每步最多跨两条边，所以最多两个四边形
+*/
+
+#include <stddef.h>
+
+namespace BoltPath
+{
+	enum Side : int
+	{
+		kUp = 0,
+		kRight,
+		kDown,
+		kLeft,
+	};
+
+	// NDC 坐标 + 纹理坐标，和 VertexPosTex 一一对应
+	struct Vertex
+	{
+		float x;
+		float y;
+		float u;
+		float v;
+	};
+
+	// 两个三角形，索引 0 1 2 2 3 0
+	struct Quad
+	{
+		Vertex v[4];
+	};
+
+	const size_t kMaxQuads = 2;
+
+	// 源大小 width x height，闪电粗 line_height 像素，返回第 step 步的四边形个数
+	size_t BuildQuads(int width, int height, int line_height, int step, int steps, Quad quads[kMaxQuads]);
+}
+
+#endif
@@ -6,6 +6,7 @@
 #include "core-d3d.h"
 #include "core-engine.h"
 #include "json.hpp"
+#include "bolt-path.h"
 
 BoltBoxFilter::BoltBoxFilter()
 {
@@ -14,10 +15,16 @@ BoltBoxFilter::BoltBoxFilter()
 
 BoltBoxFilter::~BoltBoxFilter()
 {
-	for (auto& c = bolt_bitmap_vec_.begin(); c != bolt_bitmap_vec_.end();)
+	FreeBoltBitmaps(bolt_bitmap_vec_);
+	FreeBoltBitmaps(pending_bitmap_vec_);
+}
+
+void BoltBoxFilter::FreeBoltBitmaps(std::vector<BitmapTexture::Bitmap*>& bitmaps)
+{
+	for (auto c = bitmaps.begin(); c != bitmaps.end();)
 	{
 		BitmapTexture::Bitmap* bitmap = *c;
-		c = bolt_bitmap_vec_.erase(c);
+		c = bitmaps.erase(c);
 		delete bitmap;
 		bitmap = nullptr;
 	}
@@ -28,41 +35,61 @@ bool BoltBoxFilter::Init()
 	return true;
 }
 
-void BoltBoxFilter::Update(const char* jsondata)
+void BoltBoxFilter::Update(const CoreProperty::PropertyBag& props)
 {
-	try
-	{
-		auto json = nlohmann::json::parse(jsondata);
-		if (!json.is_object())
-			return;
-		if (json.find("path") != json.end())
-		{
-			std::string path = json.at("path");
-			InitBoltBitmapRes(path.c_str());
-		}
-	}
-	catch (...)
-	{
+	const char* path = props.GetString(CoreProperty::PropertyId::kPath);
+	if (!path)
+		return;
+	std::unique_lock<std::mutex> lock(bolt_mutex_);
+	bolt_path_ = path;
+}
 
+bool BoltBoxFilter::Load()
+{
+	std::string path;
+	{
+		std::unique_lock<std::mutex> lock(bolt_mutex_);
+		path = bolt_path_;
 	}
+	if (path.empty() || path == loaded_path_)
+		return true;
+
+	std::vector<BitmapTexture::Bitmap*> bitmaps;
+	InitBoltBitmapRes(path.c_str(), bitmaps);
+	if (bitmaps.empty())
+		return false;
+	loaded_path_ = path;
+
+	// 在 RenderFilter 里由渲染线程换上
+	std::unique_lock<std::mutex> lock(bolt_mutex_);
+	FreeBoltBitmaps(pending_bitmap_vec_);
+	pending_bitmap_vec_.swap(bitmaps);
+	return true;
 }
 
-void BoltBoxFilter::SetInputTexture(ID3D11Texture2D* texture, size_t width, size_t height, uint8_t* data)
+void BoltBoxFilter::RenderFilter(ID3D11ShaderResourceView* input, ID3D11RenderTargetView* output, ID3D11DepthStencilView* depth, size_t width, size_t height)
 {
 	CoreD3D* d3d = core_engine_->GetD3D();
 
+	{
+		std::unique_lock<std::mutex> lock(bolt_mutex_);
+		if (!pending_bitmap_vec_.empty())
+		{
+			FreeBoltBitmaps(bolt_bitmap_vec_);
+			bolt_bitmap_vec_.swap(pending_bitmap_vec_);
+			bolt_texture_.Reset();
+			bolt_shader_resource_.Reset();
+			cur_bolt_frame_ = 0;
+		}
+	}
+
+	texture_width_ = width;
+	texture_height_ = height;
 	ResetBoltResource(width,height);
 	LoadBoltResource();
-	ResetFilterResource(width, height);
-
-	ComPtr<ID3D11RenderTargetView> View;
-	ComPtr<ID3D11DepthStencilView> Depth;
-	d3d->OMGetRenderTargets(1, View.GetAddressOf(), Depth.GetAddressOf());
 
-	d3d->CopyResource(output_texture_.Get(), texture);
-
-	d3d->ClearDepthStencilView(depth_stencil_view_.Get(), D3D11_CLEAR_DEPTH | D3D11_CLEAR_STENCIL, 1.0f, 0);
-	d3d->OMSetRenderTargets(1, render_target_view_.GetAddressOf(), depth_stencil_view_.Get());
+	d3d->ClearDepthStencilView(depth, D3D11_CLEAR_DEPTH | D3D11_CLEAR_STENCIL, 1.0f, 0);
+	d3d->OMSetRenderTargets(1, &output, depth);
 
 	d3d->UpdateVertexShader(CoreD3DData::VertexHlslType::kBasic2D);
 	d3d->UpdatePixelShader(CoreD3DData::PixelHlslType::kBasic2D);
@@ -70,46 +97,12 @@ void BoltBoxFilter::SetInputTexture(ID3D11Texture2D* texture, size_t width, size
 	UINT buffersize = 0;
 	auto meshData = Geometry::Create2DShow();
 	d3d->ResetMesh(meshData, buffersize);
-	d3d->PSSetShaderResources(0, 1, output_texture_view_.GetAddressOf());
+	d3d->PSSetShaderResources(0, 1, &input);
 	d3d->DrawIndexed(buffersize, 0, 0);
 
 	buffersize = LoadBoltVertexBuffer();
 	d3d->PSSetShaderResources(0, 1, bolt_shader_resource_.GetAddressOf());
 	d3d->DrawIndexed(buffersize, 0, 0);
-	
-	d3d->CopyResource(output_texture_.Get(), render_texture_.Get());
-
-	d3d->OMSetRenderTargets(1, View.GetAddressOf(), Depth.Get());
-
-}
-
-void BoltBoxFilter::CopyOutputTexture(ID3D11Texture2D* texture)
-{
-	CoreD3D* d3d = core_engine_->GetD3D();
-	if (output_texture_)
-		d3d->CopyResource(texture, output_texture_.Get());
-}
-
-void BoltBoxFilter::ResetFilterResource(int width, int height)
-{
-	CoreD3D* d3d = core_engine_->GetD3D();
-	if (texture_width_ != width || texture_height_ != height)
-	{
-		texture_width_ = width;
-		texture_height_ = height;
-
-		output_texture_.Reset();
-		output_texture_view_.Reset();
-		render_texture_.Reset();
-		render_target_view_.Reset();
-
-		d3d->CreateD3DTexture(output_texture_.GetAddressOf(), false, false, width, height, false);
-		d3d->CreateShaderResourceView(output_texture_.Get(), output_texture_view_.GetAddressOf());
-		d3d->CreateD3DTexture(render_texture_.GetAddressOf(), true, false, width, height, false);
-		d3d->CreateRenderTargetView(render_texture_.Get(), render_target_view_.GetAddressOf());
-		d3d->CreateDepthStencilBuffer(depth_stencil_buffer_.GetAddressOf(), width, height);
-		d3d->CreateDepthStencilView(depth_stencil_buffer_.Get(), depth_stencil_view_.GetAddressOf());
-	}
 }
 
 void BoltBoxFilter::LoadBoltResource()
@@ -180,7 +173,7 @@ void BoltBoxFilter::ResetBoltResource(int width, int height)
 
 }
 
-void BoltBoxFilter::InitBoltBitmapRes(const char* path)
+void BoltBoxFilter::InitBoltBitmapRes(const char* path, std::vector<BitmapTexture::Bitmap*>& bitmaps)
 {
 	std::string sPath = path;
 	char fix[4] = { 0 };
@@ -192,7 +185,7 @@ void BoltBoxFilter::InitBoltBitmapRes(const char* path)
 		BitmapTexture::Bitmap* bitmap = BitmapTexture::Bitmap::LoadFile(filePath.c_str());
 		if (bitmap)
 		{
-			bolt_bitmap_vec_.push_back(bitmap);
+			bitmaps.push_back(bitmap);
 		}
 	}
 
@@ -204,142 +197,23 @@ UINT BoltBoxFilter::LoadBoltVertexBuffer()
 
 	CoreD3D* d3d = core_engine_->GetD3D();
 
-	auto DrawSnake = [&](std::vector<VertexPosTex>& vertexvec, std::vector<DWORD>& indexvec, BoltDirection direction, float startpos, float line, DWORD offset) {
-		float height = bolt_lineheight_ / 2.0 / (float)texture_height_;
-		float width = bolt_lineheight_ / 2.0 / (float)texture_width_;
-		switch (direction)
-		{
-		case BoltDirection::kUp:
-		{
-			vertexvec.push_back({ XMFLOAT3(startpos, 1.0f - height, 0.0f), XMFLOAT2(0.0f, 1.0f) });
-			vertexvec.push_back({ XMFLOAT3(startpos, 1.0f, 0.0f), XMFLOAT2(0.0f, 0.0f) });
-			vertexvec.push_back({ XMFLOAT3(startpos + line, 1.0f, 0.0f), XMFLOAT2(1.0f, 0.0f) });
-			vertexvec.push_back({ XMFLOAT3(startpos + line, 1.0f - height, 0.0f), XMFLOAT2(1.0f, 1.0f) });
-		}
-		break;
-		case BoltDirection::kRight:
-		{
-			vertexvec.push_back({ XMFLOAT3(1.0f - width, startpos - line, 0.0f), XMFLOAT2(1.0f, 1.0f) });
-			vertexvec.push_back({ XMFLOAT3(1.0f - width, startpos, 0.0f), XMFLOAT2(0.0f, 1.0f) });
-			vertexvec.push_back({ XMFLOAT3(1.0f, startpos, 0.0f), XMFLOAT2(0.0f, 0.0f) });
-			vertexvec.push_back({ XMFLOAT3(1.0f, startpos - line, 0.0f), XMFLOAT2(1.0f, 0.0f) });
-		}
-		break;
-		case BoltDirection::kDown:
-		{
-			vertexvec.push_back({ XMFLOAT3(startpos - line, -1.0f, 0.0f), XMFLOAT2(1.0f, 0.0f) });
-			vertexvec.push_back({ XMFLOAT3(startpos - line, -1.0f + height, 0.0f), XMFLOAT2(1.0f, 1.0f) });
-			vertexvec.push_back({ XMFLOAT3(startpos, -1.0f + height, 0.0f), XMFLOAT2(0.0f, 1.0f) });
-			vertexvec.push_back({ XMFLOAT3(startpos, -1.0f, 0.0f), XMFLOAT2(0.0f, 0.0f) });
-		}
-		break;
-		case BoltDirection::kLeft:
-		{
-			vertexvec.push_back({ XMFLOAT3(-1.0f, startpos, 0.0f), XMFLOAT2(0.0f, 0.0f) });
-			vertexvec.push_back({ XMFLOAT3(-1.0f, startpos + line, 0.0f), XMFLOAT2(1.0f, 0.0f) });
-			vertexvec.push_back({ XMFLOAT3(-1.0f + width, startpos + line, 0.0f), XMFLOAT2(1.0f, 1.0f) });
-			vertexvec.push_back({ XMFLOAT3(-1.0f + width, startpos, 0.0f), XMFLOAT2(0.0f, 1.0f) });
-		}
-		break;
-		}
-		indexvec.insert(indexvec.end(), { offset,offset + 1, offset + 2, offset + 2, offset + 3, offset });
-	};
-
 	vertex_buffer_.Reset();
 	index_buffer_.Reset();
 
-	float total = (texture_width_ + texture_height_) * 2.0;
-	float boltline = texture_height_ > texture_width_ ? texture_height_ : texture_width_;
-	float step = total / (float)max_bolt_frame_ ;
-	float walked = step * cur_step_cnt_;
+	BoltPath::Quad quads[BoltPath::kMaxQuads];
+	size_t count = BoltPath::BuildQuads(texture_width_, texture_height_, bolt_lineheight_, cur_step_cnt_, max_bolt_frame_, quads);
 	cur_step_cnt_ += 1;
 	if (cur_step_cnt_ >= max_bolt_frame_ )
 		cur_step_cnt_ = 0;
 
 	std::vector<VertexPosTex> vertexvec;
 	std::vector< DWORD> indexvec;
-
-	if (walked < texture_width_)
-	{
-		float linewalked = walked;
-
-		if (linewalked >= boltline)
-		{
-			float startpos = (linewalked - boltline) / texture_width_ * 2.0 - 1.0;
-			float line = boltline / texture_width_ * 2.0;
-			DrawSnake(vertexvec, indexvec, BoltDirection::kUp, startpos, line, 0);
-		}
-		else
-		{
-			float startpos = (1.0 - (boltline - linewalked) / texture_height_) * 2.0 - 1.0;
-			float line = (boltline - linewalked) / texture_height_ * 2.0;
-			DrawSnake(vertexvec, indexvec, BoltDirection::kLeft, startpos, line, 0);
-
-			startpos = -1.0;
-			line = linewalked / texture_width_ * 2.0;
-			DrawSnake(vertexvec, indexvec, BoltDirection::kUp, startpos, line, vertexvec.size());
-		}
-	}
-	else if (walked >= texture_width_ && walked < (texture_width_ + texture_height_))
-	{
-		float linewalked = walked - texture_width_;
-
-		if (linewalked >= boltline)
-		{
-			float startpos = (1.0 - (linewalked - boltline) / texture_height_) * 2.0 - 1.0;
-			float line = boltline / texture_height_ * 2.0;
-			DrawSnake(vertexvec, indexvec, BoltDirection::kRight, startpos, line, 0);
-		}
-		else
-		{
-			float startpos = 1.0;
-			float line = linewalked / texture_height_ * 2.0;
-			DrawSnake(vertexvec, indexvec, BoltDirection::kRight, startpos, line, 0);
-
-			startpos = (1.0 - (boltline - linewalked) / texture_width_ ) * 2.0 - 1.0;
-			line = (boltline - linewalked) / texture_width_ * 2.0;
-			DrawSnake(vertexvec, indexvec, BoltDirection::kUp, startpos, line, vertexvec.size());
-		}
-	}
-	else if (walked >= (texture_width_ + texture_height_) && walked < (texture_width_ * 2 + texture_height_))
+	for (size_t i = 0; i < count; i++)
 	{
-		float linewalked = walked - texture_width_ - texture_height_;
-		if (linewalked >= boltline)
-		{
-			float startpos = (1.0 - (linewalked - boltline) / texture_width_) * 2.0 - 1.0;
-			float line = boltline / texture_width_ * 2.0;
-			DrawSnake(vertexvec, indexvec, BoltDirection::kDown, startpos, line, 0);
-		}
-		else
-		{
-			float startpos = 1.0;
-			float line = linewalked / texture_width_ * 2.0;
-			DrawSnake(vertexvec, indexvec, BoltDirection::kDown, startpos, line, 0);
-
-			startpos = (boltline - linewalked) / texture_height_ * 2.0 - 1.0;
-			line = (boltline - linewalked) / texture_height_ * 2.0;
-			DrawSnake(vertexvec, indexvec, BoltDirection::kRight, startpos, line, vertexvec.size());
-		}
-	}
-	else
-	{
-		float linewalked = walked - texture_width_* 2 - texture_height_;
-		if (linewalked >= boltline)
-		{
-			float startpos = (linewalked - boltline) / texture_height_ * 2.0 - 1.0;
-			float line = boltline / texture_height_ * 2.0;
-			DrawSnake(vertexvec, indexvec, BoltDirection::kLeft, startpos, line, 0);
-		}
-		else
-		{
-			float startpos = -1.0;
-			float line = linewalked / texture_height_ * 2.0;
-			DrawSnake(vertexvec, indexvec, BoltDirection::kLeft, startpos, line, 0);
-
-			startpos = (boltline - linewalked) / texture_width_ * 2.0 - 1.0;
-			line = (boltline - linewalked) / texture_width_ * 2.0;
-			DrawSnake(vertexvec, indexvec, BoltDirection::kDown, startpos, line, vertexvec.size());
-		}
+		DWORD offset = (DWORD)vertexvec.size();
+		for (const auto& c : quads[i].v)
+			vertexvec.push_back({ XMFLOAT3(c.x, c.y, 0.0f), XMFLOAT2(c.u, c.v) });
+		indexvec.insert(indexvec.end(), { offset,offset + 1, offset + 2, offset + 2, offset + 3, offset });
 	}
 	
 	UINT index_buffer_size_ = 0;
@@ -3,6 +3,7 @@
 
 #include <vector>
 #include <string>
+#include <mutex>
 #include "base-filter-i.h"
 #include "bitmap-texture-file.h"
 
@@ -23,13 +24,13 @@ public:
 	virtual ~BoltBoxFilter();
 
 	virtual bool Init();
-	virtual void SetInputTexture(ID3D11Texture2D* texture, size_t width, size_t height, uint8_t* data = nullptr);
-	virtual void CopyOutputTexture(ID3D11Texture2D* texture);
-	virtual void Update(const char* jsondata);
+	virtual void RenderFilter(ID3D11ShaderResourceView* input, ID3D11RenderTargetView* output, ID3D11DepthStencilView* depth, size_t width, size_t height);
+	virtual void Update(const CoreProperty::PropertyBag& props);
+	virtual bool Load();
 
 private:
-	void ResetFilterResource(int width, int height);
-	void InitBoltBitmapRes(const char* path);
+	void InitBoltBitmapRes(const char* path, std::vector<BitmapTexture::Bitmap*>& bitmaps);
+	static void FreeBoltBitmaps(std::vector<BitmapTexture::Bitmap*>& bitmaps);
 	void ResetBoltResource(int width, int height);
 	void LoadBoltResource();
 	UINT LoadBoltVertexBuffer();
@@ -41,19 +42,19 @@ private:
 	int cur_bolt_frame_ = 0;
 	int max_bolt_frame_ = 60;
 	int cur_step_cnt_ = 0;
-	ComPtr< ID3D11Texture2D> output_texture_;
-	ComPtr<ID3D11ShaderResourceView> output_texture_view_;
-	ComPtr< ID3D11Texture2D> render_texture_;
-	ComPtr< ID3D11RenderTargetView> render_target_view_;
 	ComPtr< ID3D11Texture2D> bolt_texture_;
 	ComPtr< ID3D11ShaderResourceView > bolt_shader_resource_;
 	ComPtr<ID3D11Buffer> vertex_buffer_;
 	ComPtr<ID3D11Buffer> index_buffer_;
-	ComPtr<ID3D11Texture2D> depth_stencil_buffer_;
-	ComPtr<ID3D11DepthStencilView> depth_stencil_view_;
 
 	std::vector< BitmapTexture::Bitmap*> bolt_bitmap_vec_;
 
+	std::mutex bolt_mutex_;
+	std::string bolt_path_;
+	// 加载线程读好的位图，RenderFilter 时换到 bolt_bitmap_vec_
+	std::string loaded_path_;
+	std::vector< BitmapTexture::Bitmap*> pending_bitmap_vec_;
+
 	BoltDirection bolt_direction_ = BoltDirection::kStart;
 };
 
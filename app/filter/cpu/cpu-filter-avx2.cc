@@ -0,0 +1,316 @@
+// 这个文件单独用 AVX2 编译选项编译，只能在 cpu_has_avx2() 为真时调用
+#include "cpu-filter-kernels.h"
+#include <immintrin.h>
+
+namespace
+{
+	// (a * (256 - w) + b * w + 128) >> 8，16 位通道，a b w 都不超过 256
+	inline __m256i Lerp16(__m256i a, __m256i b, __m256i w, __m256i inv, __m256i round)
+	{
+		__m256i sum = _mm256_add_epi16(_mm256_mullo_epi16(a, inv), _mm256_mullo_epi16(b, w));
+		return _mm256_srli_epi16(_mm256_add_epi16(sum, round), 8);
+	}
+
+	// 8 个像素各自的权重扩到 4 个通道，和 unpacklo/hi_epi8 的像素顺序对应
+	inline void SpreadWeights(__m256i w32, __m256i& lo, __m256i& hi)
+	{
+		__m256i w = _mm256_or_si256(w32, _mm256_slli_epi32(w32, 16));
+		lo = _mm256_unpacklo_epi32(w, w);
+		hi = _mm256_unpackhi_epi32(w, w);
+	}
+
+	// b > a 的通道交换，offset 跟着换
+	inline void OrderPair(__m256i& wa, __m256i& wb, __m256i& oa, __m256i& ob)
+	{
+		__m256i swap = _mm256_cmpgt_epi32(wb, wa);
+		__m256i w = _mm256_blendv_epi8(wa, wb, swap);
+		__m256i o = _mm256_blendv_epi8(oa, ob, swap);
+		wb = _mm256_blendv_epi8(wb, wa, swap);
+		ob = _mm256_blendv_epi8(ob, oa, swap);
+		wa = w;
+		oa = o;
+	}
+
+	// (a * (256 - w) + b * w + 128) >> 8，32 位通道
+	inline __m256i Lerp32(__m256i a, __m256i b, __m256i w, __m256i inv, __m256i round)
+	{
+		__m256i sum = _mm256_add_epi32(_mm256_mullo_epi32(a, inv), _mm256_mullo_epi32(b, w));
+		return _mm256_srli_epi32(_mm256_add_epi32(sum, round), 8);
+	}
+
+	// 8 个像素三个通道在 axis 里查到的格点下标和权重
+	struct LutAxes
+	{
+		__m256i pixels;
+		__m256i base;
+		__m256i weight[3];
+	};
+
+	inline void LoadLutAxes(const CpuFilterKernels::LutView& lut, const uint8_t* src, LutAxes& axes)
+	{
+		const __m256i byte_mask = _mm256_set1_epi32(0xFF);
+		const __m256i weight_mask = _mm256_set1_epi32(511);
+		axes.pixels = _mm256_loadu_si256((const __m256i*)src);
+		axes.base = _mm256_setzero_si256();
+		for (int c = 0; c < 3; c++)
+		{
+			__m256i value = _mm256_and_si256(_mm256_srli_epi32(axes.pixels, c * 8), byte_mask);
+			__m256i axis = _mm256_i32gather_epi32(lut.axis + c * 256, value, 4);
+			axes.base = _mm256_add_epi32(axes.base, _mm256_mullo_epi32(_mm256_srli_epi32(axis, 9), _mm256_set1_epi32(lut.stride[c])));
+			axes.weight[c] = _mm256_and_si256(axis, weight_mask);
+		}
+	}
+
+	// 三个通道的 8 位结果拼回 BGRA，alpha 取原像素
+	inline __m256i PackLutResult(const __m256i result[3], __m256i pixels)
+	{
+		__m256i out = _mm256_and_si256(pixels, _mm256_set1_epi32((int)0xFF000000));
+		for (int c = 0; c < 3; c++)
+			out = _mm256_or_si256(out, _mm256_slli_epi32(result[c], c * 8));
+		return out;
+	}
+}
+
+namespace CpuFilterKernels
+{
+	int LerpRow_AVX2(const uint8_t* a, int weight, uint8_t* dst, int count)
+	{
+		const __m256i zero = _mm256_setzero_si256();
+		const __m256i w = _mm256_set1_epi16((int16_t)weight);
+		const __m256i inv = _mm256_set1_epi16((int16_t)(256 - weight));
+		const __m256i round = _mm256_set1_epi16(128);
+
+		// b 比 a 多读一个像素，调用方保证最后一个像素的 b 也在行内
+		const int end = count & ~7;
+		int x = 0;
+		for (; x < end; x += 8)
+		{
+			__m256i pa = _mm256_loadu_si256((const __m256i*)(a + x * 4));
+			__m256i pb = _mm256_loadu_si256((const __m256i*)(a + x * 4 + 4));
+			__m256i lo = Lerp16(_mm256_unpacklo_epi8(pa, zero), _mm256_unpacklo_epi8(pb, zero), w, inv, round);
+			__m256i hi = Lerp16(_mm256_unpackhi_epi8(pa, zero), _mm256_unpackhi_epi8(pb, zero), w, inv, round);
+			_mm256_storeu_si256((__m256i*)(dst + x * 4), _mm256_packus_epi16(lo, hi));
+		}
+		return x;
+	}
+
+	int AlphaClipRow_AVX2(const uint8_t* src, uint8_t* dst, int count)
+	{
+		const __m256i threshold = _mm256_set1_epi32(25);
+		const int end = count & ~7;
+		int x = 0;
+		for (; x < end; x += 8)
+		{
+			__m256i s = _mm256_loadu_si256((const __m256i*)(src + x * 4));
+			__m256i d = _mm256_loadu_si256((const __m256i*)(dst + x * 4));
+			__m256i keep = _mm256_cmpgt_epi32(_mm256_srli_epi32(s, 24), threshold);
+			_mm256_storeu_si256((__m256i*)(dst + x * 4), _mm256_blendv_epi8(d, s, keep));
+		}
+		return x;
+	}
+
+	int SampleSpan_AVX2(const TexSpan& span, uint8_t* dst, int count)
+	{
+		const int32_t half = 1 << (kCoordBits - 1);
+		const __m256i zero = _mm256_setzero_si256();
+		const __m256i v256 = _mm256_set1_epi16(256);
+		const __m256i round = _mm256_set1_epi16(128);
+		const __m256i frac_mask = _mm256_set1_epi32(0xFF);
+		const __m256i smin = _mm256_set1_epi32(-half);
+		const __m256i smax = _mm256_set1_epi32((span.width << kCoordBits) - half);
+		const __m256i tmax = _mm256_set1_epi32((span.height << kCoordBits) - half);
+		const __m256i width = _mm256_set1_epi32(span.width);
+		const __m256i height = _mm256_set1_epi32(span.height);
+		const __m256i width_m1 = _mm256_set1_epi32(span.width - 1);
+		const __m256i height_m1 = _mm256_set1_epi32(span.height - 1);
+		const __m256i linesize = _mm256_set1_epi32(span.linesize);
+		const __m256i lane = _mm256_setr_epi32(0, 1, 2, 3, 4, 5, 6, 7);
+		const __m256i ds = _mm256_set1_epi32(span.ds);
+		const __m256i dt = _mm256_set1_epi32(span.dt);
+		const int* tex = (const int*)span.tex;
+
+		const int end = count & ~7;
+		int x = 0;
+		for (; x < end; x += 8)
+		{
+			__m256i idx = _mm256_add_epi32(_mm256_set1_epi32(x), lane);
+			__m256i s = _mm256_add_epi32(_mm256_set1_epi32(span.s), _mm256_mullo_epi32(ds, idx));
+			__m256i t = _mm256_add_epi32(_mm256_set1_epi32(span.t), _mm256_mullo_epi32(dt, idx));
+			s = _mm256_min_epi32(_mm256_max_epi32(s, smin), smax);
+			t = _mm256_min_epi32(_mm256_max_epi32(t, smin), tmax);
+
+			__m256i x0 = _mm256_srai_epi32(s, kCoordBits);
+			__m256i y0 = _mm256_srai_epi32(t, kCoordBits);
+			__m256i fx = _mm256_and_si256(_mm256_srai_epi32(s, kCoordBits - 8), frac_mask);
+			__m256i fy = _mm256_and_si256(_mm256_srai_epi32(t, kCoordBits - 8), frac_mask);
+			__m256i x1 = _mm256_add_epi32(x0, _mm256_set1_epi32(1));
+			__m256i y1 = _mm256_add_epi32(y0, _mm256_set1_epi32(1));
+
+			// WRAP：x0 只会是 -1，x1 只会是 width
+			x0 = _mm256_add_epi32(x0, _mm256_and_si256(_mm256_cmpgt_epi32(zero, x0), width));
+			y0 = _mm256_add_epi32(y0, _mm256_and_si256(_mm256_cmpgt_epi32(zero, y0), height));
+			x1 = _mm256_sub_epi32(x1, _mm256_and_si256(_mm256_cmpgt_epi32(x1, width_m1), width));
+			y1 = _mm256_sub_epi32(y1, _mm256_and_si256(_mm256_cmpgt_epi32(y1, height_m1), height));
+
+			__m256i row0 = _mm256_mullo_epi32(y0, linesize);
+			__m256i row1 = _mm256_mullo_epi32(y1, linesize);
+			__m256i col0 = _mm256_slli_epi32(x0, 2);
+			__m256i col1 = _mm256_slli_epi32(x1, 2);
+			__m256i p00 = _mm256_i32gather_epi32(tex, _mm256_add_epi32(row0, col0), 1);
+			__m256i p01 = _mm256_i32gather_epi32(tex, _mm256_add_epi32(row0, col1), 1);
+			__m256i p10 = _mm256_i32gather_epi32(tex, _mm256_add_epi32(row1, col0), 1);
+			__m256i p11 = _mm256_i32gather_epi32(tex, _mm256_add_epi32(row1, col1), 1);
+
+			__m256i wx_lo, wx_hi, wy_lo, wy_hi;
+			SpreadWeights(fx, wx_lo, wx_hi);
+			SpreadWeights(fy, wy_lo, wy_hi);
+			__m256i ix_lo = _mm256_sub_epi16(v256, wx_lo), ix_hi = _mm256_sub_epi16(v256, wx_hi);
+			__m256i iy_lo = _mm256_sub_epi16(v256, wy_lo), iy_hi = _mm256_sub_epi16(v256, wy_hi);
+
+			__m256i top_lo = Lerp16(_mm256_unpacklo_epi8(p00, zero), _mm256_unpacklo_epi8(p01, zero), wx_lo, ix_lo, round);
+			__m256i top_hi = Lerp16(_mm256_unpackhi_epi8(p00, zero), _mm256_unpackhi_epi8(p01, zero), wx_hi, ix_hi, round);
+			__m256i bot_lo = Lerp16(_mm256_unpacklo_epi8(p10, zero), _mm256_unpacklo_epi8(p11, zero), wx_lo, ix_lo, round);
+			__m256i bot_hi = Lerp16(_mm256_unpackhi_epi8(p10, zero), _mm256_unpackhi_epi8(p11, zero), wx_hi, ix_hi, round);
+			__m256i lo = Lerp16(top_lo, bot_lo, wy_lo, iy_lo, round);
+			__m256i hi = Lerp16(top_hi, bot_hi, wy_hi, iy_hi, round);
+			_mm256_storeu_si256((__m256i*)(dst + x * 4), _mm256_packus_epi16(lo, hi));
+		}
+		return x;
+	}
+
+	int LutTetrahedralRow_AVX2(const LutView& lut, const uint8_t* src, uint8_t* dst, int count)
+	{
+		const __m256i v256 = _mm256_set1_epi32(256);
+		const __m256i round = _mm256_set1_epi32(32768);
+		const int end = count & ~7;
+		int x = 0;
+		for (; x < end; x += 8)
+		{
+			LutAxes axes;
+			LoadLutAxes(lut, src + x * 4, axes);
+
+			__m256i w0 = axes.weight[0], w1 = axes.weight[1], w2 = axes.weight[2];
+			__m256i o0 = _mm256_set1_epi32(lut.stride[0]);
+			__m256i o1 = _mm256_set1_epi32(lut.stride[1]);
+			__m256i o2 = _mm256_set1_epi32(lut.stride[2]);
+			OrderPair(w0, w1, o0, o1);
+			OrderPair(w1, w2, o1, o2);
+			OrderPair(w0, w1, o0, o1);
+
+			__m256i i0 = axes.base;
+			__m256i i1 = _mm256_add_epi32(i0, o0);
+			__m256i i2 = _mm256_add_epi32(i1, o1);
+			__m256i i3 = _mm256_add_epi32(i2, o2);
+			__m256i k0 = _mm256_sub_epi32(v256, w0);
+			__m256i k1 = _mm256_sub_epi32(w0, w1);
+			__m256i k2 = _mm256_sub_epi32(w1, w2);
+
+			__m256i result[3];
+			for (int c = 0; c < 3; c++)
+			{
+				const int* entries = (const int*)lut.entries + c;
+				__m256i sum = _mm256_mullo_epi32(k0, _mm256_i32gather_epi32(entries, i0, 4));
+				sum = _mm256_add_epi32(sum, _mm256_mullo_epi32(k1, _mm256_i32gather_epi32(entries, i1, 4)));
+				sum = _mm256_add_epi32(sum, _mm256_mullo_epi32(k2, _mm256_i32gather_epi32(entries, i2, 4)));
+				sum = _mm256_add_epi32(sum, _mm256_mullo_epi32(w2, _mm256_i32gather_epi32(entries, i3, 4)));
+				result[c] = _mm256_srli_epi32(_mm256_add_epi32(sum, round), 16);
+			}
+			_mm256_storeu_si256((__m256i*)(dst + x * 4), PackLutResult(result, axes.pixels));
+		}
+		return x;
+	}
+
+	int LutTrilinearRow_AVX2(const LutView& lut, const uint8_t* src, uint8_t* dst, int count)
+	{
+		const __m256i v256 = _mm256_set1_epi32(256);
+		const __m256i round = _mm256_set1_epi32(128);
+		const __m256i sb = _mm256_set1_epi32(lut.stride[0]);
+		const __m256i sg = _mm256_set1_epi32(lut.stride[1]);
+		const __m256i sr = _mm256_set1_epi32(lut.stride[2]);
+		const int end = count & ~7;
+		int x = 0;
+		for (; x < end; x += 8)
+		{
+			LutAxes axes;
+			LoadLutAxes(lut, src + x * 4, axes);
+			const __m256i fb = axes.weight[0], fg = axes.weight[1], fr = axes.weight[2];
+			const __m256i ib = _mm256_sub_epi32(v256, fb), ig = _mm256_sub_epi32(v256, fg), ir = _mm256_sub_epi32(v256, fr);
+
+			__m256i p000 = axes.base;
+			__m256i p001 = _mm256_add_epi32(p000, sr);
+			__m256i p010 = _mm256_add_epi32(p000, sg);
+			__m256i p011 = _mm256_add_epi32(p010, sr);
+			__m256i p100 = _mm256_add_epi32(p000, sb);
+			__m256i p101 = _mm256_add_epi32(p100, sr);
+			__m256i p110 = _mm256_add_epi32(p100, sg);
+			__m256i p111 = _mm256_add_epi32(p110, sr);
+
+			__m256i result[3];
+			for (int c = 0; c < 3; c++)
+			{
+				const int* entries = (const int*)lut.entries + c;
+				__m256i c00 = Lerp32(_mm256_i32gather_epi32(entries, p000, 4), _mm256_i32gather_epi32(entries, p001, 4), fr, ir, round);
+				__m256i c01 = Lerp32(_mm256_i32gather_epi32(entries, p010, 4), _mm256_i32gather_epi32(entries, p011, 4), fr, ir, round);
+				__m256i c10 = Lerp32(_mm256_i32gather_epi32(entries, p100, 4), _mm256_i32gather_epi32(entries, p101, 4), fr, ir, round);
+				__m256i c11 = Lerp32(_mm256_i32gather_epi32(entries, p110, 4), _mm256_i32gather_epi32(entries, p111, 4), fr, ir, round);
+				__m256i lo = Lerp32(c00, c01, fg, ig, round);
+				__m256i hi = Lerp32(c10, c11, fg, ig, round);
+				__m256i v = Lerp32(lo, hi, fb, ib, round);
+				result[c] = _mm256_srli_epi32(_mm256_add_epi32(v, round), 8);
+			}
+			_mm256_storeu_si256((__m256i*)(dst + x * 4), PackLutResult(result, axes.pixels));
+		}
+		return x;
+	}
+
+	int AccumulateRow_AVX2(uint32_t* sums, const uint8_t* add, const uint8_t* sub, int count)
+	{
+		int i = 0;
+		for (; i + 8 <= count; i += 8)
+		{
+			__m256i sum = _mm256_loadu_si256((const __m256i*)(sums + i));
+			sum = _mm256_add_epi32(sum, _mm256_cvtepu8_epi32(_mm_loadl_epi64((const __m128i*)(add + i))));
+			if (sub)
+				sum = _mm256_sub_epi32(sum, _mm256_cvtepu8_epi32(_mm_loadl_epi64((const __m128i*)(sub + i))));
+			_mm256_storeu_si256((__m256i*)(sums + i), sum);
+		}
+		return i;
+	}
+
+	int ScaleRow_AVX2(const uint32_t* sums, uint32_t scale, uint8_t* dst, int count)
+	{
+		const __m256i mul = _mm256_set1_epi32((int)scale);
+		const __m256i round = _mm256_set1_epi32(1 << 23);
+		// packus 按 128 位分半做，打包后每半边是 a b a b，按 dword 重排成 a 前 b 后
+		const __m256i order = _mm256_setr_epi32(0, 4, 1, 5, 0, 4, 1, 5);
+		int i = 0;
+		for (; i + 16 <= count; i += 16)
+		{
+			__m256i a = _mm256_loadu_si256((const __m256i*)(sums + i));
+			__m256i b = _mm256_loadu_si256((const __m256i*)(sums + i + 8));
+			a = _mm256_srli_epi32(_mm256_add_epi32(_mm256_mullo_epi32(a, mul), round), 24);
+			b = _mm256_srli_epi32(_mm256_add_epi32(_mm256_mullo_epi32(b, mul), round), 24);
+			__m256i words = _mm256_packus_epi32(a, b);
+			__m256i bytes = _mm256_permutevar8x32_epi32(_mm256_packus_epi16(words, words), order);
+			_mm_storeu_si128((__m128i*)(dst + i), _mm256_castsi256_si128(bytes));
+		}
+		return i;
+	}
+
+	int SadRow_AVX2(const uint8_t* a, const uint8_t* b, int block, uint32_t* sums, int count)
+	{
+		// sad_epu8 按 8 字节一组求和，组不能跨块
+		if (block % 8)
+			return 0;
+		alignas(32) uint64_t lanes[4];
+		int x = 0;
+		for (; x + 32 <= count; x += 32)
+		{
+			__m256i sad = _mm256_sad_epu8(_mm256_loadu_si256((const __m256i*)(a + x)), _mm256_loadu_si256((const __m256i*)(b + x)));
+			_mm256_store_si256((__m256i*)lanes, sad);
+			for (int j = 0; j < 4; j++)
+				sums[(x + j * 8) / block] += (uint32_t)lanes[j];
+		}
+		return x;
+	}
+}
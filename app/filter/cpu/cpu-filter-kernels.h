@@ -0,0 +1,69 @@
+#ifndef CPU_FILTER_KERNELS_H
+#define CPU_FILTER_KERNELS_H
+
+/* CpuFilter 内部用的行处理函数，C 和 AVX2 两个版本结果逐字节相同
+* AVX2 版本返回处理到的位置，剩余部分由调用方走 C 版本
+*/
+
+#include <stdint.h>
+
+namespace CpuFilterKernels
+{
+	// 纹理坐标用 16.16 定点，整数部分是纹素下标，小数取高 8 位做权重
+	const int kCoordBits = 16;
+
+	// dst = (a * (256 - weight) + b * weight + 128) >> 8，按字节，b 从 a 的下一个像素开始，要读到 a[count]
+	void LerpRow_C(const uint8_t* a, int weight, uint8_t* dst, int begin, int count);
+	int LerpRow_AVX2(const uint8_t* a, int weight, uint8_t* dst, int count);
+
+	// src 的 alpha > 25 (即 alpha / 255 >= 0.1) 时覆盖 dst
+	void AlphaClipRow_C(const uint8_t* src, uint8_t* dst, int begin, int count);
+	int AlphaClipRow_AVX2(const uint8_t* src, uint8_t* dst, int count);
+
+	// 一段输出像素，纹理坐标沿 x 线性变化
+	struct TexSpan
+	{
+		const uint8_t* tex;
+		int linesize;
+		int width;
+		int height;
+		int32_t s;	// 第一个像素的定点坐标 (已减去半个纹素)
+		int32_t t;
+		int32_t ds;	// 每个像素的增量
+		int32_t dt;
+	};
+
+	// 双线性采样，WRAP 寻址；坐标先钳到 [-0.5, size - 0.5] 纹素
+	void SampleSpan_C(const TexSpan& span, uint8_t* dst, int begin, int count);
+	int SampleSpan_AVX2(const TexSpan& span, uint8_t* dst, int count);
+
+	// 3D LUT，entries 和 axis 的格式见 CpuFilter::Lut3DTable，stride 是 B G R 轴上相邻格点在 entries 里的距离
+	struct LutView
+	{
+		const int32_t* entries;
+		const int32_t* axis;
+		int32_t stride[3];
+	};
+
+	// 四面体插值：三个权重从大到小排序，同样大时按 B G R 的顺序，沿对应的棱走到对角
+	void LutTetrahedralRow_C(const LutView& lut, const uint8_t* src, uint8_t* dst, int begin, int count);
+	int LutTetrahedralRow_AVX2(const LutView& lut, const uint8_t* src, uint8_t* dst, int count);
+	// 三线性插值：依次沿 R G B 插值，每一步都舍入回 8.8 定点
+	void LutTrilinearRow_C(const LutView& lut, const uint8_t* src, uint8_t* dst, int begin, int count);
+	int LutTrilinearRow_AVX2(const LutView& lut, const uint8_t* src, uint8_t* dst, int count);
+
+	// 盒式模糊和马赛克的列累加，按字节，每个字节一个 uint32 的和
+	// sums[i] += add[i] - sub[i]，sub 为空时只加
+	void AccumulateRow_C(uint32_t* sums, const uint8_t* add, const uint8_t* sub, int begin, int count);
+	int AccumulateRow_AVX2(uint32_t* sums, const uint8_t* add, const uint8_t* sub, int count);
+	// dst[i] = (sums[i] * scale + (1 << 23)) >> 24，scale 为 2^24 / 窗口大小 (四舍五入)，窗口不超过 255
+	void ScaleRow_C(const uint32_t* sums, uint32_t scale, uint8_t* dst, int begin, int count);
+	int ScaleRow_AVX2(const uint32_t* sums, uint32_t scale, uint8_t* dst, int count);
+
+	// 逐字节差的绝对值按 block 个一组累加：sums[i / block] += |a[i] - b[i]|
+	void SadRow_C(const uint8_t* a, const uint8_t* b, int block, uint32_t* sums, int begin, int count);
+	// block 是 8 的倍数时才处理
+	int SadRow_AVX2(const uint8_t* a, const uint8_t* b, int block, uint32_t* sums, int count);
+}
+
+#endif
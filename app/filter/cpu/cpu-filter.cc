@@ -0,0 +1,683 @@
+#include "cpu-filter.h"
+#include "cpu-filter-kernels.h"
+#include "task-pool.h"
+#include "cpu-features.h"
+#include <math.h>
+#include <stdlib.h>
+#include <string.h>
+#include <algorithm>
+#include <functional>
+
+namespace CpuFilterKernels
+{
+	void LerpRow_C(const uint8_t* a, int weight, uint8_t* dst, int begin, int count)
+	{
+		const uint8_t* b = a + 4;
+		const int inv = 256 - weight;
+		for (int i = begin * 4; i < count * 4; i++)
+			dst[i] = (uint8_t)((a[i] * inv + b[i] * weight + 128) >> 8);
+	}
+
+	void AlphaClipRow_C(const uint8_t* src, uint8_t* dst, int begin, int count)
+	{
+		const uint32_t* s = (const uint32_t*)src;
+		uint32_t* d = (uint32_t*)dst;
+		for (int i = begin; i < count; i++)
+		{
+			if ((s[i] >> 24) > 25)
+				d[i] = s[i];
+		}
+	}
+
+	void SampleSpan_C(const TexSpan& span, uint8_t* dst, int begin, int count)
+	{
+		const int32_t half = 1 << (kCoordBits - 1);
+		const int32_t smax = (span.width << kCoordBits) - half;
+		const int32_t tmax = (span.height << kCoordBits) - half;
+		for (int i = begin; i < count; i++)
+		{
+			int32_t s = std::min(std::max(span.s + span.ds * i, -half), smax);
+			int32_t t = std::min(std::max(span.t + span.dt * i, -half), tmax);
+			int x0 = s >> kCoordBits;
+			int y0 = t >> kCoordBits;
+			int fx = (s >> (kCoordBits - 8)) & 0xFF;
+			int fy = (t >> (kCoordBits - 8)) & 0xFF;
+			int x1 = x0 + 1;
+			int y1 = y0 + 1;
+			if (x0 < 0)
+				x0 += span.width;
+			if (x1 >= span.width)
+				x1 -= span.width;
+			if (y0 < 0)
+				y0 += span.height;
+			if (y1 >= span.height)
+				y1 -= span.height;
+
+			const uint8_t* p00 = span.tex + (size_t)y0 * span.linesize + x0 * 4;
+			const uint8_t* p01 = span.tex + (size_t)y0 * span.linesize + x1 * 4;
+			const uint8_t* p10 = span.tex + (size_t)y1 * span.linesize + x0 * 4;
+			const uint8_t* p11 = span.tex + (size_t)y1 * span.linesize + x1 * 4;
+			uint8_t* out = dst + i * 4;
+			for (int c = 0; c < 4; c++)
+			{
+				int top = (p00[c] * (256 - fx) + p01[c] * fx + 128) >> 8;
+				int bottom = (p10[c] * (256 - fx) + p11[c] * fx + 128) >> 8;
+				out[c] = (uint8_t)((top * (256 - fy) + bottom * fy + 128) >> 8);
+			}
+		}
+	}
+
+	void LutTetrahedralRow_C(const LutView& lut, const uint8_t* src, uint8_t* dst, int begin, int count)
+	{
+		for (int i = begin; i < count; i++)
+		{
+			const uint8_t* in = src + i * 4;
+			int base = 0;
+			int weight[3], offset[3];
+			for (int c = 0; c < 3; c++)
+			{
+				int32_t axis = lut.axis[c * 256 + in[c]];
+				base += (axis >> 9) * lut.stride[c];
+				weight[c] = axis & 511;
+				offset[c] = lut.stride[c];
+			}
+
+			// 和 AVX2 版本同样的三次比较交换
+			auto order = [&](int a, int b) {
+				if (weight[b] > weight[a])
+				{
+					std::swap(weight[a], weight[b]);
+					std::swap(offset[a], offset[b]);
+				}
+			};
+			order(0, 1);
+			order(1, 2);
+			order(0, 1);
+
+			const int32_t* c000 = lut.entries + base;
+			const int32_t* c1 = c000 + offset[0];
+			const int32_t* c2 = c1 + offset[1];
+			const int32_t* c3 = c2 + offset[2];
+			const int w0 = 256 - weight[0];
+			const int w1 = weight[0] - weight[1];
+			const int w2 = weight[1] - weight[2];
+			const int w3 = weight[2];
+			uint8_t* out = dst + i * 4;
+			const uint8_t alpha = in[3];
+			for (int c = 0; c < 3; c++)
+				out[c] = (uint8_t)((w0 * c000[c] + w1 * c1[c] + w2 * c2[c] + w3 * c3[c] + 32768) >> 16);
+			out[3] = alpha;
+		}
+	}
+
+	void LutTrilinearRow_C(const LutView& lut, const uint8_t* src, uint8_t* dst, int begin, int count)
+	{
+		auto lerp = [](int32_t a, int32_t b, int w) { return (a * (256 - w) + b * w + 128) >> 8; };
+		const int sb = lut.stride[0], sg = lut.stride[1], sr = lut.stride[2];
+		for (int i = begin; i < count; i++)
+		{
+			const uint8_t* in = src + i * 4;
+			int32_t ab = lut.axis[in[0]];
+			int32_t ag = lut.axis[256 + in[1]];
+			int32_t ar = lut.axis[512 + in[2]];
+			const int fb = ab & 511, fg = ag & 511, fr = ar & 511;
+			const int32_t* p = lut.entries + (ab >> 9) * sb + (ag >> 9) * sg + (ar >> 9) * sr;
+			uint8_t* out = dst + i * 4;
+			const uint8_t alpha = in[3];
+			for (int c = 0; c < 3; c++)
+			{
+				int32_t c00 = lerp(p[c], p[sr + c], fr);
+				int32_t c01 = lerp(p[sg + c], p[sg + sr + c], fr);
+				int32_t c10 = lerp(p[sb + c], p[sb + sr + c], fr);
+				int32_t c11 = lerp(p[sb + sg + c], p[sb + sg + sr + c], fr);
+				int32_t v = lerp(lerp(c00, c01, fg), lerp(c10, c11, fg), fb);
+				out[c] = (uint8_t)((v + 128) >> 8);
+			}
+			out[3] = alpha;
+		}
+	}
+
+	void AccumulateRow_C(uint32_t* sums, const uint8_t* add, const uint8_t* sub, int begin, int count)
+	{
+		if (sub)
+		{
+			for (int i = begin; i < count; i++)
+				sums[i] += (uint32_t)add[i] - sub[i];
+		}
+		else
+		{
+			for (int i = begin; i < count; i++)
+				sums[i] += add[i];
+		}
+	}
+
+	void ScaleRow_C(const uint32_t* sums, uint32_t scale, uint8_t* dst, int begin, int count)
+	{
+		for (int i = begin; i < count; i++)
+			dst[i] = (uint8_t)((sums[i] * scale + (1u << 23)) >> 24);
+	}
+
+	void SadRow_C(const uint8_t* a, const uint8_t* b, int block, uint32_t* sums, int begin, int count)
+	{
+		for (int i = begin; i < count; i++)
+			sums[i / block] += (uint32_t)abs(a[i] - b[i]);
+	}
+}
+
+namespace
+{
+	using BandFunc = std::function<void(int begin, int end)>;
+
+	void RunBands(const CpuFilter::Options& options, int height, const BandFunc& func)
+	{
+		if (options.pool && options.pool->GetThreadCount() && height >= 32)
+		{
+			options.pool->ParallelFor(height, 16, [&](size_t begin, size_t end) {
+				func((int)begin, (int)end);
+			});
+		}
+		else
+		{
+			func(0, height);
+		}
+	}
+
+	// 三分之一位置的 1/256 权重，k 为 0 - 2
+	inline int ThirdWeight(int k)
+	{
+		return (k * 256 + 1) / 3;
+	}
+
+	struct QuadRaster
+	{
+		int x_begin = 0;
+		int x_end = 0;
+		int y_begin = 0;
+		int y_end = 0;
+		// 像素中心 (x_begin + 0.5, 0.5) 处的纹理坐标和梯度
+		double u0 = 0.0;
+		double v0 = 0.0;
+		double dudx = 0.0;
+		double dudy = 0.0;
+		double dvdx = 0.0;
+		double dvdy = 0.0;
+	};
+
+	// 轴对齐的四边形，覆盖规则和 D3D 一样按像素中心：左上边包含，右下边不包含
+	bool SetupQuad(const BoltPath::Quad& quad, int width, int height, QuadRaster& raster)
+	{
+		double px[4], py[4];
+		for (int i = 0; i < 4; i++)
+		{
+			px[i] = (quad.v[i].x + 1.0) * 0.5 * width;
+			py[i] = (1.0 - quad.v[i].y) * 0.5 * height;
+		}
+		double e1x = px[1] - px[0], e1y = py[1] - py[0];
+		double e3x = px[3] - px[0], e3y = py[3] - py[0];
+		double det = e1x * e3y - e3x * e1y;
+		if (det == 0.0)
+			return false;
+
+		double xmin = std::min(std::min(px[0], px[1]), std::min(px[2], px[3]));
+		double xmax = std::max(std::max(px[0], px[1]), std::max(px[2], px[3]));
+		double ymin = std::min(std::min(py[0], py[1]), std::min(py[2], py[3]));
+		double ymax = std::max(std::max(py[0], py[1]), std::max(py[2], py[3]));
+		raster.x_begin = std::max(0, (int)ceil(xmin - 0.5));
+		raster.x_end = std::min(width, (int)ceil(xmax - 0.5));
+		raster.y_begin = std::max(0, (int)ceil(ymin - 0.5));
+		raster.y_end = std::min(height, (int)ceil(ymax - 0.5));
+		if (raster.x_begin >= raster.x_end || raster.y_begin >= raster.y_end)
+			return false;
+
+		double t1u = quad.v[1].u - quad.v[0].u, t1v = quad.v[1].v - quad.v[0].v;
+		double t3u = quad.v[3].u - quad.v[0].u, t3v = quad.v[3].v - quad.v[0].v;
+		raster.dudx = (e3y * t1u - e1y * t3u) / det;
+		raster.dudy = (e1x * t3u - e3x * t1u) / det;
+		raster.dvdx = (e3y * t1v - e1y * t3v) / det;
+		raster.dvdy = (e1x * t3v - e3x * t1v) / det;
+		double cx = raster.x_begin + 0.5 - px[0];
+		double cy = 0.5 - py[0];
+		raster.u0 = quad.v[0].u + raster.dudx * cx + raster.dudy * cy;
+		raster.v0 = quad.v[0].v + raster.dvdx * cx + raster.dvdy * cy;
+		return true;
+	}
+
+	inline int32_t ToCoord(double texel)
+	{
+		return (int32_t)floor(texel * (1 << CpuFilterKernels::kCoordBits) + 0.5);
+	}
+
+	bool ClipRegion(const CpuFilter::Region& region, int width, int height, CpuFilter::Region& clipped)
+	{
+		int x0 = std::max(region.x, 0);
+		int y0 = std::max(region.y, 0);
+		int x1 = std::min(region.x + region.width, width);
+		int y1 = std::min(region.y + region.height, height);
+		clipped.x = x0;
+		clipped.y = y0;
+		clipped.width = x1 - x0;
+		clipped.height = y1 - y0;
+		return clipped.width > 0 && clipped.height > 0;
+	}
+
+	// 对每一列做竖直方向半径 radius 的盒式平均，只处理 [byte_begin, byte_end) 这些字节列，上下边缘钳位
+	void BoxColumns(const uint8_t* src, uint8_t* dst, int stride, int rows, int byte_begin, int byte_end,
+		int radius, bool avx2)
+	{
+		using namespace CpuFilterKernels;
+
+		const int count = byte_end - byte_begin;
+		const uint32_t scale = ((1u << 24) + radius) / (2 * radius + 1);
+		std::vector<uint32_t> sums(count, 0);
+		auto row = [&](int y) {
+			return src + (size_t)std::min(std::max(y, 0), rows - 1) * stride + byte_begin;
+		};
+		auto accumulate = [&](const uint8_t* add, const uint8_t* sub) {
+			int done = avx2 ? AccumulateRow_AVX2(sums.data(), add, sub, count) : 0;
+			AccumulateRow_C(sums.data(), add, sub, done, count);
+		};
+
+		for (int k = -radius; k <= radius; k++)
+			accumulate(row(k), nullptr);
+		for (int y = 0; y < rows; y++)
+		{
+			uint8_t* out = dst + (size_t)y * stride + byte_begin;
+			int done = avx2 ? ScaleRow_AVX2(sums.data(), scale, out, count) : 0;
+			ScaleRow_C(sums.data(), scale, out, done, count);
+			if (y + 1 < rows)
+				accumulate(row(y + radius + 1), row(y - radius));
+		}
+	}
+
+	// width x height 的像素块转置，按 32 位像素，分块做减少缓存抖动
+	void TransposePixels(const uint8_t* src, int src_stride, uint8_t* dst, int dst_stride, int width, int row_begin, int row_end)
+	{
+		const int kTile = 16;
+		for (int y0 = row_begin; y0 < row_end; y0 += kTile)
+		{
+			const int y1 = std::min(y0 + kTile, row_end);
+			for (int x0 = 0; x0 < width; x0 += kTile)
+			{
+				const int x1 = std::min(x0 + kTile, width);
+				for (int y = y0; y < y1; y++)
+				{
+					const uint32_t* in = (const uint32_t*)(src + (size_t)y * src_stride);
+					for (int x = x0; x < x1; x++)
+						*(uint32_t*)(dst + (size_t)x * dst_stride + y * 4) = in[x];
+				}
+			}
+		}
+	}
+}
+
+namespace CpuFilter
+{
+	void ThreeMirror(const uint8_t* src, int src_linesize, uint8_t* dst, int dst_linesize, int width, int height,
+		const Options& options)
+	{
+		using namespace CpuFilterKernels;
+
+		if (width <= 0 || height <= 0)
+			return;
+
+		const bool avx2 = options.use_simd && cpu_has_avx2();
+		// 像素中心 u = (x + 0.5) / width：u < 1/3 取 u + 1/3，u > 2/3 取 u - 1/3，中间原样
+		const int left_end = std::max(0, (2 * width - 3 + 5) / 6);
+		const int right_begin = std::min(width, (4 * width - 3) / 6 + 1);
+		const int q = width / 3;
+		const int r = width % 3;
+		const int left_offset = q;
+		const int left_weight = ThirdWeight(r);
+		const int right_offset = -q - (r ? 1 : 0);
+		const int right_weight = r ? ThirdWeight(3 - r) : 0;
+
+		auto segment = [&](const uint8_t* line, uint8_t* out, int begin, int end, int offset, int weight) {
+			if (begin >= end)
+				return;
+			const uint8_t* a = line + (begin + offset) * 4;
+			uint8_t* d = out + begin * 4;
+			const int count = end - begin;
+			if (!weight)
+			{
+				memcpy(d, a, (size_t)count * 4);
+				return;
+			}
+			int done = avx2 ? LerpRow_AVX2(a, weight, d, count) : 0;
+			LerpRow_C(a, weight, d, done, count);
+		};
+
+		RunBands(options, height, [&](int begin, int end) {
+			for (int y = begin; y < end; y++)
+			{
+				const uint8_t* line = src + (size_t)y * src_linesize;
+				uint8_t* out = dst + (size_t)y * dst_linesize;
+				segment(line, out, 0, left_end, left_offset, left_weight);
+				segment(line, out, left_end, right_begin, 0, 0);
+				segment(line, out, right_begin, width, right_offset, right_weight);
+			}
+		});
+	}
+
+	void AlphaClip(const uint8_t* src, int src_linesize, uint8_t* dst, int dst_linesize, int width, int height,
+		const Options& options)
+	{
+		using namespace CpuFilterKernels;
+
+		if (width <= 0 || height <= 0)
+			return;
+
+		const bool avx2 = options.use_simd && cpu_has_avx2();
+		RunBands(options, height, [&](int begin, int end) {
+			for (int y = begin; y < end; y++)
+			{
+				const uint8_t* line = src + (size_t)y * src_linesize;
+				uint8_t* out = dst + (size_t)y * dst_linesize;
+				int done = avx2 ? AlphaClipRow_AVX2(line, out, width) : 0;
+				AlphaClipRow_C(line, out, done, width);
+			}
+		});
+	}
+
+	void BoltBox(const uint8_t* src, int src_linesize, uint8_t* dst, int dst_linesize, int width, int height,
+		const BoltPath::Quad* quads, size_t count,
+		const uint8_t* bolt, int bolt_linesize, int bolt_width, int bolt_height,
+		const Options& options)
+	{
+		using namespace CpuFilterKernels;
+
+		if (width <= 0 || height <= 0)
+			return;
+
+		QuadRaster rasters[BoltPath::kMaxQuads];
+		size_t raster_count = 0;
+		if (bolt && bolt_width > 0 && bolt_height > 0)
+		{
+			for (size_t i = 0; i < count && raster_count < BoltPath::kMaxQuads; i++)
+			{
+				if (SetupQuad(quads[i], width, height, rasters[raster_count]))
+					raster_count++;
+			}
+		}
+
+		const bool avx2 = options.use_simd && cpu_has_avx2();
+		RunBands(options, height, [&](int begin, int end) {
+			if (src != dst)
+			{
+				for (int y = begin; y < end; y++)
+					memcpy(dst + (size_t)y * dst_linesize, src + (size_t)y * src_linesize, (size_t)width * 4);
+			}
+
+			for (size_t i = 0; i < raster_count; i++)
+			{
+				const QuadRaster& raster = rasters[i];
+				const int y_begin = std::max(begin, raster.y_begin);
+				const int y_end = std::min(end, raster.y_end);
+				const int pixels = raster.x_end - raster.x_begin;
+
+				TexSpan span;
+				span.tex = bolt;
+				span.linesize = bolt_linesize;
+				span.width = bolt_width;
+				span.height = bolt_height;
+				span.ds = ToCoord(raster.dudx * bolt_width);
+				span.dt = ToCoord(raster.dvdx * bolt_height);
+				for (int y = y_begin; y < y_end; y++)
+				{
+					double u = raster.u0 + raster.dudy * y;
+					double v = raster.v0 + raster.dvdy * y;
+					span.s = ToCoord(u * bolt_width - 0.5);
+					span.t = ToCoord(v * bolt_height - 0.5);
+					uint8_t* out = dst + (size_t)y * dst_linesize + raster.x_begin * 4;
+					int done = avx2 ? SampleSpan_AVX2(span, out, pixels) : 0;
+					SampleSpan_C(span, out, done, pixels);
+				}
+			}
+		});
+	}
+
+	bool BuildLut3DTable(const float* rgb, int size, const float* domain_min, const float* domain_max, Lut3DTable& table)
+	{
+		if (!rgb || size < 2 || size > 256)
+			return false;
+
+		const size_t count = (size_t)size * size * size;
+		table.size = size;
+		table.entries.assign(count * 4, 0);
+		for (size_t i = 0; i < count; i++)
+		{
+			for (int c = 0; c < 3; c++)
+			{
+				double v = floor(rgb[i * 3 + c] * 65280.0 + 0.5);
+				// RGB 存成 B G R
+				table.entries[i * 4 + 2 - c] = (int32_t)std::min(std::max(v, 0.0), 65280.0);
+			}
+		}
+
+		for (int c = 0; c < 3; c++)
+		{
+			// axis 按 B G R，domain 按 R G B
+			const double dmin = domain_min ? domain_min[2 - c] : 0.0;
+			const double dmax = domain_max ? domain_max[2 - c] : 1.0;
+			if (!(dmax > dmin))
+				return false;
+			for (int v = 0; v < 256; v++)
+			{
+				double t = std::min(std::max((v / 255.0 - dmin) / (dmax - dmin), 0.0), 1.0);
+				double pos = t * (size - 1);
+				int index = (int)floor(pos);
+				int weight = (int)floor((pos - index) * 256.0 + 0.5);
+				if (weight == 256)
+				{
+					index += 1;
+					weight = 0;
+				}
+				// 最后一个格点当作前一格权重 256，插值时不会越界
+				if (index >= size - 1)
+				{
+					index = size - 2;
+					weight = 256;
+				}
+				table.axis[c * 256 + v] = (index << 9) | weight;
+			}
+		}
+		return true;
+	}
+
+	void ApplyLut3D(const uint8_t* src, int src_linesize, uint8_t* dst, int dst_linesize, int width, int height,
+		const Lut3DTable& table, LutInterpolation interpolation, const Options& options)
+	{
+		using namespace CpuFilterKernels;
+
+		if (width <= 0 || height <= 0 || table.size < 2)
+			return;
+
+		LutView lut;
+		lut.entries = table.entries.data();
+		lut.axis = table.axis;
+		lut.stride[0] = table.size * table.size * 4;
+		lut.stride[1] = table.size * 4;
+		lut.stride[2] = 4;
+
+		const bool avx2 = options.use_simd && cpu_has_avx2();
+		const bool tetrahedral = interpolation == LutInterpolation::kTetrahedral;
+		RunBands(options, height, [&](int begin, int end) {
+			for (int y = begin; y < end; y++)
+			{
+				const uint8_t* line = src + (size_t)y * src_linesize;
+				uint8_t* out = dst + (size_t)y * dst_linesize;
+				if (tetrahedral)
+				{
+					int done = avx2 ? LutTetrahedralRow_AVX2(lut, line, out, width) : 0;
+					LutTetrahedralRow_C(lut, line, out, done, width);
+				}
+				else
+				{
+					int done = avx2 ? LutTrilinearRow_AVX2(lut, line, out, width) : 0;
+					LutTrilinearRow_C(lut, line, out, done, width);
+				}
+			}
+		});
+	}
+
+	void BlurRegions(uint8_t* frame, int linesize, int width, int height, const Region* regions, size_t count,
+		int radius, int passes, const Options& options)
+	{
+		radius = std::min(radius, kMaxBlurRadius);
+		if (width <= 0 || height <= 0 || radius <= 0 || passes <= 0)
+			return;
+
+		const bool avx2 = options.use_simd && cpu_has_avx2();
+		const int spread = radius * passes;
+		std::vector<uint8_t> a, b;
+		for (size_t i = 0; i < count; i++)
+		{
+			Region roi;
+			if (!ClipRegion(regions[i], width, height, roi))
+				continue;
+
+			// 多取 spread 像素的边，结果在区域内和整幅画面模糊一致
+			const int ex = std::max(roi.x - spread, 0);
+			const int ey = std::max(roi.y - spread, 0);
+			const int ew = std::min(roi.x + roi.width + spread, width) - ex;
+			const int eh = std::min(roi.y + roi.height + spread, height) - ey;
+			const int stride = ew * 4;
+			const int stride_t = eh * 4;
+			a.resize((size_t)ew * eh * 4);
+			b.resize(a.size());
+			for (int y = 0; y < eh; y++)
+				memcpy(&a[(size_t)y * stride], frame + (size_t)(ey + y) * linesize + ex * 4, stride);
+
+			// 竖直方向：按列分段并行
+			uint8_t* cur = a.data();
+			uint8_t* tmp = b.data();
+			for (int p = 0; p < passes; p++)
+			{
+				RunBands(options, ew, [&](int begin, int end) {
+					BoxColumns(cur, tmp, stride, eh, begin * 4, end * 4, radius, avx2);
+				});
+				std::swap(cur, tmp);
+			}
+
+			// 水平方向：转置后同样按列做
+			RunBands(options, eh, [&](int begin, int end) {
+				TransposePixels(cur, stride, tmp, stride_t, ew, begin, end);
+			});
+			std::swap(cur, tmp);
+			for (int p = 0; p < passes; p++)
+			{
+				RunBands(options, eh, [&](int begin, int end) {
+					BoxColumns(cur, tmp, stride_t, ew, begin * 4, end * 4, radius, avx2);
+				});
+				std::swap(cur, tmp);
+			}
+
+			// 只把区域内的像素转置回画面
+			const uint8_t* blurred = cur;
+			RunBands(options, roi.height, [&](int begin, int end) {
+				for (int y = roi.y + begin; y < roi.y + end; y++)
+				{
+					uint32_t* out = (uint32_t*)(frame + (size_t)y * linesize);
+					for (int x = roi.x; x < roi.x + roi.width; x++)
+						out[x] = *(const uint32_t*)(blurred + (size_t)(x - ex) * stride_t + (y - ey) * 4);
+				}
+			});
+		}
+	}
+
+	void MosaicRegions(uint8_t* frame, int linesize, int width, int height, const Region* regions, size_t count,
+		int block, const Options& options)
+	{
+		using namespace CpuFilterKernels;
+
+		if (width <= 0 || height <= 0 || block <= 1)
+			return;
+
+		const bool avx2 = options.use_simd && cpu_has_avx2();
+		for (size_t i = 0; i < count; i++)
+		{
+			Region roi;
+			if (!ClipRegion(regions[i], width, height, roi))
+				continue;
+
+			const int bx0 = roi.x / block;
+			const int bx1 = (roi.x + roi.width + block - 1) / block;
+			const int by0 = roi.y / block;
+			const int by1 = (roi.y + roi.height + block - 1) / block;
+			const int cx0 = bx0 * block;
+			const int cx1 = std::min(bx1 * block, width);
+			const int bytes = (cx1 - cx0) * 4;
+
+			// 按块行并行，每个块行只读写自己的那几行
+			RunBands(options, by1 - by0, [&](int begin, int end) {
+				std::vector<uint32_t> sums(bytes);
+				for (int j = by0 + begin; j < by0 + end; j++)
+				{
+					const int ry0 = j * block;
+					const int ry1 = std::min(ry0 + block, height);
+					std::fill(sums.begin(), sums.end(), 0);
+					for (int y = ry0; y < ry1; y++)
+					{
+						const uint8_t* line = frame + (size_t)y * linesize + cx0 * 4;
+						int done = avx2 ? AccumulateRow_AVX2(sums.data(), line, nullptr, bytes) : 0;
+						AccumulateRow_C(sums.data(), line, nullptr, done, bytes);
+					}
+
+					const int fy0 = std::max(ry0, roi.y);
+					const int fy1 = std::min(ry1, roi.y + roi.height);
+					for (int k = bx0; k < bx1; k++)
+					{
+						const int x0 = k * block;
+						const int x1 = std::min(x0 + block, width);
+						const uint32_t n = (uint32_t)(x1 - x0) * (ry1 - ry0);
+						uint32_t total[4] = { 0, 0, 0, 0 };
+						for (int x = x0; x < x1; x++)
+						{
+							for (int c = 0; c < 4; c++)
+								total[c] += sums[(x - cx0) * 4 + c];
+						}
+						uint32_t color = 0;
+						for (int c = 0; c < 4; c++)
+							color |= ((total[c] + n / 2) / n) << (c * 8);
+
+						const int fx0 = std::max(x0, roi.x);
+						const int fx1 = std::min(x1, roi.x + roi.width);
+						for (int y = fy0; y < fy1; y++)
+						{
+							uint32_t* out = (uint32_t*)(frame + (size_t)y * linesize);
+							std::fill(out + fx0, out + fx1, color);
+						}
+					}
+				}
+			});
+		}
+	}
+
+	void BlockSad(const uint8_t* a, int a_linesize, const uint8_t* b, int b_linesize, int width, int height,
+		int block, uint32_t* sads, const Options& options)
+	{
+		using namespace CpuFilterKernels;
+
+		if (width <= 0 || height <= 0 || block <= 0)
+			return;
+
+		const bool avx2 = options.use_simd && cpu_has_avx2();
+		const int columns = (width + block - 1) / block;
+		const int rows = (height + block - 1) / block;
+		// 按块行分段，每段只写自己那几行块
+		RunBands(options, rows, [&](int begin, int end) {
+			for (int j = begin; j < end; j++)
+			{
+				uint32_t* out = sads + (size_t)j * columns;
+				std::fill(out, out + columns, 0);
+				const int y1 = std::min((j + 1) * block, height);
+				for (int y = j * block; y < y1; y++)
+				{
+					const uint8_t* la = a + (size_t)y * a_linesize;
+					const uint8_t* lb = b + (size_t)y * b_linesize;
+					int done = avx2 ? SadRow_AVX2(la, lb, block, out, width) : 0;
+					SadRow_C(la, lb, block, out, done, width);
+				}
+			}
+		});
+	}
+}
@@ -0,0 +1,88 @@
+#ifndef CPU_FILTER_H
+#define CPU_FILTER_H
+
+/* 内置滤镜的 CPU 版本，用在无头管线、CPU 合成和 GPU 路径的对照
+* 输出和对应的着色器一致：线性采样按 8 位子像素精度，和 GPU 最多差 1
+* 行按段分给 TaskPool 并行，支持 AVX2 时走 SIMD 路径，两条路径的结果逐字节相同
+* 图像都是 BGRA，src 和 dst 不能重叠 (AlphaClip 除外，它本来就是往 dst 上合成)
+*/
+
+#include <stddef.h>
+#include <stdint.h>
+#include <vector>
+#include "bolt-path.h"
+
+class TaskPool;
+
+namespace CpuFilter
+{
+	struct Options
+	{
+		// 为空时在调用线程单线程处理
+		TaskPool* pool = nullptr;
+		bool use_simd = true;
+	};
+
+	// Basic_PS_ThreeMirror.hlsl：中间三分之一横向重复三次
+	void ThreeMirror(const uint8_t* src, int src_linesize, uint8_t* dst, int dst_linesize, int width, int height,
+		const Options& options = Options());
+
+	// Basic_PS_Alpha_2D.hlsl：src 中 alpha < 0.1 的像素丢弃，其余覆盖到 dst 上
+	void AlphaClip(const uint8_t* src, int src_linesize, uint8_t* dst, int dst_linesize, int width, int height,
+		const Options& options = Options());
+
+	// BoltBoxFilter：src 画到 dst，再把 quads 用 bolt 位图 (WRAP 寻址) 贴上去，后画的覆盖先画的
+	void BoltBox(const uint8_t* src, int src_linesize, uint8_t* dst, int dst_linesize, int width, int height,
+		const BoltPath::Quad* quads, size_t count,
+		const uint8_t* bolt, int bolt_linesize, int bolt_width, int bolt_height,
+		const Options& options = Options());
+
+	enum class LutInterpolation
+	{
+		kTetrahedral,
+		kTrilinear,
+	};
+
+	// 3D LUT 查表用的定点数据，权重按 8 位精度，和硬件三线性过滤一样
+	struct Lut3DTable
+	{
+		int size = 0;
+		// 每个格点 B G R 加一个空位，值为 0 - 255 的 8.8 定点
+		std::vector<int32_t> entries;
+		// B G R 各 256 项：8 位输入所在的格点 (下标 << 9) 和到下一个格点的权重 (0 - 256)，DOMAIN 已经换算进去
+		int32_t axis[3 * 256] = { 0 };
+	};
+
+	// rgb 是 size^3 个 RGB (R 变化最快，即 .cube 的顺序)，domain 按 RGB 顺序，为空时是 0 - 1
+	bool BuildLut3DTable(const float* rgb, int size, const float* domain_min, const float* domain_max, Lut3DTable& table);
+
+	// 画面上的矩形区域，像素坐标，可以超出画面 (处理时裁掉)
+	struct Region
+	{
+		int x = 0;
+		int y = 0;
+		int width = 0;
+		int height = 0;
+	};
+
+	const int kMaxBlurRadius = 127;
+
+	// 只改 regions 里的像素，frame 原地修改，耗时和区域面积成正比；区域重叠时按顺序处理
+	// 半径 radius 的盒式模糊做 passes 遍，3 遍近似高斯；读区域外 radius * passes 以内的像素，画面边缘按钳位处理
+	void BlurRegions(uint8_t* frame, int linesize, int width, int height, const Region* regions, size_t count,
+		int radius, int passes, const Options& options = Options());
+	// 马赛克块按画面原点对齐 (区域移动时块不跟着抖)，块内取整块的平均色
+	void MosaicRegions(uint8_t* frame, int linesize, int width, int height, const Region* regions, size_t count,
+		int block, const Options& options = Options());
+
+	// 两幅单通道图逐 block x block 块的绝对差之和，sads 按行排，ceil(width / block) x ceil(height / block) 个，
+	// 右边和下边不满的块只算画面内的像素
+	void BlockSad(const uint8_t* a, int a_linesize, const uint8_t* b, int b_linesize, int width, int height,
+		int block, uint32_t* sads, const Options& options = Options());
+
+	// Basic_PS_Lut3D*.hlsl：RGB 查表，alpha 不变；src 和 dst 可以相同
+	void ApplyLut3D(const uint8_t* src, int src_linesize, uint8_t* dst, int dst_linesize, int width, int height,
+		const Lut3DTable& table, LutInterpolation interpolation, const Options& options = Options());
+}
+
+#endif
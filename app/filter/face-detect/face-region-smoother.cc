@@ -0,0 +1,97 @@
+#include "face-region-smoother.h"
+#include <algorithm>
+
+float FaceRegionSmoother::IoU(const Box& a, const Box& b)
+{
+	float x0 = std::max(a.x, b.x);
+	float y0 = std::max(a.y, b.y);
+	float x1 = std::min(a.x + a.width, b.x + b.width);
+	float y1 = std::min(a.y + a.height, b.y + b.height);
+	if (x1 <= x0 || y1 <= y0)
+		return 0.0f;
+	float inter = (x1 - x0) * (y1 - y0);
+	float uni = a.width * a.height + b.width * b.height - inter;
+	return uni > 0.0f ? inter / uni : 0.0f;
+}
+
+void FaceRegionSmoother::Update(const std::vector<Box>* detections)
+{
+	if (!detections)
+		return;
+
+	// 贪心匹配：每次取 IoU 最大的一对
+	std::vector<bool> used_track(tracks_.size(), false);
+	std::vector<bool> used_box(detections->size(), false);
+	for (;;)
+	{
+		float best = params_.match_iou;
+		size_t best_track = 0, best_box = 0;
+		bool found = false;
+		for (size_t t = 0; t < tracks_.size(); t++)
+		{
+			if (used_track[t])
+				continue;
+			for (size_t d = 0; d < detections->size(); d++)
+			{
+				if (used_box[d])
+					continue;
+				float iou = IoU(tracks_[t].box, (*detections)[d]);
+				if (iou >= best)
+				{
+					best = iou;
+					best_track = t;
+					best_box = d;
+					found = true;
+				}
+			}
+		}
+		if (!found)
+			break;
+
+		used_track[best_track] = true;
+		used_box[best_box] = true;
+		Box& box = tracks_[best_track].box;
+		const Box& det = (*detections)[best_box];
+		const float a = params_.alpha;
+		box.x += (det.x - box.x) * a;
+		box.y += (det.y - box.y) * a;
+		box.width += (det.width - box.width) * a;
+		box.height += (det.height - box.height) * a;
+		tracks_[best_track].missed = 0;
+	}
+
+	for (size_t t = 0; t < used_track.size(); t++)
+	{
+		if (!used_track[t])
+			tracks_[t].missed++;
+	}
+	tracks_.erase(std::remove_if(tracks_.begin(), tracks_.end(), [&](const Track& track) {
+		return track.missed > params_.hold_frames;
+	}), tracks_.end());
+
+	// 新出现的脸直接用检测框，宁可第一帧多遮一点也不要慢慢长出来
+	for (size_t d = 0; d < detections->size(); d++)
+	{
+		if (used_box[d])
+			continue;
+		Track track;
+		track.box = (*detections)[d];
+		tracks_.push_back(track);
+	}
+}
+
+void FaceRegionSmoother::GetRegions(std::vector<Box>& regions) const
+{
+	regions.clear();
+	for (const auto& track : tracks_)
+	{
+		Box box = track.box;
+		float mx = box.width * params_.margin;
+		float my = box.height * params_.margin;
+		box.x -= mx;
+		box.y -= my;
+		box.width += mx * 2.0f;
+		box.height += my * 2.0f;
+		regions.push_back(box);
+	}
+}
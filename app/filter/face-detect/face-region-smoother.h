@@ -0,0 +1,58 @@
+#ifndef FACE_REGION_SMOOTHER_H
+#define FACE_REGION_SMOOTHER_H
+
+/* 人脸框的时间平滑，给隐私遮挡用
+* 检测框逐帧抖动、偶尔漏检，直接拿来打码会闪；这里按 IoU 把新框匹配到已有轨迹，位置做指数平滑，
+* 漏检的轨迹保留 hold_frames 次更新，输出时向外扩一圈 margin
+*/
+
+#include <stddef.h>
+#include <vector>
+
+class FaceRegionSmoother
+{
+public:
+	struct Box
+	{
+		float x = 0.0f;
+		float y = 0.0f;
+		float width = 0.0f;
+		float height = 0.0f;
+	};
+
+	struct Params
+	{
+		// 新框的权重，越小越稳但跟得越慢
+		float alpha = 0.35f;
+		// 每边外扩的比例 (相对框的宽高)
+		float margin = 0.15f;
+		// 漏检后保留的次数，按带结果的 Update 调用计
+		int hold_frames = 10;
+		// IoU 不低于这个值算同一张脸
+		float match_iou = 0.2f;
+	};
+
+	void SetParams(const Params& params) { params_ = params; }
+	const Params& GetParams() const { return params_; }
+
+	// 每帧调用一次，detections 为这一帧的检测结果；没有新结果的帧传 nullptr，只保持现有轨迹
+	void Update(const std::vector<Box>* detections);
+	// 平滑并外扩后的区域
+	void GetRegions(std::vector<Box>& regions) const;
+	size_t GetTrackCount() const { return tracks_.size(); }
+	void Reset() { tracks_.clear(); }
+
+	static float IoU(const Box& a, const Box& b);
+
+private:
+	struct Track
+	{
+		Box box;
+		int missed = 0;
+	};
+
+	Params params_;
+	std::vector<Track> tracks_;
+};
+
+#endif
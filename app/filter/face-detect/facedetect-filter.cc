@@ -2,9 +2,18 @@
 #include "facedetectcnn.h"
 #include "core-d3d.h"
 #include "core-engine.h"
+#include "core-video.h"
+#include "core-output.h"
 #include "logger.h"
+#include <math.h>
+#include <algorithm>
 #include <chrono>
 
+namespace
+{
+    const int kMaxPrivacyRadius = 64;
+}
+
 FaceDetectFilter::FaceDetectFilter()
 {
 
@@ -17,17 +26,36 @@ FaceDetectFilter::~FaceDetectFilter()
 
 bool FaceDetectFilter::Init()
 {
-    ai_detect_mgr_.InitAiDetectMgr({ AiDetect::AiDetectInput(AiDetect::AiDetectType::KAiDetectFace, AiDetect::AiDetectThreadType::KAiDetectIndependThread, 30) });
+    // CNN 每秒只跑几次，中间帧由跟踪器推算，跟丢时提前检测；
+    // 整幅检测默认切块并行，只借调度器空闲的名额，各块耗时都记进检测耗时，调频看到的是真实 CPU 开销
+    ai_detect_mgr_.InitAiDetectMgr({ AiDetect::AiDetectInput(AiDetect::AiDetectType::KAiDetectFace, AiDetect::AiDetectThreadType::KAiDetectIndependThread, kDetectFrameRate, true, 0, true) });
     init_result_ = true;
     return true;
 }
 
-void FaceDetectFilter::Update(const char* jsondata)
+void FaceDetectFilter::Update(const CoreProperty::PropertyBag& props)
 {
-
+    const char* mode = props.GetString(CoreProperty::PropertyId::kMode);
+    if (mode)
+    {
+        std::string name(mode);
+        mode_.store(name == "blur" ? PrivacyMode::kBlur : name == "mosaic" ? PrivacyMode::kMosaic : PrivacyMode::kRect);
+    }
+    int32_t radius = 0;
+    if (props.GetInt(CoreProperty::PropertyId::kRadius, radius))
+        radius_.store(std::min(std::max(radius, 1), kMaxPrivacyRadius));
+    int32_t fps = 0;
+    if (props.GetInt(CoreProperty::PropertyId::kMinFps, fps))
+        min_detect_fps_.store(std::min(std::max(fps, 1), kMaxDetectFrameRate));
+    if (props.GetInt(CoreProperty::PropertyId::kMaxFps, fps))
+        max_detect_fps_.store(std::min(std::max(fps, 1), kMaxDetectFrameRate));
+    // tiled 为 0 时整幅检测不切块
+    int32_t tiled = 0;
+    if (props.GetInt(CoreProperty::PropertyId::kTiled, tiled))
+        ai_detect_mgr_.EnableTiling(tiled != 0);
 }
 
-void FaceDetectFilter::SetInputTexture(ID3D11Texture2D* texture, size_t width, size_t height, uint8_t* data)
+void FaceDetectFilter::RenderFilter(ID3D11ShaderResourceView* input, ID3D11RenderTargetView* output, ID3D11DepthStencilView* depth, size_t width, size_t height)
 {
     CoreD3D* d3d = core_engine_->GetD3D();
     if (!d3d)
@@ -36,13 +64,8 @@ void FaceDetectFilter::SetInputTexture(ID3D11Texture2D* texture, size_t width, s
     if (!InitResource(width, height))
         return;
 
-    ComPtr<ID3D11RenderTargetView> View;
-    ComPtr<ID3D11DepthStencilView> Depth;
-    d3d->OMGetRenderTargets(1, View.GetAddressOf(), Depth.GetAddressOf());
-
-    d3d->CopyResource(input_texture_.Get(), texture);
-
-    uint8_t* scale_data = nullptr;
+    const int64_t now = std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+    UpdateDetectRate(now);
 
     {
         static float color[4] = { 0.0f, 1.0f, 0.0f, 0.0f };
@@ -54,25 +77,20 @@ void FaceDetectFilter::SetInputTexture(ID3D11Texture2D* texture, size_t width, s
         UINT buffersize = 0;
         auto meshData = Geometry::Create2DShow();
         d3d->ResetMesh(meshData, buffersize);
-        d3d->PSSetShaderResources(0, 1, input_texture_resource_view_.GetAddressOf());
+        d3d->PSSetShaderResources(0, 1, &input);
         d3d->DrawIndexed(buffersize, 0, 0);
         d3d->PopFrontViewPort();
-        d3d->CopyResource(input_scale_read_texture_.Get(), input_scale_texture_.Get());
-
-        D3D11_MAPPED_SUBRESOURCE map;
-        d3d->Map(input_scale_read_texture_.Get(), 0, D3D11_MAP_READ, 0, &map);
-        char* texture_data = (char*)map.pData;
-        int dataSize = map.DepthPitch;
-        scale_data = (uint8_t*)malloc(dataSize);
-        memcpy(scale_data, texture_data, dataSize);
-        d3d->UnMap(input_scale_read_texture_.Get(), 0);
-    }
 
-    if (!scale_data)
-        return;
+        // 读回纹理轮流用，都没读走时丢掉最旧的一帧
+        if (readback_pending_ == kReadbackCount)
+            readback_pending_--;
+        d3d->CopyResource(input_scale_read_textures_[readback_write_].Get(), input_scale_texture_.Get());
+        readback_times_[readback_write_] = now;
+        readback_write_ = (readback_write_ + 1) % kReadbackCount;
+        readback_pending_++;
+    }
 
-    ai_detect_mgr_.InputBgraRawPixelData(scale_data, scale_width_ * scale_height_ * 4, scale_width_, scale_height_);
-    free(scale_data);
+    ReadbackScaleFrame(d3d);
 
     float scaleX = width / (float)scale_width_;
     float scaleY = height / (float)scale_height_;
@@ -85,8 +103,16 @@ void FaceDetectFilter::SetInputTexture(ID3D11Texture2D* texture, size_t width, s
     dpiy = dpiy != 0 ? dpiy / 96.0f : 1.0f;
 
     std::vector< AiDetect::AiDetectResult > aiResult;
-    ai_detect_mgr_.GetOutputDetectResult(aiResult);
-    d3d->PushFrontViewPort(width, height);
+    // 检测结果比画面晚一个检测延迟，按最近两次结果的速度把框推到当前画面
+    ai_detect_mgr_.GetOutputDetectResult(aiResult, now, AiDetect::AiDetectAlignMode::KAiDetectAlignExtrapolate);
+
+    const PrivacyMode mode = mode_.load();
+    if (mode != PrivacyMode::kRect)
+    {
+        RenderPrivacy(input, output, width, height, aiResult, scaleX, scaleY, mode);
+        return;
+    }
+
     paint_render_target_->BeginDraw();
     paint_render_target_->Clear(D2D1::ColorF(D2D1::ColorF::White, 0.0f));
     if (!pen_brush)
@@ -145,35 +171,289 @@ void FaceDetectFilter::SetInputTexture(ID3D11Texture2D* texture, size_t width, s
 
     paint_render_target_->EndDraw();
 
-    d3d->CopyResource(copy_paint_texture_.Get(), paint_texture_.Get());
-
     UINT buffersize = 0;
     auto meshData = Geometry::Create2DShow();
     d3d->ResetMesh(meshData, buffersize);
     static float color[4] = { 0.0f, 1.0f, 0.0f, 0.0f };
 
-    d3d->OMSetRenderTargets(1, face_rendertarget_view_.GetAddressOf(), nullptr);
-    d3d->ClearRenderTargetView(face_rendertarget_view_.Get(), color);
+    d3d->OMSetRenderTargets(1, &output, nullptr);
+    d3d->ClearRenderTargetView(output, color);
 
     d3d->OpenAlphaBlend();
-    d3d->PSSetShaderResources(0, 1, input_texture_resource_view_.GetAddressOf());
+    d3d->PSSetShaderResources(0, 1, &input);
     d3d->DrawIndexed(buffersize, 0, 0);
 
-    d3d->PSSetShaderResources(0, 1, copy_paint_texture_resource_view_.GetAddressOf());
+    d3d->PSSetShaderResources(0, 1, paint_texture_resource_view_.GetAddressOf());
     d3d->DrawIndexed(buffersize, 0, 0);
     d3d->CloseAlphaBlend();
-    d3d->PopFrontViewPort();
-    d3d->OMSetRenderTargets(1, View.GetAddressOf(), Depth.Get());
 }
 
-void FaceDetectFilter::CopyOutputTexture(ID3D11Texture2D* dst)
+void FaceDetectFilter::RenderPrivacy(ID3D11ShaderResourceView* input, ID3D11RenderTargetView* output, size_t width, size_t height,
+    const std::vector< AiDetect::AiDetectResult >& results, float scaleX, float scaleY, PrivacyMode mode)
 {
     CoreD3D* d3d = core_engine_->GetD3D();
-    if (!d3d)
+
+    // 检测框换算到画面像素后做时间平滑，检测结果没更新时平滑器里的框保持不动
+    detect_boxes_.clear();
+    for (const auto& c : results)
+    {
+        if (c.detectType != AiDetect::AiDetectType::KAiDetectFace)
+            continue;
+        for (int i = 0; i < c.faceResult.size; i++)
+        {
+            if (c.faceResult.info[i].confidence <= 75)
+                continue;
+            FaceRegionSmoother::Box box;
+            box.x = c.faceResult.info[i].x * scaleX;
+            box.y = c.faceResult.info[i].y * scaleY;
+            box.width = c.faceResult.info[i].width * scaleX;
+            box.height = c.faceResult.info[i].height * scaleY;
+            detect_boxes_.push_back(box);
+        }
+    }
+    region_smoother_.Update(&detect_boxes_);
+    region_smoother_.GetRegions(privacy_regions_);
+
+    UINT buffersize = 0;
+    auto meshData = Geometry::Create2DShow();
+    d3d->ResetMesh(meshData, buffersize);
+    d3d->UpdateVertexShader(CoreD3DData::VertexHlslType::kBasic2D);
+    d3d->UpdatePixelShader(CoreD3DData::PixelHlslType::kBasic2D);
+    d3d->OMSetRenderTargets(1, &output, nullptr);
+    d3d->PSSetShaderResources(0, 1, &input);
+    d3d->DrawIndexed(buffersize, 0, 0);
+
+    if (privacy_regions_.empty() || !InitPrivacyResource(width, height))
+        return;
+
+    // 后面只画人脸区域，开销和区域面积成正比
+    const int radius = radius_.load();
+    d3d->GetD3DDeviceContext()->PSSetConstantBuffers(0, 1, privacy_constant_buffer_.GetAddressOf());
+    if (mode == PrivacyMode::kMosaic)
+    {
+        UpdatePrivacyConstants(width, height, 0.0f, 0.0f, 0.0f, (float)std::max(radius, 2));
+        auto regionMesh = BuildRegionMesh(width, height, 0.0f);
+        if (regionMesh.indexVec.empty())
+            return;
+        d3d->ResetMesh(regionMesh, buffersize);
+        d3d->UpdatePixelShader(CoreD3DData::PixelHlslType::kMosaic2D);
+        d3d->DrawIndexed(buffersize, 0, 0);
+        return;
+    }
+
+    // 和 CPU 版三遍盒式模糊的方差相同
+    const float sigma = sqrtf(radius * (radius + 1.0f));
+    const float reach = ceilf(sigma * 3.0f) + 2.0f;
+
+    // 横向：输入到中间纹理，区域上下多画 reach 行，竖向采样时都是横向模糊过的像素
+    auto expandMesh = BuildRegionMesh(width, height, reach);
+    if (expandMesh.indexVec.empty())
+        return;
+    UpdatePrivacyConstants(width, height, 1.0f, 0.0f, sigma, 0.0f);
+    d3d->ResetMesh(expandMesh, buffersize);
+    d3d->UpdatePixelShader(CoreD3DData::PixelHlslType::kBlur2D);
+    d3d->OMSetRenderTargets(1, privacy_target_view_.GetAddressOf(), nullptr);
+    d3d->DrawIndexed(buffersize, 0, 0);
+
+    // 竖向：中间纹理到输出，只画区域本身
+    auto regionMesh = BuildRegionMesh(width, height, 0.0f);
+    UpdatePrivacyConstants(width, height, 0.0f, 1.0f, sigma, 0.0f);
+    d3d->ResetMesh(regionMesh, buffersize);
+    d3d->OMSetRenderTargets(1, &output, nullptr);
+    d3d->PSSetShaderResources(0, 1, privacy_resource_view_.GetAddressOf());
+    d3d->DrawIndexed(buffersize, 0, 0);
+
+    // 中间纹理下一帧还要当 rendertarget
+    ID3D11ShaderResourceView* null_view = nullptr;
+    d3d->PSSetShaderResources(0, 1, &null_view);
+}
+
+void FaceDetectFilter::UpdatePrivacyConstants(size_t width, size_t height, float dirX, float dirY, float sigma, float block)
+{
+    CoreD3D* d3d = core_engine_->GetD3D();
+    D3D11_MAPPED_SUBRESOURCE map;
+    if (FAILED(d3d->GetD3DDeviceContext()->Map(privacy_constant_buffer_.Get(), 0, D3D11_MAP_WRITE_DISCARD, 0, &map)))
         return;
+    float* constants = (float*)map.pData;
+    constants[0] = 1.0f / width;
+    constants[1] = 1.0f / height;
+    constants[2] = dirX;
+    constants[3] = dirY;
+    constants[4] = sigma;
+    constants[5] = block;
+    constants[6] = 0.0f;
+    constants[7] = 0.0f;
+    d3d->GetD3DDeviceContext()->Unmap(privacy_constant_buffer_.Get(), 0);
+}
 
-    if (face_render_target_)
-        d3d->CopyResource(dst, face_render_target_.Get());
+Geometry::MeshData<VertexPosTex, DWORD> FaceDetectFilter::BuildRegionMesh(size_t width, size_t height, float expandY)
+{
+    Geometry::MeshData<VertexPosTex, DWORD> mesh;
+    const float w = (float)width;
+    const float h = (float)height;
+    for (const auto& box : privacy_regions_)
+    {
+        // 对齐到整像素，和 CPU 版的区域一致
+        float x0 = std::min(std::max(floorf(box.x), 0.0f), w);
+        float x1 = std::min(std::max(ceilf(box.x + box.width), 0.0f), w);
+        float y0 = std::min(std::max(floorf(box.y - expandY), 0.0f), h);
+        float y1 = std::min(std::max(ceilf(box.y + box.height + expandY), 0.0f), h);
+        if (x1 <= x0 || y1 <= y0)
+            continue;
+
+        auto quad = Geometry::Create2DShow((x0 + x1) / w - 1.0f, 1.0f - (y0 + y1) / h, (x1 - x0) / w, (y1 - y0) / h);
+        DWORD base = (DWORD)mesh.vertexVec.size();
+        mesh.vertexVec.insert(mesh.vertexVec.end(), quad.vertexVec.begin(), quad.vertexVec.end());
+        for (DWORD index : quad.indexVec)
+            mesh.indexVec.push_back(base + index);
+    }
+    return mesh;
+}
+
+bool FaceDetectFilter::InitPrivacyResource(size_t width, size_t height)
+{
+    CoreD3D* d3d = core_engine_->GetD3D();
+    if (!privacy_texture_)
+    {
+        if (!d3d->CreateD3DTexture(privacy_texture_.GetAddressOf(), true, false, width, height, false))
+            return false;
+        if (!d3d->CreateRenderTargetView(privacy_texture_.Get(), privacy_target_view_.GetAddressOf()))
+            return false;
+        if (!d3d->CreateShaderResourceView(privacy_texture_.Get(), privacy_resource_view_.GetAddressOf()))
+            return false;
+    }
+    if (!privacy_constant_buffer_)
+    {
+        D3D11_BUFFER_DESC cbd;
+        ZeroMemory(&cbd, sizeof(cbd));
+        cbd.Usage = D3D11_USAGE_DYNAMIC;
+        cbd.ByteWidth = sizeof(float) * 8;
+        cbd.BindFlags = D3D11_BIND_CONSTANT_BUFFER;
+        cbd.CPUAccessFlags = D3D11_CPU_ACCESS_WRITE;
+        if (FAILED(d3d->GetD3DDevice()->CreateBuffer(&cbd, nullptr, privacy_constant_buffer_.GetAddressOf())))
+            return false;
+    }
+    return true;
+}
+
+void FaceDetectFilter::ReadbackScaleFrame(CoreD3D* d3d)
+{
+    // 不等 GPU：最旧的一帧还没拷完就下一帧再试，检测输入晚一两帧，渲染线程不会卡在 Map 上
+    const int index = (readback_write_ - readback_pending_ + kReadbackCount) % kReadbackCount;
+    ID3D11Texture2D* texture = input_scale_read_textures_[index].Get();
+    D3D11_MAPPED_SUBRESOURCE map;
+    if (!readback_pending_ || FAILED(d3d->Map(texture, 0, D3D11_MAP_READ, D3D11_MAP_FLAG_DO_NOT_WAIT, &map)))
+        return;
+    readback_pending_--;
+
+    // 直接读到检测用的池子缓冲里，所有检测线程共享这一块；RowPitch 可能比宽度 * 4 大，按行拷
+    std::shared_ptr<FrameMailbox::Frame> scale_frame = ai_detect_mgr_.AcquireFrame(scale_width_, scale_height_);
+    if (scale_frame)
+    {
+        scale_frame->timestamp = readback_times_[index];
+        const uint8_t* texture_data = (const uint8_t*)map.pData;
+        for (int y = 0; y < scale_height_; y++)
+            memcpy(&scale_frame->data[(size_t)y * scale_frame->linesize], texture_data + (size_t)y * map.RowPitch, scale_frame->linesize);
+    }
+    d3d->UnMap(texture, 0);
+    ai_detect_mgr_.InputFrame(std::move(scale_frame));
+}
+
+void FaceDetectFilter::UpdateDetectRate(int64_t now)
+{
+    CoreVideo* video = core_engine_->GetVideo();
+    CoreOutput* output = core_engine_->GetOutput();
+    // 编码队列每帧看一次，窗口内取最大
+    if (output)
+        max_encoder_queue_ = std::max(max_encoder_queue_, (int)output->GetVideoQueueDepth());
+
+    // 上下限改了就换参数，当前频率钳到新范围内
+    DetectRateGovernor::Params params = rate_governor_.GetParams();
+    const int min_fps = min_detect_fps_.load();
+    const int max_fps = std::max(max_detect_fps_.load(), min_fps);
+    if (params.min_rate != min_fps || params.max_rate != max_fps)
+    {
+        params.min_rate = min_fps;
+        params.max_rate = max_fps;
+        params.initial_rate = kDetectFrameRate;
+        rate_governor_.SetParams(params);
+        ai_detect_mgr_.UpdateDetectFrameRate(rate_governor_.GetRate());
+    }
+
+    if (rate_window_time_ && now - rate_window_time_ < (int64_t)params.window_ms * 1000000)
+        return;
+
+    uint64_t detect_count = 0, detect_ns = 0;
+    ai_detect_mgr_.GetDetectCost(detect_count, detect_ns);
+    CoreVideo::RenderCounters render;
+    if (video)
+        render = video->GetRenderCounters();
+
+    // 第一次只记起点
+    if (rate_window_time_)
+    {
+        DetectRateGovernor::Sample sample;
+        sample.detect_count = detect_count - last_detect_count_;
+        sample.detect_ns = detect_ns - last_detect_ns_;
+        sample.frames = render.frames - last_render_frames_;
+        sample.late_frames = render.late_frames - last_late_frames_;
+        sample.render_ns = render.cost_ns - last_render_ns_;
+        sample.frame_interval_ns = render.interval_ns;
+        sample.encoder_queue = max_encoder_queue_;
+        const DetectRateGovernor::Decision decision = rate_governor_.Update(sample);
+        if (decision.changed)
+        {
+            ai_detect_mgr_.UpdateDetectFrameRate(decision.rate);
+            LOGGER_INFO("[FaceDetect] detect fps -> %d reason:%s detect:%.2fms cpu:%.2f late:%.2f render:%.2f encoder queue:%d",
+                decision.rate, DetectRateGovernor::GetReasonName(decision.reason), decision.detect_ms, decision.detect_cpu,
+                decision.late_ratio, decision.render_load, decision.encoder_queue);
+        }
+    }
+    rate_window_time_ = now;
+    last_detect_count_ = detect_count;
+    last_detect_ns_ = detect_ns;
+    last_render_frames_ = render.frames;
+    last_late_frames_ = render.late_frames;
+    last_render_ns_ = render.cost_ns;
+    max_encoder_queue_ = 0;
+
+    if (now - rate_log_time_ < 1000000000)
+        return;
+    rate_log_time_ = now;
+    const DetectRateGovernor::Stats& stats = rate_governor_.GetStats();
+    const DetectRateGovernor::Decision& last = rate_governor_.GetLastDecision();
+    LOGGER_INFO("[FaceDetect] detect fps:%d [%d, %d] windows:%llu up:%llu down:%llu overloaded:%llu blocked:%llu idle:%llu last:%s",
+        rate_governor_.GetRate(), params.min_rate, params.max_rate, stats.windows, stats.ups, stats.downs,
+        stats.overloaded, stats.blocked, stats.idle, DetectRateGovernor::GetReasonName(last.reason));
+    rate_governor_.ResetStats();
+}
+
+void FaceDetectFilter::OnHide()
+{
+    ai_detect_mgr_.DropPendingData();
+}
+
+void FaceDetectFilter::OnDeactivate()
+{
+    // 和源一样大的画图纹理和 D2D 画布，下次 RenderFilter 时重新创建
+    paint_render_target_.Reset();
+    render_target_bitmap_.Reset();
+    rect_brush_.Reset();
+    pen_brush.Reset();
+    stroke_style_.Reset();
+    dxgi_surface_.Reset();
+    paint_texture_resource_view_.Reset();
+    paint_texture_.Reset();
+    input_scale_resource_view_.Reset();
+    input_scale_texture_.Reset();
+    for (auto& texture : input_scale_read_textures_)
+        texture.Reset();
+    readback_write_ = 0;
+    readback_pending_ = 0;
+    privacy_resource_view_.Reset();
+    privacy_target_view_.Reset();
+    privacy_texture_.Reset();
+    region_smoother_.Reset();
 }
 
 bool FaceDetectFilter::InitResource(size_t width, size_t height)
@@ -222,29 +502,9 @@ bool FaceDetectFilter::InitResource(size_t width, size_t height)
 
         HR(paint_render_target_->CreateSolidColorBrush(D2D1::ColorF(0x008000, 1.0f), rect_brush_.GetAddressOf()));
     }
-    if (!face_render_target_)
+    if (!paint_texture_resource_view_)
     {
-        if (!d3d->CreateD3DTexture(face_render_target_.GetAddressOf(), true, false, width, height,false))
-            return false;
-        if (!d3d->CreateRenderTargetView(face_render_target_.Get(), face_rendertarget_view_.GetAddressOf()))
-            return false;
-    }
-
-    if (!input_texture_)
-    {
-        if (!d3d->CreateD3DTexture(input_texture_.GetAddressOf(), false, false, width, height,false))
-            return false;
-
-        if (!d3d->CreateShaderResourceView(input_texture_.Get(), input_texture_resource_view_.GetAddressOf()))
-            return false;
-    }
-
-    if (!copy_paint_texture_)
-    {
-        if (!d3d->CreateD3DTexture(copy_paint_texture_.GetAddressOf(), false, false, width, height,false))
-            return false;
-
-        if (!d3d->CreateShaderResourceView(copy_paint_texture_.Get(), copy_paint_texture_resource_view_.GetAddressOf()))
+        if (!d3d->CreateShaderResourceView(paint_texture_.Get(), paint_texture_resource_view_.GetAddressOf()))
             return false;
     }
 
@@ -256,13 +516,13 @@ bool FaceDetectFilter::InitResource(size_t width, size_t height)
         if (!d3d->CreateD3DTexture(input_scale_texture_.GetAddressOf(), true, false, scale_width_, scale_height_, false))
             return false;
 
-        if (d3d->CreateRenderTargetView(input_scale_texture_.Get(), input_scale_resource_view_.GetAddressOf()))
+        if (!d3d->CreateRenderTargetView(input_scale_texture_.Get(), input_scale_resource_view_.GetAddressOf()))
             return false;
     }
 
-    if (!input_scale_read_texture_)
+    for (auto& texture : input_scale_read_textures_)
     {
-        if (d3d->CreateD3DTexture(input_scale_read_texture_.GetAddressOf(), false, false, scale_width_, scale_height_,true))
+        if (!texture && !d3d->CreateD3DTexture(texture.GetAddressOf(), false, false, scale_width_, scale_height_, true))
             return false;
     }
     return true;
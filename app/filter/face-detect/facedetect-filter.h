@@ -1,25 +1,56 @@
 #ifndef FACEDETECTFILTER_H
 #define FACEDETECTFILTER_H
 
+#include <atomic>
 #include <string>
+#include <vector>
 #include <d2d1.h>
 #include "ai-detect-mgr.h"
 #include "base-filter-i.h"
 #include "dx-header.h"
+#include "Geometry.h"
+#include "face-region-smoother.h"
+#include "detect-rate-governor.h"
+
+class CoreD3D;
 
 class FaceDetectFilter : public IBaseFilter
 {
+	static const int kReadbackCount = 3;
+	// 开了跟踪，CNN 的初始检测频率，之后按负载在 [minFps, maxFps] 内调整
+	static const int kDetectFrameRate = 6;
+	static const int kMaxDetectFrameRate = 30;
+
 public:
 	FaceDetectFilter();
 	virtual ~FaceDetectFilter();
 
 	virtual bool Init();
-	virtual void Update(const char* jsondata);
-	virtual void SetInputTexture(ID3D11Texture2D* texture, size_t width, size_t height, uint8_t* data = nullptr);
-	virtual void CopyOutputTexture(ID3D11Texture2D* texture);
+	virtual void Update(const CoreProperty::PropertyBag& props);
+	virtual void RenderFilter(ID3D11ShaderResourceView* input, ID3D11RenderTargetView* output, ID3D11DepthStencilView* depth, size_t width, size_t height);
+	virtual void OnDeactivate();
+	virtual void OnHide();
 
 private:
+	// mode 属性：rect 画框 (默认)，blur / mosaic 只在人脸区域内模糊或打马赛克
+	enum class PrivacyMode
+	{
+		kRect,
+		kBlur,
+		kMosaic,
+	};
+
 	bool InitResource(size_t width, size_t height);
+	// 取最旧的一帧已经拷完的读回纹理交给检测
+	void ReadbackScaleFrame(CoreD3D* d3d);
+	// 每帧调用，每个窗口把检测耗时、渲染超时和编码积压交给 rate_governor_，频率变了就改检测频率
+	void UpdateDetectRate(int64_t now);
+	bool InitPrivacyResource(size_t width, size_t height);
+	void RenderPrivacy(ID3D11ShaderResourceView* input, ID3D11RenderTargetView* output, size_t width, size_t height,
+		const std::vector< AiDetect::AiDetectResult >& results, float scaleX, float scaleY, PrivacyMode mode);
+	void UpdatePrivacyConstants(size_t width, size_t height, float dirX, float dirY, float sigma, float block);
+	// 人脸区域合成一个网格，expandY 为上下额外多画的行数
+	Geometry::MeshData<VertexPosTex, DWORD> BuildRegionMesh(size_t width, size_t height, float expandY);
 
 private:
 	ComPtr<ID2D1Factory> factory_;
@@ -30,24 +61,48 @@ private:
 	ComPtr<ID2D1SolidColorBrush> rect_brush_;
 	ComPtr<ID2D1SolidColorBrush> pen_brush;
 
-	ComPtr< ID3D11Texture2D> face_render_target_;		//渲染合图
-	ComPtr< ID3D11RenderTargetView> face_rendertarget_view_;		//渲染合图的view
-	ComPtr< ID3D11Texture2D> input_texture_;				//输入的摄像头纹理
-	ComPtr<ID3D11ShaderResourceView> input_texture_resource_view_;	//输入纹理的resourceview
-	ComPtr< ID3D11Texture2D> input_scale_texture_;				//输入的摄像头纹理
-	ComPtr<ID3D11RenderTargetView> input_scale_resource_view_;	//输入纹理的resourceview
-	ComPtr< ID3D11Texture2D> input_scale_read_texture_;				//输入的摄像头纹理
+	ComPtr< ID3D11Texture2D> input_scale_texture_;				//缩小后给检测用的纹理
+	ComPtr<ID3D11RenderTargetView> input_scale_resource_view_;	//缩小纹理的rendertarget
+	ComPtr< ID3D11Texture2D> input_scale_read_textures_[kReadbackCount];			//缩小纹理的 CPU 读回，轮流用，不等 GPU
+	int64_t readback_times_[kReadbackCount] = { 0 };		//各读回纹理拷贝时的画面时间，作为检测结果的时间戳
+	int readback_write_ = 0;
+	int readback_pending_ = 0;
 	ComPtr< ID3D11Texture2D> paint_texture_;				//画图的纹理
-	ComPtr< ID3D11Texture2D> copy_paint_texture_;		//用来读取画图的纹理
-	ComPtr<ID3D11ShaderResourceView> copy_paint_texture_resource_view_;	//用来读取画图的纹理的resourceview
+	ComPtr<ID3D11ShaderResourceView> paint_texture_resource_view_;	//画图纹理的resourceview，合图时直接读
 	ComPtr<ID3D11VertexShader> vertex_shader_;				// 用于2D的顶点着色器
 	ComPtr<ID3D11PixelShader> pixel_shader_;				    // 用于2D的像素着色器
 	ComPtr<ID3D11InputLayout> vertex_layout_;
 
+	ComPtr<ID3D11Texture2D> privacy_texture_;					//横向模糊的中间结果
+	ComPtr<ID3D11RenderTargetView> privacy_target_view_;
+	ComPtr<ID3D11ShaderResourceView> privacy_resource_view_;
+	ComPtr<ID3D11Buffer> privacy_constant_buffer_;			//对应 Privacy.hlsli 的 PrivacyConstantBuffer
+	FaceRegionSmoother region_smoother_;
+	std::vector<FaceRegionSmoother::Box> detect_boxes_;
+	std::vector<FaceRegionSmoother::Box> privacy_regions_;
+	std::atomic<PrivacyMode> mode_{ PrivacyMode::kRect };
+	// 模糊半径或马赛克块大小，像素
+	std::atomic<int> radius_{ 16 };
+
+	// 检测频率的上下限，Update 里改，渲染线程上生效
+	std::atomic<int> min_detect_fps_{ 2 };
+	std::atomic<int> max_detect_fps_{ 15 };
+	// 以下只在渲染线程访问，计数都是上个窗口结束时的累计值
+	DetectRateGovernor rate_governor_;
+	int64_t rate_window_time_ = 0;
+	int64_t rate_log_time_ = 0;
+	uint64_t last_detect_count_ = 0;
+	uint64_t last_detect_ns_ = 0;
+	uint64_t last_render_frames_ = 0;
+	uint64_t last_late_frames_ = 0;
+	uint64_t last_render_ns_ = 0;
+	int max_encoder_queue_ = 0;
+
 	bool init_result_ = false;
 	AiDetectMgr ai_detect_mgr_;
 
-	int scale_width_ = 320;
+	// 检测输入宽度的两倍，最后一步由检测线程在 CPU 上按面积平均缩到 320 并转 BGR，比 GPU 一次双线性缩小混叠少
+	int scale_width_ = 640;
 	int scale_height_ = 0;
 
 	float dpi_x_ = 0.0f;
@@ -0,0 +1,135 @@
+#include "cube-lut.h"
+#include <stdlib.h>
+#include <string.h>
+#include <fstream>
+#include <sstream>
+
+namespace
+{
+	bool SetError(std::string* error, size_t line, const char* message)
+	{
+		if (error)
+			*error = "line " + std::to_string(line) + ": " + message;
+		return false;
+	}
+
+	// 读三个浮点数，后面只能有空白
+	bool ParseFloat3(const char* p, float value[3])
+	{
+		for (int i = 0; i < 3; i++)
+		{
+			char* end = nullptr;
+			value[i] = strtof(p, &end);
+			if (end == p)
+				return false;
+			p = end;
+		}
+		while (*p == ' ' || *p == '\t')
+			p++;
+		return *p == '\0';
+	}
+
+	bool StartsWith(const std::string& line, const char* key)
+	{
+		size_t length = strlen(key);
+		return line.compare(0, length, key) == 0 && (line.size() == length || line[length] == ' ' || line[length] == '\t');
+	}
+}
+
+namespace CubeLut
+{
+	bool Parse(const char* data, size_t length, Lut& lut, std::string* error)
+	{
+		lut = Lut();
+		size_t expected = 0;
+		size_t line_number = 0;
+		size_t pos = 0;
+		std::string line;
+		while (pos < length)
+		{
+			size_t end = pos;
+			while (end < length && data[end] != '\n')
+				end++;
+			line.assign(data + pos, end - pos);
+			pos = end + 1;
+			line_number++;
+
+			size_t comment = line.find('#');
+			if (comment != std::string::npos)
+				line.resize(comment);
+			while (!line.empty() && (line.back() == '\r' || line.back() == ' ' || line.back() == '\t'))
+				line.pop_back();
+			size_t first = line.find_first_not_of(" \t");
+			if (first == std::string::npos)
+				continue;
+			line.erase(0, first);
+
+			if (line[0] == '-' || line[0] == '+' || line[0] == '.' || (line[0] >= '0' && line[0] <= '9'))
+			{
+				if (!expected)
+					return SetError(error, line_number, "data before LUT_3D_SIZE");
+				if (lut.rgb.size() >= expected * 3)
+					return SetError(error, line_number, "too many entries");
+				float value[3];
+				if (!ParseFloat3(line.c_str(), value))
+					return SetError(error, line_number, "invalid entry");
+				lut.rgb.insert(lut.rgb.end(), value, value + 3);
+			}
+			else if (StartsWith(line, "TITLE"))
+			{
+				size_t begin = line.find('"');
+				size_t finish = line.rfind('"');
+				if (begin != std::string::npos && finish > begin)
+					lut.title = line.substr(begin + 1, finish - begin - 1);
+			}
+			else if (StartsWith(line, "LUT_3D_SIZE"))
+			{
+				if (expected)
+					return SetError(error, line_number, "duplicate LUT_3D_SIZE");
+				int size = atoi(line.c_str() + strlen("LUT_3D_SIZE"));
+				if (size < kMinSize || size > kMaxSize)
+					return SetError(error, line_number, "LUT_3D_SIZE out of range");
+				lut.size = size;
+				expected = (size_t)size * size * size;
+				lut.rgb.reserve(expected * 3);
+			}
+			else if (StartsWith(line, "LUT_1D_SIZE"))
+			{
+				return SetError(error, line_number, "1D LUT is not supported");
+			}
+			else if (StartsWith(line, "DOMAIN_MIN") || StartsWith(line, "DOMAIN_MAX"))
+			{
+				bool is_min = StartsWith(line, "DOMAIN_MIN");
+				if (!ParseFloat3(line.c_str() + strlen("DOMAIN_MIN"), is_min ? lut.domain_min : lut.domain_max))
+					return SetError(error, line_number, "invalid domain");
+			}
+			// 其他软件自己加的关键字 (LUT_IN_VIDEO_RANGE 等) 忽略
+		}
+
+		if (!expected)
+			return SetError(error, line_number, "missing LUT_3D_SIZE");
+		if (lut.rgb.size() != expected * 3)
+			return SetError(error, line_number, "too few entries");
+		for (int i = 0; i < 3; i++)
+		{
+			if (!(lut.domain_max[i] > lut.domain_min[i]))
+				return SetError(error, line_number, "empty domain");
+		}
+		return true;
+	}
+
+	bool LoadFile(const char* path, Lut& lut, std::string* error)
+	{
+		std::ifstream file(path, std::ios::binary);
+		if (!file)
+		{
+			if (error)
+				*error = std::string("open ") + path + " failed";
+			return false;
+		}
+		std::stringstream buffer;
+		buffer << file.rdbuf();
+		const std::string data = buffer.str();
+		return Parse(data.c_str(), data.size(), lut, error);
+	}
+}
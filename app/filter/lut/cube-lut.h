@@ -0,0 +1,33 @@
+#ifndef CUBE_LUT_H
+#define CUBE_LUT_H
+
+/* Adobe/Resolve 的 .cube 3D LUT
+* 支持 TITLE、LUT_3D_SIZE (2 - 256)、DOMAIN_MIN、DOMAIN_MAX 和 # 注释，1D LUT 不支持
+* 数据按 R 变化最快、B 最慢排列，和 3D 纹理 x/y/z 的顺序一致
+*/
+
+#include <stddef.h>
+#include <string>
+#include <vector>
+
+namespace CubeLut
+{
+	const int kMinSize = 2;
+	const int kMaxSize = 256;
+
+	struct Lut
+	{
+		std::string title;
+		int size = 0;
+		float domain_min[3] = { 0.0f, 0.0f, 0.0f };
+		float domain_max[3] = { 1.0f, 1.0f, 1.0f };
+		// size^3 个 RGB
+		std::vector<float> rgb;
+	};
+
+	// 失败时 error 带行号
+	bool Parse(const char* data, size_t length, Lut& lut, std::string* error = nullptr);
+	bool LoadFile(const char* path, Lut& lut, std::string* error = nullptr);
+}
+
+#endif
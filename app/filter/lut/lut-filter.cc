@@ -0,0 +1,158 @@
+#include "lut-filter.h"
+#include "Geometry.h"
+#include "core-d3d.h"
+#include "core-engine.h"
+#include "logger.h"
+#include <DirectXPackedVector.h>
+#include <algorithm>
+#include <vector>
+
+Lut3DFilter::Lut3DFilter()
+{
+
+}
+
+Lut3DFilter::~Lut3DFilter()
+{
+
+}
+
+bool Lut3DFilter::Init()
+{
+	return true;
+}
+
+void Lut3DFilter::Update(const CoreProperty::PropertyBag& props)
+{
+	std::unique_lock<std::mutex> lock(lut_mutex_);
+	const char* path = props.GetString(CoreProperty::PropertyId::kPath);
+	if (path)
+		lut_path_ = path;
+	const char* interpolation = props.GetString(CoreProperty::PropertyId::kInterpolation);
+	if (interpolation)
+		tetrahedral_ = std::string(interpolation) != "trilinear";
+}
+
+bool Lut3DFilter::Load()
+{
+	std::string path;
+	{
+		std::unique_lock<std::mutex> lock(lut_mutex_);
+		path = lut_path_;
+	}
+	if (path.empty() || path == loaded_path_)
+		return true;
+
+	std::unique_ptr<CubeLut::Lut> lut(new CubeLut::Lut());
+	std::string error;
+	if (!CubeLut::LoadFile(path.c_str(), *lut, &error))
+	{
+		LOGGER_ERROR("[Lut3D] load %s failed:%s", path.c_str(), error.c_str());
+		return false;
+	}
+	loaded_path_ = path;
+
+	std::unique_lock<std::mutex> lock(lut_mutex_);
+	pending_lut_.swap(lut);
+	return true;
+}
+
+bool Lut3DFilter::CreateLutResource(const CubeLut::Lut& lut)
+{
+	using namespace DirectX::PackedVector;
+
+	CoreD3D* d3d = core_engine_->GetD3D();
+	lut_texture_.Reset();
+	lut_resource_view_.Reset();
+	constant_buffer_.Reset();
+
+	// 半精度足够 8 位输出，所有 D3D11 硬件都支持对它做三线性过滤
+	const size_t count = (size_t)lut.size * lut.size * lut.size;
+	std::vector<HALF> texels(count * 4);
+	for (size_t i = 0; i < count; i++)
+	{
+		for (int c = 0; c < 3; c++)
+			texels[i * 4 + c] = XMConvertFloatToHalf(std::min(std::max(lut.rgb[i * 3 + c], 0.0f), 1.0f));
+		texels[i * 4 + 3] = XMConvertFloatToHalf(1.0f);
+	}
+
+	D3D11_TEXTURE3D_DESC desc;
+	ZeroMemory(&desc, sizeof(desc));
+	desc.Width = lut.size;
+	desc.Height = lut.size;
+	desc.Depth = lut.size;
+	desc.MipLevels = 1;
+	desc.Format = DXGI_FORMAT_R16G16B16A16_FLOAT;
+	desc.Usage = D3D11_USAGE_IMMUTABLE;
+	desc.BindFlags = D3D11_BIND_SHADER_RESOURCE;
+	D3D11_SUBRESOURCE_DATA data;
+	ZeroMemory(&data, sizeof(data));
+	data.pSysMem = texels.data();
+	data.SysMemPitch = lut.size * 4 * sizeof(HALF);
+	data.SysMemSlicePitch = lut.size * lut.size * 4 * sizeof(HALF);
+	if (FAILED(d3d->GetD3DDevice()->CreateTexture3D(&desc, &data, lut_texture_.GetAddressOf())))
+		return false;
+	if (FAILED(d3d->GetD3DDevice()->CreateShaderResourceView(lut_texture_.Get(), nullptr, lut_resource_view_.GetAddressOf())))
+		return false;
+
+	// 和 Lut3D.hlsli 的 LutConstantBuffer 对应
+	float constants[8];
+	for (int c = 0; c < 3; c++)
+	{
+		float scale = 1.0f / (lut.domain_max[c] - lut.domain_min[c]);
+		constants[c] = scale;
+		constants[4 + c] = -lut.domain_min[c] * scale;
+	}
+	constants[3] = (float)lut.size;
+	constants[7] = 0.0f;
+
+	D3D11_BUFFER_DESC cbd;
+	ZeroMemory(&cbd, sizeof(cbd));
+	cbd.Usage = D3D11_USAGE_IMMUTABLE;
+	cbd.ByteWidth = sizeof(constants);
+	cbd.BindFlags = D3D11_BIND_CONSTANT_BUFFER;
+	D3D11_SUBRESOURCE_DATA cb_data;
+	ZeroMemory(&cb_data, sizeof(cb_data));
+	cb_data.pSysMem = constants;
+	if (FAILED(d3d->GetD3DDevice()->CreateBuffer(&cbd, &cb_data, constant_buffer_.GetAddressOf())))
+	{
+		lut_resource_view_.Reset();
+		return false;
+	}
+	return true;
+}
+
+void Lut3DFilter::RenderFilter(ID3D11ShaderResourceView* input, ID3D11RenderTargetView* output, ID3D11DepthStencilView* depth, size_t width, size_t height)
+{
+	CoreD3D* d3d = core_engine_->GetD3D();
+
+	std::unique_ptr<CubeLut::Lut> lut;
+	bool tetrahedral = true;
+	{
+		std::unique_lock<std::mutex> lock(lut_mutex_);
+		lut.swap(pending_lut_);
+		tetrahedral = tetrahedral_;
+	}
+	if (lut && !CreateLutResource(*lut))
+		LOGGER_ERROR("[Lut3D] create %d^3 lut texture failed", lut->size);
+
+	auto meshData = Geometry::Create2DShow();
+	UINT buffersize = 0;
+	d3d->ResetMesh(meshData, buffersize);
+	d3d->OMSetRenderTargets(1, &output, nullptr);
+	d3d->UpdateVertexShader(CoreD3DData::VertexHlslType::kBasic2D);
+
+	if (!lut_resource_view_)
+	{
+		d3d->UpdatePixelShader(CoreD3DData::PixelHlslType::kBasic2D);
+		d3d->PSSetShaderResources(0, 1, &input);
+		d3d->DrawIndexed(buffersize, 0, 0);
+		return;
+	}
+
+	d3d->UpdatePixelShader(tetrahedral ? CoreD3DData::PixelHlslType::kLut3DTetrahedral2D : CoreD3DData::PixelHlslType::kLut3D2D);
+	ID3D11ShaderResourceView* views[2] = { input, lut_resource_view_.Get() };
+	d3d->PSSetShaderResources(0, 2, views);
+	d3d->GetD3DDeviceContext()->PSSetConstantBuffers(0, 1, constant_buffer_.GetAddressOf());
+	d3d->DrawIndexed(buffersize, 0, 0);
+}
@@ -0,0 +1,39 @@
+#ifndef LUT_FILTER_H
+#define LUT_FILTER_H
+
+#include <memory>
+#include <mutex>
+#include <string>
+#include "base-filter-i.h"
+#include "cube-lut.h"
+
+// .cube 3D LUT 调色，path 指定文件，interpolation 为 tetrahedral (默认) 或 trilinear
+// 还没有 LUT 或加载失败时原样输出
+class Lut3DFilter : public IBaseFilter
+{
+public:
+	Lut3DFilter();
+	virtual ~Lut3DFilter();
+
+	virtual bool Init();
+	virtual void RenderFilter(ID3D11ShaderResourceView* input, ID3D11RenderTargetView* output, ID3D11DepthStencilView* depth, size_t width, size_t height);
+	virtual void Update(const CoreProperty::PropertyBag& props);
+	virtual bool Load();
+
+private:
+	bool CreateLutResource(const CubeLut::Lut& lut);
+
+private:
+	std::mutex lut_mutex_;
+	std::string lut_path_;
+	bool tetrahedral_ = true;
+	// 加载线程读好的 LUT，RenderFilter 时由渲染线程建纹理
+	std::string loaded_path_;
+	std::unique_ptr<CubeLut::Lut> pending_lut_;
+
+	ComPtr<ID3D11Texture3D> lut_texture_;
+	ComPtr<ID3D11ShaderResourceView> lut_resource_view_;
+	ComPtr<ID3D11Buffer> constant_buffer_;
+};
+
+#endif
@@ -0,0 +1,78 @@
+/* 共享内存帧环读端示例
+* shm-frame-dump [name] [frames]
+* 打印每帧序号、时间戳和校验值，最后统计跳帧数，可以和 shm-frame-feed 配合在 Linux 上验证
+*/
+
+#include "shm-frame-reader.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <inttypes.h>
+
+static uint32_t Fnv1a(const uint8_t* data, size_t size, uint32_t hash)
+{
+	for (size_t i = 0; i < size; i++)
+		hash = (hash ^ data[i]) * 16777619u;
+	return hash;
+}
+
+int main(int argc, char* argv[])
+{
+	const char* name = argc > 1 ? argv[1] : SHM_FRAME_RING_DEFAULT_NAME;
+	uint64_t max_frames = argc > 2 ? strtoull(argv[2], NULL, 10) : 0;
+
+	ShmFrameReader reader;
+	if (!reader.Open(name))
+	{
+		fprintf(stderr, "open %s failed\n", name);
+		return 1;
+	}
+
+	const ShmFrameRing::ShmRingHeader* header = reader.GetHeader();
+	printf("video %ux%u stride:%u slots:%u, audio ch:%u rate:%u slots:%u\n",
+		header->video_width, header->video_height, header->video_stride, header->video_slot_count,
+		header->audio_channels, header->audio_samples_per_sec, header->audio_slot_count);
+
+	uint64_t next = reader.GetVideoPublished();
+	uint64_t next_audio = reader.GetAudioPublished();
+	uint64_t received = 0;
+	uint64_t skipped = 0;
+	uint64_t torn = 0;
+	uint64_t audio_packets = 0;
+	while (!max_frames || received < max_frames)
+	{
+		if (!reader.WaitVideo(next, 1000))
+			break;
+
+		ShmFrameReader::VideoFrame frame;
+		if (!reader.AcquireLatestVideo(&frame))
+			continue;
+
+		uint32_t hash = 2166136261u;
+		for (uint32_t y = 0; y < frame.height; y++)
+			hash = Fnv1a(frame.data + (size_t)y * frame.stride, (size_t)frame.width * 4, hash);
+
+		if (!reader.ValidateVideo(frame))
+		{
+			torn++;
+			continue;
+		}
+
+		skipped += frame.frame_index - next;
+		next = frame.frame_index + 1;
+		received++;
+		printf("frame %" PRIu64 " ts:%" PRIu64 " hash:%08x\n", frame.frame_index, frame.timestamp, hash);
+
+		uint64_t audio_published = reader.GetAudioPublished();
+		while (next_audio < audio_published)
+		{
+			ShmFrameReader::AudioPacket packet;
+			if (reader.AcquireAudio(next_audio, &packet))
+				audio_packets++;
+			next_audio++;
+		}
+	}
+
+	printf("received:%" PRIu64 " skipped:%" PRIu64 " torn:%" PRIu64 " audio packets:%" PRIu64 "\n",
+		received, skipped, torn, audio_packets);
+	return 0;
+}
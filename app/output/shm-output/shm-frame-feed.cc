@@ -0,0 +1,70 @@
+/* 共享内存帧环写端示例，不需要启动引擎
+* shm-frame-feed [name] [frames] [fps]
+* 用 TestPatternGenerator 生成可复现的画面，同时写一路 1kHz 正弦音
+*/
+
+#include "shm-frame-writer.h"
+#include "test-pattern-generator.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <math.h>
+#include <vector>
+#include <chrono>
+#include <thread>
+
+int main(int argc, char* argv[])
+{
+	const char* name = argc > 1 ? argv[1] : SHM_FRAME_RING_DEFAULT_NAME;
+	uint64_t frames = argc > 2 ? strtoull(argv[2], NULL, 10) : 300;
+	uint32_t fps = argc > 3 ? (uint32_t)atoi(argv[3]) : 30;
+	if (!fps)
+		fps = 30;
+
+	TestPatternGenerator::Params params;
+	params.type = TestPatternGenerator::PatternType::kAnimatedText;
+	params.width = 640;
+	params.height = 360;
+	params.seed = 1;
+	TestPatternGenerator generator;
+	generator.SetParams(params);
+
+	ShmFrameWriter::Config config;
+	config.name = name;
+	config.width = params.width;
+	config.height = params.height;
+	config.audio_channels = 2;
+	config.audio_samples_per_sec = 48000;
+	config.audio_max_frames = 48000 / fps;
+
+	ShmFrameWriter writer;
+	if (!writer.Open(config))
+	{
+		fprintf(stderr, "create %s failed\n", name);
+		return 1;
+	}
+
+	std::vector<uint8_t> bgra((size_t)params.width * params.height * 4);
+	std::vector<float> tone(config.audio_max_frames);
+	const uint8_t* planes[2] = { (const uint8_t*)tone.data(), (const uint8_t*)tone.data() };
+	uint64_t samples = 0;
+
+	auto start = std::chrono::steady_clock::now();
+	for (uint64_t i = 0; i < frames; i++)
+	{
+		generator.Generate(i, bgra.data(), params.width * 4);
+		uint64_t ts = (uint64_t)std::chrono::duration_cast<std::chrono::nanoseconds>(
+			std::chrono::steady_clock::now().time_since_epoch()).count();
+		writer.WriteVideo(bgra.data(), (size_t)params.width * 4, ts);
+
+		for (uint32_t s = 0; s < config.audio_max_frames; s++)
+			tone[s] = 0.25f * (float)sin(6.283185307179586 * fmod((double)(samples + s) * 1000.0 / 48000.0, 1.0));
+		samples += config.audio_max_frames;
+		writer.WriteAudio(planes, config.audio_max_frames, ts);
+
+		std::this_thread::sleep_until(start + std::chrono::nanoseconds((i + 1) * 1000000000ULL / fps));
+	}
+
+	printf("published video:%llu audio:%llu\n",
+		(unsigned long long)writer.GetVideoPublished(), (unsigned long long)writer.GetAudioPublished());
+	return 0;
+}
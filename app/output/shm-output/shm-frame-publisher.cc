@@ -0,0 +1,75 @@
+#include "shm-frame-publisher.h"
+#include "core-engine.h"
+#include "core-settings.h"
+#include "core-video.h"
+#include "core-audio.h"
+#include "logger.h"
+
+ShmFramePublisher::ShmFramePublisher()
+{
+
+}
+
+ShmFramePublisher::~ShmFramePublisher()
+{
+	Stop();
+}
+
+bool ShmFramePublisher::Start(const char* name, bool with_audio)
+{
+	CoreSettings* settings = core_engine_->GetSettings();
+	const CoreSettingsData::Output* output = settings->GetOutputParam();
+
+	ShmFrameWriter::Config config;
+	config.name = name;
+	config.width = (uint32_t)output->video.width;
+	config.height = (uint32_t)output->video.height;
+	if (with_audio)
+	{
+		config.audio_channels = (uint32_t)CoreAudioData::get_audio_channels(output->audio.speakers);
+		config.audio_samples_per_sec = output->audio.samples_per_sec;
+		config.audio_max_frames = AUDIO_OUTPUT_FRAMES;
+	}
+
+	{
+		std::unique_lock<std::mutex> lock(writer_mutex_);
+		if (!writer_.Open(config))
+		{
+			LOGGER_ERROR("[ShmOutput] open shared memory %s failed", name);
+			return false;
+		}
+		with_audio_ = with_audio;
+	}
+
+	core_engine_->GetVideo()->RegisterVideoDataCallback(this, std::bind(&ShmFramePublisher::VideoRawDataReceived, this, std::placeholders::_1));
+	if (with_audio)
+		core_engine_->GetAudio()->RegisterCoreAudioDataCallback(this, std::bind(&ShmFramePublisher::AudioRawDataReceived, this, std::placeholders::_1));
+	LOGGER_INFO("[ShmOutput] publishing %ux%u to %s, audio:%d", config.width, config.height, name, (int)with_audio);
+	return true;
+}
+
+void ShmFramePublisher::Stop()
+{
+	if (!core_engine_)
+		return;
+	core_engine_->GetVideo()->UnRegisterVideoDataCallback(this);
+	core_engine_->GetAudio()->UnRegisterCoreAudioDataCallback(this);
+
+	std::unique_lock<std::mutex> lock(writer_mutex_);
+	if (writer_.IsOpen())
+		LOGGER_INFO("[ShmOutput] stop, video:%llu audio:%llu", writer_.GetVideoPublished(), writer_.GetAudioPublished());
+	writer_.Close();
+}
+
+void ShmFramePublisher::VideoRawDataReceived(const CoreVideoData::RawData* data)
+{
+	std::unique_lock<std::mutex> lock(writer_mutex_);
+	writer_.WriteVideo(data->bgra_data, data->linesize, data->timestamp);
+}
+
+void ShmFramePublisher::AudioRawDataReceived(const CoreAudioData::AudioMixerOutput* data)
+{
+	std::unique_lock<std::mutex> lock(writer_mutex_);
+	if (with_audio_)
+		writer_.WriteAudio(data->data, data->frames, data->timestamp);
+}
@@ -0,0 +1,36 @@
+#ifndef SHM_FRAME_PUBLISHER_H
+#define SHM_FRAME_PUBLISHER_H
+
+/* 把合成后的画面和混音后的音频发布到共享内存帧环
+* 挂在 CoreVideo / CoreAudio 的数据回调上，回调线程里直接写 slot，不另开线程
+*/
+
+#include "shm-frame-writer.h"
+#include "core-video-data.h"
+#include "core-audio-data.h"
+#include <mutex>
+
+class CoreEngine;
+
+class ShmFramePublisher
+{
+public:
+	ShmFramePublisher();
+	~ShmFramePublisher();
+
+	void SetCoreEnv(CoreEngine* engine) { core_engine_ = engine; }
+	bool Start(const char* name, bool with_audio);
+	void Stop();
+
+private:
+	void VideoRawDataReceived(const CoreVideoData::RawData* data);
+	void AudioRawDataReceived(const CoreAudioData::AudioMixerOutput* data);
+
+private:
+	CoreEngine* core_engine_ = nullptr;
+	std::mutex writer_mutex_;
+	ShmFrameWriter writer_;
+	bool with_audio_ = false;
+};
+
+#endif
@@ -0,0 +1,188 @@
+#include "shm-frame-reader.h"
+#include <string.h>
+
+using namespace ShmFrameRing;
+
+#define SHM_FRAME_READ_RETRY 8
+
+ShmFrameReader::ShmFrameReader()
+{
+
+}
+
+ShmFrameReader::~ShmFrameReader()
+{
+	Close();
+}
+
+bool ShmFrameReader::Open(const char* name)
+{
+	Close();
+	if (!region_.Open(name))
+		return false;
+
+	ShmRingHeader* header = (ShmRingHeader*)region_.GetData();
+	if (region_.GetSize() < sizeof(ShmRingHeader)
+		|| header->magic != SHM_FRAME_RING_MAGIC
+		|| header->version != SHM_FRAME_RING_VERSION
+		|| header->total_size > region_.GetSize())
+	{
+		region_.Close();
+		return false;
+	}
+	header_ = header;
+	return true;
+}
+
+void ShmFrameReader::Close()
+{
+	header_ = nullptr;
+	region_.Close();
+}
+
+bool ShmFrameReader::IsWriterAlive() const
+{
+	return header_ && header_->writer_alive.load(std::memory_order_acquire) != 0;
+}
+
+uint64_t ShmFrameReader::GetVideoPublished() const
+{
+	return header_ ? header_->video_published.load(std::memory_order_acquire) : 0;
+}
+
+uint64_t ShmFrameReader::GetAudioPublished() const
+{
+	return header_ ? header_->audio_published.load(std::memory_order_acquire) : 0;
+}
+
+bool ShmFrameReader::WaitVideo(uint64_t next_index, uint32_t timeout_ms)
+{
+	if (!header_)
+		return false;
+	while (header_->video_published.load(std::memory_order_acquire) <= next_index)
+	{
+		if (!IsWriterAlive())
+			return false;
+		uint32_t notify = header_->video_notify.load(std::memory_order_acquire);
+		if (header_->video_published.load(std::memory_order_acquire) > next_index)
+			break;
+		if (!region_.Wait(&header_->video_notify, notify, timeout_ms))
+			return false;
+	}
+	return true;
+}
+
+bool ShmFrameReader::WaitAudio(uint64_t next_index, uint32_t timeout_ms)
+{
+	if (!header_ || !header_->audio_slot_count)
+		return false;
+	while (header_->audio_published.load(std::memory_order_acquire) <= next_index)
+	{
+		if (!IsWriterAlive())
+			return false;
+		uint32_t notify = header_->audio_notify.load(std::memory_order_acquire);
+		if (header_->audio_published.load(std::memory_order_acquire) > next_index)
+			break;
+		if (!region_.Wait(&header_->audio_notify, notify, timeout_ms))
+			return false;
+	}
+	return true;
+}
+
+bool ShmFrameReader::AcquireLatestVideo(VideoFrame* frame)
+{
+	if (!header_)
+		return false;
+	for (int i = 0; i < SHM_FRAME_READ_RETRY; i++)
+	{
+		uint64_t published = header_->video_published.load(std::memory_order_acquire);
+		if (!published)
+			return false;
+		if (AcquireVideo(published - 1, frame))
+			return true;
+	}
+	return false;
+}
+
+bool ShmFrameReader::AcquireVideo(uint64_t frame_index, VideoFrame* frame)
+{
+	if (!header_ || !frame)
+		return false;
+
+	ShmSlotHeader* slot = VideoSlot(header_, frame_index);
+	uint64_t sequence = slot->sequence.load(std::memory_order_acquire);
+	if (sequence != frame_index * 2 + 2)
+		return false;
+
+	frame->data = SlotData(slot);
+	frame->width = header_->video_width;
+	frame->height = header_->video_height;
+	frame->stride = header_->video_stride;
+	frame->frame_index = frame_index;
+	frame->timestamp = slot->timestamp;
+	frame->sequence = sequence;
+	return ValidateVideo(*frame);
+}
+
+bool ShmFrameReader::ValidateVideo(const VideoFrame& frame) const
+{
+	if (!header_)
+		return false;
+	std::atomic_thread_fence(std::memory_order_acquire);
+	ShmSlotHeader* slot = VideoSlot(header_, frame.frame_index);
+	return slot->sequence.load(std::memory_order_relaxed) == frame.sequence;
+}
+
+bool ShmFrameReader::CopyLatestVideo(uint8_t* dst, size_t dst_linesize, VideoFrame* info)
+{
+	for (int i = 0; i < SHM_FRAME_READ_RETRY; i++)
+	{
+		VideoFrame frame;
+		if (!AcquireLatestVideo(&frame))
+			return false;
+
+		const size_t row = dst_linesize < frame.stride ? dst_linesize : frame.stride;
+		for (uint32_t y = 0; y < frame.height; y++)
+			memcpy(dst + y * dst_linesize, frame.data + (size_t)y * frame.stride, row);
+
+		if (ValidateVideo(frame))
+		{
+			if (info)
+				*info = frame;
+			return true;
+		}
+	}
+	return false;
+}
+
+bool ShmFrameReader::AcquireAudio(uint64_t packet_index, AudioPacket* packet)
+{
+	if (!header_ || !header_->audio_slot_count || !packet)
+		return false;
+
+	ShmSlotHeader* slot = AudioSlot(header_, packet_index);
+	uint64_t sequence = slot->sequence.load(std::memory_order_acquire);
+	if (sequence != packet_index * 2 + 2)
+		return false;
+
+	const float* base = (const float*)SlotData(slot);
+	memset(packet->planes, 0, sizeof(packet->planes));
+	for (uint32_t c = 0; c < header_->audio_channels; c++)
+		packet->planes[c] = base + (size_t)c * header_->audio_max_frames;
+	packet->channels = header_->audio_channels;
+	packet->frames = slot->audio_frames;
+	packet->samples_per_sec = header_->audio_samples_per_sec;
+	packet->packet_index = packet_index;
+	packet->timestamp = slot->timestamp;
+	packet->sequence = sequence;
+	return ValidateAudio(*packet);
+}
+
+bool ShmFrameReader::ValidateAudio(const AudioPacket& packet) const
+{
+	if (!header_ || !header_->audio_slot_count)
+		return false;
+	std::atomic_thread_fence(std::memory_order_acquire);
+	ShmSlotHeader* slot = AudioSlot(header_, packet.packet_index);
+	return slot->sequence.load(std::memory_order_relaxed) == packet.sequence;
+}
@@ -0,0 +1,78 @@
+#ifndef SHM_FRAME_READER_H
+#define SHM_FRAME_READER_H
+
+/* 共享内存帧环的读端库，给其他进程用
+* Acquire* 直接返回共享内存里的指针（零拷贝），用完后调用 Validate* 确认期间没被写端覆盖
+* 不想处理覆盖的话用 CopyLatestVideo，内部会重试
+*
+*	ShmFrameReader reader;
+*	reader.Open(SHM_FRAME_RING_DEFAULT_NAME);
+*	uint64_t seen = 0;
+*	while (reader.WaitVideo(seen, 100)) {
+*		ShmFrameReader::VideoFrame frame;
+*		if (reader.AcquireLatestVideo(&frame)) {
+*			consume(frame.data);
+*			if (reader.ValidateVideo(frame)) seen = frame.frame_index + 1;
+*		}
+*	}
+*/
+
+#include "shm-frame-ring.h"
+
+class ShmFrameReader
+{
+public:
+	struct VideoFrame
+	{
+		const uint8_t* data;
+		uint32_t width;
+		uint32_t height;
+		uint32_t stride;
+		uint64_t frame_index;
+		uint64_t timestamp;
+		uint64_t sequence;
+	};
+
+	struct AudioPacket
+	{
+		// planes[c] 指向第 c 个声道，float planar
+		const float* planes[SHM_FRAME_RING_MAX_AUDIO_CHANNELS];
+		uint32_t channels;
+		uint32_t frames;
+		uint32_t samples_per_sec;
+		uint64_t packet_index;
+		uint64_t timestamp;
+		uint64_t sequence;
+	};
+
+	ShmFrameReader();
+	~ShmFrameReader();
+
+	bool Open(const char* name);
+	void Close();
+	bool IsOpen() const { return header_ != nullptr; }
+	bool IsWriterAlive() const;
+	const ShmFrameRing::ShmRingHeader* GetHeader() const { return header_; }
+
+	uint64_t GetVideoPublished() const;
+	uint64_t GetAudioPublished() const;
+
+	// 等到已发布帧数 > next_index，超时或写端退出返回 false
+	bool WaitVideo(uint64_t next_index, uint32_t timeout_ms);
+	bool WaitAudio(uint64_t next_index, uint32_t timeout_ms);
+
+	bool AcquireLatestVideo(VideoFrame* frame);
+	bool AcquireVideo(uint64_t frame_index, VideoFrame* frame);
+	bool ValidateVideo(const VideoFrame& frame) const;
+	bool CopyLatestVideo(uint8_t* dst, size_t dst_linesize, VideoFrame* info);
+
+	// 音频要按顺序消费，index 太旧（已被覆盖）或还没写时返回 false
+	bool AcquireAudio(uint64_t packet_index, AudioPacket* packet);
+	bool ValidateAudio(const AudioPacket& packet) const;
+
+private:
+	ShmFrameRing::ShmRegion region_;
+	ShmFrameRing::ShmRingHeader* header_ = nullptr;
+};
+
+#endif
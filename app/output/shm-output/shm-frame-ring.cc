@@ -0,0 +1,235 @@
+#include "shm-frame-ring.h"
+#include <string.h>
+#include <thread>
+#include <chrono>
+
+#if defined(_WIN32)
+#include <Windows.h>
+#else
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#if defined(__linux__)
+#include <linux/futex.h>
+#include <sys/syscall.h>
+#include <time.h>
+#include <limits.h>
+#endif
+#endif
+
+namespace ShmFrameRing
+{
+#if defined(_WIN32)
+	static std::wstring ToWide(const std::string& name)
+	{
+		return std::wstring(name.begin(), name.end());
+	}
+#endif
+
+	ShmRegion::ShmRegion()
+	{
+
+	}
+
+	ShmRegion::~ShmRegion()
+	{
+		Close();
+	}
+
+	bool ShmRegion::Create(const char* name, size_t size)
+	{
+		Close();
+		name_ = name;
+		size_ = size;
+		owner_ = true;
+
+#if defined(_WIN32)
+		std::wstring map_name = L"Local\\" + ToWide(name_);
+		HANDLE mapping = CreateFileMappingW(INVALID_HANDLE_VALUE, NULL, PAGE_READWRITE,
+			(DWORD)((uint64_t)size >> 32), (DWORD)(size & 0xFFFFFFFF), map_name.c_str());
+		if (!mapping)
+			return false;
+		mapping_ = mapping;
+		data_ = MapViewOfFile(mapping, FILE_MAP_ALL_ACCESS, 0, 0, size);
+		if (!data_ || !OpenEvents(true))
+		{
+			Close();
+			return false;
+		}
+#else
+		std::string shm_name = "/" + name_;
+		shm_unlink(shm_name.c_str());
+		int fd = shm_open(shm_name.c_str(), O_CREAT | O_RDWR, 0600);
+		if (fd < 0)
+			return false;
+		if (ftruncate(fd, (off_t)size) != 0)
+		{
+			close(fd);
+			shm_unlink(shm_name.c_str());
+			return false;
+		}
+		void* data = mmap(NULL, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+		close(fd);
+		if (data == MAP_FAILED)
+		{
+			shm_unlink(shm_name.c_str());
+			return false;
+		}
+		data_ = data;
+#endif
+		memset(data_, 0, size_);
+		return true;
+	}
+
+	bool ShmRegion::Open(const char* name)
+	{
+		Close();
+		name_ = name;
+		owner_ = false;
+
+#if defined(_WIN32)
+		std::wstring map_name = L"Local\\" + ToWide(name_);
+		HANDLE mapping = OpenFileMappingW(FILE_MAP_ALL_ACCESS, FALSE, map_name.c_str());
+		if (!mapping)
+			return false;
+		mapping_ = mapping;
+		data_ = MapViewOfFile(mapping, FILE_MAP_ALL_ACCESS, 0, 0, 0);
+		if (!data_)
+		{
+			Close();
+			return false;
+		}
+		MEMORY_BASIC_INFORMATION info;
+		VirtualQuery(data_, &info, sizeof(info));
+		size_ = info.RegionSize;
+		if (!OpenEvents(false))
+		{
+			Close();
+			return false;
+		}
+#else
+		std::string shm_name = "/" + name_;
+		int fd = shm_open(shm_name.c_str(), O_RDWR, 0600);
+		if (fd < 0)
+			return false;
+		struct stat st;
+		if (fstat(fd, &st) != 0 || st.st_size <= 0)
+		{
+			close(fd);
+			return false;
+		}
+		// 读端也需要写权限，futex 和 seqlock 的原子变量都在这块内存里
+		void* data = mmap(NULL, (size_t)st.st_size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+		close(fd);
+		if (data == MAP_FAILED)
+			return false;
+		data_ = data;
+		size_ = (size_t)st.st_size;
+#endif
+		return true;
+	}
+
+	void ShmRegion::Close()
+	{
+#if defined(_WIN32)
+		if (data_)
+			UnmapViewOfFile(data_);
+		if (mapping_)
+			CloseHandle((HANDLE)mapping_);
+		if (video_event_)
+			CloseHandle((HANDLE)video_event_);
+		if (audio_event_)
+			CloseHandle((HANDLE)audio_event_);
+		video_event_ = nullptr;
+		audio_event_ = nullptr;
+		mapping_ = nullptr;
+#else
+		if (data_)
+			munmap(data_, size_);
+		if (owner_ && !name_.empty())
+			shm_unlink(("/" + name_).c_str());
+#endif
+		data_ = nullptr;
+		size_ = 0;
+		owner_ = false;
+	}
+
+#if defined(_WIN32)
+	bool ShmRegion::OpenEvents(bool create)
+	{
+		std::wstring video_name = L"Local\\" + ToWide(name_) + L"_video";
+		std::wstring audio_name = L"Local\\" + ToWide(name_) + L"_audio";
+		if (create)
+		{
+			video_event_ = CreateEventW(NULL, TRUE, FALSE, video_name.c_str());
+			audio_event_ = CreateEventW(NULL, TRUE, FALSE, audio_name.c_str());
+		}
+		else
+		{
+			video_event_ = OpenEventW(SYNCHRONIZE, FALSE, video_name.c_str());
+			audio_event_ = OpenEventW(SYNCHRONIZE, FALSE, audio_name.c_str());
+		}
+		return video_event_ && audio_event_;
+	}
+
+	void* ShmRegion::GetEvent(const std::atomic<uint32_t>* word) const
+	{
+		const ShmRingHeader* header = (const ShmRingHeader*)data_;
+		return word == &header->video_notify ? video_event_ : audio_event_;
+	}
+#endif
+
+	void ShmRegion::Notify(std::atomic<uint32_t>* word)
+	{
+		word->fetch_add(1, std::memory_order_release);
+#if defined(_WIN32)
+		// 手动重置事件：唤醒当前所有等待者，错过的读端靠 Wait 的超时兜底
+		HANDLE ev = (HANDLE)GetEvent(word);
+		if (ev)
+		{
+			SetEvent(ev);
+			ResetEvent(ev);
+		}
+#elif defined(__linux__)
+		syscall(SYS_futex, (uint32_t*)word, FUTEX_WAKE, INT_MAX, NULL, NULL, 0);
+#endif
+	}
+
+	bool ShmRegion::Wait(std::atomic<uint32_t>* word, uint32_t expected, uint32_t timeout_ms)
+	{
+		if (word->load(std::memory_order_acquire) != expected)
+			return true;
+#if defined(_WIN32)
+		HANDLE ev = (HANDLE)GetEvent(word);
+		uint32_t waited = 0;
+		while (word->load(std::memory_order_acquire) == expected)
+		{
+			if (waited >= timeout_ms)
+				return false;
+			uint32_t step = (timeout_ms - waited) < 4 ? (timeout_ms - waited) : 4;
+			if (ev)
+				WaitForSingleObject(ev, step);
+			else
+				Sleep(step);
+			waited += step;
+		}
+		return true;
+#elif defined(__linux__)
+		struct timespec ts;
+		ts.tv_sec = timeout_ms / 1000;
+		ts.tv_nsec = (long)(timeout_ms % 1000) * 1000000L;
+		syscall(SYS_futex, (uint32_t*)word, FUTEX_WAIT, expected, &ts, NULL, 0);
+		return word->load(std::memory_order_acquire) != expected;
+#else
+		auto deadline = std::chrono::steady_clock::now() + std::chrono::milliseconds(timeout_ms);
+		while (word->load(std::memory_order_acquire) == expected)
+		{
+			if (std::chrono::steady_clock::now() >= deadline)
+				return false;
+			std::this_thread::sleep_for(std::chrono::microseconds(500));
+		}
+		return true;
+#endif
+	}
+}
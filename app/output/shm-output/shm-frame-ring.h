@@ -0,0 +1,145 @@
+#ifndef SHM_FRAME_RING_H
+#define SHM_FRAME_RING_H
+
+/* 共享内存帧环形缓冲的内存布局，写端(TinyStudio)和读端(其他进程)共用
+*
+* [ShmRingHeader][video slot 0]...[video slot N-1][audio slot 0]...[audio slot M-1]
+* 每个 slot = ShmSlotHeader + 数据，按 64 字节对齐
+*
+* slot 用 seqlock 保护：写第 k 帧时 sequence = 2k+1，写完置为 2k+2
+* 读端读数据前后各取一次 sequence，不相等或为奇数说明被覆盖，丢弃重读
+* 新帧通知：Linux 用 futex 等 *_notify，Windows 用命名事件，其他平台退化为轮询
+*/
+
+#include <stdint.h>
+#include <stddef.h>
+#include <atomic>
+#include <string>
+
+#define SHM_FRAME_RING_MAGIC 0x52465354 // 'TSFR'
+#define SHM_FRAME_RING_VERSION 1
+#define SHM_FRAME_RING_ALIGN 64
+#define SHM_FRAME_RING_DEFAULT_NAME "TinyStudioFrames"
+#define SHM_FRAME_RING_MAX_AUDIO_CHANNELS 8
+
+namespace ShmFrameRing
+{
+	enum PixelFormat : uint32_t
+	{
+		kPixelBGRA = 0,
+	};
+
+	enum AudioFormat : uint32_t
+	{
+		kAudioFloatPlanar = 0,
+	};
+
+	struct ShmSlotHeader
+	{
+		std::atomic<uint64_t> sequence;
+		uint64_t frame_index;
+		uint64_t timestamp;
+		uint32_t data_size;
+		// 音频 slot 的有效帧数，视频 slot 不用
+		uint32_t audio_frames;
+		uint8_t reserved[SHM_FRAME_RING_ALIGN - 32];
+	};
+
+	struct ShmRingHeader
+	{
+		uint32_t magic;
+		uint32_t version;
+		uint32_t header_size;
+		uint32_t reserved0;
+
+		uint32_t video_slot_count;
+		uint32_t video_width;
+		uint32_t video_height;
+		uint32_t video_stride;
+		uint32_t video_format;
+		uint32_t video_slot_size;
+		uint64_t video_slot_offset;
+
+		uint32_t audio_slot_count;
+		uint32_t audio_channels;
+		uint32_t audio_samples_per_sec;
+		uint32_t audio_max_frames;
+		uint32_t audio_format;
+		uint32_t audio_slot_size;
+		uint64_t audio_slot_offset;
+
+		uint64_t total_size;
+
+		// 已发布的帧数，最新一帧在 slot (count - 1) % slot_count
+		alignas(SHM_FRAME_RING_ALIGN) std::atomic<uint64_t> video_published;
+		alignas(SHM_FRAME_RING_ALIGN) std::atomic<uint64_t> audio_published;
+		// futex 字，每次发布 +1
+		alignas(SHM_FRAME_RING_ALIGN) std::atomic<uint32_t> video_notify;
+		alignas(SHM_FRAME_RING_ALIGN) std::atomic<uint32_t> audio_notify;
+		std::atomic<uint32_t> writer_alive;
+	};
+
+	static_assert(sizeof(ShmSlotHeader) == SHM_FRAME_RING_ALIGN, "slot header must be one cache line");
+	static_assert(std::atomic<uint64_t>::is_always_lock_free, "shared atomics must be lock free");
+	static_assert(std::atomic<uint32_t>::is_always_lock_free, "shared atomics must be lock free");
+
+	inline size_t AlignUp(size_t size)
+	{
+		return (size + SHM_FRAME_RING_ALIGN - 1) & ~(size_t)(SHM_FRAME_RING_ALIGN - 1);
+	}
+
+	inline ShmSlotHeader* VideoSlot(ShmRingHeader* header, uint64_t index)
+	{
+		return (ShmSlotHeader*)((uint8_t*)header + header->video_slot_offset
+			+ (index % header->video_slot_count) * (size_t)header->video_slot_size);
+	}
+
+	inline ShmSlotHeader* AudioSlot(ShmRingHeader* header, uint64_t index)
+	{
+		return (ShmSlotHeader*)((uint8_t*)header + header->audio_slot_offset
+			+ (index % header->audio_slot_count) * (size_t)header->audio_slot_size);
+	}
+
+	inline uint8_t* SlotData(ShmSlotHeader* slot)
+	{
+		return (uint8_t*)slot + sizeof(ShmSlotHeader);
+	}
+
+	// 平台相关的共享内存映射和通知，写端 Create，读端 Open
+	class ShmRegion
+	{
+	public:
+		ShmRegion();
+		~ShmRegion();
+
+		bool Create(const char* name, size_t size);
+		bool Open(const char* name);
+		void Close();
+
+		void* GetData() const { return data_; }
+		size_t GetSize() const { return size_; }
+
+		// word 为头里的 video_notify 或 audio_notify
+		void Notify(std::atomic<uint32_t>* word);
+		// 等到 *word != expected 或超时，返回 false 表示超时
+		bool Wait(std::atomic<uint32_t>* word, uint32_t expected, uint32_t timeout_ms);
+
+	private:
+#if defined(_WIN32)
+		bool OpenEvents(bool create);
+		// word 对应的事件
+		void* GetEvent(const std::atomic<uint32_t>* word) const;
+#endif
+
+	private:
+		std::string name_;
+		void* data_ = nullptr;
+		size_t size_ = 0;
+		bool owner_ = false;
+		void* mapping_ = nullptr;
+		void* video_event_ = nullptr;
+		void* audio_event_ = nullptr;
+	};
+}
+
+#endif
@@ -0,0 +1,153 @@
+#include "shm-frame-writer.h"
+#include <string.h>
+
+using namespace ShmFrameRing;
+
+ShmFrameWriter::ShmFrameWriter()
+{
+
+}
+
+ShmFrameWriter::~ShmFrameWriter()
+{
+	Close();
+}
+
+bool ShmFrameWriter::Open(const Config& config)
+{
+	Close();
+	if (!config.width || !config.height || !config.video_slots)
+		return false;
+	if (config.audio_channels > SHM_FRAME_RING_MAX_AUDIO_CHANNELS)
+		return false;
+
+	const size_t header_size = AlignUp(sizeof(ShmRingHeader));
+	const uint32_t stride = config.width * 4;
+	const size_t video_slot_size = AlignUp(sizeof(ShmSlotHeader) + (size_t)stride * config.height);
+	const uint32_t audio_slots = config.audio_channels ? config.audio_slots : 0;
+	const size_t audio_slot_size = audio_slots
+		? AlignUp(sizeof(ShmSlotHeader) + (size_t)config.audio_channels * config.audio_max_frames * sizeof(float))
+		: 0;
+	const size_t total = header_size + video_slot_size * config.video_slots + audio_slot_size * audio_slots;
+
+	if (!region_.Create(config.name.c_str(), total))
+		return false;
+
+	ShmRingHeader* header = (ShmRingHeader*)region_.GetData();
+	header->magic = SHM_FRAME_RING_MAGIC;
+	header->version = SHM_FRAME_RING_VERSION;
+	header->header_size = (uint32_t)header_size;
+	header->video_slot_count = config.video_slots;
+	header->video_width = config.width;
+	header->video_height = config.height;
+	header->video_stride = stride;
+	header->video_format = kPixelBGRA;
+	header->video_slot_size = (uint32_t)video_slot_size;
+	header->video_slot_offset = header_size;
+	header->audio_slot_count = audio_slots;
+	header->audio_channels = config.audio_channels;
+	header->audio_samples_per_sec = config.audio_samples_per_sec;
+	header->audio_max_frames = config.audio_max_frames;
+	header->audio_format = kAudioFloatPlanar;
+	header->audio_slot_size = (uint32_t)audio_slot_size;
+	header->audio_slot_offset = header_size + video_slot_size * config.video_slots;
+	header->total_size = total;
+	header->video_published.store(0, std::memory_order_relaxed);
+	header->audio_published.store(0, std::memory_order_relaxed);
+	header->video_notify.store(0, std::memory_order_relaxed);
+	header->audio_notify.store(0, std::memory_order_relaxed);
+	header->writer_alive.store(1, std::memory_order_release);
+
+	header_ = header;
+	return true;
+}
+
+void ShmFrameWriter::Close()
+{
+	if (header_)
+	{
+		header_->writer_alive.store(0, std::memory_order_release);
+		// 把等待中的读端叫醒，让它们看到 writer_alive == 0
+		region_.Notify(&header_->video_notify);
+		region_.Notify(&header_->audio_notify);
+		header_ = nullptr;
+	}
+	region_.Close();
+}
+
+bool ShmFrameWriter::WriteVideo(const uint8_t* bgra, size_t linesize, uint64_t timestamp)
+{
+	if (!header_ || !bgra)
+		return false;
+
+	const uint64_t index = header_->video_published.load(std::memory_order_relaxed);
+	ShmSlotHeader* slot = VideoSlot(header_, index);
+
+	slot->sequence.store(index * 2 + 1, std::memory_order_relaxed);
+	std::atomic_thread_fence(std::memory_order_release);
+
+	uint8_t* dst = SlotData(slot);
+	const size_t stride = header_->video_stride;
+	const size_t row = linesize < stride ? linesize : stride;
+	if (linesize == stride)
+	{
+		memcpy(dst, bgra, stride * header_->video_height);
+	}
+	else
+	{
+		for (uint32_t y = 0; y < header_->video_height; y++)
+			memcpy(dst + y * stride, bgra + y * linesize, row);
+	}
+	slot->frame_index = index;
+	slot->timestamp = timestamp;
+	slot->data_size = (uint32_t)(stride * header_->video_height);
+	slot->audio_frames = 0;
+
+	slot->sequence.store(index * 2 + 2, std::memory_order_release);
+	header_->video_published.store(index + 1, std::memory_order_release);
+	region_.Notify(&header_->video_notify);
+	return true;
+}
+
+bool ShmFrameWriter::WriteAudio(const uint8_t* const* planes, uint32_t frames, uint64_t timestamp)
+{
+	if (!header_ || !header_->audio_slot_count || !planes)
+		return false;
+	if (frames > header_->audio_max_frames)
+		frames = header_->audio_max_frames;
+
+	const uint64_t index = header_->audio_published.load(std::memory_order_relaxed);
+	ShmSlotHeader* slot = AudioSlot(header_, index);
+
+	slot->sequence.store(index * 2 + 1, std::memory_order_relaxed);
+	std::atomic_thread_fence(std::memory_order_release);
+
+	float* dst = (float*)SlotData(slot);
+	for (uint32_t c = 0; c < header_->audio_channels; c++)
+	{
+		float* plane = dst + (size_t)c * header_->audio_max_frames;
+		if (planes[c])
+			memcpy(plane, planes[c], frames * sizeof(float));
+		else
+			memset(plane, 0, frames * sizeof(float));
+	}
+	slot->frame_index = index;
+	slot->timestamp = timestamp;
+	slot->data_size = header_->audio_channels * frames * (uint32_t)sizeof(float);
+	slot->audio_frames = frames;
+
+	slot->sequence.store(index * 2 + 2, std::memory_order_release);
+	header_->audio_published.store(index + 1, std::memory_order_release);
+	region_.Notify(&header_->audio_notify);
+	return true;
+}
+
+uint64_t ShmFrameWriter::GetVideoPublished() const
+{
+	return header_ ? header_->video_published.load(std::memory_order_relaxed) : 0;
+}
+
+uint64_t ShmFrameWriter::GetAudioPublished() const
+{
+	return header_ ? header_->audio_published.load(std::memory_order_relaxed) : 0;
+}
@@ -0,0 +1,46 @@
+#ifndef SHM_FRAME_WRITER_H
+#define SHM_FRAME_WRITER_H
+
+/* 共享内存帧环的写端，单写者
+* 不依赖引擎，Linux 下也能单独编译，shm-frame-feed 用它灌测试数据
+*/
+
+#include "shm-frame-ring.h"
+
+class ShmFrameWriter
+{
+public:
+	struct Config
+	{
+		std::string name = SHM_FRAME_RING_DEFAULT_NAME;
+		uint32_t video_slots = 4;
+		uint32_t width = 0;
+		uint32_t height = 0;
+		// audio_channels 为 0 时不开音频环
+		uint32_t audio_slots = 16;
+		uint32_t audio_channels = 0;
+		uint32_t audio_samples_per_sec = 48000;
+		uint32_t audio_max_frames = 1024;
+	};
+
+	ShmFrameWriter();
+	~ShmFrameWriter();
+
+	bool Open(const Config& config);
+	void Close();
+	bool IsOpen() const { return header_ != nullptr; }
+
+	// linesize 可以和共享内存里的 stride 不同，按行拷贝
+	bool WriteVideo(const uint8_t* bgra, size_t linesize, uint64_t timestamp);
+	// planes 为 float planar
+	bool WriteAudio(const uint8_t* const* planes, uint32_t frames, uint64_t timestamp);
+
+	uint64_t GetVideoPublished() const;
+	uint64_t GetAudioPublished() const;
+
+private:
+	ShmFrameRing::ShmRegion region_;
+	ShmFrameRing::ShmRingHeader* header_ = nullptr;
+};
+
+#endif
@@ -1,4 +1,7 @@
 #include "base-source-i.h"
+#include "task-pool.h"
+#include "logger.h"
+#include "platform.h"
 
 IBaseSource::~IBaseSource()
 {
@@ -20,6 +23,7 @@ void IBaseSource::SetCoreEnv(CoreEngine* engine)
 void IBaseSource::SetSourceName(const char* name)
 {
 	source_name_ = std::string(name);
+	profile_item_.store(nullptr);
 }
 
 const char* IBaseSource::GetSourceName()
@@ -46,51 +50,216 @@ bool IBaseSource::UpdateEntry(const char* jsondata)
 {
 	try
 	{
-		auto json = nlohmann::json::parse(jsondata);
-		if (!json.is_object())
+		CoreProperty::PropertyBag props;
+		if (!props.FromJson(nlohmann::json::parse(jsondata)))
 			return false;
-		if (json.find("topX") != json.end() && json.find("topY") != json.end() && json.find("width") != json.end() && json.find("height") != json.end())
+		return UpdateEntry(props);
+	}
+	catch (...)
+	{
+
+	}
+	return false;
+}
+
+bool IBaseSource::UpdateEntry(const CoreProperty::PropertyBag& props)
+{
+	using CoreProperty::PropertyId;
+
+	SourceRectType rect;
+	if (props.GetInt(PropertyId::kTopX, rect.topX) && props.GetInt(PropertyId::kTopY, rect.topY)
+		&& props.GetInt(PropertyId::kWidth, rect.width) && props.GetInt(PropertyId::kHeight, rect.height))
+	{
+		source_rect_type_ = rect;
+
+		if (source_rect_type_.width)
+			source_texture_size_.width = source_rect_type_.width;
+
+		if (source_rect_type_.height)
+			source_texture_size_.height = source_rect_type_.height;
+	}
+	else
+	{
+		if (source_rect_type_.topX != 0 || source_rect_type_.topY != 0 || source_rect_type_.width != 0 || source_rect_type_.height != 0)
 		{
-			int topX = std::stoi((std::string)json.at("topX"));
-			int topY = std::stoi((std::string)json.at("topY"));
-			int width = std::stoi((std::string)json.at("width"));
-			int height = std::stoi((std::string)json.at("height"));
-			source_rect_type_.topX = topX;
-			source_rect_type_.topY = topY;
-			source_rect_type_.width = width;
-			source_rect_type_.height = height;
-
-			if (source_rect_type_.width)
-				source_texture_size_.width = source_rect_type_.width;
-
-			if (source_rect_type_.height)
-				source_texture_size_.height = source_rect_type_.height;
+
 		}
 		else
 		{
-			if (source_rect_type_.topX != 0 || source_rect_type_.topY != 0 || source_rect_type_.width != 0 || source_rect_type_.height != 0)
-			{
-
-			}
-			else
-			{
-				source_rect_type_.topX = (int32_t)CoreSceneData::AlignType::kAlignLeft;
-				source_rect_type_.topY = (int32_t)CoreSceneData::AlignType::kAlignTop;
-				source_rect_type_.width = (int32_t)CoreSceneData::SizeType::kClientSize;
-				source_rect_type_.height = (int32_t)CoreSceneData::SizeType::kClientSize;
-			}
+			source_rect_type_.topX = (int32_t)CoreSceneData::AlignType::kAlignLeft;
+			source_rect_type_.topY = (int32_t)CoreSceneData::AlignType::kAlignTop;
+			source_rect_type_.width = (int32_t)CoreSceneData::SizeType::kClientSize;
+			source_rect_type_.height = (int32_t)CoreSceneData::SizeType::kClientSize;
 		}
-		Update(jsondata);
 	}
-	catch (...)
+	return Update(props);
+}
+
+void IBaseSource::LoadAsync(TaskPool* pool)
+{
+	{
+		std::unique_lock<std::mutex> lock(load_mutex_);
+		load_pool_ = pool;
+		// 正在加载时只做标记，当前这一轮结束后再加载一次
+		if (loading_)
+		{
+			reload_ = true;
+			return;
+		}
+		loading_ = true;
+	}
+	pool->Post([this]() { LoadImpl(); });
+}
+
+void IBaseSource::RequestReload()
+{
+	TaskPool* pool = nullptr;
+	{
+		std::unique_lock<std::mutex> lock(load_mutex_);
+		pool = load_pool_;
+	}
+	if (pool)
+		LoadAsync(pool);
+}
+
+void IBaseSource::WaitLoad()
+{
+	std::unique_lock<std::mutex> lock(load_mutex_);
+	load_cond_.wait(lock, [this]() { return !loading_; });
+}
+
+bool IBaseSource::IsLoading()
+{
+	std::unique_lock<std::mutex> lock(load_mutex_);
+	return loading_;
+}
+
+void IBaseSource::LoadImpl()
+{
+	while (1)
 	{
+		uint64_t start_ns = os_gettime_ns();
+		bool ret = Load();
+		// 滤镜在 LoadAsync 之前已经全部创建好，这里不走 GetCoreFilter 的延迟创建
+		if (ret && core_filter_)
+			ret = core_filter_->LoadFilters();
 
+		if (ret)
+			LOGGER_INFO("[Source] %s loaded, cost:%f ms", source_name_.c_str(), (os_gettime_ns() - start_ns) / 1000000.0);
+		else
+			LOGGER_ERROR("[Source] %s load failed", source_name_.c_str());
+
+		std::unique_lock<std::mutex> lock(load_mutex_);
+		if (reload_)
+		{
+			reload_ = false;
+			continue;
+		}
+		if (ret)
+			source_ready_.store(true);
+		loading_ = false;
+		load_cond_.notify_all();
+		return;
 	}
-	return false;
+}
+
+namespace
+{
+	// 遮挡状态来回变化时不要每帧都暂停/恢复线程
+	const int kHideDelayFrames = 10;
+}
+
+void IBaseSource::Activate()
+{
+	if (active_.load())
+		return;
+	active_.store(true);
+	OnActivate();
+	if (core_filter_)
+		core_filter_->SetFiltersActive(true);
+}
+
+void IBaseSource::Deactivate()
+{
+	if (!active_.load())
+		return;
+	Hide();
+	active_.store(false);
+	OnDeactivate();
+	if (core_filter_)
+		core_filter_->SetFiltersActive(false);
+}
+
+void IBaseSource::Show()
+{
+	if (!active_.load() || showing_.load())
+		return;
+	showing_.store(true);
+	undrawn_frames_ = 0;
+	OnShow();
+	if (core_filter_)
+		core_filter_->SetFiltersShowing(true);
+}
+
+void IBaseSource::Hide()
+{
+	if (!showing_.load())
+		return;
+	showing_.store(false);
+	OnHide();
+	if (core_filter_)
+		core_filter_->SetFiltersShowing(false);
+}
+
+void IBaseSource::UpdateShowing()
+{
+	if (drawn_)
+	{
+		undrawn_frames_ = 0;
+		Show();
+	}
+	else if (showing_.load() && ++undrawn_frames_ >= kHideDelayFrames)
+	{
+		Hide();
+	}
+	drawn_ = false;
+}
+
+Profiler::Item* IBaseSource::GetProfileItem()
+{
+	Profiler::Item* item = profile_item_.load();
+	if (!item && core_engine_ && core_engine_->GetProfiler())
+	{
+		item = core_engine_->GetProfiler()->GetItem(source_name_);
+		profile_item_.store(item);
+	}
+	return item;
+}
+
+bool IBaseSource::TickBeginEntry()
+{
+	if (!IsReady())
+		return false;
+	ProfileScope scope(GetProfileItem(), Profiler::Metric::kTickBegin);
+	tick_begun_ = TickBegin();
+	return tick_begun_;
+}
+
+void IBaseSource::TickPrepareEntry()
+{
+	ProfileScope scope(GetProfileItem(), Profiler::Metric::kTickPrepare);
+	TickPrepare();
 }
 
 bool IBaseSource::TickEntry()
 {
+	if (!IsReady() && !tick_begun_)
+		return false;
+
+	tick_begun_ = false;
+	Profiler::Item* item = GetProfileItem();
+	ProfileScope scope(item, Profiler::Metric::kTick);
+	GpuProfileScope gpu_scope(core_engine_ ? core_engine_->GetD3D() : nullptr, item, Profiler::Metric::kTickGpu);
 	bool ret = Tick();
 	UpdateTextureSize();
 	source_rect_.width = (float)source_texture_size_.width;
@@ -98,6 +267,22 @@ bool IBaseSource::TickEntry()
 	return ret;
 }
 
+void IBaseSource::CopyToMapped(uint8_t* dst, uint32_t dst_pitch, const uint8_t* src, uint32_t src_pitch, uint32_t height)
+{
+	size_t row_copy = (src_pitch < dst_pitch) ? src_pitch : dst_pitch;
+	if (src_pitch == dst_pitch)
+	{
+		memcpy(dst, src, row_copy * height);
+		return;
+	}
+	for (uint32_t i = 0; i < height; i++)
+	{
+		memcpy(dst, src, row_copy);
+		dst += dst_pitch;
+		src += src_pitch;
+	}
+}
+
 void IBaseSource::Draw2DSource()
 {
 	CoreD3D* d3d = core_engine_->GetD3D();
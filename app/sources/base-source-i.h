@@ -3,6 +3,9 @@
 #include "core-filter.h"
 #include <Windows.h>
 #include <memory>
+#include <atomic>
+#include <mutex>
+#include <condition_variable>
 #include <wrl/client.h>
 #include <string>
 #include <d3d11_1.h>
@@ -13,8 +16,11 @@
 #include "core-settings.h"
 #include "core-engine.h"
 #include "core-d3d.h"
+#include "core-property.h"
+#include "profiler.h"
 
 class CoreEngine;
+class TaskPool;
 
 class IBaseSource
 {
@@ -50,16 +56,60 @@ public:
 	const SourceRect* GetSourceRect();
 	CoreFilter* GetCoreFilter();
 	bool UpdateEntry(const char* jsondata);
+	bool UpdateEntry(const CoreProperty::PropertyBag& props);
+	// 每帧的 Tick 分三段，都只处理已就绪的源：
+	// TickBeginEntry 在渲染线程，返回 true 表示这一帧有 CPU 工作 (纹理已经 Map 或者有数据要生成)
+	// TickPrepareEntry 只对 TickBeginEntry 返回 true 的源调用，在工作线程里和其他源并行，不能调用 D3D 上下文
+	// TickEntry 在渲染线程提交 (Unmap、创建纹理等)，没有拆分的源所有工作都在这里
+	bool TickBeginEntry();
+	void TickPrepareEntry();
 	bool TickEntry();
+	// 按源名字登记的耗时统计条目，三段 Tick 和 Render 都记在上面
+	Profiler::Item* GetProfileItem();
+	// 在 pool 上加载源和它的滤镜，首次加载完成前 IsReady 为 false，场景里保留位置但不渲染
+	void LoadAsync(TaskPool* pool);
+	void WaitLoad();
+	// 加载 (或重新加载) 还没结束；加载失败时 IsLoading 和 IsReady 都为 false
+	bool IsLoading();
+	bool IsReady() { return source_ready_.load(); }
 	void GetRenderSize(float& cenx, float& ceny, float& scalex, float& scaley);
 	virtual bool Init() = 0;
 	virtual bool Render() = 0;
+	// 不带透明度地画满自己的区域，用来判断后面的源是否被完全遮挡
+	virtual bool IsOpaque() { return false; }
+
+	// 以下只在渲染线程调用，状态不变时不会重复回调
+	// 激活：所在场景是当前场景 (或正在淡出)；显示：画面上可见，没有被完全遮挡也不在画面外
+	// 隐藏的源不再 Tick，反激活时先隐藏
+	void Activate();
+	void Deactivate();
+	void Show();
+	void Hide();
+	bool IsActive() { return active_.load(); }
+	bool IsShowing() { return showing_.load(); }
+	// 本帧在某个渲染目标里画了 (没被遮挡)
+	void MarkDrawn() { drawn_ = true; }
+	// 每帧 Tick 前调用，连续 kHideDelayFrames 帧没画就隐藏，画了就马上显示
+	void UpdateShowing();
 	
 protected:
-	virtual bool Update(const char* json) = 0;
+	virtual bool Update(const CoreProperty::PropertyBag& props) = 0;
+	virtual bool TickBegin() { return false; }
+	virtual void TickPrepare() {}
 	virtual bool Tick() = 0;
 	virtual void UpdateTextureSize() = 0;
 	void Draw2DSource();
+	// 按行拷贝到映射的纹理，行宽不同时逐行拷贝
+	static void CopyToMapped(uint8_t* dst, uint32_t dst_pitch, const uint8_t* src, uint32_t src_pitch, uint32_t height);
+	// 在加载线程里调用，只做文件读取、解析和解码，D3D 资源留到 Tick 里在渲染线程创建；需要可重复调用
+	virtual bool Load() { return true; }
+	// 属性变化需要重新 Load 时调用，还没开始加载时什么都不做
+	void RequestReload();
+	// 隐藏时停掉解码/采集线程，反激活时可以释放大块缓冲；重新激活后第一次 Tick 要能马上出画面
+	virtual void OnActivate() {}
+	virtual void OnDeactivate() {}
+	virtual void OnShow() {}
+	virtual void OnHide() {}
 
 protected:
 	CoreEngine* core_engine_ = nullptr;
@@ -69,4 +119,24 @@ protected:
 	SourceTextureSize source_texture_size_;
 	SourceRect source_rect_;
 	SourceRectType source_rect_type_;
+
+private:
+	void LoadImpl();
+
+private:
+	TaskPool* load_pool_ = nullptr;
+	std::mutex load_mutex_;
+	std::condition_variable load_cond_;
+	bool loading_ = false;
+	bool reload_ = false;
+	std::atomic<bool> source_ready_{ false };
+	// TickPrepareEntry 在工作线程里也会取，改名时清空重新登记
+	std::atomic<Profiler::Item*> profile_item_{ nullptr };
+	// TickBegin 之后一定要走到 Tick，否则 Map 的纹理不会 Unmap
+	bool tick_begun_ = false;
+
+	std::atomic<bool> active_{ false };
+	std::atomic<bool> showing_{ false };
+	bool drawn_ = false;
+	int undrawn_frames_ = 0;
 };
\ No newline at end of file
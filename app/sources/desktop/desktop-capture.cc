@@ -37,7 +37,7 @@ bool DesktopCaptureSource::Init()
 	return true;
 }
 
-bool DesktopCaptureSource::Update(const char* json)
+bool DesktopCaptureSource::Update(const CoreProperty::PropertyBag& props)
 {
 	return true;
 }
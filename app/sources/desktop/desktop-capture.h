@@ -11,9 +11,10 @@ public:
 
 	virtual bool Init();
 	virtual bool Render();
+	virtual bool IsOpaque() { return m_pTexture != nullptr; }
 
 protected:
-	virtual bool Update(const char* json);
+	virtual bool Update(const CoreProperty::PropertyBag& props);
 	virtual bool Tick();
 	virtual void UpdateTextureSize();
 
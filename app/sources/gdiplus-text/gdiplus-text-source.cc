@@ -95,31 +95,20 @@ bool GdiplusTextSource::Init()
 	return true;
 }
 
-bool GdiplusTextSource::Update(const char* jsondata)
+bool GdiplusTextSource::Update(const CoreProperty::PropertyBag& props)
 {
-	try
+	std::string sText;
+	if (props.GetString(CoreProperty::PropertyId::kText, sText))
 	{
-		auto json = nlohmann::json::parse(jsondata);
-		if (!json.is_object())
-			return false;
-		if (json.find("text") != json.end())
-		{
-			std::string sText = json.at("text");
-			std::wstring wText = L"";
-			wText = toWideString(sText.c_str(), sText.length(), CP_UTF8);
-			wText.push_back('\n');
-			if (wText == text)
-				return true;
-			text = wText;
-			text_update_.store(true);
-		}
-		return true;
-	}
-	catch (...)
-	{
-
+		std::wstring wText = L"";
+		wText = toWideString(sText.c_str(), sText.length(), CP_UTF8);
+		wText.push_back('\n');
+		if (wText == text)
+			return true;
+		text = wText;
+		text_update_.store(true);
 	}
-	return false;
+	return true;
 }
 
 void GdiplusTextSource::UpdateFont()
@@ -308,10 +297,6 @@ void GdiplusTextSource::CalculateTextSizes(const Gdiplus::StringFormat& format,
 
 void GdiplusTextSource::RenderText()
 {
-	CoreD3D* d3d = core_engine_->GetD3D();
-	m_pTexture.Reset();
-	m_pResourceView.Reset();
-
 	Gdiplus::StringFormat format(Gdiplus::StringFormat::GenericTypographic());
 	Gdiplus::Status stat;
 
@@ -321,8 +306,8 @@ void GdiplusTextSource::RenderText()
 	GetStringFormat(format);
 	CalculateTextSizes(format, box, size);
 
-	std::unique_ptr<uint8_t[]> bits(new uint8_t[size.cx * size.cy * 4]);
-	Gdiplus::Bitmap bitmap(size.cx, size.cy, 4 * size.cx, PixelFormat32bppARGB, bits.get());
+	text_data_.resize((size_t)size.cx * size.cy * 4);
+	Gdiplus::Bitmap bitmap(size.cx, size.cy, 4 * size.cx, PixelFormat32bppARGB, text_data_.data());
 
 	Gdiplus::Graphics graphics_bitmap(&bitmap);
 	Gdiplus::LinearGradientBrush brush(Gdiplus::RectF(0, 0, (float)size.cx, (float)size.cy),
@@ -351,49 +336,50 @@ void GdiplusTextSource::RenderText()
 		(int)text.size(),
 		font.get(), box,
 		&format, &brush);
-	width = size.cx;
-	height = size.cy;
+	text_width_ = size.cx;
+	text_height_ = size.cy;
+	text_dirty_ = true;
+}
 
+void GdiplusTextSource::UploadText()
+{
+	CoreD3D* d3d = core_engine_->GetD3D();
+	m_pTexture.Reset();
+	m_pResourceView.Reset();
+
+	width = text_width_;
+	height = text_height_;
 	d3d->CreateD3DTexture(m_pTexture.GetAddressOf(), false, false, width, height, false);
 	d3d->CreateShaderResourceView(m_pTexture.Get(), m_pResourceView.GetAddressOf());
 
-	uint8_t* ptr;
-	uint32_t linesize_out;
-	size_t row_copy;
-	size_t height;
-	uint8_t* data = bits.get();
-
-	D3D11_MAPPED_SUBRESOURCE map;
-
+	D3D11_MAPPED_SUBRESOURCE map = {};
 	d3d->Map(m_pTexture.Get(), 0, D3D11_MAP_WRITE_DISCARD, 0, &map);
+	if (!map.pData)
+		return;
+	CopyToMapped((uint8_t*)map.pData, map.RowPitch, text_data_.data(), width * 4, height);
+	d3d->UnMap(m_pTexture.Get(), 0);
+}
 
-	ptr = (uint8_t*)map.pData;
-	linesize_out = map.RowPitch;
-	uint32_t linesize = size.cx * 4;
-	row_copy = (linesize < linesize_out) ? linesize : linesize_out;
-	height = size.cy;
-	if (linesize == linesize_out) {
-		memcpy(ptr, data, row_copy * height);
-	}
-	else {
-		uint8_t* const end = ptr + height * linesize_out;
-		while (ptr < end) {
-			memcpy(ptr, data, row_copy);
-			ptr += linesize_out;
-			data += linesize;
-		}
-	}
+bool GdiplusTextSource::TickBegin()
+{
+	// 文字内容没变时不用重新光栅化
+	return text_update_.exchange(false);
+}
 
-	d3d->UnMap(m_pTexture.Get(), 0);
+void GdiplusTextSource::TickPrepare()
+{
+	UpdateFont();
+	RenderText();
 }
 
 bool GdiplusTextSource::Tick()
 {
-	if (text_update_.load())
+	// 纹理按文字大小重建，留在渲染线程
+	if (text_dirty_)
 	{
-		UpdateFont();
-		RenderText();
-		text_update_.store(false);
+		text_dirty_ = false;
+		if (text_width_ > 0 && text_height_ > 0)
+			UploadText();
 	}
 	return true;
 }
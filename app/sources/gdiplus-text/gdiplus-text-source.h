@@ -63,13 +63,17 @@ public:
 	virtual bool Render();
 
 protected:
-	virtual bool Update(const char* json);
+	virtual bool Update(const CoreProperty::PropertyBag& props);
+	virtual bool TickBegin();
+	virtual void TickPrepare();
 	virtual bool Tick();
 	virtual void UpdateTextureSize();
 
 private:
 	void UpdateFont();
+	// 在工作线程里光栅化到 text_data_，UploadText 在渲染线程创建纹理并上传
 	void RenderText();
+	void UploadText();
 	void GetStringFormat(Gdiplus::StringFormat& format);
 	void CalculateTextSizes(const Gdiplus::StringFormat& format,
 		Gdiplus::RectF& bounding_box, SIZE& text_size);
@@ -82,6 +86,9 @@ private:
 	std::vector<uint8_t> text_data_;
 	std::vector<D3D11_SUBRESOURCE_DATA> srd;
 	std::atomic<bool> text_update_;
+	int text_width_ = 0;
+	int text_height_ = 0;
+	bool text_dirty_ = false;
 
 	HDCObj hdc_;
 	Gdiplus::Graphics graphics_;
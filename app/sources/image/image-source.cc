@@ -12,6 +12,11 @@ ImageSource::ImageSource()
 
 ImageSource::~ImageSource()
 {
+	if (pending_data_)
+	{
+		free(pending_data_);
+		pending_data_ = nullptr;
+	}
 	gs_free_image_deps();
 }
 
@@ -21,26 +26,51 @@ bool ImageSource::Init()
 	return true;
 }
 
-bool ImageSource::Update(const char* jsondata)
+bool ImageSource::Update(const CoreProperty::PropertyBag& props)
 {
-	try
+	std::string path;
+	if (!props.GetString(CoreProperty::PropertyId::kPath, path))
+		return false;
 	{
-		auto json = nlohmann::json::parse(jsondata);
-		if (!json.is_object())
-			return false;
-		if (json.find("path") != json.end())
-		{
-			std::string path = json.at("path");
-			image_file_path_ = path;
+		std::unique_lock<std::mutex> lock(image_mutex_);
+		if (path == image_file_path_)
 			return true;
-		}
+		image_file_path_ = path;
 	}
-	catch (...)
+	RequestReload();
+	return true;
+}
+
+bool ImageSource::Load()
+{
+	std::string path;
 	{
+		std::unique_lock<std::mutex> lock(image_mutex_);
+		path = image_file_path_;
+	}
+	if (path.empty() || path == loaded_path_)
+		return true;
 
+	uint32_t width = 0;
+	uint32_t height = 0;
+	int size = 0;
+	gs_color_format format;
+	uint8_t* data = gs_create_texture_file_data(path.c_str(), &format, &width, &height, size);
+	if (!data)
+	{
+		LOGGER_ERROR("[ImageSource] decode image failed:%s", path.c_str());
+		return false;
 	}
+	loaded_path_ = path;
 
-	return false;
+	// 解码结果交给渲染线程在 Tick 里上传
+	std::unique_lock<std::mutex> lock(image_mutex_);
+	if (pending_data_)
+		free(pending_data_);
+	pending_data_ = data;
+	pending_width_ = width;
+	pending_height_ = height;
+	return true;
 }
 
 bool ImageSource::Render()
@@ -60,61 +90,66 @@ bool ImageSource::Render()
 	return false;
 }
 
-bool ImageSource::Tick()
+bool ImageSource::TickBegin()
 {
-	if (!image_file_path_.empty())
+	uint8_t* data = nullptr;
+	uint32_t width = 0;
+	uint32_t height = 0;
 	{
-		CoreD3D* d3d = core_engine_->GetD3D();
+		std::unique_lock<std::mutex> lock(image_mutex_);
+		data = pending_data_;
+		width = pending_width_;
+		height = pending_height_;
+		pending_data_ = nullptr;
+	}
+	if (!data)
+		return false;
 
-		uint32_t width = 0;
-		uint32_t height = 0;
-		int size = 0;
-		gs_color_format format;
-		uint8_t* data = gs_create_texture_file_data(image_file_path_.c_str(), &format, &width, &height, size);
-		if (!data)
-		{
-			image_file_path_.clear();
-			return false;
-		}
-
-		if (!m_pTexture)
-		{
-			d3d->CreateD3DTexture(m_pTexture.GetAddressOf(), false, false, width, height, false);
-		}
-		if (!m_pResourceView)
-		{
-			d3d->CreateShaderResourceView(m_pTexture.Get(), m_pResourceView.GetAddressOf());
-		}
-		texture_width_ = width;
-		texture_height_ = height;
-		uint8_t* ptr;
-		uint32_t linesize_out;
-		size_t row_copy;
-
-		D3D11_MAPPED_SUBRESOURCE map;
-		d3d->Map(m_pTexture.Get(), 0, D3D11_MAP_WRITE_DISCARD, 0, &map);
-		ptr = (uint8_t*)map.pData;
-		linesize_out = map.RowPitch;
-		uint32_t linesize = width * 4;
-		row_copy = (linesize < linesize_out) ? linesize : linesize_out;
-		if (linesize == linesize_out)
-		{
-			memcpy(ptr, data, row_copy * height);
-		}
-		else
-		{
-			uint8_t* const end = ptr + height * linesize_out;
-			while (ptr < end) {
-				memcpy(ptr, data, row_copy);
-				ptr += linesize_out;
-				data += linesize;
-			}
-		}
-		d3d->UnMap(m_pTexture.Get(), 0);
+	CoreD3D* d3d = core_engine_->GetD3D();
+	if (m_pTexture && (texture_width_ != (int)width || texture_height_ != (int)height))
+	{
+		m_pResourceView.Reset();
+		m_pTexture.Reset();
+	}
+	if (!m_pTexture)
+	{
+		d3d->CreateD3DTexture(m_pTexture.GetAddressOf(), false, false, width, height, false);
+	}
+	if (!m_pResourceView)
+	{
+		d3d->CreateShaderResourceView(m_pTexture.Get(), m_pResourceView.GetAddressOf());
+	}
+	texture_width_ = width;
+	texture_height_ = height;
+
+	D3D11_MAPPED_SUBRESOURCE map = {};
+	d3d->Map(m_pTexture.Get(), 0, D3D11_MAP_WRITE_DISCARD, 0, &map);
+	if (!map.pData)
+	{
 		free(data);
-		image_file_path_.clear();
-		return true;
+		return false;
 	}
+	mapped_data_ = (uint8_t*)map.pData;
+	mapped_pitch_ = map.RowPitch;
+	upload_data_ = data;
+	return true;
+}
+
+void ImageSource::TickPrepare()
+{
+	CopyToMapped(mapped_data_, mapped_pitch_, upload_data_, texture_width_ * 4, texture_height_);
+}
+
+bool ImageSource::Tick()
+{
+	if (!mapped_data_)
+		return true;
+
+	CoreD3D* d3d = core_engine_->GetD3D();
+	d3d->UnMap(m_pTexture.Get(), 0);
+	mapped_data_ = nullptr;
+	free(upload_data_);
+	upload_data_ = nullptr;
 	return true;
 }
 
@@ -14,14 +14,28 @@ public:
 	virtual bool Render();
 
 protected:
-	virtual bool Update(const char* json);
+	virtual bool Update(const CoreProperty::PropertyBag& props);
+	virtual bool Load();
+	virtual bool TickBegin();
+	virtual void TickPrepare();
 	virtual bool Tick();
 	virtual void UpdateTextureSize();
 
 private:
 	ComPtr< ID3D11Texture2D> m_pTexture;
 	ComPtr<ID3D11ShaderResourceView> m_pResourceView;
-	std::string image_file_path_;
 	int texture_width_ = 0;
 	int texture_height_ = 0;
+	// TickBegin 里 Map 的纹理和取走的解码数据，TickPrepare 在工作线程里拷贝
+	uint8_t* mapped_data_ = nullptr;
+	uint32_t mapped_pitch_ = 0;
+	uint8_t* upload_data_ = nullptr;
+
+	std::mutex image_mutex_;
+	std::string image_file_path_;
+	// 以下由加载线程写入，pending_data_ 在 Tick 里取走
+	std::string loaded_path_;
+	uint8_t* pending_data_ = nullptr;
+	uint32_t pending_width_ = 0;
+	uint32_t pending_height_ = 0;
 };
\ No newline at end of file
@@ -76,7 +76,11 @@ MediaControler::MediaControler(MediaStopped cb)
 
 MediaControler::~MediaControler()
 {
-	media_started_.store(false);
+	{
+		std::unique_lock<std::mutex> lock(pause_mutex_);
+		media_started_.store(false);
+	}
+	pause_cond_.notify_all();
 	if (media_thread_.joinable())
 		media_thread_.join();
 	if (audio_in_frame)
@@ -202,6 +206,9 @@ void MediaControler::MediaThreadImpl()
 		int64_t curTime = os_gettime_ns();
 		if((start_pts_ + minTime) > curTime)
 			std::this_thread::sleep_for(std::chrono::nanoseconds( (start_pts_ + minTime) - curTime));
+
+		// 放在一轮解码之后，暂停前已经解出下一帧，恢复时可以马上显示
+		WaitWhilePaused();
 	}
 
 end:
@@ -209,6 +216,53 @@ end:
 		media_stopped_cb_();
 }
 
+void MediaControler::Pause()
+{
+	std::unique_lock<std::mutex> lock(pause_mutex_);
+	paused_ = true;
+}
+
+void MediaControler::Resume()
+{
+	{
+		std::unique_lock<std::mutex> lock(pause_mutex_);
+		paused_ = false;
+	}
+	pause_cond_.notify_all();
+}
+
+void MediaControler::RefreshFrame()
+{
+	{
+		std::unique_lock<std::mutex> lock(pause_mutex_);
+		refresh_frame_ = true;
+	}
+	pause_cond_.notify_all();
+}
+
+void MediaControler::WaitWhilePaused()
+{
+	// 在一轮解码结束后调用，这时 scale_pic 里是最新一帧且没有在写
+	std::unique_lock<std::mutex> lock(pause_mutex_);
+	uint64_t pause_ns = 0;
+	while (1)
+	{
+		if (refresh_frame_)
+		{
+			refresh_frame_ = false;
+			if (has_frame_)
+				frame_ready_.store(true);
+		}
+		if (!paused_ || !media_started_.load())
+			break;
+		if (!pause_ns)
+			pause_ns = os_gettime_ns();
+		pause_cond_.wait(lock);
+	}
+	if (pause_ns)
+		start_pts_ += (int64_t)(os_gettime_ns() - pause_ns);
+}
+
 void MediaControler::CalcAudioFramePts()
 {
 	int64_t last_pts = audio_time_.frame_pts;
@@ -507,6 +561,7 @@ bool MediaControler::DecodeNext(bool& get_frame)
 			if (!ScaleVideoFrame())
 				return false;
 
+			has_frame_ = true;
 			frame_ready_.store(true);
 		}
 
@@ -5,6 +5,8 @@
 #include <string>
 #include <atomic>
 #include <functional>
+#include <mutex>
+#include <condition_variable>
 #include "circlebuf.h"
 #include "wasapi-audio-monitor.h"
 
@@ -37,6 +39,11 @@ public:
 	void GetFrameData(uint8_t** pic, int* lineSize, int& width, int& height);
 	void RenderFrameFinish();
 	void RenderAudio();
+	// 暂停后解码线程停在两帧之间，暂停的时间不计入播放进度；可以在 StartMedia 之前调用，这时解出第一帧后就停住
+	void Pause();
+	void Resume();
+	// 把最后一帧重新标记为可取，纹理被释放后用来马上恢复画面；在解码线程里处理，不和解码抢 scale_pic
+	void RefreshFrame();
 
 private:
 	void MediaThreadImpl();
@@ -52,6 +59,7 @@ private:
 	void CalcFramePts();
 	void CalcAudioFramePts();
 	int64_t GetEstimatedDuration(int64_t last_pts,bool bAudio);
+	void WaitWhilePaused();
 
 private:
 
@@ -78,7 +86,14 @@ private:
 	SwsContext* swscale_context_ = nullptr;
 	int scale_linesizes[4] = { 0 };
 	uint8_t* scale_pic[4] = { nullptr };
-	int64_t start_pts_ = 0;
+	std::atomic<int64_t> start_pts_{ 0 };
+
+	std::mutex pause_mutex_;
+	std::condition_variable pause_cond_;
+	bool paused_ = false;
+	bool refresh_frame_ = false;
+	// 只在解码线程访问，scale_pic 里有转换好的帧
+	bool has_frame_ = false;
 
 	FrameTimestamp video_time_;
 	FrameTimestamp audio_time_;
@@ -19,32 +19,54 @@ bool MediaSourceLogic::Init()
 	return true;
 }
 
-bool MediaSourceLogic::Update(const char* jsondata)
+bool MediaSourceLogic::Update(const CoreProperty::PropertyBag& props)
 {
+	std::unique_lock<std::mutex> lock(media_mutex_);
 	if (media_controler_)
 		return true;
 
-	try
+	std::string path;
+	if (props.GetString(CoreProperty::PropertyId::kPath, path))
 	{
-		auto json = nlohmann::json::parse(jsondata);
-		if (!json.is_object())
-			return false;
-		if (json.find("path") != json.end())
-		{
-			std::string path = json.at("path");
-			media_controler_.reset(new MediaControler(std::bind(&MediaSourceLogic::MediaStopped, this)));
-			media_controler_->StartMedia(std::wstring(path.begin(), path.end()).c_str());
-			return true;
-		}
-	}
-	catch (...)
-	{
-
+		media_controler_.reset(new MediaControler(std::bind(&MediaSourceLogic::MediaStopped, this)));
+		// 预加载的场景还不可见，解出第一帧后就停住
+		if (!IsShowing())
+			media_controler_->Pause();
+		media_controler_->StartMedia(std::wstring(path.begin(), path.end()).c_str());
+		return true;
 	}
 
 	return false;
 }
 
+void MediaSourceLogic::OnActivate()
+{
+	// 纹理在反激活时释放了，让解码线程把最后一帧重新交出来
+	std::unique_lock<std::mutex> lock(media_mutex_);
+	if (media_controler_ && !m_pTexture)
+		media_controler_->RefreshFrame();
+}
+
+void MediaSourceLogic::OnDeactivate()
+{
+	m_pResourceView.Reset();
+	m_pTexture.Reset();
+}
+
+void MediaSourceLogic::OnShow()
+{
+	std::unique_lock<std::mutex> lock(media_mutex_);
+	if (media_controler_)
+		media_controler_->Resume();
+}
+
+void MediaSourceLogic::OnHide()
+{
+	std::unique_lock<std::mutex> lock(media_mutex_);
+	if (media_controler_)
+		media_controler_->Pause();
+}
+
 void MediaSourceLogic::MediaStopped()
 {
 
@@ -56,57 +78,56 @@ void MediaSourceLogic::UpdateTextureSize()
 	source_texture_size_.height = texture_height_;
 }
 
-bool MediaSourceLogic::Tick()
+bool MediaSourceLogic::TickBegin()
 {
-	CoreD3D* d3d = core_engine_->GetD3D();
+	if (!media_controler_ || !media_controler_->GetFrameReady())
+		return false;
 
-	if (media_controler_ && media_controler_->GetFrameReady())
+	CoreD3D* d3d = core_engine_->GetD3D();
+	int lineSize[4] = { 0 };
+	uint8_t* picData[4] = { 0 };
+	int width = 0;
+	int height = 0;
+	media_controler_->GetFrameData(picData, lineSize, width, height);
+	if (!m_pTexture)
 	{
-		int lineSize[4] = { 0 };
-		uint8_t* picData[4] = { 0 };
-		int width = 0;
-		int height = 0;
-		media_controler_->GetFrameData(picData, lineSize, width, height);
-		if (!m_pTexture)
-		{
-			d3d->CreateD3DTexture(m_pTexture.GetAddressOf(), false, false, width, height, false);
-		}
-		if (!m_pResourceView)
-		{
-			d3d->CreateShaderResourceView(m_pTexture.Get(), m_pResourceView.GetAddressOf());
-		}
-		texture_width_ = width;
-		texture_height_ = height;
-		uint8_t* ptr;
-		uint32_t linesize_out;
-		size_t row_copy;
-
-		D3D11_MAPPED_SUBRESOURCE map;
-
-		d3d->Map(m_pTexture.Get(), 0, D3D11_MAP_WRITE_DISCARD, 0, &map);
-
-		ptr = (uint8_t*)map.pData;
-		linesize_out = map.RowPitch;
-		uint32_t linesize = lineSize[0];
-		uint8_t* data = picData[0];
-		row_copy = (linesize < linesize_out) ? linesize : linesize_out;
-		if (linesize == linesize_out)
-		{
-			memcpy(ptr, data, row_copy * height);
-		}
-		else
-		{
-			uint8_t* const end = ptr + height * linesize_out;
-			while (ptr < end) {
-				memcpy(ptr, data, row_copy);
-				ptr += linesize_out;
-				data += linesize;
-			}
-		}
-		d3d->UnMap(m_pTexture.Get(), 0);
-
-		media_controler_->RenderFrameFinish();
+		d3d->CreateD3DTexture(m_pTexture.GetAddressOf(), false, false, width, height, false);
 	}
+	if (!m_pResourceView)
+	{
+		d3d->CreateShaderResourceView(m_pTexture.Get(), m_pResourceView.GetAddressOf());
+	}
+	texture_width_ = width;
+	texture_height_ = height;
+
+	D3D11_MAPPED_SUBRESOURCE map = {};
+	d3d->Map(m_pTexture.Get(), 0, D3D11_MAP_WRITE_DISCARD, 0, &map);
+	if (!map.pData)
+		return false;
+
+	// 帧数据在 RenderFrameFinish 之前不会被解码线程改写
+	mapped_data_ = (uint8_t*)map.pData;
+	mapped_pitch_ = map.RowPitch;
+	frame_data_ = picData[0];
+	frame_pitch_ = lineSize[0];
+	return true;
+}
+
+void MediaSourceLogic::TickPrepare()
+{
+	CopyToMapped(mapped_data_, mapped_pitch_, frame_data_, frame_pitch_, texture_height_);
+}
+
+bool MediaSourceLogic::Tick()
+{
+	if (!mapped_data_)
+		return true;
+
+	CoreD3D* d3d = core_engine_->GetD3D();
+	d3d->UnMap(m_pTexture.Get(), 0);
+	mapped_data_ = nullptr;
+	frame_data_ = nullptr;
+	media_controler_->RenderFrameFinish();
 	return true;
 }
 
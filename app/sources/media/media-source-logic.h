@@ -4,6 +4,7 @@
 #include "base-source-i.h"
 #include "media-controler.h"
 #include <memory>
+#include <mutex>
 
 class MediaSourceLogic : public IBaseSource
 {
@@ -13,11 +14,19 @@ public:
 
 	virtual bool Init();
 	virtual bool Render();
+	// 打开失败、预加载、停用释放纹理后到解码出下一帧之前都没有画面
+	virtual bool IsOpaque() { return m_pTexture != nullptr; }
 
 protected:
-	virtual bool Update(const char* jsondata);
+	virtual bool Update(const CoreProperty::PropertyBag& props);
+	virtual bool TickBegin();
+	virtual void TickPrepare();
 	virtual bool Tick();
 	virtual void UpdateTextureSize();
+	virtual void OnActivate();
+	virtual void OnDeactivate();
+	virtual void OnShow();
+	virtual void OnHide();
 
 private:
 	void MediaStopped();
@@ -25,9 +34,16 @@ private:
 private:
 	ComPtr< ID3D11Texture2D> m_pTexture;
 	ComPtr<ID3D11ShaderResourceView> m_pResourceView;
+	// 保护 media_controler_ 的创建，Update 不在渲染线程
+	std::mutex media_mutex_;
 	std::unique_ptr<MediaControler> media_controler_;
 	int texture_width_ = 0;
 	int texture_height_ = 0;
+	// TickBegin 里 Map 的纹理和这一帧的数据，TickPrepare 在工作线程里拷贝
+	uint8_t* mapped_data_ = nullptr;
+	uint32_t mapped_pitch_ = 0;
+	const uint8_t* frame_data_ = nullptr;
+	uint32_t frame_pitch_ = 0;
 
 };
 
@@ -43,7 +43,7 @@ bool ObjModelSource::Render()
 	d3d->OMSetRenderTargets(1, render_targetview_.GetAddressOf(), depth_stencil_view_.Get());
 	d3d->PushFrontViewPort((float)source_texture_size_.width, (float)source_texture_size_.height);
 
-	if (obj_render_mgr_)
+	if (obj_render_mgr_ && obj_render_mgr_->IsRenderResourceReady())
 		obj_render_mgr_->ForeachDrawFaces();
 	
 	d3d->PopFrontViewPort();
@@ -64,35 +64,35 @@ bool ObjModelSource::Render()
 	return true;
 }
 
-bool ObjModelSource::Update(const char* jsondata)
+bool ObjModelSource::Update(const CoreProperty::PropertyBag& props)
 {
-	if (obj_render_mgr_)
+	// 模型只加载一次，后续的 path 更新忽略
+	if (!model_path_.empty())
 		return true;
 
-	obj_render_mgr_ = new ObjRenderMgr();
-	obj_render_mgr_->SetCoreEngine(core_engine_);
+	return props.GetString(CoreProperty::PropertyId::kPath, model_path_);
+}
 
-	try
-	{
-		auto json = nlohmann::json::parse(jsondata);
-		if (!json.is_object())
-			return false;
-		if (json.find("path") != json.end())
-		{
-			std::string path = json.at("path");
-			return obj_render_mgr_->InitObjResourceFolder(path.c_str());
-		}
-	}
-	catch (...)
-	{
+bool ObjModelSource::Load()
+{
+	if (obj_render_mgr_ || model_path_.empty())
+		return true;
 
+	ObjRenderMgr* mgr = new ObjRenderMgr();
+	mgr->SetCoreEngine(core_engine_);
+	if (!mgr->LoadObjResource(model_path_.c_str()))
+	{
+		delete mgr;
+		return false;
 	}
-
-	return false;
+	obj_render_mgr_ = mgr;
+	return true;
 }
 
 bool ObjModelSource::Tick()
 {
+	if (obj_render_mgr_ && !obj_render_mgr_->IsRenderResourceReady())
+		return obj_render_mgr_->InitRenderResource();
 	return true;
 }
 
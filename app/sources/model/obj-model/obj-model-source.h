@@ -14,13 +14,15 @@ public:
 	virtual bool Render();
 
 protected:
-	virtual bool Update(const char* jsondata);
+	virtual bool Update(const CoreProperty::PropertyBag& props);
+	virtual bool Load();
 	virtual bool Tick();
 	virtual void UpdateTextureSize();
 	bool InitRenderTexture();
 
 private:
 	ObjRenderMgr* obj_render_mgr_ = nullptr;
+	std::string model_path_;
 
 	ComPtr< ID3D11Texture2D> render_texture_;
 	ComPtr<ID3D11ShaderResourceView> render_shaderresource_;
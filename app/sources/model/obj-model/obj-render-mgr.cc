@@ -18,22 +18,39 @@ ObjRenderMgr::~ObjRenderMgr()
 }
 
 bool ObjRenderMgr::InitObjResourceFolder(const char* path)
+{
+	if (!LoadObjResource(path))
+		return false;
+
+	return InitRenderResource();
+}
+
+bool ObjRenderMgr::LoadObjResource(const char* path)
 {
 	if (obj_res_mgr_)
 		return true;
 
 	obj_res_mgr_ = new ObjResourceMgr();
 
-	if (!obj_res_mgr_->Init(path))
+	return obj_res_mgr_->Init(path);
+}
+
+bool ObjRenderMgr::InitRenderResource()
+{
+	if (render_resource_ready_)
+		return true;
+
+	if (!obj_res_mgr_ || !obj_res_mgr_->diffuse_bitmap_)
 		return false;
-	
+
 	if (!InitDiffuseTexture())
 		return false;
 
 	if (!InitVSConstantBuffer())
 		return false;
 
-	return InitObjVertext();
+	render_resource_ready_ = InitObjVertext();
+	return render_resource_ready_;
 }
 
 bool ObjRenderMgr::InitDiffuseTexture()
@@ -24,6 +24,11 @@ public:
 
 	void SetCoreEngine(CoreEngine* engine) { core_engine_ = engine; }
 	bool InitObjResourceFolder(const char* path);
+	// 解析 obj 和纹理文件，不涉及 D3D，可以在加载线程里调用
+	bool LoadObjResource(const char* path);
+	// 创建顶点、纹理和常量缓冲，必须在渲染线程调用
+	bool InitRenderResource();
+	bool IsRenderResourceReady() { return render_resource_ready_; }
 	void ForeachDrawFaces();
 
 private:
@@ -34,6 +39,7 @@ private:
 private:
 	CoreEngine* core_engine_ = nullptr;
 	ObjResourceMgr* obj_res_mgr_ = nullptr;
+	bool render_resource_ready_ = false;
 
 	ComPtr<ID3D11Buffer> vertex_buffer_;
 	ComPtr<ID3D11Buffer>  index_buffer_;
@@ -0,0 +1,269 @@
+#include "test-pattern-generator.h"
+#include <string.h>
+
+namespace
+{
+	inline uint64_t SplitMix64(uint64_t x)
+	{
+		x += 0x9E3779B97F4A7C15ULL;
+		x = (x ^ (x >> 30)) * 0xBF58476D1CE4E5B9ULL;
+		x = (x ^ (x >> 27)) * 0x94D049BB133111EBULL;
+		return x ^ (x >> 31);
+	}
+
+	struct XorShift64
+	{
+		uint64_t state;
+		explicit XorShift64(uint64_t seed) : state(SplitMix64(seed) | 1) {}
+		uint64_t Next()
+		{
+			state ^= state << 13;
+			state ^= state >> 7;
+			state ^= state << 17;
+			return state;
+		}
+	};
+
+	inline void FillRow(uint8_t* row, int width, uint32_t bgra)
+	{
+		uint32_t* p = (uint32_t*)row;
+		for (int x = 0; x < width; x++)
+			p[x] = bgra;
+	}
+
+	// 5x7 点阵，每行低 5 位有效，高位在左
+	struct Glyph
+	{
+		char c;
+		uint8_t rows[7];
+	};
+
+	const Glyph kGlyphs[] = {
+		{ '0', { 0x0E, 0x11, 0x13, 0x15, 0x19, 0x11, 0x0E } },
+		{ '1', { 0x04, 0x0C, 0x04, 0x04, 0x04, 0x04, 0x0E } },
+		{ '2', { 0x0E, 0x11, 0x01, 0x02, 0x04, 0x08, 0x1F } },
+		{ '3', { 0x1F, 0x02, 0x04, 0x02, 0x01, 0x11, 0x0E } },
+		{ '4', { 0x02, 0x06, 0x0A, 0x12, 0x1F, 0x02, 0x02 } },
+		{ '5', { 0x1F, 0x10, 0x1E, 0x01, 0x01, 0x11, 0x0E } },
+		{ '6', { 0x06, 0x08, 0x10, 0x1E, 0x11, 0x11, 0x0E } },
+		{ '7', { 0x1F, 0x01, 0x02, 0x04, 0x08, 0x08, 0x08 } },
+		{ '8', { 0x0E, 0x11, 0x11, 0x0E, 0x11, 0x11, 0x0E } },
+		{ '9', { 0x0E, 0x11, 0x11, 0x0F, 0x01, 0x02, 0x0C } },
+		{ 'A', { 0x0E, 0x11, 0x11, 0x1F, 0x11, 0x11, 0x11 } },
+		{ 'B', { 0x1E, 0x11, 0x11, 0x1E, 0x11, 0x11, 0x1E } },
+		{ 'C', { 0x0E, 0x11, 0x10, 0x10, 0x10, 0x11, 0x0E } },
+		{ 'D', { 0x1C, 0x12, 0x11, 0x11, 0x11, 0x12, 0x1C } },
+		{ 'E', { 0x1F, 0x10, 0x10, 0x1E, 0x10, 0x10, 0x1F } },
+		{ 'F', { 0x1F, 0x10, 0x10, 0x1E, 0x10, 0x10, 0x10 } },
+		{ 'G', { 0x0E, 0x11, 0x10, 0x17, 0x11, 0x11, 0x0F } },
+		{ 'H', { 0x11, 0x11, 0x11, 0x1F, 0x11, 0x11, 0x11 } },
+		{ 'I', { 0x0E, 0x04, 0x04, 0x04, 0x04, 0x04, 0x0E } },
+		{ 'J', { 0x07, 0x02, 0x02, 0x02, 0x02, 0x12, 0x0C } },
+		{ 'K', { 0x11, 0x12, 0x14, 0x18, 0x14, 0x12, 0x11 } },
+		{ 'L', { 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x1F } },
+		{ 'M', { 0x11, 0x1B, 0x15, 0x15, 0x11, 0x11, 0x11 } },
+		{ 'N', { 0x11, 0x11, 0x19, 0x15, 0x13, 0x11, 0x11 } },
+		{ 'O', { 0x0E, 0x11, 0x11, 0x11, 0x11, 0x11, 0x0E } },
+		{ 'P', { 0x1E, 0x11, 0x11, 0x1E, 0x10, 0x10, 0x10 } },
+		{ 'Q', { 0x0E, 0x11, 0x11, 0x11, 0x15, 0x12, 0x0D } },
+		{ 'R', { 0x1E, 0x11, 0x11, 0x1E, 0x14, 0x12, 0x11 } },
+		{ 'S', { 0x0F, 0x10, 0x10, 0x0E, 0x01, 0x01, 0x1E } },
+		{ 'T', { 0x1F, 0x04, 0x04, 0x04, 0x04, 0x04, 0x04 } },
+		{ 'U', { 0x11, 0x11, 0x11, 0x11, 0x11, 0x11, 0x0E } },
+		{ 'V', { 0x11, 0x11, 0x11, 0x11, 0x11, 0x0A, 0x04 } },
+		{ 'W', { 0x11, 0x11, 0x11, 0x15, 0x15, 0x15, 0x0A } },
+		{ 'X', { 0x11, 0x11, 0x0A, 0x04, 0x0A, 0x11, 0x11 } },
+		{ 'Y', { 0x11, 0x11, 0x11, 0x0A, 0x04, 0x04, 0x04 } },
+		{ 'Z', { 0x1F, 0x01, 0x02, 0x04, 0x08, 0x10, 0x1F } },
+		{ ':', { 0x00, 0x0C, 0x0C, 0x00, 0x0C, 0x0C, 0x00 } },
+		{ '-', { 0x00, 0x00, 0x00, 0x1F, 0x00, 0x00, 0x00 } },
+		{ '.', { 0x00, 0x00, 0x00, 0x00, 0x00, 0x0C, 0x0C } },
+	};
+
+	const uint8_t* FindGlyph(char c)
+	{
+		if (c >= 'a' && c <= 'z')
+			c = c - 'a' + 'A';
+		for (const Glyph& g : kGlyphs)
+		{
+			if (g.c == c)
+				return g.rows;
+		}
+		return nullptr;
+	}
+}
+
+bool TestPatternGenerator::ParsePatternType(const std::string& name, PatternType& type)
+{
+	if (name == "bars")
+		type = PatternType::kColorBars;
+	else if (name == "gradient")
+		type = PatternType::kMovingGradient;
+	else if (name == "noise")
+		type = PatternType::kScrollingNoise;
+	else if (name == "text")
+		type = PatternType::kAnimatedText;
+	else
+		return false;
+	return true;
+}
+
+void TestPatternGenerator::SetParams(const Params& params)
+{
+	params_ = params;
+	if (params_.width < 16)
+		params_.width = 16;
+	if (params_.height < 16)
+		params_.height = 16;
+	if (params_.entropy < 0)
+		params_.entropy = 0;
+	if (params_.entropy > 100)
+		params_.entropy = 100;
+}
+
+void TestPatternGenerator::Generate(uint64_t frame_index, uint8_t* bgra, int linesize) const
+{
+	switch (params_.type)
+	{
+	case PatternType::kColorBars:
+		DrawColorBars(bgra, linesize);
+		break;
+	case PatternType::kMovingGradient:
+		DrawMovingGradient(frame_index, bgra, linesize);
+		break;
+	case PatternType::kScrollingNoise:
+		DrawScrollingNoise(frame_index, bgra, linesize);
+		break;
+	case PatternType::kAnimatedText:
+		DrawAnimatedText(frame_index, bgra, linesize);
+		break;
+	}
+
+	if (params_.entropy > 0)
+		DrawEntropyBlocks(frame_index, bgra, linesize);
+}
+
+void TestPatternGenerator::DrawColorBars(uint8_t* bgra, int linesize) const
+{
+	// 75% SMPTE: 白 黄 青 绿 品 红 蓝
+	static const uint32_t kBars[7] = {
+		0xFFBFBFBF, 0xFF00BFBF, 0xFFBFBF00, 0xFF00BF00, 0xFFBF00BF, 0xFF0000BF, 0xFFBF0000,
+	};
+	const int width = params_.width;
+	uint32_t* first = (uint32_t*)bgra;
+	for (int x = 0; x < width; x++)
+		first[x] = kBars[x * 7 / width];
+	for (int y = 1; y < params_.height; y++)
+		memcpy(bgra + (size_t)y * linesize, bgra, (size_t)width * 4);
+}
+
+void TestPatternGenerator::DrawMovingGradient(uint64_t frame_index, uint8_t* bgra, int linesize) const
+{
+	const uint32_t shift = (uint32_t)(frame_index & 0xFFFF);
+	for (int y = 0; y < params_.height; y++)
+	{
+		uint8_t* p = bgra + (size_t)y * linesize;
+		for (int x = 0; x < params_.width; x++)
+		{
+			p[0] = (uint8_t)((x + y + shift * 3) >> 1);
+			p[1] = (uint8_t)(y + shift);
+			p[2] = (uint8_t)(x + shift * 2);
+			p[3] = 0xFF;
+			p += 4;
+		}
+	}
+}
+
+void TestPatternGenerator::DrawScrollingNoise(uint64_t frame_index, uint8_t* bgra, int linesize) const
+{
+	// 每一行的噪声只由 seed 和 "逻辑行号" 决定，整体每帧向上滚动 2 行
+	for (int y = 0; y < params_.height; y++)
+	{
+		XorShift64 rng(params_.seed ^ ((uint64_t)y + frame_index * 2) * 0xD1B54A32D192ED03ULL);
+		uint32_t* p = (uint32_t*)(bgra + (size_t)y * linesize);
+		int x = 0;
+		for (; x + 1 < params_.width; x += 2)
+		{
+			uint64_t v = rng.Next();
+			p[x] = (uint32_t)v | 0xFF000000;
+			p[x + 1] = (uint32_t)(v >> 32) | 0xFF000000;
+		}
+		if (x < params_.width)
+			p[x] = (uint32_t)rng.Next() | 0xFF000000;
+	}
+}
+
+void TestPatternGenerator::DrawAnimatedText(uint64_t frame_index, uint8_t* bgra, int linesize) const
+{
+	for (int y = 0; y < params_.height; y++)
+		FillRow(bgra + (size_t)y * linesize, params_.width, 0xFF202020);
+
+	std::string text = params_.text + " " + std::to_string(frame_index);
+	int scale = params_.height / 60;
+	if (scale < 1)
+		scale = 1;
+	const int glyph_w = 6 * scale;
+	const int glyph_h = 7 * scale;
+	const int text_w = glyph_w * (int)text.size();
+
+	// 文字在画面内来回弹跳，位置完全由帧号决定
+	int range_x = params_.width - text_w;
+	int range_y = params_.height - glyph_h;
+	if (range_x < 1)
+		range_x = 1;
+	if (range_y < 1)
+		range_y = 1;
+	uint64_t tx = (frame_index * 3) % (uint64_t)(range_x * 2);
+	uint64_t ty = (frame_index * 2) % (uint64_t)(range_y * 2);
+	int origin_x = (int)(tx < (uint64_t)range_x ? tx : range_x * 2 - tx);
+	int origin_y = (int)(ty < (uint64_t)range_y ? ty : range_y * 2 - ty);
+
+	for (size_t i = 0; i < text.size(); i++)
+	{
+		const uint8_t* rows = FindGlyph(text[i]);
+		if (!rows)
+			continue;
+		int gx = origin_x + (int)i * glyph_w;
+		for (int gy = 0; gy < glyph_h; gy++)
+		{
+			int py = origin_y + gy;
+			if (py < 0 || py >= params_.height)
+				continue;
+			uint8_t bits = rows[gy / scale];
+			uint32_t* p = (uint32_t*)(bgra + (size_t)py * linesize);
+			for (int col = 0; col < 5 * scale; col++)
+			{
+				int px = gx + col;
+				if (px < 0 || px >= params_.width)
+					continue;
+				if (bits & (0x10 >> (col / scale)))
+					p[px] = 0xFFFFFFFF;
+			}
+		}
+	}
+}
+
+void TestPatternGenerator::DrawEntropyBlocks(uint64_t frame_index, uint8_t* bgra, int linesize) const
+{
+	const int block = 16;
+	const int blocks_x = (params_.width + block - 1) / block;
+	const int blocks_y = (params_.height + block - 1) / block;
+	XorShift64 pick(params_.seed ^ (frame_index * 0x9E3779B97F4A7C15ULL));
+	for (int by = 0; by < blocks_y; by++)
+	{
+		for (int bx = 0; bx < blocks_x; bx++)
+		{
+			if ((int)(pick.Next() % 100) >= params_.entropy)
+				continue;
+			XorShift64 rng(pick.Next());
+			int y_end = (by + 1) * block < params_.height ? (by + 1) * block : params_.height;
+			int x_end = (bx + 1) * block < params_.width ? (bx + 1) * block : params_.width;
+			for (int y = by * block; y < y_end; y++)
+			{
+				uint32_t* p = (uint32_t*)(bgra + (size_t)y * linesize);
+				for (int x = bx * block; x < x_end; x++)
+					p[x] = (uint32_t)rng.Next() | 0xFF000000;
+			}
+		}
+	}
+}
@@ -0,0 +1,52 @@
+#ifndef TEST_PATTERN_GENERATOR_H
+#define TEST_PATTERN_GENERATOR_H
+
+/* 可复现的测试图案生成器
+* 同样的 seed + frame index 一定得到逐字节相同的 BGRA 画面，方便压测对比
+* 不依赖 d3d，source 和 benchmark 都直接用它
+*/
+
+#include <stdint.h>
+#include <string>
+
+class TestPatternGenerator
+{
+public:
+	enum class PatternType
+	{
+		kColorBars,
+		kMovingGradient,
+		kScrollingNoise,
+		kAnimatedText,
+	};
+
+	struct Params
+	{
+		PatternType type = PatternType::kColorBars;
+		int width = 1280;
+		int height = 720;
+		// 0 - 100，每帧被随机噪声覆盖的 16x16 块比例，用来控制编码负载
+		int entropy = 0;
+		uint64_t seed = 0;
+		std::string text = "FRAME";
+	};
+
+	static bool ParsePatternType(const std::string& name, PatternType& type);
+
+	void SetParams(const Params& params);
+	const Params& GetParams() const { return params_; }
+
+	void Generate(uint64_t frame_index, uint8_t* bgra, int linesize) const;
+
+private:
+	void DrawColorBars(uint8_t* bgra, int linesize) const;
+	void DrawMovingGradient(uint64_t frame_index, uint8_t* bgra, int linesize) const;
+	void DrawScrollingNoise(uint64_t frame_index, uint8_t* bgra, int linesize) const;
+	void DrawAnimatedText(uint64_t frame_index, uint8_t* bgra, int linesize) const;
+	void DrawEntropyBlocks(uint64_t frame_index, uint8_t* bgra, int linesize) const;
+
+private:
+	Params params_;
+};
+
+#endif
@@ -0,0 +1,123 @@
+#include "test-pattern-source.h"
+#include "core-engine.h"
+#include "core-d3d.h"
+#include "json.hpp"
+#include "logger.h"
+#include "platform.h"
+
+TestPatternSource::TestPatternSource()
+{
+
+}
+
+TestPatternSource::~TestPatternSource()
+{
+
+}
+
+bool TestPatternSource::Init()
+{
+	return true;
+}
+
+bool TestPatternSource::Update(const CoreProperty::PropertyBag& props)
+{
+	using CoreProperty::PropertyId;
+
+	TestPatternGenerator::Params params = generator_.GetParams();
+	std::string pattern;
+	if (props.GetString(PropertyId::kPattern, pattern))
+	{
+		if (!TestPatternGenerator::ParsePatternType(pattern, params.type))
+			LOGGER_ERROR("[TestPattern] unknown pattern:%s", pattern.c_str());
+	}
+	props.GetInt(PropertyId::kPatternWidth, params.width);
+	props.GetInt(PropertyId::kPatternHeight, params.height);
+	props.GetInt(PropertyId::kEntropy, params.entropy);
+	int64_t seed = 0;
+	if (props.GetInt(PropertyId::kSeed, seed))
+		params.seed = (uint64_t)seed;
+	props.GetString(PropertyId::kText, params.text);
+	int32_t fps = 0;
+	if (props.GetInt(PropertyId::kFps, fps))
+		fps_ = fps > 0 ? (uint32_t)fps : 30;
+
+	generator_.SetParams(params);
+	params_changed_ = true;
+	return true;
+}
+
+bool TestPatternSource::TickBegin()
+{
+	const TestPatternGenerator::Params& params = generator_.GetParams();
+	CoreD3D* d3d = core_engine_->GetD3D();
+
+	if (params_changed_)
+	{
+		if (texture_width_ != params.width || texture_height_ != params.height)
+		{
+			m_pResourceView.Reset();
+			m_pTexture.Reset();
+		}
+		if (!m_pTexture)
+		{
+			d3d->CreateD3DTexture(m_pTexture.GetAddressOf(), false, false, params.width, params.height, false);
+			d3d->CreateShaderResourceView(m_pTexture.Get(), m_pResourceView.GetAddressOf());
+		}
+		texture_width_ = params.width;
+		texture_height_ = params.height;
+		start_ns_ = os_gettime_ns();
+		last_frame_index_ = UINT64_MAX;
+		params_changed_ = false;
+	}
+
+	uint64_t frame_index = util_mul_div64(os_gettime_ns() - start_ns_, fps_, 1000000000ULL);
+	if (frame_index == last_frame_index_)
+		return false;
+
+	D3D11_MAPPED_SUBRESOURCE map = {};
+	d3d->Map(m_pTexture.Get(), 0, D3D11_MAP_WRITE_DISCARD, 0, &map);
+	if (!map.pData)
+		return false;
+	last_frame_index_ = frame_index;
+	mapped_data_ = (uint8_t*)map.pData;
+	mapped_pitch_ = map.RowPitch;
+	return true;
+}
+
+void TestPatternSource::TickPrepare()
+{
+	generator_.Generate(last_frame_index_, mapped_data_, (int)mapped_pitch_);
+}
+
+bool TestPatternSource::Tick()
+{
+	if (!mapped_data_)
+		return true;
+
+	CoreD3D* d3d = core_engine_->GetD3D();
+	d3d->UnMap(m_pTexture.Get(), 0);
+	mapped_data_ = nullptr;
+	return true;
+}
+
+bool TestPatternSource::Render()
+{
+	if (m_pTexture)
+	{
+		CoreD3D* d3d = core_engine_->GetD3D();
+		d3d->UpdateVertexShader(CoreD3DData::VertexHlslType::kBasic2D);
+		d3d->UpdatePixelShader(CoreD3DData::PixelHlslType::kBasic2D);
+		d3d->PSSetShaderResources(0, 1, m_pResourceView.GetAddressOf());
+		Draw2DSource();
+		return true;
+	}
+
+	return false;
+}
+
+void TestPatternSource::UpdateTextureSize()
+{
+	source_texture_size_.width = texture_width_;
+	source_texture_size_.height = texture_height_;
+}
@@ -0,0 +1,45 @@
+#ifndef TEST_PATTERN_SOURCE_H
+#define TEST_PATTERN_SOURCE_H
+
+/* 合成测试图案源，用于压测
+* param: pattern(bars/gradient/noise/text) patternWidth patternHeight fps entropy seed text
+* 帧号由 fps 和启动后的时间决定，画面只和 seed + 帧号有关
+*/
+
+#include "base-source-i.h"
+#include "test-pattern-generator.h"
+
+class TestPatternSource : public IBaseSource
+{
+public:
+	TestPatternSource();
+	virtual ~TestPatternSource();
+
+	virtual bool Init();
+	virtual bool Render();
+	// 第一帧生成之前没有纹理
+	virtual bool IsOpaque() { return m_pTexture != nullptr; }
+
+protected:
+	virtual bool Update(const CoreProperty::PropertyBag& props);
+	virtual bool TickBegin();
+	virtual void TickPrepare();
+	virtual bool Tick();
+	virtual void UpdateTextureSize();
+
+private:
+	ComPtr<ID3D11Texture2D> m_pTexture;
+	ComPtr<ID3D11ShaderResourceView> m_pResourceView;
+	TestPatternGenerator generator_;
+	bool params_changed_ = true;
+	uint32_t fps_ = 30;
+	uint64_t start_ns_ = 0;
+	uint64_t last_frame_index_ = UINT64_MAX;
+	int texture_width_ = 0;
+	int texture_height_ = 0;
+	// TickBegin 里 Map 的纹理，TickPrepare 在工作线程里生成图案
+	uint8_t* mapped_data_ = nullptr;
+	uint32_t mapped_pitch_ = 0;
+};
+
+#endif
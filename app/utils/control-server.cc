@@ -0,0 +1,452 @@
+#include "control-server.h"
+
+#if defined(_WIN32)
+#include <Windows.h>
+#else
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/un.h>
+#include <poll.h>
+#include <unistd.h>
+#include <errno.h>
+#include <string.h>
+#endif
+
+namespace
+{
+	// 超过这个长度还没有换行就断开连接
+	const size_t kMaxLineSize = 16 * 1024 * 1024;
+
+#if defined(_WIN32)
+	const DWORD kPipeBufferSize = 64 * 1024;
+
+	// 空表示一直等
+	typedef HANDLE StopSignal;
+
+	std::wstring ToWide(const std::string& str)
+	{
+		int len = MultiByteToWideChar(CP_UTF8, 0, str.c_str(), (int)str.size(), nullptr, 0);
+		std::wstring wstr(len, L'\0');
+		if (len > 0)
+			MultiByteToWideChar(CP_UTF8, 0, str.c_str(), (int)str.size(), &wstr[0], len);
+		return wstr;
+	}
+
+	HANDLE CreatePipeInstance(const std::wstring& name, bool first)
+	{
+		DWORD open_mode = PIPE_ACCESS_DUPLEX | FILE_FLAG_OVERLAPPED;
+		// 第一个实例独占名字，防止和已经在运行的进程共用一个端点
+		if (first)
+			open_mode |= FILE_FLAG_FIRST_PIPE_INSTANCE;
+		return CreateNamedPipeW(name.c_str(), open_mode,
+			PIPE_TYPE_BYTE | PIPE_READMODE_BYTE | PIPE_WAIT | PIPE_REJECT_REMOTE_CLIENTS,
+			PIPE_UNLIMITED_INSTANCES, kPipeBufferSize, kPipeBufferSize, 0, nullptr);
+	}
+
+	// 等待重叠 IO 完成，stop 触发时取消
+	bool WaitOverlapped(HANDLE handle, OVERLAPPED* ov, StopSignal stop, DWORD* bytes)
+	{
+		HANDLE events[2] = { ov->hEvent, stop };
+		DWORD ret = WaitForMultipleObjects(stop ? 2 : 1, events, FALSE, INFINITE);
+		if (ret != WAIT_OBJECT_0)
+		{
+			CancelIo(handle);
+			GetOverlappedResult(handle, ov, bytes, TRUE);
+			return false;
+		}
+		return GetOverlappedResult(handle, ov, bytes, FALSE) != FALSE;
+	}
+
+	// 返回 0 表示断开或被停止
+	size_t ReadConnection(intptr_t handle, char* buffer, size_t size, StopSignal stop)
+	{
+		HANDLE pipe = (HANDLE)handle;
+		OVERLAPPED ov = {};
+		ov.hEvent = CreateEventW(nullptr, TRUE, FALSE, nullptr);
+		DWORD bytes = 0;
+		bool ok = ReadFile(pipe, buffer, (DWORD)size, nullptr, &ov) != FALSE;
+		if (ok)
+			ok = GetOverlappedResult(pipe, &ov, &bytes, FALSE) != FALSE;
+		else if (GetLastError() == ERROR_IO_PENDING)
+			ok = WaitOverlapped(pipe, &ov, stop, &bytes);
+		CloseHandle(ov.hEvent);
+		return ok ? bytes : 0;
+	}
+
+	bool WriteConnection(intptr_t handle, const char* data, size_t size, StopSignal stop)
+	{
+		HANDLE pipe = (HANDLE)handle;
+		OVERLAPPED ov = {};
+		ov.hEvent = CreateEventW(nullptr, TRUE, FALSE, nullptr);
+		bool ok = true;
+		while (ok && size > 0)
+		{
+			DWORD bytes = 0;
+			ResetEvent(ov.hEvent);
+			ok = WriteFile(pipe, data, (DWORD)size, nullptr, &ov) != FALSE;
+			if (ok)
+				ok = GetOverlappedResult(pipe, &ov, &bytes, FALSE) != FALSE;
+			else if (GetLastError() == ERROR_IO_PENDING)
+				ok = WaitOverlapped(pipe, &ov, stop, &bytes);
+			data += bytes;
+			size -= bytes;
+		}
+		CloseHandle(ov.hEvent);
+		return ok;
+	}
+
+	void CloseConnection(intptr_t handle)
+	{
+		CloseHandle((HANDLE)handle);
+	}
+#else
+	// 轮询间隔，决定 Stop 最多等多久
+	const int kPollMs = 100;
+
+	// 空表示一直等
+	typedef const std::atomic<bool>* StopSignal;
+
+	// 返回 false 表示被停止或出错
+	bool WaitReadable(int fd, StopSignal running)
+	{
+		while (true)
+		{
+			if (!running)
+				return true;
+			if (!running->load())
+				return false;
+			pollfd pfd = { fd, POLLIN, 0 };
+			int ret = poll(&pfd, 1, kPollMs);
+			if (ret > 0)
+				return true;
+			if (ret < 0 && errno != EINTR)
+				return false;
+		}
+	}
+
+	size_t ReadConnection(intptr_t handle, char* buffer, size_t size, StopSignal running)
+	{
+		int fd = (int)handle;
+		while (WaitReadable(fd, running))
+		{
+			ssize_t ret = recv(fd, buffer, size, 0);
+			if (ret < 0 && errno == EINTR)
+				continue;
+			return ret > 0 ? (size_t)ret : 0;
+		}
+		return 0;
+	}
+
+	bool WriteConnection(intptr_t handle, const char* data, size_t size, StopSignal)
+	{
+		int fd = (int)handle;
+		while (size > 0)
+		{
+			ssize_t ret = send(fd, data, size, MSG_NOSIGNAL);
+			if (ret < 0)
+			{
+				if (errno == EINTR)
+					continue;
+				return false;
+			}
+			data += ret;
+			size -= (size_t)ret;
+		}
+		return true;
+	}
+
+	void CloseConnection(intptr_t handle)
+	{
+		close((int)handle);
+	}
+
+	bool MakeAddress(const std::string& path, sockaddr_un& addr)
+	{
+		memset(&addr, 0, sizeof(addr));
+		addr.sun_family = AF_UNIX;
+		if (path.empty() || path.size() >= sizeof(addr.sun_path))
+			return false;
+		memcpy(addr.sun_path, path.c_str(), path.size());
+		return true;
+	}
+#endif
+}
+
+ControlServer::ControlServer()
+{
+}
+
+ControlServer::~ControlServer()
+{
+	Stop();
+}
+
+const char* ControlServer::DefaultEndpoint()
+{
+#if defined(_WIN32)
+	return "\\\\.\\pipe\\tinystudio-control";
+#else
+	return "/tmp/tinystudio-control.sock";
+#endif
+}
+
+bool ControlServer::Start(const char* endpoint, Handler handler)
+{
+	if (running_ || !endpoint || !handler)
+		return false;
+
+	endpoint_ = endpoint;
+	handler_ = handler;
+
+#if defined(_WIN32)
+	HANDLE pipe = CreatePipeInstance(ToWide(endpoint_), true);
+	if (pipe == INVALID_HANDLE_VALUE)
+		return false;
+	stop_event_ = CreateEventW(nullptr, TRUE, FALSE, nullptr);
+	listen_handle_ = (intptr_t)pipe;
+#else
+	sockaddr_un addr;
+	if (!MakeAddress(endpoint_, addr))
+		return false;
+	int fd = socket(AF_UNIX, SOCK_STREAM, 0);
+	if (fd < 0)
+		return false;
+	// 上次异常退出留下的套接字文件
+	unlink(endpoint_.c_str());
+	if (bind(fd, (sockaddr*)&addr, sizeof(addr)) != 0 || listen(fd, 8) != 0)
+	{
+		close(fd);
+		return false;
+	}
+	// 只允许当前用户连接
+	chmod(endpoint_.c_str(), S_IRUSR | S_IWUSR);
+	listen_handle_ = fd;
+#endif
+
+	running_ = true;
+	accept_thread_ = std::thread(&ControlServer::AcceptThreadImpl, this);
+	return true;
+}
+
+void ControlServer::Stop()
+{
+	if (!running_)
+		return;
+
+	running_ = false;
+#if defined(_WIN32)
+	SetEvent((HANDLE)stop_event_);
+#endif
+	if (accept_thread_.joinable())
+		accept_thread_.join();
+	ReapClients(true);
+
+#if defined(_WIN32)
+	CloseHandle((HANDLE)stop_event_);
+	stop_event_ = nullptr;
+#else
+	close((int)listen_handle_);
+	unlink(endpoint_.c_str());
+#endif
+	listen_handle_ = -1;
+}
+
+void ControlServer::AcceptThreadImpl()
+{
+#if defined(_WIN32)
+	std::wstring name = ToWide(endpoint_);
+	HANDLE pipe = (HANDLE)listen_handle_;
+	while (running_)
+	{
+		if (pipe == INVALID_HANDLE_VALUE)
+		{
+			pipe = CreatePipeInstance(name, false);
+			if (pipe == INVALID_HANDLE_VALUE)
+				break;
+		}
+
+		OVERLAPPED ov = {};
+		ov.hEvent = CreateEventW(nullptr, TRUE, FALSE, nullptr);
+		bool connected = ConnectNamedPipe(pipe, &ov) != FALSE;
+		if (!connected)
+		{
+			DWORD error = GetLastError();
+			if (error == ERROR_PIPE_CONNECTED)
+			{
+				connected = true;
+			}
+			else if (error == ERROR_IO_PENDING)
+			{
+				DWORD bytes = 0;
+				connected = WaitOverlapped(pipe, &ov, (HANDLE)stop_event_, &bytes);
+			}
+		}
+		CloseHandle(ov.hEvent);
+
+		if (!connected || !running_)
+		{
+			CloseHandle(pipe);
+			pipe = INVALID_HANDLE_VALUE;
+			continue;
+		}
+		AddClient((intptr_t)pipe);
+		pipe = INVALID_HANDLE_VALUE;
+	}
+	if (pipe != INVALID_HANDLE_VALUE)
+		CloseHandle(pipe);
+#else
+	int listen_fd = (int)listen_handle_;
+	while (WaitReadable(listen_fd, &running_))
+	{
+		int fd = accept(listen_fd, nullptr, nullptr);
+		if (fd < 0)
+			continue;
+		AddClient(fd);
+	}
+#endif
+}
+
+void ControlServer::AddClient(intptr_t handle)
+{
+	ReapClients(false);
+
+	std::unique_lock<std::mutex> lock(client_mutex_);
+	clients_.emplace_back(new Client());
+	Client* client = clients_.back().get();
+	client->thread = std::thread(&ControlServer::ClientThreadImpl, this, client, handle);
+}
+
+void ControlServer::ReapClients(bool all)
+{
+	std::list<std::unique_ptr<Client>> finished;
+	{
+		std::unique_lock<std::mutex> lock(client_mutex_);
+		for (auto it = clients_.begin(); it != clients_.end();)
+		{
+			if (all || (*it)->finished)
+			{
+				finished.push_back(std::move(*it));
+				it = clients_.erase(it);
+			}
+			else
+			{
+				++it;
+			}
+		}
+	}
+	// 在锁外 join，连接线程退出前不需要这把锁
+	for (auto& c : finished)
+	{
+		if (c->thread.joinable())
+			c->thread.join();
+	}
+}
+
+void ControlServer::ClientThreadImpl(Client* client, intptr_t handle)
+{
+#if defined(_WIN32)
+	StopSignal stop = (HANDLE)stop_event_;
+#else
+	StopSignal stop = &running_;
+#endif
+	std::string buffer;
+	char chunk[4096];
+	bool alive = true;
+	while (alive && running_)
+	{
+		size_t read = ReadConnection(handle, chunk, sizeof(chunk), stop);
+		if (read == 0)
+			break;
+		buffer.append(chunk, read);
+
+		size_t begin = 0;
+		size_t pos = 0;
+		while (alive && (pos = buffer.find('\n', begin)) != std::string::npos)
+		{
+			std::string line = buffer.substr(begin, pos - begin);
+			begin = pos + 1;
+			if (!line.empty() && line.back() == '\r')
+				line.pop_back();
+			if (line.empty())
+				continue;
+			std::string reply = handler_(line);
+			reply += '\n';
+			alive = WriteConnection(handle, reply.data(), reply.size(), stop);
+		}
+		buffer.erase(0, begin);
+		if (buffer.size() > kMaxLineSize)
+			break;
+	}
+	CloseConnection(handle);
+	client->finished = true;
+}
+
+ControlClient::ControlClient()
+{
+}
+
+ControlClient::~ControlClient()
+{
+	Close();
+}
+
+bool ControlClient::Connect(const char* endpoint)
+{
+	Close();
+#if defined(_WIN32)
+	std::wstring name = ToWide(endpoint);
+	// 所有实例都在忙时等一下
+	if (!WaitNamedPipeW(name.c_str(), 2000))
+		return false;
+	HANDLE pipe = CreateFileW(name.c_str(), GENERIC_READ | GENERIC_WRITE, 0, nullptr, OPEN_EXISTING, FILE_FLAG_OVERLAPPED, nullptr);
+	if (pipe == INVALID_HANDLE_VALUE)
+		return false;
+	handle_ = (intptr_t)pipe;
+#else
+	sockaddr_un addr;
+	if (!MakeAddress(endpoint, addr))
+		return false;
+	int fd = socket(AF_UNIX, SOCK_STREAM, 0);
+	if (fd < 0)
+		return false;
+	if (connect(fd, (sockaddr*)&addr, sizeof(addr)) != 0)
+	{
+		close(fd);
+		return false;
+	}
+	handle_ = fd;
+#endif
+	return true;
+}
+
+void ControlClient::Close()
+{
+	if (handle_ == -1)
+		return;
+	CloseConnection(handle_);
+	handle_ = -1;
+	buffer_.clear();
+}
+
+bool ControlClient::Request(const std::string& request, std::string& reply)
+{
+	if (handle_ == -1)
+		return false;
+
+	std::string line = request + '\n';
+	if (!WriteConnection(handle_, line.data(), line.size(), nullptr))
+		return false;
+
+	char chunk[4096];
+	size_t pos = 0;
+	while ((pos = buffer_.find('\n')) == std::string::npos)
+	{
+		size_t read = ReadConnection(handle_, chunk, sizeof(chunk), nullptr);
+		if (read == 0)
+			return false;
+		buffer_.append(chunk, read);
+	}
+	reply = buffer_.substr(0, pos);
+	buffer_.erase(0, pos + 1);
+	return true;
+}
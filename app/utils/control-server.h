@@ -0,0 +1,80 @@
+#ifndef CONTROL_SERVER_H
+#define CONTROL_SERVER_H
+
+/* 本机控制端点
+* Windows 上是命名管道，其他平台是 Unix 域套接字；只接受本机连接
+* 按行收发：每收到一行 (以 '\n' 结尾) 调用一次 handler，把返回值加 '\n' 写回去
+* 每个连接一个线程，同一个连接上的请求按顺序处理；Stop 会断开所有连接并等线程退出
+*/
+
+#include <stdint.h>
+#include <string>
+#include <functional>
+#include <thread>
+#include <mutex>
+#include <list>
+#include <atomic>
+#include <memory>
+
+class ControlServer
+{
+public:
+	using Handler = std::function<std::string(const std::string& request)>;
+
+	ControlServer();
+	~ControlServer();
+
+	// Windows: \\.\pipe\tinystudio-control，其他平台: /tmp/tinystudio-control.sock
+	static const char* DefaultEndpoint();
+
+	bool Start(const char* endpoint, Handler handler);
+	void Stop();
+	bool IsRunning() const { return running_; }
+
+private:
+	struct Client
+	{
+		std::thread thread;
+		std::atomic<bool> finished{ false };
+	};
+
+	void AcceptThreadImpl();
+	// handle 为命名管道句柄或套接字，线程退出时关闭
+	void ClientThreadImpl(Client* client, intptr_t handle);
+	void AddClient(intptr_t handle);
+	// 回收已经断开的连接
+	void ReapClients(bool all);
+
+private:
+	std::string endpoint_;
+	Handler handler_;
+	std::atomic<bool> running_{ false };
+	std::thread accept_thread_;
+	// Windows 上是 Start 里创建的第一个管道实例，其他平台是监听套接字
+	intptr_t listen_handle_ = -1;
+#if defined(_WIN32)
+	// 手动重置的事件，Stop 时触发，打断所有等待中的重叠 IO
+	void* stop_event_ = nullptr;
+#endif
+	std::mutex client_mutex_;
+	std::list<std::unique_ptr<Client>> clients_;
+};
+
+// 给命令行工具用的客户端，一问一答
+class ControlClient
+{
+public:
+	ControlClient();
+	~ControlClient();
+
+	bool Connect(const char* endpoint);
+	void Close();
+	// request 不能包含换行
+	bool Request(const std::string& request, std::string& reply);
+
+private:
+	intptr_t handle_ = -1;
+	std::string buffer_;
+};
+
+#endif
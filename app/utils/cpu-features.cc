@@ -0,0 +1,41 @@
+#include "cpu-features.h"
+#include <stdlib.h>
+#if defined(_MSC_VER)
+#include <intrin.h>
+#include <immintrin.h>
+#endif
+
+static bool detect_avx2()
+{
+	const char* disable = getenv("TINY_DISABLE_SIMD");
+	if (disable && disable[0] == '1')
+		return false;
+
+#if defined(_MSC_VER) && (defined(_M_X64) || defined(_M_IX86))
+	int info[4] = { 0 };
+	__cpuid(info, 0);
+	if (info[0] < 7)
+		return false;
+	__cpuid(info, 1);
+	bool osxsave = (info[2] & (1 << 27)) != 0;
+	bool fma = (info[2] & (1 << 12)) != 0;
+	if (!osxsave || !fma)
+		return false;
+	// 操作系统需要保存 ymm 寄存器
+	if ((_xgetbv(0) & 0x6) != 0x6)
+		return false;
+	__cpuidex(info, 7, 0);
+	return (info[1] & (1 << 5)) != 0;
+#elif (defined(__GNUC__) || defined(__clang__)) && (defined(__x86_64__) || defined(__i386__))
+	__builtin_cpu_init();
+	return __builtin_cpu_supports("avx2") && __builtin_cpu_supports("fma");
+#else
+	return false;
+#endif
+}
+
+bool cpu_has_avx2()
+{
+	static const bool has_avx2 = detect_avx2();
+	return has_avx2;
+}
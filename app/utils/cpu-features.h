@@ -0,0 +1,7 @@
+#pragma once
+
+/* 运行时 CPU 指令集检测，SIMD 路径都按这里的结果分发
+* 设置环境变量 TINY_DISABLE_SIMD=1 可以强制走标量路径，方便对比
+*/
+
+bool cpu_has_avx2();
@@ -0,0 +1,151 @@
+#include "frame-mailbox.h"
+
+// 空闲缓冲的池子，信箱销毁后还被消费者引用的帧释放时也要能回到这里，所以用 shared_ptr 持有
+struct FrameMailbox::Pool
+{
+	// 生产者手上一块、每个消费者手上和槽里各一块，再多就是异常情况，直接释放
+	explicit Pool(size_t consumer_count) : max_free(consumer_count * 2 + 2) {}
+
+	~Pool()
+	{
+		for (auto frame : free)
+			delete frame;
+	}
+
+	std::mutex mutex;
+	std::vector<Frame*> free;
+	size_t max_free = 0;
+	uint64_t allocated = 0;
+};
+
+FrameMailbox::FrameMailbox(size_t consumer_count)
+	: pool_(std::make_shared<Pool>(consumer_count)), slots_(consumer_count)
+{
+
+}
+
+FrameMailbox::~FrameMailbox()
+{
+	Close();
+}
+
+std::shared_ptr<FrameMailbox::Frame> FrameMailbox::Acquire(size_t size)
+{
+	Frame* frame = nullptr;
+	{
+		std::unique_lock<std::mutex> lock(pool_->mutex);
+		if (!pool_->free.empty())
+		{
+			frame = pool_->free.back();
+			pool_->free.pop_back();
+		}
+		else
+		{
+			pool_->allocated++;
+		}
+	}
+	if (!frame)
+		frame = new Frame();
+	frame->data.resize(size);
+	frame->sequence = 0;
+
+	std::shared_ptr<Pool> pool = pool_;
+	return std::shared_ptr<Frame>(frame, [pool](Frame* released) {
+		std::unique_lock<std::mutex> lock(pool->mutex);
+		if (pool->free.size() < pool->max_free)
+			pool->free.push_back(released);
+		else
+			delete released;
+	});
+}
+
+void FrameMailbox::Publish(std::shared_ptr<Frame> frame)
+{
+	if (!frame)
+		return;
+
+	// 被替换的旧帧要在锁外释放，释放时会去拿池子的锁
+	std::vector<FramePtr> replaced;
+	{
+		std::unique_lock<std::mutex> lock(mutex_);
+		if (closed_)
+			return;
+		frame->sequence = ++sequence_;
+		FramePtr shared = std::move(frame);
+		replaced.reserve(slots_.size());
+		for (auto& slot : slots_)
+		{
+			if (slot.frame)
+			{
+				slot.dropped++;
+				dropped_++;
+				replaced.push_back(std::move(slot.frame));
+			}
+			slot.frame = shared;
+		}
+	}
+	cond_.notify_all();
+}
+
+FrameMailbox::FramePtr FrameMailbox::Wait(size_t consumer)
+{
+	std::unique_lock<std::mutex> lock(mutex_);
+	Slot& slot = slots_[consumer];
+	cond_.wait(lock, [&] { return slot.frame || closed_; });
+	if (closed_)
+		return nullptr;
+	return std::move(slot.frame);
+}
+
+FrameMailbox::FramePtr FrameMailbox::TryTake(size_t consumer)
+{
+	std::unique_lock<std::mutex> lock(mutex_);
+	return std::move(slots_[consumer].frame);
+}
+
+void FrameMailbox::Drop()
+{
+	std::vector<FramePtr> pending;
+	std::unique_lock<std::mutex> lock(mutex_);
+	for (auto& slot : slots_)
+	{
+		if (slot.frame)
+			pending.push_back(std::move(slot.frame));
+	}
+	// pending 在锁外析构
+	lock.unlock();
+}
+
+void FrameMailbox::Close()
+{
+	std::vector<FramePtr> pending;
+	{
+		std::unique_lock<std::mutex> lock(mutex_);
+		closed_ = true;
+		for (auto& slot : slots_)
+		{
+			if (slot.frame)
+				pending.push_back(std::move(slot.frame));
+		}
+	}
+	cond_.notify_all();
+}
+
+FrameMailbox::Stats FrameMailbox::GetStats()
+{
+	Stats stats;
+	{
+		std::unique_lock<std::mutex> lock(mutex_);
+		stats.published = sequence_;
+		stats.dropped = dropped_;
+	}
+	std::unique_lock<std::mutex> lock(pool_->mutex);
+	stats.allocated = pool_->allocated;
+	return stats;
+}
+
+uint64_t FrameMailbox::GetDroppedCount(size_t consumer)
+{
+	std::unique_lock<std::mutex> lock(mutex_);
+	return slots_[consumer].dropped;
+}
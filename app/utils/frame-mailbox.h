@@ -0,0 +1,86 @@
+#ifndef FRAME_MAILBOX_H
+#define FRAME_MAILBOX_H
+
+/* 单生产者多消费者的最新帧信箱
+* 生产者 Acquire 一块池子里的缓冲，写好后 Publish；每个消费者有一个槽，只放最新的一帧，
+* 所有消费者拿到的是同一块缓冲 (shared_ptr 引用计数)，最后一个引用释放时缓冲回到池子
+* 消费者还没取走的旧帧被新帧直接替换，不做拷贝，记为丢帧
+*/
+
+#include <stddef.h>
+#include <stdint.h>
+#include <condition_variable>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+class FrameMailbox
+{
+public:
+	struct Frame
+	{
+		std::vector<uint8_t> data;
+		size_t width = 0;
+		size_t height = 0;
+		size_t linesize = 0;
+		// Publish 时按 1, 2, 3 ... 编号
+		uint64_t sequence = 0;
+		// 源帧时间，steady_clock 纳秒，由生产者填
+		int64_t timestamp = 0;
+	};
+	using FramePtr = std::shared_ptr<const Frame>;
+
+	struct Stats
+	{
+		uint64_t published = 0;
+		// 所有消费者丢掉的帧数之和
+		uint64_t dropped = 0;
+		// 池子新分配过的缓冲数，稳定后不再增长
+		uint64_t allocated = 0;
+	};
+
+	explicit FrameMailbox(size_t consumer_count);
+	~FrameMailbox();
+
+	FrameMailbox(const FrameMailbox&) = delete;
+	FrameMailbox& operator=(const FrameMailbox&) = delete;
+
+	size_t GetConsumerCount() const { return slots_.size(); }
+
+	// 生产者：data 调整到 size 字节，内容是上次用过的旧数据
+	std::shared_ptr<Frame> Acquire(size_t size);
+	// Publish 之后生产者不能再写这一帧
+	void Publish(std::shared_ptr<Frame> frame);
+
+	// 消费者：等到有新帧为止，Close 之后返回空
+	FramePtr Wait(size_t consumer);
+	// 没有新帧时立即返回空
+	FramePtr TryTake(size_t consumer);
+
+	// 清空所有槽，不算丢帧
+	void Drop();
+	// 唤醒所有等待的消费者，之后 Wait 立即返回空
+	void Close();
+
+	Stats GetStats();
+	uint64_t GetDroppedCount(size_t consumer);
+
+private:
+	struct Pool;
+
+	struct Slot
+	{
+		FramePtr frame;
+		uint64_t dropped = 0;
+	};
+
+	std::shared_ptr<Pool> pool_;
+	std::mutex mutex_;
+	std::condition_variable cond_;
+	std::vector<Slot> slots_;
+	uint64_t sequence_ = 0;
+	uint64_t dropped_ = 0;
+	bool closed_ = false;
+};
+
+#endif
@@ -0,0 +1,73 @@
+#ifndef MPSC_QUEUE_H
+#define MPSC_QUEUE_H
+
+/* 多生产者单消费者的无锁队列 (Vyukov 链表队列)
+* Push 可以在任意线程调用，只有一次 exchange 和一次 store，不会被消费者阻塞
+* Pop 只能在一个线程调用；生产者 exchange 之后还没链接上时 Pop 会暂时返回 false，下次再取
+*/
+
+#include <atomic>
+#include <utility>
+
+template <typename T>
+class MpscQueue
+{
+	struct Node
+	{
+		std::atomic<Node*> next{ nullptr };
+		T value;
+	};
+
+public:
+	MpscQueue()
+	{
+		Node* stub = new Node();
+		head_.store(stub);
+		tail_ = stub;
+	}
+
+	~MpscQueue()
+	{
+		T value;
+		while (Pop(value))
+		{
+		}
+		delete tail_;
+	}
+
+	MpscQueue(const MpscQueue&) = delete;
+	MpscQueue& operator=(const MpscQueue&) = delete;
+
+	void Push(T value)
+	{
+		Node* node = new Node();
+		node->value = std::move(value);
+		Node* prev = head_.exchange(node, std::memory_order_acq_rel);
+		prev->next.store(node, std::memory_order_release);
+	}
+
+	bool Pop(T& value)
+	{
+		Node* tail = tail_;
+		Node* next = tail->next.load(std::memory_order_acquire);
+		if (!next)
+			return false;
+		// next 变成新的哨兵节点，值移走后释放旧的哨兵
+		value = std::move(next->value);
+		tail_ = next;
+		delete tail;
+		return true;
+	}
+
+	// 只在消费者线程调用
+	bool Empty() const
+	{
+		return tail_->next.load(std::memory_order_acquire) == nullptr;
+	}
+
+private:
+	std::atomic<Node*> head_;
+	Node* tail_ = nullptr;
+};
+
+#endif
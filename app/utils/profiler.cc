@@ -0,0 +1,142 @@
+#include "profiler.h"
+#include "json.hpp"
+#include <algorithm>
+
+void Profiler::Item::Record(Metric metric, uint64_t ns)
+{
+	std::unique_lock<std::mutex> lock(mutex_);
+	Window& window = windows_[(int)metric];
+	if (window.size == kWindow)
+		window.total -= window.samples[window.next];
+	else
+		window.size += 1;
+	window.samples[window.next] = ns;
+	window.total += ns;
+	window.next = (window.next + 1) % kWindow;
+}
+
+void Profiler::Item::GetStats(ItemStats& stats)
+{
+	stats.name = name_;
+	uint64_t sorted[kWindow];
+	for (int i = 0; i < (int)Metric::kCount; i++)
+	{
+		size_t size = 0;
+		uint64_t total = 0;
+		{
+			std::unique_lock<std::mutex> lock(mutex_);
+			const Window& window = windows_[i];
+			size = window.size;
+			total = window.total;
+			std::copy(window.samples, window.samples + size, sorted);
+		}
+
+		MetricStats& out = stats.metrics[i];
+		out = MetricStats();
+		if (!size)
+			continue;
+		std::sort(sorted, sorted + size);
+		out.count = size;
+		out.mean_ms = total / (double)size / 1e6;
+		out.p95_ms = sorted[(size_t)(0.95 * (size - 1) + 0.5)] / 1e6;
+		out.max_ms = sorted[size - 1] / 1e6;
+	}
+}
+
+void Profiler::Item::Reset()
+{
+	std::unique_lock<std::mutex> lock(mutex_);
+	for (auto& c : windows_)
+		c = Window();
+}
+
+const char* Profiler::GetMetricName(Metric metric)
+{
+	switch (metric)
+	{
+	case Metric::kTickBegin:
+		return "tick_begin";
+	case Metric::kTickPrepare:
+		return "tick_prepare";
+	case Metric::kTick:
+		return "tick";
+	case Metric::kTickGpu:
+		return "tick_gpu";
+	case Metric::kRender:
+		return "render";
+	case Metric::kRenderGpu:
+		return "render_gpu";
+	default:
+		return "unknown";
+	}
+}
+
+Profiler::Item* Profiler::GetItem(const std::string& name)
+{
+	std::unique_lock<std::mutex> lock(mutex_);
+	auto it = items_.find(name);
+	if (it != items_.end())
+		return it->second.get();
+	Item* item = new Item(name);
+	items_.insert(std::make_pair(name, std::unique_ptr<Item>(item)));
+	return item;
+}
+
+void Profiler::GetStats(std::vector<ItemStats>& stats)
+{
+	std::vector<Item*> items;
+	{
+		std::unique_lock<std::mutex> lock(mutex_);
+		for (const auto& c : items_)
+			items.push_back(c.second.get());
+	}
+
+	stats.clear();
+	for (auto c : items)
+	{
+		ItemStats item;
+		c->GetStats(item);
+		bool empty = true;
+		for (const auto& m : item.metrics)
+			empty = empty && !m.count;
+		if (!empty)
+			stats.push_back(item);
+	}
+
+	auto cost = [](const ItemStats& item) {
+		double total = 0.0;
+		for (const auto& m : item.metrics)
+			total += m.mean_ms;
+		return total;
+	};
+	std::sort(stats.begin(), stats.end(), [&](const ItemStats& a, const ItemStats& b) { return cost(a) > cost(b); });
+}
+
+void Profiler::Reset()
+{
+	std::unique_lock<std::mutex> lock(mutex_);
+	for (const auto& c : items_)
+		c.second->Reset();
+}
+
+std::string Profiler::DumpJson()
+{
+	std::vector<ItemStats> stats;
+	GetStats(stats);
+
+	nlohmann::json items = nlohmann::json::array();
+	for (const auto& c : stats)
+	{
+		nlohmann::json item = { { "name", c.name } };
+		for (int i = 0; i < (int)Metric::kCount; i++)
+		{
+			const MetricStats& m = c.metrics[i];
+			if (!m.count)
+				continue;
+			item[GetMetricName((Metric)i)] = { { "count", m.count }, { "mean", m.mean_ms }, { "p95", m.p95_ms }, { "max", m.max_ms } };
+		}
+		items.push_back(item);
+	}
+	nlohmann::json result = { { "ok", true }, { "window", (uint64_t)kWindow }, { "items", items } };
+	return result.dump();
+}
@@ -0,0 +1,113 @@
+#ifndef PROFILER_H
+#define PROFILER_H
+
+/* 运行时耗时统计，定位是哪个源或滤镜拖慢了场景
+* 每个条目 (源、"源/滤镜") 按指标保存最近 kWindow 个样本，查询时算平均、p95 和最大值
+* CPU 时间用 ProfileScope 按单调时钟记录；GPU 时间由 CoreD3D 的 timestamp 查询晚几帧读回后写入
+* 条目创建后不删除，指针可以一直缓存；Record 可以在任意线程调用
+*/
+
+#include <stdint.h>
+#include <chrono>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+class Profiler
+{
+public:
+	enum class Metric : int
+	{
+		kTickBegin = 0,
+		kTickPrepare,
+		kTick,
+		kTickGpu,
+		kRender,
+		kRenderGpu,
+		kCount
+	};
+
+	static const size_t kWindow = 120;
+
+	struct MetricStats
+	{
+		uint64_t count = 0;
+		double mean_ms = 0.0;
+		double p95_ms = 0.0;
+		double max_ms = 0.0;
+	};
+
+	struct ItemStats
+	{
+		std::string name;
+		MetricStats metrics[(int)Metric::kCount];
+	};
+
+	class Item
+	{
+	public:
+		explicit Item(const std::string& name) : name_(name) {}
+		const std::string& GetName() const { return name_; }
+		void Record(Metric metric, uint64_t ns);
+		void GetStats(ItemStats& stats);
+		void Reset();
+
+	private:
+		struct Window
+		{
+			uint64_t samples[kWindow] = { 0 };
+			size_t next = 0;
+			size_t size = 0;
+			uint64_t total = 0;
+		};
+
+		std::string name_;
+		std::mutex mutex_;
+		Window windows_[(int)Metric::kCount];
+	};
+
+	static const char* GetMetricName(Metric metric);
+
+	// 没有就创建
+	Item* GetItem(const std::string& name);
+	// 按各指标平均耗时之和从大到小
+	void GetStats(std::vector<ItemStats>& stats);
+	void Reset();
+	// {"ok":true,"window":120,"items":[{"name":..,"render":{"count":..,"mean":..,"p95":..,"max":..},..}]}，单位毫秒
+	std::string DumpJson();
+
+private:
+	std::mutex mutex_;
+	std::map<std::string, std::unique_ptr<Item>> items_;
+};
+
+// CPU 耗时，item 为空时什么都不做
+class ProfileScope
+{
+public:
+	ProfileScope(Profiler::Item* item, Profiler::Metric metric)
+		: item_(item), metric_(metric)
+	{
+		if (item_)
+			begin_ = std::chrono::steady_clock::now();
+	}
+
+	~ProfileScope()
+	{
+		if (item_)
+			item_->Record(metric_, (uint64_t)std::chrono::duration_cast<std::chrono::nanoseconds>(
+				std::chrono::steady_clock::now() - begin_).count());
+	}
+
+	ProfileScope(const ProfileScope&) = delete;
+	ProfileScope& operator=(const ProfileScope&) = delete;
+
+private:
+	Profiler::Item* item_;
+	Profiler::Metric metric_;
+	std::chrono::steady_clock::time_point begin_;
+};
+
+#endif
@@ -0,0 +1,115 @@
+#include "task-pool.h"
+#include <chrono>
+
+TaskPool::TaskPool(size_t thread_count)
+{
+	for (size_t i = 0; i < thread_count; i++)
+		threads_.emplace_back(&TaskPool::WorkThreadImpl, this);
+}
+
+TaskPool::~TaskPool()
+{
+	{
+		std::unique_lock<std::mutex> lock(task_mutex_);
+		quit_ = true;
+	}
+	task_cond_.notify_all();
+	for (auto& t : threads_)
+	{
+		if (t.joinable())
+			t.join();
+	}
+}
+
+TaskPool* TaskPool::GetShared()
+{
+	static TaskPool pool(std::thread::hardware_concurrency() > 1 ? std::thread::hardware_concurrency() - 1 : 1);
+	return &pool;
+}
+
+void TaskPool::Post(Task task)
+{
+	{
+		std::unique_lock<std::mutex> lock(task_mutex_);
+		task_list_.push_back(std::move(task));
+	}
+	task_cond_.notify_one();
+}
+
+void TaskPool::ParallelFor(size_t count, size_t min_grain, const RangeTask& task)
+{
+	if (!count)
+		return;
+	if (!min_grain)
+		min_grain = 1;
+
+	size_t bands = count / min_grain;
+	if (bands > threads_.size() + 1)
+		bands = threads_.size() + 1;
+	if (bands <= 1)
+	{
+		task(0, count);
+		return;
+	}
+
+	std::mutex done_mutex;
+	std::condition_variable done_cond;
+	size_t pending = bands - 1;
+
+	// 第 0 段留给调用线程
+	for (size_t i = 1; i < bands; i++)
+	{
+		size_t begin = count * i / bands;
+		size_t end = count * (i + 1) / bands;
+		Post([&, begin, end]() {
+			task(begin, end);
+			std::unique_lock<std::mutex> lock(done_mutex);
+			if (--pending == 0)
+				done_cond.notify_one();
+		});
+	}
+	task(0, count / bands);
+
+	// 等待期间帮忙执行队列里的任务，工作线程里嵌套调用 ParallelFor 也不会卡死
+	while (1)
+	{
+		{
+			std::unique_lock<std::mutex> lock(done_mutex);
+			if (pending == 0)
+				break;
+		}
+		Task other;
+		{
+			std::unique_lock<std::mutex> lock(task_mutex_);
+			if (!task_list_.empty())
+			{
+				other = std::move(task_list_.front());
+				task_list_.pop_front();
+			}
+		}
+		if (other)
+		{
+			other();
+			continue;
+		}
+		std::unique_lock<std::mutex> lock(done_mutex);
+		done_cond.wait_for(lock, std::chrono::milliseconds(1), [&]() { return pending == 0; });
+	}
+}
+
+void TaskPool::WorkThreadImpl()
+{
+	while (1)
+	{
+		Task task;
+		{
+			std::unique_lock<std::mutex> lock(task_mutex_);
+			task_cond_.wait(lock, [this]() { return quit_ || !task_list_.empty(); });
+			if (quit_ && task_list_.empty())
+				return;
+			task = std::move(task_list_.front());
+			task_list_.pop_front();
+		}
+		task();
+	}
+}
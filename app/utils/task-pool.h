@@ -0,0 +1,44 @@
+#ifndef TASK_POOL_H
+#define TASK_POOL_H
+
+/* 常驻工作线程池
+* Post 投递异步任务；ParallelFor 把 [0, count) 切成若干段分给工作线程，调用线程也参与，全部完成才返回
+* GetShared 是进程内共享的实例，线程数 = 硬件线程数 - 1
+*/
+
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <functional>
+#include <vector>
+#include <list>
+#include <atomic>
+
+class TaskPool
+{
+public:
+	using Task = std::function<void()>;
+	using RangeTask = std::function<void(size_t begin, size_t end)>;
+
+	explicit TaskPool(size_t thread_count);
+	~TaskPool();
+
+	static TaskPool* GetShared();
+
+	size_t GetThreadCount() const { return threads_.size(); }
+	void Post(Task task);
+	// 分段数 = min(count / min_grain, 线程数 + 1)
+	void ParallelFor(size_t count, size_t min_grain, const RangeTask& task);
+
+private:
+	void WorkThreadImpl();
+
+private:
+	std::vector<std::thread> threads_;
+	std::mutex task_mutex_;
+	std::condition_variable task_cond_;
+	std::list<Task> task_list_;
+	bool quit_ = false;
+};
+
+#endif
@@ -0,0 +1,121 @@
+// 这个文件单独用 AVX2 编译选项编译，只能在 cpu_has_avx2() 为真时调用
+#include "video-scaler-kernels.h"
+#include <immintrin.h>
+
+namespace VideoScalerKernels
+{
+	void HScaleBGRA_AVX2(const uint8_t* src, int16_t* dst, const VideoScaler::FilterTable& table, int dst_width)
+	{
+		const int taps = table.taps;
+		// [b0 g0 r0 a0 b1 g1 r1 a1] -> [b0 b1 g0 g1 r0 r1 a0 a1]，和系数对 (c0, c1) 做 madd
+		const __m128i shuffle = _mm_setr_epi8(0, 4, 1, 5, 2, 6, 3, 7, -1, -1, -1, -1, -1, -1, -1, -1);
+		// 一次 4 个源像素：低 128 位是像素 0/1，高 128 位是像素 2/3
+		const __m128i shuffle4 = _mm_setr_epi8(0, 4, 1, 5, 2, 6, 3, 7, 8, 12, 9, 13, 10, 14, 11, 15);
+		const __m256i coeff_pairs = _mm256_setr_epi32(0, 0, 0, 0, 1, 1, 1, 1);
+		const __m128i round = _mm_set1_epi32(1 << (SCALER_INTER_SHIFT - 1));
+
+		for (int x = 0; x < dst_width; x++)
+		{
+			const uint8_t* p = src + (size_t)table.start[x] * 4;
+			const int16_t* c = &table.coeffs[(size_t)x * taps];
+			int k = 0;
+			__m256i acc4 = _mm256_setzero_si256();
+			for (; k + 4 <= taps; k += 4)
+			{
+				__m128i px = _mm_shuffle_epi8(_mm_loadu_si128((const __m128i*)(p + k * 4)), shuffle4);
+				__m256i coeff = _mm256_permutevar8x32_epi32(
+					_mm256_castsi128_si256(_mm_loadl_epi64((const __m128i*)(c + k))), coeff_pairs);
+				acc4 = _mm256_add_epi32(acc4, _mm256_madd_epi16(_mm256_cvtepu8_epi16(px), coeff));
+			}
+			__m128i acc = _mm_add_epi32(_mm256_castsi256_si128(acc4), _mm256_extracti128_si256(acc4, 1));
+			for (; k < taps; k += 2)
+			{
+				__m128i px = _mm_loadl_epi64((const __m128i*)(p + k * 4));
+				px = _mm_cvtepu8_epi16(_mm_shuffle_epi8(px, shuffle));
+				__m128i coeff = _mm_set1_epi32((int32_t)(((uint32_t)(uint16_t)c[k + 1] << 16) | (uint16_t)c[k]));
+				acc = _mm_add_epi32(acc, _mm_madd_epi16(px, coeff));
+			}
+			acc = _mm_srai_epi32(_mm_add_epi32(acc, round), SCALER_INTER_SHIFT);
+			_mm_storel_epi64((__m128i*)(dst + x * 4), _mm_packs_epi32(acc, acc));
+		}
+	}
+
+	int HScalePlane_AVX2(const uint8_t* src, int16_t* dst, const VideoScaler::FilterTable& table, int dst_width)
+	{
+		const int taps = table.taps;
+		const int end = table.simd_end & ~7;
+		const __m256i mask = _mm256_set1_epi32(0xFF);
+		const __m256i round = _mm256_set1_epi32(1 << (SCALER_INTER_SHIFT - 1));
+
+		int x = 0;
+		for (; x < end; x += 8)
+		{
+			__m256i index = _mm256_loadu_si256((const __m256i*)&table.start[x]);
+			__m256i acc = _mm256_setzero_si256();
+			for (int k = 0; k < taps; k++)
+			{
+				__m256i px = _mm256_and_si256(_mm256_i32gather_epi32((const int*)(src + k), index, 1), mask);
+				__m256i coeff = _mm256_cvtepi16_epi32(_mm_loadu_si128((const __m128i*)&table.coeffs_t[(size_t)k * dst_width + x]));
+				acc = _mm256_add_epi32(acc, _mm256_mullo_epi32(px, coeff));
+			}
+			acc = _mm256_srai_epi32(_mm256_add_epi32(acc, round), SCALER_INTER_SHIFT);
+			__m128i packed = _mm_packs_epi32(_mm256_castsi256_si128(acc), _mm256_extracti128_si256(acc, 1));
+			_mm_storeu_si128((__m128i*)(dst + x), packed);
+		}
+		return x;
+	}
+
+	int VScale_AVX2(const int16_t* const* rows, const int16_t* coeffs, int taps, uint8_t* dst, int width)
+	{
+		const __m256i round = _mm256_set1_epi32(1 << (SCALER_OUTPUT_SHIFT - 1));
+		const int end = width & ~15;
+
+		int x = 0;
+		for (; x < end; x += 16)
+		{
+			__m256i lo = _mm256_setzero_si256();
+			__m256i hi = _mm256_setzero_si256();
+			int k = 0;
+			for (; k + 1 < taps; k += 2)
+			{
+				__m256i a = _mm256_loadu_si256((const __m256i*)(rows[k] + x));
+				__m256i b = _mm256_loadu_si256((const __m256i*)(rows[k + 1] + x));
+				__m256i coeff = _mm256_set1_epi32((int32_t)(((uint32_t)(uint16_t)coeffs[k + 1] << 16) | (uint16_t)coeffs[k]));
+				lo = _mm256_add_epi32(lo, _mm256_madd_epi16(_mm256_unpacklo_epi16(a, b), coeff));
+				hi = _mm256_add_epi32(hi, _mm256_madd_epi16(_mm256_unpackhi_epi16(a, b), coeff));
+			}
+			if (k < taps)
+			{
+				__m256i a = _mm256_loadu_si256((const __m256i*)(rows[k] + x));
+				__m256i coeff = _mm256_set1_epi32((uint16_t)coeffs[k]);
+				__m256i zero = _mm256_setzero_si256();
+				lo = _mm256_add_epi32(lo, _mm256_madd_epi16(_mm256_unpacklo_epi16(a, zero), coeff));
+				hi = _mm256_add_epi32(hi, _mm256_madd_epi16(_mm256_unpackhi_epi16(a, zero), coeff));
+			}
+			lo = _mm256_srai_epi32(_mm256_add_epi32(lo, round), SCALER_OUTPUT_SHIFT);
+			hi = _mm256_srai_epi32(_mm256_add_epi32(hi, round), SCALER_OUTPUT_SHIFT);
+			// unpack/pack 都在 128 位通道内进行，两次之后顺序正好还原
+			__m256i words = _mm256_packs_epi32(lo, hi);
+			__m256i bytes = _mm256_permute4x64_epi64(_mm256_packus_epi16(words, words), 0x08);
+			_mm_storeu_si128((__m128i*)(dst + x), _mm256_castsi256_si128(bytes));
+		}
+		return x;
+	}
+
+	int PackBGR_AVX2(const uint8_t* src, uint8_t* dst, int count)
+	{
+		const __m256i to_bgr = _mm256_setr_epi8(0, 1, 2, 4, 5, 6, 8, 9, 10, 12, 13, 14, -1, -1, -1, -1,
+			0, 1, 2, 4, 5, 6, 8, 9, 10, 12, 13, 14, -1, -1, -1, -1);
+		// 两个 128 位各有 12 字节，挪到一起
+		const __m256i pack = _mm256_setr_epi32(0, 1, 2, 4, 5, 6, 3, 7);
+		int x = 0;
+		// 每次 8 个像素写 32 字节，多出的 8 字节由下一组覆盖
+		for (; x + 11 <= count; x += 8)
+		{
+			__m256i bgra = _mm256_loadu_si256((const __m256i*)(src + x * 4));
+			__m256i bgr = _mm256_permutevar8x32_epi32(_mm256_shuffle_epi8(bgra, to_bgr), pack);
+			_mm256_storeu_si256((__m256i*)(dst + x * 3), bgr);
+		}
+		return x;
+	}
+}
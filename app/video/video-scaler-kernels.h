@@ -0,0 +1,31 @@
+#ifndef VIDEO_SCALER_KERNELS_H
+#define VIDEO_SCALER_KERNELS_H
+
+/* VideoScaler 内部用的行处理函数
+* 水平：uint8 源行 -> int16 中间行 (6 位小数)
+* 垂直：taps 条中间行 -> uint8 目标行
+*/
+
+#include "video-scaler.h"
+
+#define SCALER_COEFF_BITS 14
+#define SCALER_INTER_SHIFT 8
+#define SCALER_OUTPUT_SHIFT (SCALER_COEFF_BITS * 2 - SCALER_INTER_SHIFT)
+
+namespace VideoScalerKernels
+{
+	void HScaleBGRA_C(const uint8_t* src, int16_t* dst, const VideoScaler::FilterTable& table, int dst_width);
+	void HScalePlane_C(const uint8_t* src, int16_t* dst, const VideoScaler::FilterTable& table, int begin, int dst_width);
+	void VScale_C(const int16_t* const* rows, const int16_t* coeffs, int taps, uint8_t* dst, int begin, int width);
+	// BGRA 行去掉 alpha，count 为像素数
+	void PackBGR_C(const uint8_t* src, uint8_t* dst, int begin, int count);
+
+	void HScaleBGRA_AVX2(const uint8_t* src, int16_t* dst, const VideoScaler::FilterTable& table, int dst_width);
+	// 只处理 [0, table.simd_end)，返回处理到的位置，剩余部分由调用方走 C 版本
+	int HScalePlane_AVX2(const uint8_t* src, int16_t* dst, const VideoScaler::FilterTable& table, int dst_width);
+	// 返回处理到的位置
+	int VScale_AVX2(const int16_t* const* rows, const int16_t* coeffs, int taps, uint8_t* dst, int width);
+	int PackBGR_AVX2(const uint8_t* src, uint8_t* dst, int count);
+}
+
+#endif
@@ -0,0 +1,354 @@
+#include "video-scaler.h"
+#include "video-scaler-kernels.h"
+#include "task-pool.h"
+#include "cpu-features.h"
+#include <math.h>
+#include <algorithm>
+
+namespace
+{
+	const double kPi = 3.14159265358979323846;
+
+	double KernelRadius(VideoScaler::Filter filter)
+	{
+		switch (filter)
+		{
+		case VideoScaler::Filter::kBilinear:
+			return 1.0;
+		case VideoScaler::Filter::kBicubic:
+			return 2.0;
+		case VideoScaler::Filter::kLanczos:
+			return 3.0;
+		case VideoScaler::Filter::kArea:
+			return 0.5;
+		}
+		return 1.0;
+	}
+
+	double KernelWeight(VideoScaler::Filter filter, double x)
+	{
+		x = fabs(x);
+		switch (filter)
+		{
+		case VideoScaler::Filter::kBilinear:
+			return x < 1.0 ? 1.0 - x : 0.0;
+		case VideoScaler::Filter::kBicubic:
+		{
+			// Keys 三次卷积，a = -0.6 和 swscale SWS_BICUBIC 的默认参数一致
+			const double a = -0.6;
+			if (x < 1.0)
+				return ((a + 2.0) * x - (a + 3.0)) * x * x + 1.0;
+			if (x < 2.0)
+				return ((a * x - 5.0 * a) * x + 8.0 * a) * x - 4.0 * a;
+			return 0.0;
+		}
+		case VideoScaler::Filter::kLanczos:
+		{
+			if (x < 1e-8)
+				return 1.0;
+			if (x >= 3.0)
+				return 0.0;
+			double px = kPi * x;
+			return 3.0 * sin(px) * sin(px / 3.0) / (px * px);
+		}
+		}
+		return 0.0;
+	}
+
+	// 源像素 j 占 [j - 0.5, j + 0.5]，目标像素覆盖 [center - scale / 2, center + scale / 2]，取重叠长度
+	double AreaWeight(int j, double center, double scale)
+	{
+		double lo = std::max(j - 0.5, center - scale * 0.5);
+		double hi = std::min(j + 0.5, center + scale * 0.5);
+		return hi > lo ? hi - lo : 0.0;
+	}
+
+	inline int16_t Clamp16(int32_t v)
+	{
+		return (int16_t)(v < -32768 ? -32768 : (v > 32767 ? 32767 : v));
+	}
+
+	inline uint8_t Clamp8(int32_t v)
+	{
+		return (uint8_t)(v < 0 ? 0 : (v > 255 ? 255 : v));
+	}
+}
+
+namespace VideoScalerKernels
+{
+	void HScaleBGRA_C(const uint8_t* src, int16_t* dst, const VideoScaler::FilterTable& table, int dst_width)
+	{
+		const int taps = table.taps;
+		for (int x = 0; x < dst_width; x++)
+		{
+			const uint8_t* p = src + (size_t)table.start[x] * 4;
+			const int16_t* c = &table.coeffs[(size_t)x * taps];
+			int32_t b = 0, g = 0, r = 0, a = 0;
+			for (int k = 0; k < taps; k++)
+			{
+				b += p[0] * c[k];
+				g += p[1] * c[k];
+				r += p[2] * c[k];
+				a += p[3] * c[k];
+				p += 4;
+			}
+			const int32_t round = 1 << (SCALER_INTER_SHIFT - 1);
+			dst[x * 4 + 0] = Clamp16((b + round) >> SCALER_INTER_SHIFT);
+			dst[x * 4 + 1] = Clamp16((g + round) >> SCALER_INTER_SHIFT);
+			dst[x * 4 + 2] = Clamp16((r + round) >> SCALER_INTER_SHIFT);
+			dst[x * 4 + 3] = Clamp16((a + round) >> SCALER_INTER_SHIFT);
+		}
+	}
+
+	void HScalePlane_C(const uint8_t* src, int16_t* dst, const VideoScaler::FilterTable& table, int begin, int dst_width)
+	{
+		const int taps = table.taps;
+		for (int x = begin; x < dst_width; x++)
+		{
+			const uint8_t* p = src + table.start[x];
+			const int16_t* c = &table.coeffs[(size_t)x * taps];
+			int32_t sum = 0;
+			for (int k = 0; k < taps; k++)
+				sum += p[k] * c[k];
+			dst[x] = Clamp16((sum + (1 << (SCALER_INTER_SHIFT - 1))) >> SCALER_INTER_SHIFT);
+		}
+	}
+
+	void VScale_C(const int16_t* const* rows, const int16_t* coeffs, int taps, uint8_t* dst, int begin, int width)
+	{
+		const int32_t round = 1 << (SCALER_OUTPUT_SHIFT - 1);
+		for (int x = begin; x < width; x++)
+		{
+			int32_t sum = 0;
+			for (int k = 0; k < taps; k++)
+				sum += rows[k][x] * coeffs[k];
+			dst[x] = Clamp8((sum + round) >> SCALER_OUTPUT_SHIFT);
+		}
+	}
+
+	void PackBGR_C(const uint8_t* src, uint8_t* dst, int begin, int count)
+	{
+		for (int x = begin; x < count; x++)
+		{
+			dst[x * 3 + 0] = src[x * 4 + 0];
+			dst[x * 3 + 1] = src[x * 4 + 1];
+			dst[x * 3 + 2] = src[x * 4 + 2];
+		}
+	}
+}
+
+VideoScaler::VideoScaler()
+{
+
+}
+
+VideoScaler::~VideoScaler()
+{
+
+}
+
+void VideoScaler::BuildFilterTable(FilterTable& table, int src_size, int dst_size, Filter filter)
+{
+	const double scale = (double)src_size / dst_size;
+	const double filter_scale = scale > 1.0 ? scale : 1.0;
+	const double support = KernelRadius(filter) * filter_scale;
+	int raw_taps = (int)ceil(support * 2.0);
+
+	// 面积平均只取和目标像素有重叠的源像素：目标像素 i 覆盖源 [i * scale, (i + 1) * scale)
+	auto area_first = [&](int i) { return (int)floor(i * scale + 1e-9); };
+	if (filter == Filter::kArea)
+	{
+		raw_taps = 1;
+		for (int i = 0; i < dst_size; i++)
+			raw_taps = std::max(raw_taps, (int)ceil((i + 1) * scale - 1e-9) - area_first(i));
+	}
+
+	int taps = raw_taps < src_size ? raw_taps : src_size;
+	if ((taps & 1) && taps + 1 <= src_size)
+		taps += 1;
+
+	table.taps = taps;
+	table.start.resize(dst_size);
+	table.coeffs.assign((size_t)dst_size * taps, 0);
+	table.coeffs_t.assign((size_t)dst_size * taps, 0);
+
+	std::vector<double> weights(taps);
+	for (int i = 0; i < dst_size; i++)
+	{
+		const double center = (i + 0.5) * scale - 0.5;
+		const int first = filter == Filter::kArea ? area_first(i) : (int)floor(center - support) + 1;
+		const int start = std::min(std::max(first, 0), src_size - taps);
+
+		// 超出边界的权重并到边缘像素上
+		std::fill(weights.begin(), weights.end(), 0.0);
+		double sum = 0.0;
+		for (int k = 0; k < raw_taps; k++)
+		{
+			int j = first + k;
+			double w = filter == Filter::kArea ? AreaWeight(j, center, scale) : KernelWeight(filter, (j - center) / filter_scale);
+			j = std::min(std::max(j, 0), src_size - 1);
+			weights[j - start] += w;
+			sum += w;
+		}
+
+		int16_t* coeffs = &table.coeffs[(size_t)i * taps];
+		int total = 0;
+		int largest = 0;
+		for (int k = 0; k < taps; k++)
+		{
+			coeffs[k] = (int16_t)lrint(weights[k] / sum * (1 << SCALER_COEFF_BITS));
+			total += coeffs[k];
+			if (abs(coeffs[k]) > abs(coeffs[largest]))
+				largest = k;
+		}
+		coeffs[largest] += (int16_t)((1 << SCALER_COEFF_BITS) - total);
+
+		table.start[i] = start;
+		for (int k = 0; k < taps; k++)
+			table.coeffs_t[(size_t)k * dst_size + i] = coeffs[k];
+	}
+
+	// 平面格式的 SIMD 路径每个点会多读 3 个字节
+	table.simd_end = 0;
+	while (table.simd_end < dst_size && table.start[table.simd_end] + taps + 3 <= src_size)
+		table.simd_end++;
+}
+
+bool VideoScaler::Init(Format format, int src_width, int src_height, int dst_width, int dst_height, Filter filter)
+{
+	if (src_width <= 0 || src_height <= 0 || dst_width <= 0 || dst_height <= 0)
+		return false;
+
+	if (!planes_.empty() && format == format_ && filter == filter_ &&
+		planes_[0].src_width == src_width && planes_[0].src_height == src_height &&
+		planes_[0].dst_width == dst_width && planes_[0].dst_height == dst_height)
+		return true;
+
+	format_ = format;
+	filter_ = filter;
+	planes_.clear();
+
+	auto add_plane = [&](int channels, int sw, int sh, int dw, int dh) {
+		Plane plane;
+		plane.channels = channels;
+		plane.src_width = sw;
+		plane.src_height = sh;
+		plane.dst_width = dw;
+		plane.dst_height = dh;
+		BuildFilterTable(plane.h, sw, dw, filter);
+		BuildFilterTable(plane.v, sh, dh, filter);
+		planes_.push_back(std::move(plane));
+	};
+
+	if (format == Format::kBGRA || format == Format::kBGRAToBGR)
+	{
+		add_plane(4, src_width, src_height, dst_width, dst_height);
+	}
+	else
+	{
+		add_plane(1, src_width, src_height, dst_width, dst_height);
+		add_plane(1, (src_width + 1) / 2, (src_height + 1) / 2, (dst_width + 1) / 2, (dst_height + 1) / 2);
+		add_plane(1, (src_width + 1) / 2, (src_height + 1) / 2, (dst_width + 1) / 2, (dst_height + 1) / 2);
+	}
+	return true;
+}
+
+bool VideoScaler::Scale(const uint8_t* const src[], const int src_linesize[], uint8_t* const dst[], const int dst_linesize[])
+{
+	if (planes_.empty())
+		return false;
+	const Plane& first = planes_[0];
+	if (format_ == Format::kBGRAToBGR && first.src_width == first.dst_width && first.src_height == first.dst_height)
+	{
+		// 同尺寸只去 alpha
+		const bool avx2 = use_simd_ && cpu_has_avx2();
+		for (int y = 0; y < first.dst_height; y++)
+		{
+			const uint8_t* line = src[0] + (size_t)y * src_linesize[0];
+			uint8_t* out = dst[0] + (size_t)y * dst_linesize[0];
+			int done = avx2 ? VideoScalerKernels::PackBGR_AVX2(line, out, first.dst_width) : 0;
+			VideoScalerKernels::PackBGR_C(line, out, done, first.dst_width);
+		}
+		return true;
+	}
+	for (size_t i = 0; i < planes_.size(); i++)
+		ScalePlane(planes_[i], src[i], src_linesize[i], dst[i], dst_linesize[i]);
+	return true;
+}
+
+void VideoScaler::ScalePlane(const Plane& plane, const uint8_t* src, int src_linesize, uint8_t* dst, int dst_linesize)
+{
+	if (task_pool_ && task_pool_->GetThreadCount() && plane.dst_height >= 32)
+	{
+		task_pool_->ParallelFor(plane.dst_height, 16, [&](size_t begin, size_t end) {
+			ScaleBand(plane, src, src_linesize, dst, dst_linesize, (int)begin, (int)end);
+		});
+	}
+	else
+	{
+		ScaleBand(plane, src, src_linesize, dst, dst_linesize, 0, plane.dst_height);
+	}
+}
+
+void VideoScaler::ScaleBand(const Plane& plane, const uint8_t* src, int src_linesize, uint8_t* dst, int dst_linesize,
+	int begin, int end)
+{
+	using namespace VideoScalerKernels;
+
+	const bool avx2 = use_simd_ && cpu_has_avx2();
+	const int vtaps = plane.v.taps;
+	const int row_width = plane.dst_width * plane.channels;
+	const bool pack_bgr = format_ == Format::kBGRAToBGR;
+
+	// 每个线程缓存最近 vtaps 行水平缩放结果，相邻输出行共享大部分源行
+	thread_local std::vector<int16_t> ring;
+	thread_local std::vector<int> ring_rows;
+	thread_local std::vector<const int16_t*> rows;
+	ring.resize((size_t)vtaps * row_width);
+	ring_rows.assign(vtaps, -1);
+	rows.resize(vtaps);
+	// 输出 BGR 时先垂直缩放成 BGRA 行再去 alpha
+	thread_local std::vector<uint8_t> bgra;
+	if (pack_bgr)
+		bgra.resize(row_width);
+
+	for (int y = begin; y < end; y++)
+	{
+		const int start = plane.v.start[y];
+		for (int k = 0; k < vtaps; k++)
+		{
+			const int sy = start + k;
+			const int slot = sy % vtaps;
+			int16_t* inter = &ring[(size_t)slot * row_width];
+			if (ring_rows[slot] != sy)
+			{
+				const uint8_t* line = src + (size_t)sy * src_linesize;
+				if (plane.channels == 4)
+				{
+					if (avx2 && !(plane.h.taps & 1))
+						HScaleBGRA_AVX2(line, inter, plane.h, plane.dst_width);
+					else
+						HScaleBGRA_C(line, inter, plane.h, plane.dst_width);
+				}
+				else
+				{
+					int done = avx2 ? HScalePlane_AVX2(line, inter, plane.h, plane.dst_width) : 0;
+					HScalePlane_C(line, inter, plane.h, done, plane.dst_width);
+				}
+				ring_rows[slot] = sy;
+			}
+			rows[k] = inter;
+		}
+
+		const int16_t* coeffs = &plane.v.coeffs[(size_t)y * vtaps];
+		uint8_t* out = dst + (size_t)y * dst_linesize;
+		uint8_t* line = pack_bgr ? bgra.data() : out;
+		int done = avx2 ? VScale_AVX2(rows.data(), coeffs, vtaps, line, row_width) : 0;
+		VScale_C(rows.data(), coeffs, vtaps, line, done, row_width);
+		if (pack_bgr)
+		{
+			done = avx2 ? PackBGR_AVX2(line, out, plane.dst_width) : 0;
+			PackBGR_C(line, out, done, plane.dst_width);
+		}
+	}
+}
@@ -0,0 +1,85 @@
+#ifndef VIDEO_SCALER_H
+#define VIDEO_SCALER_H
+
+/* CPU 缩放器，用在输出缩放、多路输出降分辨率和检测输入降采样
+* 可分离滤波：先水平再垂直，滤波系数在 Init 时预计算成 14 位定点表
+* 输出行按段分给 TaskPool 并行，支持 AVX2 时走 SIMD 路径
+* 支持 BGRA、I420 (三个平面分别缩放) 和 BGRA 输入 BGR 输出 (检测网络的输入)
+*/
+
+#include <stdint.h>
+#include <vector>
+
+class TaskPool;
+
+class VideoScaler
+{
+public:
+	enum class Filter
+	{
+		kBilinear,
+		kBicubic,
+		kLanczos,
+		// 面积平均：每个目标像素取源图上对应矩形的加权平均，边界像素按覆盖比例计权
+		kArea,
+	};
+
+	enum class Format
+	{
+		kBGRA,
+		kI420,
+		// 按 BGRA 缩放后去掉 alpha，dst 每像素 3 字节
+		kBGRAToBGR,
+	};
+
+	struct FilterTable
+	{
+		// taps 为每个输出点覆盖的源点数，偶数时 SIMD 水平路径可用
+		int taps = 0;
+		std::vector<int32_t> start;
+		// [dst][taps]
+		std::vector<int16_t> coeffs;
+		// [taps][dst]，平面格式水平 SIMD 路径用
+		std::vector<int16_t> coeffs_t;
+		// 小于该下标的输出点 SIMD 读取不会越过行尾
+		int simd_end = 0;
+	};
+
+	VideoScaler();
+	~VideoScaler();
+
+	// 参数和上次相同时直接返回，不重建系数表
+	bool Init(Format format, int src_width, int src_height, int dst_width, int dst_height, Filter filter);
+	// pool 为空时在调用线程单线程缩放
+	void SetTaskPool(TaskPool* pool) { task_pool_ = pool; }
+	void SetUseSimd(bool use_simd) { use_simd_ = use_simd; }
+
+	bool Scale(const uint8_t* const src[], const int src_linesize[], uint8_t* const dst[], const int dst_linesize[]);
+
+	static void BuildFilterTable(FilterTable& table, int src_size, int dst_size, Filter filter);
+
+private:
+	struct Plane
+	{
+		int channels;
+		int src_width;
+		int src_height;
+		int dst_width;
+		int dst_height;
+		FilterTable h;
+		FilterTable v;
+	};
+
+	void ScalePlane(const Plane& plane, const uint8_t* src, int src_linesize, uint8_t* dst, int dst_linesize);
+	void ScaleBand(const Plane& plane, const uint8_t* src, int src_linesize, uint8_t* dst, int dst_linesize,
+		int begin, int end);
+
+private:
+	Format format_ = Format::kBGRA;
+	Filter filter_ = Filter::kBilinear;
+	std::vector<Plane> planes_;
+	TaskPool* task_pool_ = nullptr;
+	bool use_simd_ = true;
+};
+
+#endif
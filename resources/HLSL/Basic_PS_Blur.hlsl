@@ -0,0 +1,26 @@
+#include "Privacy.hlsli"
+
+// 像素着色器(2D)：沿 g_PrivacyTexel.zw 方向的一维高斯模糊，横竖各画一遍
+float4 PS_2D(VertexPosHTex pIn) : SV_Target
+{
+    float2 uv = PrivacyUV(pIn.PosH.xy);
+    float2 step_uv = g_PrivacyTexel.zw * g_PrivacyTexel.xy;
+    float sigma = max(g_PrivacyParam.x, 0.5);
+    float k = -0.5 / (sigma * sigma);
+    int taps = (int)ceil(sigma * 3.0);
+
+    float4 sum = PrivacySample(uv);
+    float total = 1.0;
+    // 相邻两个像素合成一次线性采样，采样次数减半
+    [loop]
+    for (int i = 1; i <= taps; i += 2)
+    {
+        float w0 = exp(k * i * i);
+        float w1 = exp(k * (i + 1) * (i + 1));
+        float w = w0 + w1;
+        float offset = i + w1 / w;
+        sum += (PrivacySample(uv + step_uv * offset) + PrivacySample(uv - step_uv * offset)) * w;
+        total += w * 2.0;
+    }
+    return sum / total;
+}
@@ -0,0 +1,9 @@
+#include "Lut3D.hlsli"
+
+// 像素着色器(2D)：3D LUT 三线性插值，由采样器完成，alpha 不变
+float4 PS_2D(VertexPosHTex pIn) : SV_Target
+{
+    float4 color = g_Tex.Sample(g_SamLinear, pIn.Tex);
+    float3 coord = (LutPosition(color.rgb) + 0.5) / g_LutScale.w;
+    return float4(g_Lut.SampleLevel(g_SamLinear, coord, 0).rgb, color.a);
+}
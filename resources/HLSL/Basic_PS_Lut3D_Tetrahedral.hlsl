@@ -0,0 +1,51 @@
+#include "Lut3D.hlsli"
+
+// 像素着色器(2D)：3D LUT 四面体插值，alpha 不变
+// 格子按 r g b 小数部分的大小顺序切成 6 个四面体，沿对应的棱从 c000 走到 c111
+float4 PS_2D(VertexPosHTex pIn) : SV_Target
+{
+    float4 color = g_Tex.Sample(g_SamLinear, pIn.Tex);
+    float3 pos = LutPosition(color.rgb);
+    float3 base = min(floor(pos), g_LutScale.w - 2.0);
+    float3 f = pos - base;
+    int3 i = int3(base);
+
+    int3 o1, o2;
+    float3 w;
+    if (f.r >= f.g)
+    {
+        if (f.g >= f.b)
+        {
+            o1 = int3(1, 0, 0); o2 = int3(1, 1, 0); w = f.rgb;
+        }
+        else if (f.r >= f.b)
+        {
+            o1 = int3(1, 0, 0); o2 = int3(1, 0, 1); w = f.rbg;
+        }
+        else
+        {
+            o1 = int3(0, 0, 1); o2 = int3(1, 0, 1); w = f.brg;
+        }
+    }
+    else
+    {
+        if (f.b >= f.g)
+        {
+            o1 = int3(0, 0, 1); o2 = int3(0, 1, 1); w = f.bgr;
+        }
+        else if (f.b >= f.r)
+        {
+            o1 = int3(0, 1, 0); o2 = int3(0, 1, 1); w = f.gbr;
+        }
+        else
+        {
+            o1 = int3(0, 1, 0); o2 = int3(1, 1, 0); w = f.grb;
+        }
+    }
+
+    float3 rgb = (1.0 - w.x) * g_Lut.Load(int4(i, 0)).rgb
+        + (w.x - w.y) * g_Lut.Load(int4(i + o1, 0)).rgb
+        + (w.y - w.z) * g_Lut.Load(int4(i + o2, 0)).rgb
+        + w.z * g_Lut.Load(int4(i + 1, 0)).rgb;
+    return float4(rgb, color.a);
+}
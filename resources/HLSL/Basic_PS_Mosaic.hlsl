@@ -0,0 +1,17 @@
+#include "Privacy.hlsli"
+
+// 像素着色器(2D)：马赛克，块按画面原点对齐，块内 4x4 次线性采样取平均
+float4 PS_2D(VertexPosHTex pIn) : SV_Target
+{
+    float block = max(g_PrivacyParam.y, 2.0);
+    float2 cell = floor(pIn.PosH.xy / block) * block;
+    float4 sum = 0.0;
+    [unroll]
+    for (int y = 0; y < 4; y++)
+    {
+        [unroll]
+        for (int x = 0; x < 4; x++)
+            sum += PrivacySample(PrivacyUV(cell + (float2(x, y) + 0.5) * (block / 4.0)));
+    }
+    return sum / 16.0;
+}
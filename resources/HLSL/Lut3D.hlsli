@@ -0,0 +1,15 @@
+#include "Basic.hlsli"
+
+Texture3D g_Lut : register(t1);
+
+cbuffer LutConstantBuffer : register(b0)
+{
+    float4 g_LutScale;  // xyz: 1 / (DOMAIN_MAX - DOMAIN_MIN)，w: LUT 边长
+    float4 g_LutOffset; // xyz: -DOMAIN_MIN * g_LutScale
+}
+
+// 输入颜色在 LUT 里的格点坐标 (0 到边长 - 1)
+float3 LutPosition(float3 color)
+{
+    return saturate(color * g_LutScale.xyz + g_LutOffset.xyz) * (g_LutScale.w - 1.0);
+}
@@ -0,0 +1,20 @@
+#include "Basic.hlsli"
+
+cbuffer PrivacyConstantBuffer : register(b0)
+{
+    float4 g_PrivacyTexel; // xy: 1 / 纹理宽高，zw: 模糊方向，(1, 0) 或 (0, 1)
+    float4 g_PrivacyParam; // x: 高斯模糊的 sigma (像素)，y: 马赛克块大小 (像素)
+}
+
+// 只画人脸区域的小四边形，纹理坐标按屏幕位置算，输入输出大小相同
+float2 PrivacyUV(float2 pixel)
+{
+    return pixel * g_PrivacyTexel.xy;
+}
+
+// 采样器是 WRAP，手动钳到边缘像素中心
+float4 PrivacySample(float2 uv)
+{
+    float2 half_texel = g_PrivacyTexel.xy * 0.5;
+    return g_Tex.SampleLevel(g_SamLinear, clamp(uv, half_texel, 1.0 - half_texel), 0);
+}